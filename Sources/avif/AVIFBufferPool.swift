@@ -0,0 +1,60 @@
+//
+//  AVIFBufferPool.swift
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+import Foundation
+import avifc
+
+/// Pool of pixel buffers backing decoded images.
+/// When an image is deallocated its buffer is kept for the next decoding of a similar size
+/// instead of being freed, within `budget` bytes. The pool is emptied on memory pressure.
+public enum AVIFBufferPool {
+
+    /// Maximum amount of bytes retained by idle buffers, 0 disables pooling
+    public static var budget: Int {
+        get { Int(AVIFPixelBufferPool.budget()) }
+        set { AVIFPixelBufferPool.setBudget(UInt(max(newValue, 0))) }
+    }
+
+    /// Amount of buffers served from the pool
+    public static var hits: UInt64 {
+        AVIFPixelBufferPool.hits()
+    }
+
+    /// Amount of buffers which had to be allocated
+    public static var misses: UInt64 {
+        AVIFPixelBufferPool.misses()
+    }
+
+    /// Bytes currently held by idle buffers
+    public static var bytesRetained: UInt64 {
+        AVIFPixelBufferPool.bytesRetained()
+    }
+
+    /// Frees every idle buffer
+    public static func trim() {
+        AVIFPixelBufferPool.trim()
+    }
+}
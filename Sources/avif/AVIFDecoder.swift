@@ -73,6 +73,9 @@ public final class AVIFDecoder {
     }
 
     public static func readSize(data: Data) throws -> CGSize {
+        if let info = try? readInfo(data: data) {
+            return CGSize(width: CGFloat(info.width), height: CGFloat(info.height))
+        }
         guard let decoder = avifDecoderCreate() else {
             throw AVIFUnderlyingError(underlyingError: "Can't initialize decoder")
         }
@@ -94,6 +97,9 @@ public final class AVIFDecoder {
     }
 
     public static func readSize(path: String) throws -> CGSize {
+        if let info = try? readInfo(path: path) {
+            return CGSize(width: CGFloat(info.width), height: CGFloat(info.height))
+        }
         guard let decoder = avifDecoderCreate() else {
             throw AVIFUnderlyingError(underlyingError: "Can't initialize decoder")
         }
@@ -114,6 +120,32 @@ public final class AVIFDecoder {
     public static func readSize(at: URL) throws -> CGSize {
         return try readSize(path: at.path)
     }
+
+    /// Reads the basic image description from the header boxes only, without a full parse.
+    /// Throws if the needed boxes are not in `data`, e.g. when only a prefix of an unusual file is given
+    public static func readInfo(data: Data) throws -> AVIFImageInfo {
+        var info = avifImageInfo()
+        let result = data.withUnsafeBytes { pointer -> avifResult in
+            guard let baseAddress = pointer.baseAddress else {
+                return AVIF_RESULT_TRUNCATED_DATA
+            }
+            var input = avifROData(data: baseAddress.assumingMemoryBound(to: UInt8.self), size: data.count)
+            return avifPeekImageInfo(&input, &info)
+        }
+        if result != AVIF_RESULT_OK {
+            throw AVIFUnderlyingError(underlyingError: String(utf8String: avifResultToString(result)) ?? "Unknown error")
+        }
+        return AVIFImageInfo(info)
+    }
+
+    /// Reads the basic image description from the first 64 KB of the file
+    public static func readInfo(path: String) throws -> AVIFImageInfo {
+        guard let handle = FileHandle(forReadingAtPath: path) else {
+            throw OpenStreamError()
+        }
+        defer { handle.closeFile() }
+        return try readInfo(data: handle.readData(ofLength: 64 * 1024))
+    }
     
     public static func decode(at: URL, scale: CGFloat = 1, sampleSize: CGSize = .zero) throws -> PlatformImage {
         guard let iStream = InputStream(url: at) else {
@@ -0,0 +1,54 @@
+//
+//  AVIFImageInfo.swift
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+import Foundation
+import avifc
+
+/// Image description read from the header boxes by `AVIFDecoder.readInfo`
+public struct AVIFImageInfo {
+    public let width: Int
+    public let height: Int
+    public let bitDepth: Int
+    public let hasAlpha: Bool
+    /// 1 for still images
+    public let frameCount: Int
+    public let isSequence: Bool
+    public let hasGainMap: Bool
+    /// PQ or HLG transfer characteristics
+    public let isHDR: Bool
+
+    init(_ info: avifImageInfo) {
+        width = Int(info.width)
+        height = Int(info.height)
+        bitDepth = Int(info.depth)
+        hasAlpha = info.alphaPresent == AVIF_TRUE
+        frameCount = Int(info.frameCount)
+        isSequence = info.isSequence == AVIF_TRUE
+        hasGainMap = info.gainMapPresent == AVIF_TRUE
+        let transfer = Int(info.transferCharacteristics)
+        isHDR = transfer == AVIF_TRANSFER_CHARACTERISTICS_PQ || transfer == AVIF_TRANSFER_CHARACTERISTICS_HLG
+    }
+}
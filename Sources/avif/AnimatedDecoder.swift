@@ -27,6 +27,13 @@ import Foundation
 import avifc
 
 public class AnimatedDecoder {
+
+    public enum FrameCachePolicy {
+        /// Keeps every converted frame while they fit the budget
+        case keepAll
+        /// Keeps only the given amount of most recently used frames
+        case ringBuffer(Int)
+    }
     
     private let mAVIFAnimatedDecoder: AVIFAnimatedDecoder
     
@@ -66,5 +73,30 @@ public class AnimatedDecoder {
         }
         return image.takeRetainedValue()
     }
-    
+
+    /// Sets how converted frames are kept, `budget` is in bytes and 0 disables the cache
+    public func setCachePolicy(_ policy: FrameCachePolicy, budget: Int = 32 * 1024 * 1024) {
+        switch policy {
+        case .keepAll:
+            mAVIFAnimatedDecoder.setCachePolicy(.keepAll, capacity: 0, budget: UInt(max(budget, 0)))
+        case .ringBuffer(let capacity):
+            mAVIFAnimatedDecoder.setCachePolicy(.ringBuffer, capacity: Int32(capacity), budget: UInt(max(budget, 0)))
+        }
+    }
+
+    /// Amount of frames decoded in background after the last requested one, 0 disables prefetching
+    public var prefetchCount: Int = 2 {
+        didSet {
+            mAVIFAnimatedDecoder.setPrefetchCount(Int32(prefetchCount))
+        }
+    }
+
+    public var cacheHits: UInt64 {
+        mAVIFAnimatedDecoder.cacheHits()
+    }
+
+    public var cacheMisses: UInt64 {
+        mAVIFAnimatedDecoder.cacheMisses()
+    }
+
 }
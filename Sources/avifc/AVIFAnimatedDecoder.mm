@@ -29,9 +29,121 @@
 #import "PlatformImage.h"
 #import "AVIFImageXForm.h"
 #import <thread>
+#import <mutex>
+#import <atomic>
+#import <list>
+#import <unordered_map>
+
+/**
+ * Converted frames by index, least recently used are evicted first once the byte budget
+ * or the maximum amount of frames is exceeded.
+ */
+class FrameCache {
+public:
+    ~FrameCache() {
+        clear();
+    }
+
+    /**
+     * Returns the cached frame retained, or nullptr
+     */
+    CGImageRef copy(int frame) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = mIndex.find(frame);
+        if (it == mIndex.end()) {
+            mMisses += 1;
+            return nullptr;
+        }
+        mHits += 1;
+        mEntries.splice(mEntries.begin(), mEntries, it->second);
+        return CGImageRetain(it->second->image);
+    }
+
+    bool contains(int frame) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mIndex.find(frame) != mIndex.end();
+    }
+
+    void insert(int frame, CGImageRef image) {
+        const size_t bytes = CGImageGetBytesPerRow(image) * CGImageGetHeight(image);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (bytes > mBudget || mIndex.find(frame) != mIndex.end()) {
+            return;
+        }
+        mEntries.push_front(Entry {.frame = frame, .image = CGImageRetain(image), .bytes = bytes});
+        mIndex[frame] = mEntries.begin();
+        mBytes += bytes;
+        trim();
+    }
+
+    /**
+     * @param maxFrames 0 for no limit on the amount of frames
+     */
+    void setLimits(size_t maxFrames, size_t budget) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxFrames = maxFrames;
+        mBudget = budget;
+        trim();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto &entry: mEntries) {
+            CGImageRelease(entry.image);
+        }
+        mEntries.clear();
+        mIndex.clear();
+        mBytes = 0;
+    }
+
+    uint64_t hits() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mHits;
+    }
+
+    uint64_t misses() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mMisses;
+    }
+
+private:
+    struct Entry {
+        int frame;
+        CGImageRef image;
+        size_t bytes;
+    };
+
+    void trim() {
+        while (!mEntries.empty() && (mBytes > mBudget || (mMaxFrames > 0 && mEntries.size() > mMaxFrames))) {
+            Entry &entry = mEntries.back();
+            mBytes -= entry.bytes;
+            mIndex.erase(entry.frame);
+            CGImageRelease(entry.image);
+            mEntries.pop_back();
+        }
+    }
+
+    std::mutex mMutex;
+    std::list<Entry> mEntries;
+    std::unordered_map<int, std::list<Entry>::iterator> mIndex;
+    size_t mBytes = 0;
+    size_t mBudget = 32 * 1024 * 1024;
+    size_t mMaxFrames = 0;
+    uint64_t mHits = 0;
+    uint64_t mMisses = 0;
+};
 
 @implementation AVIFAnimatedDecoder {
     avifDecoder *_idec;
+    // The decoder reads from the data in place
+    NSData *_data;
+    // avifDecoder is not thread safe, requests and prefetching take turns on it
+    std::mutex _decoderLock;
+    FrameCache _cache;
+    dispatch_queue_t _prefetchQueue;
+    std::atomic<int> _prefetchCount;
+    // Bumped on every request, so prefetching for a stale playhead gives up
+    std::atomic<uint64_t> _prefetchGeneration;
 }
 
 -(nullable id)initWithData:(nonnull NSData*)data {
@@ -40,6 +152,7 @@
         return nil;
     }
 
+    _data = data;
     auto result = avifDecoderSetIOMemory(_idec, reinterpret_cast<const uint8_t*>(data.bytes), data.length);
     if (result != AVIF_RESULT_OK) {
         avifDecoderDestroy(_idec);
@@ -58,6 +171,9 @@
         _idec = nullptr;
         return nil;
     }
+    _prefetchQueue = dispatch_queue_create("com.avif.swift.prefetch", DISPATCH_QUEUE_SERIAL);
+    _prefetchCount = 2;
+    _prefetchGeneration = 0;
     return self;
 }
 
@@ -74,16 +190,81 @@
     return image;
 }
 
--(nullable CGImageRef)get:(int)frame {
+-(nullable CGImageRef)decodeFrame:(int)frame {
+    std::lock_guard<std::mutex> lock(_decoderLock);
     avifResult nextImageResult = avifDecoderNthImage(_idec, frame);
     if (nextImageResult != AVIF_RESULT_OK) {
         return nil;
     }
     auto xForm = [[AVIFImageXForm alloc] init];
-    return [xForm formCGImage:_idec scale:1];
+    CGImageRef image = [xForm formCGImage:_idec scale:1];
+    if (image) {
+        _cache.insert(frame, image);
+    }
+    return image;
+}
+
+-(nullable CGImageRef)get:(int)frame {
+    CGImageRef image = _cache.copy(frame);
+    if (!image) {
+        image = [self decodeFrame:frame];
+    }
+    if (image) {
+        [self prefetchAfter:frame];
+    }
+    return image;
+}
+
+-(void)prefetchAfter:(int)frame {
+    const int prefetchCount = std::min(_prefetchCount.load(), _idec->imageCount - 1);
+    const uint64_t generation = ++_prefetchGeneration;
+    if (prefetchCount <= 0) {
+        return;
+    }
+    const int framesCount = _idec->imageCount;
+    __weak AVIFAnimatedDecoder *weakSelf = self;
+    dispatch_async(_prefetchQueue, ^{
+        for (int i = 1; i <= prefetchCount; ++i) {
+            AVIFAnimatedDecoder *strongSelf = weakSelf;
+            // Playhead has moved on, the next request schedules its own frames
+            if (!strongSelf || strongSelf->_prefetchGeneration.load() != generation) {
+                return;
+            }
+            const int next = (frame + i) % framesCount;
+            if (strongSelf->_cache.contains(next)) {
+                continue;
+            }
+            CGImageRef image = [strongSelf decodeFrame:next];
+            if (!image) {
+                return;
+            }
+            CGImageRelease(image);
+        }
+    });
+}
+
+-(void)setCachePolicy:(AVIFFrameCachePolicy)policy capacity:(int)capacity budget:(NSUInteger)budget {
+    size_t maxFrames = 0;
+    if (policy == kRingBuffer) {
+        maxFrames = static_cast<size_t>(std::max(capacity, 1));
+    }
+    _cache.setLimits(maxFrames, budget);
+}
+
+-(void)setPrefetchCount:(int)prefetchCount {
+    _prefetchCount = std::max(prefetchCount, 0);
+}
+
+-(uint64_t)cacheHits {
+    return _cache.hits();
+}
+
+-(uint64_t)cacheMisses {
+    return _cache.misses();
 }
 
 -(int)frameDuration:(int)frame {
+    std::lock_guard<std::mutex> lock(_decoderLock);
     avifImageTiming timing;
     auto result = avifDecoderNthImageTiming(_idec, frame, &timing);
     if (result != AVIF_RESULT_OK) {
@@ -105,10 +286,13 @@
 }
 
 -(CGSize)imageSize {
+    std::lock_guard<std::mutex> lock(_decoderLock);
     return CGSizeMake(_idec->image->width, _idec->image->height);
 }
 
 - (void)dealloc {
+    // Queued prefetch blocks hold only a weak reference and find nil
+    _prefetchGeneration += 1;
     if (_idec) {
         avifDecoderDestroy(_idec);
         _idec = NULL;
@@ -28,15 +28,178 @@
 #import "avif/avif.h"
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <list>
 #import "avifpixart.h"
 #import "ColorSpace.h"
+#import "AVIFOutputData.h"
+#include "PremultipliedYuv.hpp"
 
-static void releaseSharedAEncoderImage(avifImage* image) {
-    avifImageDestroy(image);
+/**
+ * Images of encoded frames kept for the next frames of the same geometry, so an animation allocates its planes once
+ * instead of once per frame. Images are handed out as shared pointers that come back to the pool when released,
+ * the most recently released are reused first and only `capacity` idle images are kept.
+ */
+class ImagePlanePool : public std::enable_shared_from_this<ImagePlanePool> {
+public:
+    ~ImagePlanePool() {
+        clear();
+    }
+
+    /**
+     * Returns an image with allocated planes, their contents are undefined. Metadata is always the one of a freshly
+     * created image, nothing set for a previous frame is carried over. nullptr if allocation has failed
+     */
+    std::shared_ptr<avifImage> acquire(uint32_t width, uint32_t height, uint32_t depth, avifPixelFormat format, bool alpha) {
+        const Key key = { width, height, depth, format, alpha };
+        avifImage* image = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto it = mIdle.begin(); it != mIdle.end(); ++it) {
+                if (it->key == key) {
+                    image = it->image;
+                    mIdle.erase(it);
+                    mReused += 1;
+                    break;
+                }
+            }
+        }
+        if (image) {
+            resetMetadata(image);
+        } else {
+            image = avifImageCreate(width, height, depth, format);
+            if (!image) {
+                return nullptr;
+            }
+            if (avifImageAllocatePlanes(image, alpha ? AVIF_PLANES_ALL : AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+                avifImageDestroy(image);
+                return nullptr;
+            }
+            std::lock_guard<std::mutex> lock(mMutex);
+            mAllocated += 1;
+        }
+        std::weak_ptr<ImagePlanePool> weakPool = shared_from_this();
+        return std::shared_ptr<avifImage>(image, [weakPool, key](avifImage* released) {
+            if (auto pool = weakPool.lock()) {
+                pool->recycle(released, key);
+            } else {
+                avifImageDestroy(released);
+            }
+        });
+    }
+
+    void setCapacity(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCapacity = capacity;
+        trimLocked();
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto& entry: mIdle) {
+            avifImageDestroy(entry.image);
+        }
+        mIdle.clear();
+    }
+
+    uint64_t reused() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mReused;
+    }
+
+    uint64_t allocated() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mAllocated;
+    }
+
+private:
+    struct Key {
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        avifPixelFormat format;
+        bool alpha;
+
+        bool operator==(const Key& other) const {
+            return width == other.width && height == other.height && depth == other.depth &&
+                   format == other.format && alpha == other.alpha;
+        }
+    };
+
+    struct Entry {
+        Key key;
+        avifImage* image;
+    };
+
+    /**
+     * Brings everything except the planes back to the defaults of avifImageCreate
+     */
+    static void resetMetadata(avifImage* image) {
+        image->yuvRange = AVIF_RANGE_FULL;
+        image->yuvChromaSamplePosition = AVIF_CHROMA_SAMPLE_POSITION_UNKNOWN;
+        image->alphaPremultiplied = AVIF_FALSE;
+        image->colorPrimaries = AVIF_COLOR_PRIMARIES_UNSPECIFIED;
+        image->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED;
+        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED;
+        image->clli = {};
+        image->transformFlags = AVIF_TRANSFORM_NONE;
+        image->pasp = {};
+        image->clap = {};
+        image->irot = {};
+        image->imir = {};
+        avifRWDataFree(&image->icc);
+        avifRWDataFree(&image->exif);
+        avifRWDataFree(&image->xmp);
+    }
+
+    void recycle(avifImage* image, const Key& key) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIdle.push_front({ key, image });
+        trimLocked();
+    }
+
+    void trimLocked() {
+        while (mIdle.size() > mCapacity) {
+            avifImageDestroy(mIdle.back().image);
+            mIdle.pop_back();
+        }
+    }
+
+    std::mutex mMutex;
+    // Most recently released images are at the front
+    std::list<Entry> mIdle;
+    size_t mCapacity = 4;
+    uint64_t mReused = 0;
+    uint64_t mAllocated = 0;
+};
+
+static uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
 }
 
 @implementation AVIFAnimatedEncoder {
     avifEncoder * encoder;
+    FILE* streamFile;
+    NSString* streamPath;
+    // Asynchronous frames are converted on one stage and encoded on the next one, both serial so order is kept
+    dispatch_queue_t conversionQueue;
+    dispatch_queue_t encodeQueue;
+    dispatch_group_t pendingGroup;
+    dispatch_semaphore_t pendingSlots;
+    NSInteger maxPendingFrames;
+    std::atomic<NSInteger> pendingCount;
+    // First failure of an asynchronous frame, the following frames are dropped
+    std::mutex pipelineErrorLock;
+    NSError* pipelineError;
+    std::atomic<uint64_t> backPressureCount;
+    std::atomic<uint64_t> backPressureNanos;
+    std::atomic<uint64_t> conversionNanos;
+    std::atomic<uint64_t> encodeNanos;
+    std::atomic<uint64_t> convertedFrames;
+    std::shared_ptr<ImagePlanePool> imagePool;
 }
 
 -(void)dealloc {
@@ -66,49 +229,40 @@ static void releaseSharedAEncoderImage(avifImage* image) {
     }
     encoder->codecChoice = choice;
 
+    maxPendingFrames = 3;
+    pendingCount = 0;
+    backPressureCount = 0;
+    backPressureNanos = 0;
+    conversionNanos = 0;
+    encodeNanos = 0;
+    convertedFrames = 0;
+    // Every frame in flight holds an image, plus the one being converted
+    imagePool = std::make_shared<ImagePlanePool>();
+    imagePool->setCapacity(maxPendingFrames + 1);
+
     return (__bridge void * _Nullable)(self);
 }
 
-- (void* _Nullable)addImage:(Image * _Nonnull)platformImage duration:(NSUInteger)duration error:(NSError * _Nullable * _Nullable)error {
-    if (!encoder) {
-        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Encoder aws not allocated" }];
-        return nil;
-    }
+- (std::shared_ptr<avifImage>)convertImage:(Image * _Nonnull)platformImage error:(NSError * _Nullable * _Nullable)error {
+    auto conversionStart = std::chrono::steady_clock::now();
     uint32_t width;
     uint32_t height;
-    auto sourceImage = [platformImage rgbaPixels:&width imageHeight:&height];
+    // Unpremultiplication is fused with the YUV conversion below
+    auto sourceImage = [platformImage premultipliedRgbaPixels:&width imageHeight:&height];
     if (!sourceImage) {
         *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
                                             code:500
                                         userInfo:@{ NSLocalizedDescriptionKey: @"Fetching image pixels has failed" }];
-        return nil;
+        return nullptr;
     }
     
-    auto img = avifImageCreate(width, height, (uint32_t)8, AVIF_PIXEL_FORMAT_YUV420);
-
-    if (!img) {
+    // Planes of the previous frames are reused when the size and the alpha presence are the same
+    auto image = imagePool->acquire(width, height, 8, AVIF_PIXEL_FORMAT_YUV420, sourceImage.sourceHasAlpha);
+    if (!image) {
         *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
                                             code:500
                                         userInfo:@{ NSLocalizedDescriptionKey: @"Memory allocation for image has failed" }];
-        return nil;
-    }
-    
-    std::shared_ptr<avifImage> image(img, releaseSharedAEncoderImage);
-    
-    if (sourceImage.sourceHasAlpha) {
-        if (avifImageAllocatePlanes(image.get(), AVIF_PLANES_ALL) != AVIF_RESULT_OK) {
-            *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
-                                                code:500
-                                            userInfo:@{ NSLocalizedDescriptionKey: @"Memory allocation for image has failed" }];
-            return nil;
-        }
-    } else {
-        if (avifImageAllocatePlanes(image.get(), AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
-            *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
-                                                code:500
-                                            userInfo:@{ NSLocalizedDescriptionKey: @"Memory allocation for image has failed" }];
-            return nil;
-        }
+        return nullptr;
     }
     
     [ColorSpace apply:image.get() colorSpace: [sourceImage colorSpace]];
@@ -119,17 +273,55 @@ static void releaseSharedAEncoderImage(avifImage* image) {
         matrix = YuvMatrix::Bt2020;
     }
     
-    pixart_rgba8_to_yuv8(image->yuvPlanes[0], image->yuvRowBytes[0],
-                         image->yuvPlanes[1], image->yuvRowBytes[1],
-                         image->yuvPlanes[2], image->yuvRowBytes[2],
-                         [sourceImage data], width * 4,
-                         width, height,
-                         YuvRange::Tv, YuvMatrix::YCgCo, YuvType::Yuv420);
+    if (sourceImage.sourceHasAlpha) {
+        // Unpremultiplies, converts and copies the alpha out in a single pass over the pixels
+        premultipliedRgba8ToYuv8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                                 image->yuvPlanes[1], image->yuvRowBytes[1],
+                                 image->yuvPlanes[2], image->yuvRowBytes[2],
+                                 image->alphaPlane, image->alphaRowBytes,
+                                 [sourceImage data], width * 4,
+                                 width, height,
+                                 YuvRange::Tv, YuvMatrix::YCgCo, YuvType::Yuv420);
+    } else {
+        // Opaque pixels are the same premultiplied or not
+        pixart_rgba8_to_yuv8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                             image->yuvPlanes[1], image->yuvRowBytes[1],
+                             image->yuvPlanes[2], image->yuvRowBytes[2],
+                             [sourceImage data], width * 4,
+                             width, height,
+                             YuvRange::Tv, YuvMatrix::YCgCo, YuvType::Yuv420);
+    }
     
     image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_YCGCO;
     image->yuvRange = AVIF_RANGE_LIMITED;
     
-    avifResult addImageResult = avifEncoderAddImage(encoder, image.get(), (int)round(1000.0f * (float)duration), AVIF_ADD_IMAGE_FLAG_NONE);
+    conversionNanos += nanosecondsSince(conversionStart);
+    convertedFrames += 1;
+    return image;
+}
+
+- (avifResult)encodeConverted:(avifImage * _Nonnull)image duration:(NSUInteger)duration {
+    auto encodeStart = std::chrono::steady_clock::now();
+    avifResult addImageResult = avifEncoderAddImage(encoder, image, (int)round(1000.0f * (float)duration), AVIF_ADD_IMAGE_FLAG_NONE);
+    encodeNanos += nanosecondsSince(encodeStart);
+    return addImageResult;
+}
+
+- (void* _Nullable)addImage:(Image * _Nonnull)platformImage duration:(NSUInteger)duration error:(NSError * _Nullable * _Nullable)error {
+    if (!encoder) {
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Encoder aws not allocated" }];
+        return nil;
+    }
+    // Frames queued with addImageAsync go first
+    if (![self waitForPendingImages:error]) {
+        return nil;
+    }
+    auto image = [self convertImage:platformImage error:error];
+    if (!image) {
+        return nil;
+    }
+    
+    avifResult addImageResult = [self encodeConverted:image.get() duration:duration];
     if (addImageResult != AVIF_RESULT_OK) {
         [self cleanUp];
         *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"add image failed with result: %s", avifResultToString(addImageResult)] }];
@@ -139,7 +331,134 @@ static void releaseSharedAEncoderImage(avifImage* image) {
     return (__bridge void * _Nullable)(self);
 }
 
+- (void)recordPipelineError:(NSError * _Nonnull)error {
+    std::lock_guard<std::mutex> lock(pipelineErrorLock);
+    if (!pipelineError) {
+        pipelineError = error;
+    }
+}
+
+- (BOOL)hasPipelineError {
+    std::lock_guard<std::mutex> lock(pipelineErrorLock);
+    return pipelineError != nil;
+}
+
+- (BOOL)addImageAsync:(Image * _Nonnull)platformImage duration:(NSUInteger)duration error:(NSError * _Nullable * _Nullable)error {
+    if (!encoder) {
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Encoder aws not allocated" }];
+        return NO;
+    }
+    if (!conversionQueue) {
+        conversionQueue = dispatch_queue_create("com.avif.swift.encoder.conversion", DISPATCH_QUEUE_SERIAL);
+        encodeQueue = dispatch_queue_create("com.avif.swift.encoder.encode", DISPATCH_QUEUE_SERIAL);
+        pendingGroup = dispatch_group_create();
+        pendingSlots = dispatch_semaphore_create(maxPendingFrames);
+    }
+    if ([self hasPipelineError]) {
+        return [self waitForPendingImages:error];
+    }
+
+    // Back-pressure: a frame holds its RGBA and YUV copies until it is encoded, so only a few may be in flight
+    if (dispatch_semaphore_wait(pendingSlots, DISPATCH_TIME_NOW) != 0) {
+        auto waitStart = std::chrono::steady_clock::now();
+        dispatch_semaphore_wait(pendingSlots, DISPATCH_TIME_FOREVER);
+        backPressureCount += 1;
+        backPressureNanos += nanosecondsSince(waitStart);
+    }
+    pendingCount += 1;
+
+    dispatch_group_enter(pendingGroup);
+    dispatch_async(conversionQueue, ^{
+        NSError* conversionError = nil;
+        std::shared_ptr<avifImage> image;
+        if (![self hasPipelineError]) {
+            @autoreleasepool {
+                image = [self convertImage:platformImage error:&conversionError];
+            }
+            if (!image) {
+                [self recordPipelineError:conversionError];
+            }
+        }
+        dispatch_async(encodeQueue, ^{
+            if (image && ![self hasPipelineError]) {
+                avifResult addImageResult = [self encodeConverted:image.get() duration:duration];
+                if (addImageResult != AVIF_RESULT_OK) {
+                    [self recordPipelineError:[[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"add image failed with result: %s", avifResultToString(addImageResult)] }]];
+                }
+            }
+            pendingCount -= 1;
+            dispatch_semaphore_signal(pendingSlots);
+            dispatch_group_leave(pendingGroup);
+        });
+    });
+    return YES;
+}
+
+- (BOOL)waitForPendingImages:(NSError * _Nullable * _Nullable)error {
+    if (pendingGroup) {
+        dispatch_group_wait(pendingGroup, DISPATCH_TIME_FOREVER);
+    }
+    std::lock_guard<std::mutex> lock(pipelineErrorLock);
+    if (pipelineError) {
+        *error = pipelineError;
+        return NO;
+    }
+    return YES;
+}
+
+/**
+ * Frames queued with `addImageAsync` are encoded with the settings they were added with, and the encode stage must not
+ * read the encoder while it is changed. A failure of those frames is reported by the call finishing the file
+ */
+- (void)waitForSettingsChange {
+    NSError* pendingError = nil;
+    [self waitForPendingImages:&pendingError];
+}
+
+- (void)setMaxPendingFrames:(NSInteger)count {
+    if (!pendingSlots) {
+        maxPendingFrames = MAX(count, 1);
+        if (imagePool) {
+            imagePool->setCapacity(maxPendingFrames + 1);
+        }
+    }
+}
+
+- (NSInteger)pendingFrames {
+    return pendingCount.load();
+}
+
+- (NSUInteger)backPressureCount {
+    return static_cast<NSUInteger>(backPressureCount.load());
+}
+
+- (NSTimeInterval)backPressureTime {
+    return static_cast<NSTimeInterval>(backPressureNanos.load()) / 1e9;
+}
+
+- (NSTimeInterval)conversionTime {
+    return static_cast<NSTimeInterval>(conversionNanos.load()) / 1e9;
+}
+
+- (NSTimeInterval)encodeTime {
+    return static_cast<NSTimeInterval>(encodeNanos.load()) / 1e9;
+}
+
+- (double)conversionFramesPerSecond {
+    const uint64_t nanos = conversionNanos.load();
+    return nanos > 0 ? static_cast<double>(convertedFrames.load()) * 1e9 / static_cast<double>(nanos) : 0;
+}
+
+- (NSUInteger)reusedImagesCount {
+    return imagePool ? static_cast<NSUInteger>(imagePool->reused()) : 0;
+}
+
+- (NSUInteger)allocatedImagesCount {
+    return imagePool ? static_cast<NSUInteger>(imagePool->allocated()) : 0;
+}
+
 - (void)setCompressionQuality:(double)quality {
+    [self waitForSettingsChange];
     int rescaledQuality = AVIF_QUANTIZER_WORST_QUALITY - (int)((quality) * AVIF_QUANTIZER_WORST_QUALITY);
     if (encoder) {
         encoder->minQuantizer = rescaledQuality;
@@ -148,6 +467,7 @@ static void releaseSharedAEncoderImage(avifImage* image) {
 }
 
 - (void)setLoopsCount:(NSInteger)loopsCount {
+    [self waitForSettingsChange];
     if (encoder) {
         encoder->repetitionCount = static_cast<int>(loopsCount);
     }
@@ -158,6 +478,14 @@ static void releaseSharedAEncoderImage(avifImage* image) {
         *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Encoder aws not allocated" }];
         return nil;
     }
+    if (streamFile) {
+        *error = [self streamingActiveError];
+        return nil;
+    }
+    if (![self waitForPendingImages:error]) {
+        [self cleanUp];
+        return nil;
+    }
     avifRWData avifOutput = AVIF_DATA_EMPTY;
     avifResult finishResult = avifEncoderFinish(encoder, &avifOutput);
     if (finishResult != AVIF_RESULT_OK) {
@@ -168,25 +496,147 @@ static void releaseSharedAEncoderImage(avifImage* image) {
         return nil;
     }
     
-    NSData *result = [[NSData alloc] initWithBytes:avifOutput.data length:avifOutput.size];
-    
-    avifRWDataFree(&avifOutput);
+    NSData *result = AVIFDataTakingRWData(&avifOutput);
     [self cleanUp];
     
     return result;
 }
 
+- (NSError*)streamingActiveError {
+    // Frames already went to the streaming file, the encoder can only be finished into it
+    return [[NSError alloc] initWithDomain:@"AVIFEncoder"
+                                      code:500
+                                  userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"Streaming to %@ is active, call finishStreaming to complete the file", streamPath] }];
+}
+
+static avifResult writeToFile(void* userData, const uint8_t* data, size_t size) {
+    FILE* file = reinterpret_cast<FILE*>(userData);
+    return fwrite(data, 1, size, file) == size ? AVIF_RESULT_OK : AVIF_RESULT_IO_ERROR;
+}
+
+- (BOOL)startStreamingToPath:(nonnull NSString*)path error:(NSError * _Nullable *_Nullable)error {
+    if (!encoder) {
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Encoder aws not allocated" }];
+        return NO;
+    }
+    // Frames queued with addImageAsync still use the encoder, streaming is rejected below if any frame was added
+    if (![self waitForPendingImages:error]) {
+        [self cleanUp];
+        return NO;
+    }
+    FILE* file = fopen([path fileSystemRepresentation], "wb");
+    if (!file) {
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"Failed to open %@ for writing", path] }];
+        return NO;
+    }
+    // Every added frame is written out as soon as the codec outputs it, the boxes describing them follow at the end
+    avifResult streamingResult = avifEncoderSetStreamingSink(encoder, writeToFile, file);
+    if (streamingResult != AVIF_RESULT_OK) {
+        fclose(file);
+        remove([path fileSystemRepresentation]);
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"streaming is not available: %s", avifResultToString(streamingResult)] }];
+        return NO;
+    }
+    streamFile = file;
+    streamPath = path;
+    return YES;
+}
+
+- (BOOL)finishStreaming:(NSError * _Nullable *_Nullable)error {
+    if (!encoder || !streamFile) {
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Streaming was not started" }];
+        return NO;
+    }
+    if (![self waitForPendingImages:error]) {
+        [self cleanUp];
+        return NO;
+    }
+    avifRWData avifOutput = AVIF_DATA_EMPTY;
+    avifResult finishResult = avifEncoderFinish(encoder, &avifOutput);
+    avifRWDataFree(&avifOutput);
+    if (fclose(streamFile) != 0 && finishResult == AVIF_RESULT_OK) {
+        finishResult = AVIF_RESULT_IO_ERROR;
+    }
+    streamFile = nullptr;
+    NSString* path = streamPath;
+    [self cleanUp];
+    if (finishResult != AVIF_RESULT_OK) {
+        remove([path fileSystemRepresentation]);
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"encoding failed with result: %s", avifResultToString(finishResult)] }];
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)encodeToPath:(nonnull NSString*)path error:(NSError * _Nullable *_Nullable)error {
+    if (!encoder) {
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Encoder aws not allocated" }];
+        return NO;
+    }
+    if (streamFile) {
+        *error = [self streamingActiveError];
+        return NO;
+    }
+    if (![self waitForPendingImages:error]) {
+        [self cleanUp];
+        return NO;
+    }
+    FILE* file = fopen([path fileSystemRepresentation], "wb");
+    if (!file) {
+        [self cleanUp];
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"Failed to open %@ for writing", path] }];
+        return NO;
+    }
+    // Encoded frames are written straight from the encoder, the file is never assembled in memory
+    avifResult finishResult = avifEncoderFinishToSink(encoder, writeToFile, file);
+    if (fclose(file) != 0 && finishResult == AVIF_RESULT_OK) {
+        finishResult = AVIF_RESULT_IO_ERROR;
+    }
+    [self cleanUp];
+    if (finishResult != AVIF_RESULT_OK) {
+        remove([path fileSystemRepresentation]);
+        *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
+                                            code:500
+                                        userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat: @"encoding failed with result: %s", avifResultToString(finishResult)] }];
+        return NO;
+    }
+    return YES;
+}
+
 - (void)setSpeed:(NSInteger)speed {
+    [self waitForSettingsChange];
     if (encoder) {
         encoder->speed = (int)MAX(MIN(speed, AVIF_SPEED_FASTEST), AVIF_SPEED_SLOWEST);
     }
 }
 
 - (void)cleanUp {
+    if (pendingGroup) {
+        // Asynchronous frames still use the encoder
+        dispatch_group_wait(pendingGroup, DISPATCH_TIME_FOREVER);
+    }
     if (encoder) {
         avifEncoderDestroy(encoder);
         encoder = nil;
     }
+    if (imagePool) {
+        imagePool->clear();
+    }
+    if (streamFile) {
+        // Streaming was abandoned, the partial file is not a valid AVIF
+        fclose(streamFile);
+        streamFile = nullptr;
+        remove([streamPath fileSystemRepresentation]);
+    }
+    streamPath = nil;
 }
 
 @end
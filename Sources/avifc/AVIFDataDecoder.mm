@@ -13,7 +13,9 @@
 #import <Accelerate/Accelerate.h>
 #import "AVIFDataDecoder.h"
 #import <vector>
+#import <algorithm>
 #import "AVIFImageXForm.h"
+#import "ChunkedStreamIO.hpp"
 #import <thread>
 
 @implementation AVIFDataDecoder {
@@ -83,7 +85,26 @@ void sharedDecoderDeallocator(avifDecoder* d) {
     return nil;
 }
 
+// Bytes read from a file to find the dimensions, enough for the meta and moov boxes of most files
+static const size_t kPeekPrefixSize = 64 * 1024;
+
+static NSValue* AVIFSizeValue(uint32_t width, uint32_t height) {
+    CGSize size = CGSizeMake(width, height);
+#if TARGET_OS_OSX
+    return [NSValue valueWithSize:size];
+#else
+    return [NSValue valueWithCGSize:size];
+#endif
+}
+
 - (nullable NSValue*)readSize:(nonnull NSData*)data error:(NSError *_Nullable * _Nullable)error {
+    // Only the header boxes are read in place, full parse is a fallback for files the peek can't resolve
+    avifImageInfo info;
+    avifROData input = { .data = reinterpret_cast<const uint8_t *>(data.bytes), .size = data.length };
+    if (avifPeekImageInfo(&input, &info) == AVIF_RESULT_OK) {
+        return AVIFSizeValue(info.width, info.height);
+    }
+
     std::shared_ptr<avifDecoder> decoder(avifDecoderCreate(), sharedDecoderDeallocator);
     avifResult decodeResult = avifDecoderSetIOMemory(decoder.get(), reinterpret_cast<const uint8_t *>(data.bytes), data.length);
     if (decodeResult != AVIF_RESULT_OK) {
@@ -113,6 +134,18 @@ void sharedDecoderDeallocator(avifDecoder* d) {
 }
 
 - (nullable NSValue*)readSizeFromPath:(nonnull NSString*)path error:(NSError *_Nullable * _Nullable)error {
+    FILE* file = fopen([path fileSystemRepresentation], "rb");
+    if (file) {
+        std::vector<uint8_t> prefix(kPeekPrefixSize);
+        size_t prefixSize = fread(prefix.data(), 1, prefix.size(), file);
+        fclose(file);
+        avifImageInfo info;
+        avifROData input = { .data = prefix.data(), .size = prefixSize };
+        if (avifPeekImageInfo(&input, &info) == AVIF_RESULT_OK) {
+            return AVIFSizeValue(info.width, info.height);
+        }
+    }
+
     std::shared_ptr<avifDecoder> decoder(avifDecoderCreate(), sharedDecoderDeallocator);
     avifResult decodeResult = avifDecoderSetIOFile(decoder.get(), [path UTF8String]);
     if (decodeResult != AVIF_RESULT_OK) {
@@ -153,22 +186,23 @@ void sharedDecoderDeallocator(avifDecoder* d) {
                                             userInfo:@{ NSLocalizedDescriptionKey: @"Scale cannot be less than 1" }];
             return nil;
         }
-        NSInteger result;
-        int bufferLength = 30196;
-        uint8_t buffer[30196];
-        NSMutableData* data = [[NSMutableData alloc] init];
         [inputStream open];
-        while((result = [inputStream read:buffer maxLength:bufferLength]) != 0) {
-            if(result > 0) {
-                [data appendBytes:&buffer[0] length:result];
-                if (maxContentSize > 0 && data.length > maxContentSize) {
-                    *error = [[NSError alloc] initWithDomain:@"AVIF"
-                                                        code:500
-                                                    userInfo:@{ NSLocalizedDescriptionKey: @"Content limit exceeded" }];
-                    [inputStream close];
-                    return nil;
-                }
-            } else {
+        ChunkedStreamIO streamIO([inputStream](uint8_t *buffer, size_t length) -> long {
+            return static_cast<long>([inputStream read:buffer maxLength:length]);
+        }, maxContentSize);
+        // Declared after the IO so the decoder is destroyed first, it does not own the IO
+        std::shared_ptr<avifDecoder> decoder(avifDecoderCreate(), sharedDecoderDeallocator);
+        avifDecoderSetIO(decoder.get(), streamIO.io());
+
+        // Pulls more bytes while libavif is waiting on IO, returns false and fills the error if the stream can't go on
+        auto pumpStream = [&]() -> bool {
+            auto status = streamIO.pump();
+            if (status == ChunkedStreamIO::Status::LimitExceeded) {
+                *error = [[NSError alloc] initWithDomain:@"AVIF"
+                                                    code:500
+                                                userInfo:@{ NSLocalizedDescriptionKey: @"Content limit exceeded" }];
+                return false;
+            } else if (status == ChunkedStreamIO::Status::Failed) {
                 auto err = [inputStream streamError];
                 if (err) {
                     *error = err;
@@ -177,30 +211,28 @@ void sharedDecoderDeallocator(avifDecoder* d) {
                                                         code:500
                                                     userInfo:@{ NSLocalizedDescriptionKey: @"Input stream signalled unknown error" }];
                 }
-                [inputStream close];
-                return nil;
+                return false;
             }
-        }
-        [inputStream close];
-        std::shared_ptr<avifDecoder> decoder(avifDecoderCreate(), sharedDecoderDeallocator);
+            return true;
+        };
 
-        avifResult decodeResult = avifDecoderSetIOMemory(decoder.get(), reinterpret_cast<const uint8_t *>(data.bytes), data.length);
-        if (decodeResult != AVIF_RESULT_OK) {
-            NSLog(@"Failed to decode image: %s", avifResultToString(decodeResult));
-            *error = [[NSError alloc] initWithDomain:@"AVIF"
-                                                code:500
-                                            userInfo:@{ NSLocalizedDescriptionKey: [NSString stringWithFormat:@"Decoding AVIF failed with: %s", avifResultToString(decodeResult)] }];
-            return nil;
-        }
-        
         // Disable strict mode to keep some AVIF image compatible
         decoder->strictFlags = AVIF_STRICT_DISABLED;
         decoder->ignoreXMP = true;
         decoder->ignoreExif = true;
         int hwThreads = std::thread::hardware_concurrency();
         decoder->maxThreads = hwThreads;
-        decodeResult = avifDecoderParse(decoder.get());
+        // Header is parsed as soon as it arrives, so too large images are rejected before the whole payload is received
+        avifResult decodeResult = avifDecoderParse(decoder.get());
+        while (decodeResult == AVIF_RESULT_WAITING_ON_IO) {
+            if (!pumpStream()) {
+                [inputStream close];
+                return nil;
+            }
+            decodeResult = avifDecoderParse(decoder.get());
+        }
         if (decodeResult != AVIF_RESULT_OK) {
+            [inputStream close];
             NSLog(@"Failed to decode image: %s", avifResultToString(decodeResult));
             *error = [[NSError alloc] initWithDomain:@"AVIF"
                                                 code:500
@@ -210,6 +242,14 @@ void sharedDecoderDeallocator(avifDecoder* d) {
         
         // Static image
         avifResult nextImageResult = avifDecoderNextImage(decoder.get());
+        while (nextImageResult == AVIF_RESULT_WAITING_ON_IO) {
+            if (!pumpStream()) {
+                [inputStream close];
+                return nil;
+            }
+            nextImageResult = avifDecoderNextImage(decoder.get());
+        }
+        [inputStream close];
         if (nextImageResult != AVIF_RESULT_OK) {
             NSLog(@"Failed to decode image: %s", avifResultToString(nextImageResult));
             *error = [[NSError alloc] initWithDomain:@"AVIF"
@@ -218,6 +258,9 @@ void sharedDecoderDeallocator(avifDecoder* d) {
             return nil;
         }
 
+        uint32_t targetWidth = decoder->image->width;
+        uint32_t targetHeight = decoder->image->height;
+
         if (!CGSizeEqualToSize(CGSizeZero, sampleSize)) {
 
             float imageAspectRatio = (float)decoder->image->width / (float)decoder->image->height;
@@ -228,17 +271,22 @@ void sharedDecoderDeallocator(avifDecoder* d) {
             if (imageAspectRatio > canvasRatio) {
                 resizeFactor = sampleSize.width / (float)decoder->image->width;
             } else {
-                resizeFactor = sampleSize.height / (float)decoder->image->width;
+                resizeFactor = sampleSize.height / (float)decoder->image->height;
             }
 
-            if (avifImageScale(decoder->image, (float)decoder->image->width*resizeFactor,
-                               (float)decoder->image->height*resizeFactor, &decoder->diag) != AVIF_RESULT_OK) {
-                return nil;
+            targetWidth = std::max((uint32_t)((float)decoder->image->width*resizeFactor), (uint32_t)1);
+            targetHeight = std::max((uint32_t)((float)decoder->image->height*resizeFactor), (uint32_t)1);
+
+            // Downscaling is fused into the RGB conversion, only upscaling goes through scaled YUV planes
+            if (resizeFactor > 1.0f) {
+                if (avifImageScale(decoder->image, targetWidth, targetHeight, &decoder->diag) != AVIF_RESULT_OK) {
+                    return nil;
+                }
             }
         }
         
         auto xForm = [[AVIFImageXForm alloc] init];
-        auto image = [xForm form:decoder.get() scale:scale];
+        auto image = [xForm form:decoder.get() scale:scale width:targetWidth height:targetHeight];
 
         if (!image) {
             *error = [[NSError alloc] initWithDomain:@"AVIF" code:500 userInfo:@{ NSLocalizedDescriptionKey: @"Decoding AVIF has failed" }];
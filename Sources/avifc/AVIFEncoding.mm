@@ -36,7 +36,9 @@
 #include <sys/types.h>
 #include <sys/sysctl.h>
 #import "ColorSpace.h"
+#import "AVIFOutputData.h"
 #import "avifpixart.h"
+#include "PremultipliedYuv.hpp"
 
 static void releaseSharedEncoder(avifEncoder* encoder) {
     avifEncoderDestroy(encoder);
@@ -63,7 +65,8 @@ static void releaseSharedPixels(unsigned char * pixels) {
     uint32_t width;
     uint32_t height;
     
-    auto sourceImage = [platformImage rgbaPixels:&width imageHeight:&height];
+    // Unpremultiplication is fused with the YUV conversion below
+    auto sourceImage = [platformImage premultipliedRgbaPixels:&width imageHeight:&height];
     if (!sourceImage) {
         *error = [[NSError alloc] initWithDomain:@"AVIFEncoder"
                                             code:500
@@ -143,39 +146,23 @@ static void releaseSharedPixels(unsigned char * pixels) {
         yuvRange = YuvRange::Pc;
     }
     
-    pixart_rgba8_to_yuv8(image->yuvPlanes[0], image->yuvRowBytes[0],
-                         image->yuvPlanes[1], image->yuvRowBytes[1],
-                         image->yuvPlanes[2], image->yuvRowBytes[2],
-                         [sourceImage data], width * 4,
-                         width, height,
-                         yuvRange, matrix, yuvType);
-
-    if (sourceImage.sourceHasAlpha && image->alphaPlane) {
-        if (image->depth > 8) {
-            uint32_t expand = image->depth - 8;
-            uint32_t rem = 8 - expand;
-            for (uint32_t y = 0; y < height; ++y) {
-                auto srcPtr = sourceImage.data + y * width * 4;
-                auto dstPtr = reinterpret_cast<uint16_t*>(image->alphaPlane + image->alphaRowBytes * y);
-                for (uint32_t x = 0; x < width; ++x) {
-                    uint32_t oldAlpha = static_cast<uint32_t>(srcPtr[3]);
-                    uint32_t newAlpha = (oldAlpha << expand) | (oldAlpha >> rem);
-                    *dstPtr = newAlpha;
-                    dstPtr += 1;
-                    srcPtr += 4;
-                }
-            }
-        } else {
-            for (uint32_t y = 0; y < height; ++y) {
-                auto srcPtr = sourceImage.data + y * width * 4;
-                auto dstPtr = image->alphaPlane + image->alphaRowBytes * y;
-                for (uint32_t x = 0; x < width; ++x) {
-                    *dstPtr = srcPtr[3];
-                    dstPtr += 1;
-                    srcPtr += 4;
-                }
-            }
-        }
+    if (sourceImage.sourceHasAlpha) {
+        // Unpremultiplies, converts and copies the alpha out in a single pass over the pixels
+        premultipliedRgba8ToYuv8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                                 image->yuvPlanes[1], image->yuvRowBytes[1],
+                                 image->yuvPlanes[2], image->yuvRowBytes[2],
+                                 image->alphaPlane, image->alphaRowBytes,
+                                 [sourceImage data], width * 4,
+                                 width, height,
+                                 yuvRange, matrix, yuvType);
+    } else {
+        // Opaque pixels are the same premultiplied or not
+        pixart_rgba8_to_yuv8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                             image->yuvPlanes[1], image->yuvRowBytes[1],
+                             image->yuvPlanes[2], image->yuvRowBytes[2],
+                             [sourceImage data], width * 4,
+                             width, height,
+                             yuvRange, matrix, yuvType);
     }
         
     std::time_t currentTime = std::time(nullptr);
@@ -243,9 +230,7 @@ static void releaseSharedPixels(unsigned char * pixels) {
         return nil;
     }
     
-    NSData *result = [[NSData alloc] initWithBytes:avifOutput.data length:avifOutput.size];
-    
-    avifRWDataFree(&avifOutput);
+    NSData *result = AVIFDataTakingRWData(&avifOutput);
     encoder.reset();
     
     return result;
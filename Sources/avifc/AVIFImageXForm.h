@@ -36,6 +36,9 @@
 @interface AVIFImageXForm : NSObject
 - (nullable Image*)form:(nonnull avifDecoder*)decoder scale:(CGFloat)scale;
 - (_Nullable CGImageRef)formCGImage:(nonnull avifDecoder*)decoder scale:(CGFloat)scale;
+/// Downscales the decoded image to `width` x `height` while converting it, without a full size intermediate
+- (nullable Image*)form:(nonnull avifDecoder*)decoder scale:(CGFloat)scale width:(uint32_t)width height:(uint32_t)height;
+- (_Nullable CGImageRef)formCGImage:(nonnull avifDecoder*)decoder scale:(CGFloat)scale width:(uint32_t)width height:(uint32_t)height;
 @end
 
 
@@ -0,0 +1,49 @@
+//
+//  AVIFOutputData.h
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#ifndef AVIFOutputData_h
+#define AVIFOutputData_h
+
+#import <Foundation/Foundation.h>
+#if __has_include(<libavif/avif.h>)
+#import <libavif/avif.h>
+#else
+#import "avif/avif.h"
+#endif
+
+/// Hands the encoded file over to an NSData without copying, the buffer is freed together with the NSData.
+/// `output` is left empty.
+static inline NSData* _Nonnull AVIFDataTakingRWData(avifRWData* _Nonnull output) {
+    uint8_t* bytes = output->data;
+    const size_t size = output->size;
+    output->data = nullptr;
+    output->size = 0;
+    return [[NSData alloc] initWithBytesNoCopy:bytes length:size deallocator:^(void * _Nonnull buffer, NSUInteger) {
+        avifFree(buffer);
+    }];
+}
+
+#endif /* AVIFOutputData_h */
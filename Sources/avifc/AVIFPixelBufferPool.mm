@@ -0,0 +1,56 @@
+//
+//  AVIFPixelBufferPool.mm
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#import "AVIFPixelBufferPool.h"
+#import "PixelBufferPool.hpp"
+
+@implementation AVIFPixelBufferPool
+
++(NSUInteger)budget {
+    return PixelBufferPool::shared().budget();
+}
+
++(void)setBudget:(NSUInteger)budget {
+    PixelBufferPool::shared().setBudget(budget);
+}
+
++(void)trim {
+    PixelBufferPool::shared().trim(0);
+}
+
++(uint64_t)hits {
+    return PixelBufferPool::shared().statistics().hits;
+}
+
++(uint64_t)misses {
+    return PixelBufferPool::shared().statistics().misses;
+}
+
++(uint64_t)bytesRetained {
+    return PixelBufferPool::shared().statistics().bytesRetained;
+}
+
+@end
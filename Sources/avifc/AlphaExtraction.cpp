@@ -0,0 +1,105 @@
+//
+//  AlphaExtraction.cpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#include "AlphaExtraction.hpp"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#include <immintrin.h>
+#define ALPHA_EXTRACTION_X86 1
+#if defined(__GNUC__) || defined(__clang__)
+#define ALPHA_EXTRACTION_AVX2 1
+#endif
+#endif
+
+namespace {
+
+    void extractAlpha8Row(const uint8_t *src, uint8_t *dst, uint32_t width) {
+        uint32_t x = 0;
+#if defined(__ARM_NEON)
+        for (; x + 16 <= width; x += 16) {
+            uint8x16x4_t pixels = vld4q_u8(src + x * 4);
+            vst1q_u8(dst + x, pixels.val[3]);
+        }
+#elif defined(ALPHA_EXTRACTION_X86)
+        for (; x + 16 <= width; x += 16) {
+            const __m128i *pixels = reinterpret_cast<const __m128i *>(src + x * 4);
+            __m128i a0 = _mm_srli_epi32(_mm_loadu_si128(pixels), 24);
+            __m128i a1 = _mm_srli_epi32(_mm_loadu_si128(pixels + 1), 24);
+            __m128i a2 = _mm_srli_epi32(_mm_loadu_si128(pixels + 2), 24);
+            __m128i a3 = _mm_srli_epi32(_mm_loadu_si128(pixels + 3), 24);
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), packed);
+        }
+#endif
+        for (; x < width; ++x) {
+            dst[x] = src[x * 4 + 3];
+        }
+    }
+
+#if defined(ALPHA_EXTRACTION_AVX2)
+    __attribute__((target("avx2")))
+    void extractAlpha8RowAVX2(const uint8_t *src, uint8_t *dst, uint32_t width) {
+        // Packing works within 128 bit lanes, the permutation puts the 4 pixel groups back in order
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        uint32_t x = 0;
+        for (; x + 32 <= width; x += 32) {
+            const __m256i *pixels = reinterpret_cast<const __m256i *>(src + x * 4);
+            __m256i a0 = _mm256_srli_epi32(_mm256_loadu_si256(pixels), 24);
+            __m256i a1 = _mm256_srli_epi32(_mm256_loadu_si256(pixels + 1), 24);
+            __m256i a2 = _mm256_srli_epi32(_mm256_loadu_si256(pixels + 2), 24);
+            __m256i a3 = _mm256_srli_epi32(_mm256_loadu_si256(pixels + 3), 24);
+            __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a0, a1), _mm256_packs_epi32(a2, a3));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), _mm256_permutevar8x32_epi32(packed, order));
+        }
+        extractAlpha8Row(src + x * 4, dst + x, width - x);
+    }
+
+    bool hasAVX2() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+#endif
+
+    void extractAlphaRow(const uint8_t *src, uint8_t *dst, uint32_t width) {
+#if defined(ALPHA_EXTRACTION_AVX2)
+        if (hasAVX2()) {
+            extractAlpha8RowAVX2(src, dst, width);
+            return;
+        }
+#endif
+        extractAlpha8Row(src, dst, width);
+    }
+}
+
+void extractAlpha(const uint8_t *rgba, size_t rgbaStride,
+                  uint8_t *alpha, size_t alphaStride,
+                  uint32_t width, uint32_t height) {
+    for (uint32_t y = 0; y < height; ++y) {
+        extractAlphaRow(rgba + rgbaStride * y, alpha + alphaStride * y, width);
+    }
+}
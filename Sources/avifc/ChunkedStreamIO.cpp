@@ -0,0 +1,128 @@
+//
+//  ChunkedStreamIO.cpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#include "ChunkedStreamIO.hpp"
+#include <algorithm>
+#include <cstring>
+
+// Chunks start small enough for thumbnails and grow geometrically, so a multi-megabyte image is
+// kept in a few dozens chunks without any of them being reallocated
+static constexpr size_t kFirstChunkCapacity = 32 * 1024;
+static constexpr size_t kMaxChunkCapacity = 4 * 1024 * 1024;
+
+ChunkedStreamIO::ChunkedStreamIO(Source source, uint64_t maxContentSize)
+        : mSource(std::move(source)), mMaxContentSize(maxContentSize) {
+    memset(&mIO, 0, sizeof(mIO));
+    mIO.destroy = nullptr;
+    mIO.read = &ChunkedStreamIO::read;
+    mIO.write = nullptr;
+    // Unknown until the stream ends, the limit is the best upper boundary available
+    mIO.sizeHint = maxContentSize;
+    mIO.persistent = AVIF_FALSE;
+    mIO.data = this;
+}
+
+ChunkedStreamIO::Status ChunkedStreamIO::pump() {
+    if (mEnded) {
+        return Status::EndOfStream;
+    }
+    if (mChunks.empty() || mChunks.back().size == mChunks.back().capacity) {
+        const size_t capacity = mChunks.empty() ? kFirstChunkCapacity
+                                                : std::min(mChunks.back().capacity * 2, kMaxChunkCapacity);
+        mChunks.push_back(Chunk {
+            .data = std::make_unique<uint8_t[]>(capacity),
+            .size = 0,
+            .capacity = capacity,
+            .offset = mSize
+        });
+    }
+    Chunk &chunk = mChunks.back();
+    const long result = mSource(chunk.data.get() + chunk.size, chunk.capacity - chunk.size);
+    if (result < 0) {
+        return Status::Failed;
+    }
+    if (result == 0) {
+        mEnded = true;
+        mIO.sizeHint = mSize;
+        return Status::EndOfStream;
+    }
+    chunk.size += static_cast<size_t>(result);
+    mSize += static_cast<uint64_t>(result);
+    if (mMaxContentSize > 0 && mSize > mMaxContentSize) {
+        return Status::LimitExceeded;
+    }
+    return Status::Ok;
+}
+
+avifResult ChunkedStreamIO::read(struct avifIO *io, uint32_t readFlags, uint64_t offset, size_t size, avifROData *out) {
+    if (readFlags != 0) {
+        // Unsupported readFlags
+        return AVIF_RESULT_IO_ERROR;
+    }
+    return reinterpret_cast<ChunkedStreamIO *>(io->data)->read(offset, size, out);
+}
+
+avifResult ChunkedStreamIO::read(uint64_t offset, size_t size, avifROData *out) {
+    if (offset > mSize) {
+        return mEnded ? AVIF_RESULT_IO_ERROR : AVIF_RESULT_WAITING_ON_IO;
+    }
+    const uint64_t availableSize = mSize - offset;
+    if (size > availableSize) {
+        if (!mEnded) {
+            return AVIF_RESULT_WAITING_ON_IO;
+        }
+        size = static_cast<size_t>(availableSize);
+    }
+    if (size == 0) {
+        out->data = nullptr;
+        out->size = 0;
+        return AVIF_RESULT_OK;
+    }
+
+    // Last chunk starting at or before offset
+    auto chunk = std::upper_bound(mChunks.begin(), mChunks.end(), offset, [](uint64_t value, const Chunk &c) {
+        return value < c.offset;
+    }) - 1;
+    size_t chunkOffset = static_cast<size_t>(offset - chunk->offset);
+    if (chunkOffset + size <= chunk->size) {
+        out->data = chunk->data.get() + chunkOffset;
+        out->size = size;
+        return AVIF_RESULT_OK;
+    }
+
+    mScratch.resize(size);
+    size_t copied = 0;
+    while (copied < size) {
+        const size_t length = std::min(size - copied, chunk->size - chunkOffset);
+        memcpy(mScratch.data() + copied, chunk->data.get() + chunkOffset, length);
+        copied += length;
+        chunkOffset = 0;
+        ++chunk;
+    }
+    out->data = mScratch.data();
+    out->size = size;
+    return AVIF_RESULT_OK;
+}
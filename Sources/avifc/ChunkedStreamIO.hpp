@@ -0,0 +1,107 @@
+//
+//  ChunkedStreamIO.hpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#if __has_include(<libavif/avif.h>)
+#include <libavif/avif.h>
+#else
+#include "avif/avif.h"
+#endif
+
+/**
+ * avifIO over a stream that is still being received. Incoming bytes are appended to a list of
+ * chunks, so nothing is ever reallocated or moved; reads for a range that did not arrive yet return
+ * AVIF_RESULT_WAITING_ON_IO, which lets libavif parse and decode as soon as enough data is there.
+ */
+class ChunkedStreamIO {
+public:
+    /**
+     * Reads up to `length` bytes into `buffer`. Returns amount of bytes read, 0 at the end of the stream
+     * and a negative value on error.
+     */
+    using Source = std::function<long(uint8_t *buffer, size_t length)>;
+
+    enum class Status {
+        Ok,
+        EndOfStream,
+        Failed,
+        LimitExceeded
+    };
+
+    /**
+     * @param maxContentSize maximum amount of bytes accepted from the source, 0 for no limit
+     */
+    ChunkedStreamIO(Source source, uint64_t maxContentSize);
+
+    ChunkedStreamIO(const ChunkedStreamIO &) = delete;
+    ChunkedStreamIO &operator=(const ChunkedStreamIO &) = delete;
+
+    /**
+     * Not owned by the decoder: io->destroy is not set, so this object must outlive the decoder it is attached to.
+     */
+    avifIO *io() {
+        return &mIO;
+    }
+
+    /**
+     * Pulls the next portion of bytes from the source.
+     */
+    Status pump();
+
+    uint64_t size() const {
+        return mSize;
+    }
+
+    bool ended() const {
+        return mEnded;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+        size_t capacity;
+        uint64_t offset;
+    };
+
+    static avifResult read(struct avifIO *io, uint32_t readFlags, uint64_t offset, size_t size, avifROData *out);
+
+    avifResult read(uint64_t offset, size_t size, avifROData *out);
+
+    avifIO mIO;
+    Source mSource;
+    uint64_t mMaxContentSize;
+    uint64_t mSize = 0;
+    bool mEnded = false;
+    std::vector<Chunk> mChunks;
+    // Only used for reads spanning several chunks, libavif keeps a returned region only until the next read
+    std::vector<uint8_t> mScratch;
+};
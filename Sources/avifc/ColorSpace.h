@@ -21,7 +21,10 @@ struct AvifColorSpace {
 };
 
 @interface ColorSpace: NSObject
+/// The returned color space is shared and owned by the cache, it must not be released
 +(AvifColorSpace)queryColorSpace:(uint16_t)colorPrimaries transferCharacteristics:(uint16_t)transferCharacteristics;
+/// Color space of an embedded ICC profile, identical profiles are parsed once. Returned retained, nil if the profile is invalid
++(nullable CGColorSpaceRef)copyColorSpaceWithICC:(nonnull const uint8_t*)data size:(size_t)size CF_RETURNS_RETAINED;
 +(void)apply:(nonnull avifImage*)image colorSpace:(EnclosedColorSpace)colorSpace;
 @end
 
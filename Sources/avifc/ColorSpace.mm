@@ -12,10 +12,13 @@
 #else
 #import "avif/avif.h"
 #endif
+#include <mutex>
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <cstring>
 
-@implementation ColorSpace
-
-+(AvifColorSpace)queryColorSpace:(uint16_t)colorPrimaries transferCharacteristics:(uint16_t)transferCharacteristics {
+static AvifColorSpace createColorSpace(uint16_t colorPrimaries, uint16_t transferCharacteristics) {
     CGColorSpaceRef colorSpace = nullptr;
     bool wideGamut = false;
     
@@ -152,6 +155,83 @@
     };
 }
 
+/**
+ * Embedded ICC profiles parsed so far, the most recently used first. Profiles are compared byte
+ * by byte after matching their hash, profiles that CoreGraphics rejects are remembered as well.
+ */
+class ICCColorSpaceCache {
+public:
+    CGColorSpaceRef _Nullable copy(const uint8_t * _Nonnull data, size_t size) {
+        const uint64_t hash = hashBytes(data, size);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+                if (it->hash == hash && it->profile.size() == size && memcmp(it->profile.data(), data, size) == 0) {
+                    mEntries.splice(mEntries.begin(), mEntries, it);
+                    return it->colorSpace ? CGColorSpaceRetain(it->colorSpace) : nullptr;
+                }
+            }
+        }
+
+        CFDataRef iccData = CFDataCreate(kCFAllocatorDefault, data, size);
+        CGColorSpaceRef colorSpace = iccData ? CGColorSpaceCreateWithICCData(iccData) : nullptr;
+        if (iccData) {
+            CFRelease(iccData);
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries.push_front({ hash, std::vector<uint8_t>(data, data + size), colorSpace });
+        while (mEntries.size() > kCapacity) {
+            if (mEntries.back().colorSpace) {
+                CGColorSpaceRelease(mEntries.back().colorSpace);
+            }
+            mEntries.pop_back();
+        }
+        return colorSpace ? CGColorSpaceRetain(colorSpace) : nullptr;
+    }
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::vector<uint8_t> profile;
+        CGColorSpaceRef _Nullable colorSpace;
+    };
+
+    // FNV-1a, profiles are a few kilobytes at most
+    static uint64_t hashBytes(const uint8_t * _Nonnull data, size_t size) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ data[i]) * 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    static constexpr size_t kCapacity = 16;
+    std::mutex mMutex;
+    std::list<Entry> mEntries;
+};
+
+@implementation ColorSpace
+
++(AvifColorSpace)queryColorSpace:(uint16_t)colorPrimaries transferCharacteristics:(uint16_t)transferCharacteristics {
+    // Color spaces are created once per (primaries, transfer) pair and live as long as the process,
+    // so decoding many images reuses the same few objects
+    static std::mutex lock;
+    static std::unordered_map<uint32_t, AvifColorSpace> colorSpaces;
+    const uint32_t key = (static_cast<uint32_t>(colorPrimaries) << 16) | transferCharacteristics;
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = colorSpaces.find(key);
+    if (it == colorSpaces.end()) {
+        it = colorSpaces.emplace(key, createColorSpace(colorPrimaries, transferCharacteristics)).first;
+    }
+    return it->second;
+}
+
++(nullable CGColorSpaceRef)copyColorSpaceWithICC:(nonnull const uint8_t*)data size:(size_t)size {
+    static ICCColorSpaceCache cache;
+    return cache.copy(data, size);
+}
+
 +(void)apply:(avifImage*)image colorSpace:(EnclosedColorSpace)colorSpace {
     switch (colorSpace) {
         case kSRGB:
@@ -0,0 +1,145 @@
+//
+//  PixelBufferPool.cpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+
+#include "PixelBufferPool.hpp"
+#if __APPLE__
+#include <dispatch/dispatch.h>
+#endif
+
+// Enough for a handful of full screen frames
+static constexpr size_t kDefaultBudget = 32 * 1024 * 1024;
+// Small buffers are cheap to allocate, pooling them only costs a lookup
+static constexpr size_t kMinPooledSize = 16 * 1024;
+
+#if __APPLE__
+static void PixelBufferPoolMemoryPressure(void *context) {
+    reinterpret_cast<PixelBufferPool *>(context)->trim(0);
+}
+#endif
+
+PixelBufferPool &PixelBufferPool::shared() {
+    // Never destroyed, buffers may be released by images that outlive static destructors
+    static PixelBufferPool *pool = new PixelBufferPool();
+    return *pool;
+}
+
+PixelBufferPool::PixelBufferPool() : mBudget(kDefaultBudget) {
+#if __APPLE__
+    dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_MEMORYPRESSURE, 0,
+                                                      DISPATCH_MEMORYPRESSURE_WARN | DISPATCH_MEMORYPRESSURE_CRITICAL,
+                                                      dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+    if (source) {
+        dispatch_set_context(source, this);
+        dispatch_source_set_event_handler_f(source, PixelBufferPoolMemoryPressure);
+        dispatch_resume(source);
+    }
+#endif
+}
+
+size_t PixelBufferPool::bucketSize(size_t size) {
+    if (size < kMinPooledSize) {
+        return size;
+    }
+    // Keep three significant bits: 8 buckets per power of two
+    size_t shift = 0;
+    while ((size >> shift) >= 16) {
+        ++shift;
+    }
+    const size_t step = static_cast<size_t>(1) << shift;
+    return (size + step - 1) & ~(step - 1);
+}
+
+uint8_t *PixelBufferPool::acquire(size_t size, size_t *capacity) {
+    const size_t bucket = bucketSize(size);
+    if (bucket >= kMinPooledSize) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+            if (it->capacity == bucket) {
+                uint8_t *data = it->data;
+                mBytesRetained -= it->capacity;
+                mEntries.erase(it);
+                mHits += 1;
+                *capacity = bucket;
+                return data;
+            }
+        }
+        mMisses += 1;
+    }
+    uint8_t *data = new uint8_t[bucket];
+    *capacity = bucket;
+    return data;
+}
+
+void PixelBufferPool::recycle(uint8_t *data, size_t capacity) {
+    if (!data) {
+        return;
+    }
+    if (capacity >= kMinPooledSize) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (capacity <= mBudget) {
+            mEntries.push_front(Entry {.data = data, .capacity = capacity});
+            mBytesRetained += capacity;
+            trimLocked(mBudget);
+            return;
+        }
+    }
+    delete[] data;
+}
+
+void PixelBufferPool::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mBudget = bytes;
+    trimLocked(mBudget);
+}
+
+size_t PixelBufferPool::budget() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mBudget;
+}
+
+void PixelBufferPool::trim(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    trimLocked(bytes);
+}
+
+void PixelBufferPool::trimLocked(size_t bytes) {
+    while (mBytesRetained > bytes && !mEntries.empty()) {
+        Entry &entry = mEntries.back();
+        mBytesRetained -= entry.capacity;
+        delete[] entry.data;
+        mEntries.pop_back();
+    }
+}
+
+PixelBufferPool::Statistics PixelBufferPool::statistics() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return Statistics {
+        .hits = mHits,
+        .misses = mMisses,
+        .bytesRetained = mBytesRetained
+    };
+}
@@ -0,0 +1,162 @@
+//
+//  PixelBufferPool.hpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+/**
+ * Process-wide cache of pixel buffers released by decoded images. Sizes are rounded up to buckets
+ * with at most 12.5% of slack, so decoding the same few sizes over and over is served from
+ * the cache instead of the system allocator. Retained bytes never exceed the budget, least
+ * recently released buffers are dropped first, and the cache is emptied on memory pressure.
+ */
+class PixelBufferPool {
+public:
+    struct Statistics {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t bytesRetained;
+    };
+
+    static PixelBufferPool &shared();
+
+    /**
+     * Returns a buffer of at least `size` bytes, contents are undefined.
+     * @param capacity receives the actual size of the buffer, which has to be passed back to `recycle`
+     */
+    uint8_t *acquire(size_t size, size_t *capacity);
+
+    /**
+     * Takes the buffer back, it is either retained for reuse or freed when it doesn't fit the budget.
+     */
+    void recycle(uint8_t *data, size_t capacity);
+
+    /**
+     * Maximum amount of bytes retained by idle buffers, 0 disables pooling.
+     */
+    void setBudget(size_t bytes);
+
+    size_t budget();
+
+    /**
+     * Frees idle buffers until no more than `bytes` are retained.
+     */
+    void trim(size_t bytes);
+
+    Statistics statistics();
+
+private:
+    struct Entry {
+        uint8_t *data;
+        size_t capacity;
+    };
+
+    PixelBufferPool();
+
+    void trimLocked(size_t bytes);
+
+    static size_t bucketSize(size_t size);
+
+    std::mutex mMutex;
+    // Most recently released buffers are at the front
+    std::list<Entry> mEntries;
+    size_t mBudget;
+    size_t mBytesRetained = 0;
+    uint64_t mHits = 0;
+    uint64_t mMisses = 0;
+};
+
+/**
+ * Move-only byte storage taken from the shared `PixelBufferPool` and returned to it on destruction.
+ */
+class PixelBuffer {
+public:
+    PixelBuffer() = default;
+
+    explicit PixelBuffer(size_t size) : mSize(size) {
+        mData = PixelBufferPool::shared().acquire(size, &mCapacity);
+    }
+
+    PixelBuffer(PixelBuffer &&other) noexcept: mData(other.mData), mSize(other.mSize), mCapacity(other.mCapacity) {
+        other.mData = nullptr;
+        other.mSize = 0;
+        other.mCapacity = 0;
+    }
+
+    PixelBuffer &operator=(PixelBuffer &&other) noexcept {
+        if (this != &other) {
+            clear();
+            mData = other.mData;
+            mSize = other.mSize;
+            mCapacity = other.mCapacity;
+            other.mData = nullptr;
+            other.mSize = 0;
+            other.mCapacity = 0;
+        }
+        return *this;
+    }
+
+    PixelBuffer(const PixelBuffer &) = delete;
+    PixelBuffer &operator=(const PixelBuffer &) = delete;
+
+    ~PixelBuffer() {
+        clear();
+    }
+
+    /**
+     * Gives the storage back to the pool
+     */
+    void clear() {
+        if (mData) {
+            PixelBufferPool::shared().recycle(mData, mCapacity);
+            mData = nullptr;
+            mSize = 0;
+            mCapacity = 0;
+        }
+    }
+
+    uint8_t *data() {
+        return mData;
+    }
+
+    const uint8_t *data() const {
+        return mData;
+    }
+
+    size_t size() const {
+        return mSize;
+    }
+
+private:
+    uint8_t *mData = nullptr;
+    size_t mSize = 0;
+    size_t mCapacity = 0;
+};
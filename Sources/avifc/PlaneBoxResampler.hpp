@@ -0,0 +1,104 @@
+//
+//  PlaneBoxResampler.hpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Area-averaging downscaler producing destination rows on demand, so a plane may be resampled
+ * one band at a time without materializing a full size intermediate plane.
+ * Every destination sample is the rounded mean of the source samples it covers; when scaling up
+ * a dimension this degrades to nearest neighbour.
+ */
+template<typename T>
+class PlaneBoxResampler {
+public:
+    PlaneBoxResampler(const T *src, size_t srcStride, uint32_t srcWidth, uint32_t srcHeight,
+                      uint32_t dstWidth, uint32_t dstHeight)
+            : mSrc(reinterpret_cast<const uint8_t *>(src)), mSrcStride(srcStride),
+              mSrcHeight(srcHeight), mDstWidth(dstWidth), mDstHeight(dstHeight) {
+        mColumns.reserve(dstWidth);
+        for (uint32_t x = 0; x < dstWidth; ++x) {
+            mColumns.push_back(span(x, srcWidth, dstWidth));
+        }
+    }
+
+    /**
+     * Writes destination rows [firstRow, firstRow + rowCount) to `dst`, `dst` points to the first of them.
+     * @param accumulator scratch storage, reused between calls to avoid allocations; must not be shared between threads
+     */
+    void resampleRows(uint32_t firstRow, uint32_t rowCount, T *dst, size_t dstStride,
+                      std::vector<uint64_t> &accumulator) const {
+        accumulator.resize(mDstWidth);
+        for (uint32_t row = firstRow; row < firstRow + rowCount; ++row) {
+            const Span rows = span(row, mSrcHeight, mDstHeight);
+            std::fill(accumulator.begin(), accumulator.end(), 0);
+            for (uint32_t y = rows.start; y < rows.end; ++y) {
+                auto srcRow = reinterpret_cast<const T *>(mSrc + y * mSrcStride);
+                for (uint32_t x = 0; x < mDstWidth; ++x) {
+                    const Span &columns = mColumns[x];
+                    uint64_t sum = 0;
+                    for (uint32_t i = columns.start; i < columns.end; ++i) {
+                        sum += srcRow[i];
+                    }
+                    accumulator[x] += sum;
+                }
+            }
+            auto dstRow = reinterpret_cast<T *>(reinterpret_cast<uint8_t *>(dst) + (row - firstRow) * dstStride);
+            const uint64_t spanHeight = rows.end - rows.start;
+            for (uint32_t x = 0; x < mDstWidth; ++x) {
+                const uint64_t area = spanHeight * (mColumns[x].end - mColumns[x].start);
+                dstRow[x] = static_cast<T>((accumulator[x] + area / 2) / area);
+            }
+        }
+    }
+
+private:
+    struct Span {
+        uint32_t start;
+        uint32_t end;
+    };
+
+    static Span span(uint32_t index, uint32_t srcSize, uint32_t dstSize) {
+        const auto start = static_cast<uint32_t>(static_cast<uint64_t>(index) * srcSize / dstSize);
+        const auto end = static_cast<uint32_t>(static_cast<uint64_t>(index + 1) * srcSize / dstSize);
+        return Span {
+            .start = std::min(start, srcSize - 1),
+            .end = std::max(std::min(end, srcSize), std::min(start, srcSize - 1) + 1)
+        };
+    }
+
+    const uint8_t *mSrc;
+    size_t mSrcStride;
+    uint32_t mSrcHeight;
+    uint32_t mDstWidth;
+    uint32_t mDstHeight;
+    std::vector<Span> mColumns;
+};
@@ -156,7 +156,7 @@
     return imageRef;
 }
 
--(nullable EnclosedImage*)rgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight {
+-(nullable EnclosedImage*)premultipliedRgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight {
     CGImageRef imageRef = [self makeCGImage];
     NSUInteger width = CGImageGetWidth(imageRef);
     NSUInteger height = CGImageGetHeight(imageRef);
@@ -197,14 +197,10 @@
     CGContextRelease(targetContext);
     CGColorSpaceRelease(colorSpace);
 
-    if (![self avifUnpremultiplyRGBA:img.data width:width height:height]) {
-        return nil;
-    }
-
     return img;
 }
 #else
--(nullable EnclosedImage*)rgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight {
+-(nullable EnclosedImage*)premultipliedRgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight {
     CGImageRef imageRef = [self CGImage];
     NSUInteger width = CGImageGetWidth(imageRef);
     NSUInteger height = CGImageGetHeight(imageRef);
@@ -238,11 +234,18 @@
     CGContextRelease(context);
     CGColorSpaceRelease(colorSpace);
 
-    if (![self avifUnpremultiplyRGBA:img.data width:width height:height]) {
+    return img;
+}
+#endif
+
+-(nullable EnclosedImage*)rgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight {
+    auto img = [self premultipliedRgbaPixels:imageWidth imageHeight:imageHeight];
+    if (!img) {
+        return nil;
+    }
+    if (![self avifUnpremultiplyRGBA:img.data width:*imageWidth height:*imageHeight]) {
         return nil;
     }
-
     return img;
 }
-#endif
 @end
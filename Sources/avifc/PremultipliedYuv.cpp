@@ -0,0 +1,121 @@
+//
+//  PremultipliedYuv.cpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#include "PremultipliedYuv.hpp"
+#include "AlphaExtraction.hpp"
+#include "concurrency.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // Scratch size of a band, a few rows of a large frame still fit the L1/L2 caches
+    constexpr size_t kBandBytes = 64 * 1024;
+
+    /**
+     * 32.32 fixed point reciprocals of alpha: (n * table[a]) >> 32 == n / a for any n < 65536,
+     * which makes the unpremultiplication below bit exact with vImageUnpremultiplyData_RGBA8888
+     */
+    struct ReciprocalTable {
+        uint64_t values[256];
+
+        ReciprocalTable() {
+            values[0] = 0;
+            for (uint64_t a = 1; a < 256; ++a) {
+                values[a] = (uint64_t(1) << 32) / a + 1;
+            }
+        }
+    };
+
+    const ReciprocalTable &reciprocals() {
+        static const ReciprocalTable table;
+        return table;
+    }
+
+    void unpremultiplyRow(const uint8_t *src, uint8_t *dst, uint32_t width, const ReciprocalTable &table) {
+        for (uint32_t x = 0; x < width; ++x, src += 4, dst += 4) {
+            const uint32_t a = src[3];
+            if (a == 255) {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            } else {
+                const uint64_t reciprocal = table.values[a];
+                const uint32_t bias = a / 2;
+                dst[0] = static_cast<uint8_t>(std::min<uint64_t>(((src[0] * 255u + bias) * reciprocal) >> 32, 255));
+                dst[1] = static_cast<uint8_t>(std::min<uint64_t>(((src[1] * 255u + bias) * reciprocal) >> 32, 255));
+                dst[2] = static_cast<uint8_t>(std::min<uint64_t>(((src[2] * 255u + bias) * reciprocal) >> 32, 255));
+            }
+            dst[3] = static_cast<uint8_t>(a);
+        }
+    }
+}
+
+void premultipliedRgba8ToYuv8(uint8_t *yPlane, uint32_t yStride,
+                              uint8_t *uPlane, uint32_t uStride,
+                              uint8_t *vPlane, uint32_t vStride,
+                              uint8_t *alpha, uint32_t alphaStride,
+                              const uint8_t *rgba, uint32_t rgbaStride,
+                              uint32_t width, uint32_t height,
+                              YuvRange range, YuvMatrix matrix, YuvType yuvType) {
+    if (width == 0 || height == 0) {
+        return;
+    }
+    const uint32_t scratchStride = width * 4;
+    // Bands of 4:2:0 must start on even rows, so every band but the last one covers whole chroma rows
+    uint32_t bandRows = static_cast<uint32_t>(std::max<size_t>(kBandBytes / scratchStride, 2));
+    bandRows = std::min(bandRows - bandRows % 2, height + height % 2);
+    const int bandsCount = static_cast<int>((height + bandRows - 1) / bandRows);
+    const uint32_t chromaShift = yuvType == YuvType::Yuv420 ? 1 : 0;
+    const ReciprocalTable &table = reciprocals();
+
+    const int threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    concurrency::parallel_for(threads, bandsCount, [&](int band) {
+        thread_local std::vector<uint8_t> scratch;
+        const uint32_t top = static_cast<uint32_t>(band) * bandRows;
+        const uint32_t rows = std::min(bandRows, height - top);
+        scratch.resize(static_cast<size_t>(scratchStride) * rows);
+
+        const uint8_t *source = rgba + static_cast<size_t>(rgbaStride) * top;
+        for (uint32_t y = 0; y < rows; ++y) {
+            unpremultiplyRow(source + static_cast<size_t>(rgbaStride) * y,
+                             scratch.data() + static_cast<size_t>(scratchStride) * y, width, table);
+        }
+
+        const uint32_t chromaTop = top >> chromaShift;
+        pixart_rgba8_to_yuv8(yPlane + static_cast<size_t>(yStride) * top, yStride,
+                             uPlane + static_cast<size_t>(uStride) * chromaTop, uStride,
+                             vPlane + static_cast<size_t>(vStride) * chromaTop, vStride,
+                             scratch.data(), scratchStride,
+                             width, rows,
+                             range, matrix, yuvType);
+
+        if (alpha) {
+            extractAlpha(source, rgbaStride, alpha + static_cast<size_t>(alphaStride) * top, alphaStride, width, rows);
+        }
+    });
+}
@@ -0,0 +1,45 @@
+//
+//  PremultipliedYuv.hpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "avifpixart.h"
+
+/**
+ * Converts premultiplied RGBA8 straight to 8 bit YUV, and copies its alpha when `alpha` is not null.
+ * The frame is processed in bands of a few rows: each band is unpremultiplied into a scratch buffer
+ * small enough to stay in cache, converted by pixart from there and its alpha copied out, so the
+ * source is read from memory once instead of once per step. Bands run in parallel on the shared pool.
+ */
+void premultipliedRgba8ToYuv8(uint8_t *yPlane, uint32_t yStride,
+                              uint8_t *uPlane, uint32_t uStride,
+                              uint8_t *vPlane, uint32_t vStride,
+                              uint8_t *alpha, uint32_t alphaStride,
+                              const uint8_t *rgba, uint32_t rgbaStride,
+                              uint32_t width, uint32_t height,
+                              YuvRange range, YuvMatrix matrix, YuvType yuvType);
@@ -0,0 +1,471 @@
+//
+//  RgbConversion.hpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <avif/avif.h>
+#include "avifpixart.h"
+#include "PixelBufferPool.hpp"
+#include "PlaneBoxResampler.hpp"
+#include "concurrency.hpp"
+
+/**
+ * Pixels of a converted image, handed over to CoreGraphics through an `XFormDataContainer`
+ */
+struct AvifImageHandle {
+    PixelBuffer data;
+    uint32_t stride;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bitDepth;
+    uint32_t components;
+};
+
+/**
+ * Interleaved pixel layout which `AvifConvertImage` produces for an image
+ */
+struct AvifRgbLayout {
+    uint32_t bitDepth;
+    uint32_t components;
+    uint32_t bytesPerPixel;
+};
+
+#define RETURN_ERROR_HANDLE(result_ptr)                     \
+*(result_ptr) = AVIF_RESULT_UNKNOWN_ERROR;          \
+return AvifImageHandle {                            \
+.data = PixelBuffer(),                          \
+.stride = 0,                                    \
+.width = 0,                                     \
+.height = 0,                                    \
+.bitDepth = 0,                                  \
+.components = 0                                 \
+};                                              \
+
+inline bool AvifImageIsYCgCoR(const avifImage* image) {
+    return image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_YCGCO_RE
+    || image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_YCGCO_RO;
+}
+
+inline bool AvifRgbLayoutForImage(const avifImage* image, AvifRgbLayout* layout) {
+    auto imageUsesAlpha = image->imageOwnsAlphaPlane || image->alphaPlane != nullptr;
+    uint32_t components = imageUsesAlpha ? 4 : 3;
+    uint32_t bitDepth = image->depth > 8 ? image->depth : 8;
+    
+    if (AvifImageIsYCgCoR(image) && image->depth == 10) {
+        if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) {
+            return false;
+        }
+        bitDepth = 8;
+    } else if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_IDENTITY
+               && image->yuvFormat != AVIF_PIXEL_FORMAT_YUV444) {
+        return false;
+    } else if (image->yuvFormat != AVIF_PIXEL_FORMAT_YUV400 && AvifImageIsYCgCoR(image)) {
+        if (image->depth != 12) {
+            return false;
+        }
+        bitDepth = 10;
+    }
+    
+    layout->bitDepth = bitDepth;
+    layout->components = components;
+    layout->bytesPerPixel = components * (bitDepth > 8 ? sizeof(uint16_t) : sizeof(uint8_t));
+    return true;
+}
+
+/**
+ * Converts the whole image into `dst` with the layout given by `AvifRgbLayoutForImage`
+ */
+inline bool AvifConvertImage(const avifImage* image, uint8_t* dst, uint32_t stride) {
+    AvifRgbLayout layout;
+    if (!AvifRgbLayoutForImage(image, &layout)) {
+        return false;
+    }
+    
+    auto components = layout.components;
+    auto hasColorPlanes = image->yuvPlanes[0] != nullptr
+    && image->yuvPlanes[1] != nullptr
+    && image->yuvPlanes[2] != nullptr;
+    if (components == 4 && image->alphaPlane == nullptr) {
+        return false;
+    }
+    
+    YuvRange pixartYuvRange = YuvRange::Pc;
+    if (image->yuvRange == AVIF_RANGE_LIMITED) {
+        pixartYuvRange = YuvRange::Tv;
+    }
+    
+    YuvType yuvType = YuvType::Yuv420;
+    if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422) {
+        yuvType = YuvType::Yuv422;
+    } else if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) {
+        yuvType = YuvType::Yuv444;
+    }
+    
+    if (AvifImageIsYCgCoR(image) && image->yuvFormat != AVIF_PIXEL_FORMAT_YUV400) {
+        if (!hasColorPlanes) {
+            return false;
+        }
+        AvifYCgCoRType rType = AvifYCgCoRType::Re;
+        if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_YCGCO_RO) {
+            rType = AvifYCgCoRType::Ro;
+        }
+        if (image->depth == 10) {
+            if (components == 3) {
+                pixart_icgc_r_type_to_rgb(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                          reinterpret_cast<const uint16_t*>(image->yuvPlanes[1]), image->yuvRowBytes[1],
+                                          reinterpret_cast<const uint16_t*>(image->yuvPlanes[2]), image->yuvRowBytes[2],
+                                          dst, stride,
+                                          image->width, image->height,
+                                          pixartYuvRange, rType, yuvType);
+            } else {
+                pixart_icgc_r_type_with_alpha_to_rgba(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                                      reinterpret_cast<const uint16_t*>(image->yuvPlanes[1]), image->yuvRowBytes[1],
+                                                      reinterpret_cast<const uint16_t*>(image->yuvPlanes[2]), image->yuvRowBytes[2],
+                                                      reinterpret_cast<const uint16_t*>(image->alphaPlane), image->alphaRowBytes,
+                                                      dst, stride,
+                                                      image->width, image->height,
+                                                      pixartYuvRange, rType, yuvType);
+            }
+        } else {
+            if (components == 3) {
+                pixart_icgc12_r_to_rgb10(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                         reinterpret_cast<const uint16_t*>(image->yuvPlanes[1]), image->yuvRowBytes[1],
+                                         reinterpret_cast<const uint16_t*>(image->yuvPlanes[2]), image->yuvRowBytes[2],
+                                         reinterpret_cast<uint16_t*>(dst), stride,
+                                         image->width, image->height,
+                                         pixartYuvRange, rType, yuvType);
+            } else {
+                pixart_icgc_r_alpha12_to_rgba10(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                                reinterpret_cast<const uint16_t*>(image->yuvPlanes[1]), image->yuvRowBytes[1],
+                                                reinterpret_cast<const uint16_t*>(image->yuvPlanes[2]), image->yuvRowBytes[2],
+                                                reinterpret_cast<const uint16_t*>(image->alphaPlane), image->alphaRowBytes,
+                                                reinterpret_cast<uint16_t*>(dst), stride,
+                                                image->width, image->height,
+                                                pixartYuvRange, rType, yuvType);
+            }
+        }
+        return true;
+    }
+    
+    YuvMatrix matrix = YuvMatrix::Bt709;
+    if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_BT601) {
+        matrix = YuvMatrix::Bt601;
+    } else if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_BT2020_NCL
+               || image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_SMPTE2085) {
+        matrix = YuvMatrix::Bt2020;
+    } else if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_IDENTITY) {
+        matrix = YuvMatrix::Identity;
+    } else if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_YCGCO) {
+        matrix = YuvMatrix::YCgCo;
+    }
+    
+    bool highBitDepth = image->depth > 8;
+    uint32_t bitDepth = image->depth;
+    
+    if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) {
+        if (image->yuvPlanes[0] == nullptr) {
+            return false;
+        }
+        if (highBitDepth) {
+            if (components == 3) {
+                pixart_yuv400_p16_to_rgb16(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                           reinterpret_cast<uint16_t*>(dst), stride,
+                                           bitDepth,
+                                           image->width, image->height,
+                                           pixartYuvRange, matrix);
+            } else {
+                pixart_yuv400_p16_with_alpha_to_rgba16(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                                       reinterpret_cast<const uint16_t*>(image->alphaPlane), image->alphaRowBytes,
+                                                       reinterpret_cast<uint16_t*>(dst), stride,
+                                                       bitDepth,
+                                                       image->width, image->height,
+                                                       pixartYuvRange, matrix);
+            }
+        } else {
+            if (components == 3) {
+                pixart_yuv400_to_rgb8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                                      dst, stride,
+                                      image->width, image->height,
+                                      pixartYuvRange, matrix);
+            } else {
+                pixart_yuv400_with_alpha_to_rgba8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                                                  image->alphaPlane, image->alphaRowBytes,
+                                                  dst, stride,
+                                                  image->width, image->height,
+                                                  pixartYuvRange, matrix);
+            }
+        }
+        return true;
+    }
+    
+    if (!hasColorPlanes) {
+        return false;
+    }
+    
+    if (highBitDepth) {
+        if (components == 3) {
+            pixart_yuv16_to_rgb16(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                  reinterpret_cast<const uint16_t*>(image->yuvPlanes[1]), image->yuvRowBytes[1],
+                                  reinterpret_cast<const uint16_t*>(image->yuvPlanes[2]), image->yuvRowBytes[2],
+                                  reinterpret_cast<uint16_t*>(dst), stride,
+                                  bitDepth,
+                                  image->width, image->height,
+                                  pixartYuvRange, matrix, yuvType);
+        } else {
+            pixart_yuv16_with_alpha_to_rgba16(reinterpret_cast<const uint16_t*>(image->yuvPlanes[0]), image->yuvRowBytes[0],
+                                              reinterpret_cast<const uint16_t*>(image->yuvPlanes[1]), image->yuvRowBytes[1],
+                                              reinterpret_cast<const uint16_t*>(image->yuvPlanes[2]), image->yuvRowBytes[2],
+                                              reinterpret_cast<const uint16_t*>(image->alphaPlane), image->alphaRowBytes,
+                                              reinterpret_cast<uint16_t*>(dst), stride,
+                                              bitDepth,
+                                              image->width, image->height,
+                                              pixartYuvRange, matrix, yuvType);
+        }
+    } else {
+        if (components == 3) {
+            pixart_yuv8_to_rgb8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                                image->yuvPlanes[1], image->yuvRowBytes[1],
+                                image->yuvPlanes[2], image->yuvRowBytes[2],
+                                dst, stride,
+                                image->width, image->height,
+                                pixartYuvRange, matrix, yuvType);
+        } else {
+            pixart_yuv8_with_alpha_to_rgba8(image->yuvPlanes[0], image->yuvRowBytes[0],
+                                            image->yuvPlanes[1], image->yuvRowBytes[1],
+                                            image->yuvPlanes[2], image->yuvRowBytes[2],
+                                            image->alphaPlane, image->alphaRowBytes,
+                                            dst, stride,
+                                            image->width, image->height,
+                                            pixartYuvRange, matrix, yuvType);
+        }
+    }
+    return true;
+}
+
+/**
+ * Scratch storage of a thread converting bands of an image, kept between bands
+ */
+struct AvifBandScratch {
+    std::vector<uint8_t> planes[AVIF_PLANE_COUNT_YUV + 1];
+    std::vector<uint64_t> accumulator;
+    std::vector<uint8_t> rgb;
+};
+
+/**
+ * Splits the output into bands of rows and calls `convertBand(bandImage, firstRow, scratch)` for each of them
+ * in parallel. `bandImage` is a shallow view on the rows of the band: when `width` x `height` is the size of
+ * the image it points into the image planes, otherwise the planes are box-resampled into small per thread
+ * planes, so no scaled copy of the image is ever allocated.
+ */
+template<typename T, typename ConvertBand>
+bool AvifConvertImageBands(const avifImage* image, uint32_t width, uint32_t height, ConvertBand&& convertBand) {
+    avifPixelFormatInfo formatInfo;
+    avifGetPixelFormatInfo(image->yuvFormat, &formatInfo);
+    const uint32_t shiftX = formatInfo.monochrome ? 0 : formatInfo.chromaShiftX;
+    const uint32_t shiftY = formatInfo.monochrome ? 0 : formatInfo.chromaShiftY;
+    const bool scaled = width != image->width || height != image->height;
+    
+    const uint8_t* srcPlanes[AVIF_PLANE_COUNT_YUV + 1] = {
+        image->yuvPlanes[0], image->yuvPlanes[1], image->yuvPlanes[2], image->alphaPlane
+    };
+    const uint32_t srcStrides[AVIF_PLANE_COUNT_YUV + 1] = {
+        image->yuvRowBytes[0], image->yuvRowBytes[1], image->yuvRowBytes[2], image->alphaRowBytes
+    };
+    
+    std::unique_ptr<PlaneBoxResampler<T>> resamplers[AVIF_PLANE_COUNT_YUV + 1];
+    uint32_t dstWidths[AVIF_PLANE_COUNT_YUV + 1];
+    for (int plane = 0; plane < AVIF_PLANE_COUNT_YUV + 1; ++plane) {
+        const bool isChroma = plane == AVIF_CHAN_U || plane == AVIF_CHAN_V;
+        dstWidths[plane] = isChroma ? (width + shiftX) >> shiftX : width;
+        if (!scaled || srcPlanes[plane] == nullptr || (isChroma && formatInfo.monochrome)) {
+            continue;
+        }
+        const uint32_t srcWidth = isChroma ? avifImagePlaneWidth(image, plane) : image->width;
+        const uint32_t srcHeight = isChroma ? avifImagePlaneHeight(image, plane) : image->height;
+        const uint32_t dstHeight = isChroma ? (height + shiftY) >> shiftY : height;
+        resamplers[plane] = std::make_unique<PlaneBoxResampler<T>>(reinterpret_cast<const T*>(srcPlanes[plane]),
+                                                                   srcStrides[plane],
+                                                                   srcWidth, srcHeight,
+                                                                   dstWidths[plane], dstHeight);
+    }
+    
+    // Even amount of rows, thus 4:2:0 chroma rows never straddle two bands
+    constexpr uint32_t bandHeight = 32;
+    const int bandsCount = static_cast<int>((height + bandHeight - 1) / bandHeight);
+    const int threadsCount = std::max(std::min(static_cast<int>(std::thread::hardware_concurrency()), bandsCount), 1);
+    
+    std::vector<AvifBandScratch> scratches(threadsCount);
+    std::atomic<bool> converted(true);
+    
+    concurrency::parallel_for_with_thread_id(threadsCount, bandsCount, [&](int threadId, int band) {
+        AvifBandScratch& scratch = scratches[threadId];
+        const uint32_t firstRow = static_cast<uint32_t>(band) * bandHeight;
+        const uint32_t rowsCount = std::min(bandHeight, height - firstRow);
+        
+        // Shallow view on the band, owns nothing and is never destroyed
+        avifImage bandImage = *image;
+        bandImage.width = width;
+        bandImage.height = rowsCount;
+        uint8_t* bandPlanes[AVIF_PLANE_COUNT_YUV + 1] = { nullptr, nullptr, nullptr, nullptr };
+        uint32_t bandStrides[AVIF_PLANE_COUNT_YUV + 1] = { 0, 0, 0, 0 };
+        
+        for (int plane = 0; plane < AVIF_PLANE_COUNT_YUV + 1; ++plane) {
+            const bool isChroma = plane == AVIF_CHAN_U || plane == AVIF_CHAN_V;
+            const uint32_t planeFirstRow = isChroma ? firstRow >> shiftY : firstRow;
+            if (!scaled) {
+                if (srcPlanes[plane] != nullptr) {
+                    bandPlanes[plane] = const_cast<uint8_t*>(srcPlanes[plane]) + static_cast<size_t>(planeFirstRow) * srcStrides[plane];
+                    bandStrides[plane] = srcStrides[plane];
+                }
+                continue;
+            }
+            if (!resamplers[plane]) {
+                continue;
+            }
+            const uint32_t planeRowsCount = isChroma ? ((firstRow + rowsCount + shiftY) >> shiftY) - planeFirstRow : rowsCount;
+            bandStrides[plane] = dstWidths[plane] * static_cast<uint32_t>(sizeof(T));
+            scratch.planes[plane].resize(bandStrides[plane] * bandHeight);
+            bandPlanes[plane] = scratch.planes[plane].data();
+            resamplers[plane]->resampleRows(planeFirstRow, planeRowsCount,
+                                            reinterpret_cast<T*>(bandPlanes[plane]), bandStrides[plane],
+                                            scratch.accumulator);
+        }
+        
+        for (int plane = 0; plane < AVIF_PLANE_COUNT_YUV; ++plane) {
+            bandImage.yuvPlanes[plane] = bandPlanes[plane];
+            bandImage.yuvRowBytes[plane] = bandStrides[plane];
+        }
+        bandImage.alphaPlane = bandPlanes[AVIF_PLANE_COUNT_YUV];
+        bandImage.alphaRowBytes = bandStrides[AVIF_PLANE_COUNT_YUV];
+        
+        if (!convertBand(bandImage, firstRow, scratch)) {
+            converted = false;
+        }
+    });
+    
+    return converted;
+}
+
+/**
+ * Downscales the planes and converts them to RGB(A) at once, each band is converted straight into `dst`,
+ * so neither a scaled copy of the image nor a full resolution RGB buffer is ever allocated.
+ */
+template<typename T>
+bool AvifScaleAndConvertImage(const avifImage* image, uint32_t width, uint32_t height,
+                              uint8_t* dst, uint32_t stride) {
+    return AvifConvertImageBands<T>(image, width, height, [&](const avifImage& bandImage, uint32_t firstRow, AvifBandScratch&) {
+        return AvifConvertImage(&bandImage, dst + static_cast<size_t>(firstRow) * stride, stride);
+    });
+}
+
+/**
+ * Converts RGB deeper than 8 bits band by band into small per thread buffers and packs each band to RA30
+ * in `dst`, so the frame needs a single RA30 buffer instead of an extra 16-bit RGB copy of it.
+ */
+inline bool AvifConvertImageToRA30(const avifImage* image, uint32_t width, uint32_t height, uint32_t bitDepth,
+                                   uint8_t* dst, uint32_t stride) {
+    return AvifConvertImageBands<uint16_t>(image, width, height, [&](const avifImage& bandImage, uint32_t firstRow, AvifBandScratch& scratch) {
+        const uint32_t rgbStride = bandImage.width * 3 * static_cast<uint32_t>(sizeof(uint16_t));
+        scratch.rgb.resize(static_cast<size_t>(rgbStride) * bandImage.height);
+        if (!AvifConvertImage(&bandImage, scratch.rgb.data(), rgbStride)) {
+            return false;
+        }
+        pixart_rgb_u16_to_ra30(reinterpret_cast<const uint16_t*>(scratch.rgb.data()), rgbStride,
+                               dst + static_cast<size_t>(firstRow) * stride, stride,
+                               bitDepth, bandImage.width, bandImage.height);
+        return true;
+    });
+}
+
+/**
+ * Converts `image` downscaled to `width` x `height` into a single pixel buffer that a CGDataProvider hands to
+ * CoreGraphics as is. 8-bit images become RGB(A) 8-bit; deeper RGB is packed to RA30 when `allowRA30`,
+ * deeper images otherwise become half float RGB(A), which `bitDepth` of the handle tells apart: 8, 10 or 16.
+ * Upscaling is not supported.
+ */
+inline AvifImageHandle AvifHandleImage(const avifImage* image, uint32_t width, uint32_t height, bool allowRA30, int* result) {
+    if (image == nullptr || width == 0 || height == 0 || width > image->width || height > image->height) {
+        RETURN_ERROR_HANDLE(result);
+    }
+    AvifRgbLayout layout;
+    if (!AvifRgbLayoutForImage(image, &layout)) {
+        RETURN_ERROR_HANDLE(result);
+    }
+    
+    const bool scaled = width != image->width || height != image->height;
+    const bool packRA30 = allowRA30 && layout.bitDepth > 8 && layout.components == 3;
+    uint32_t stride = width * (packRA30 ? static_cast<uint32_t>(sizeof(uint32_t)) : layout.bytesPerPixel);
+    PixelBuffer data(stride * height);
+    bool converted;
+    if (packRA30) {
+        converted = AvifConvertImageToRA30(image, width, height, layout.bitDepth, data.data(), stride);
+    } else if (!scaled) {
+        converted = AvifConvertImage(image, data.data(), stride);
+    } else {
+        converted = image->depth > 8
+        ? AvifScaleAndConvertImage<uint16_t>(image, width, height, data.data(), stride)
+        : AvifScaleAndConvertImage<uint8_t>(image, width, height, data.data(), stride);
+    }
+    if (!converted) {
+        RETURN_ERROR_HANDLE(result);
+    }
+    
+    uint32_t bitDepth = layout.bitDepth;
+    uint32_t components = layout.components;
+    if (packRA30) {
+        bitDepth = 10;
+        components = 4;
+    } else if (layout.bitDepth > 8) {
+        // Converted in place, half floats take as much room as the 16-bit samples
+        if (components == 3) {
+            pixart_rgb_u16_to_f16(reinterpret_cast<const uint16_t*>(data.data()), stride,
+                                  reinterpret_cast<uint16_t*>(data.data()), stride,
+                                  layout.bitDepth, width, height);
+        } else {
+            pixart_rgba_u16_to_f16(reinterpret_cast<const uint16_t*>(data.data()), stride,
+                                   reinterpret_cast<uint16_t*>(data.data()), stride,
+                                   layout.bitDepth, width, height);
+        }
+        bitDepth = 16;
+    }
+    
+    *result = AVIF_RESULT_OK;
+    return AvifImageHandle {
+        .data = std::move(data),
+        .stride = stride,
+        .width = width,
+        .height = height,
+        .bitDepth = bitDepth,
+        .components = components
+    };
+}
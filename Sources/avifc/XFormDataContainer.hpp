@@ -0,0 +1,64 @@
+//
+//  XFormDataContainer.hpp
+//  avif.swift [https://github.com/awxkee/avif.swift]
+//
+//  Created by Radzivon Bartoshyk on 17/10/2026.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "PixelBufferPool.hpp"
+
+/**
+ * Owner of the pixels of a decoded frame while a CGDataProvider reads them. The provider is created
+ * with the container as its info and `XFormDataRelease` as its release callback, which gives the
+ * buffer back to the `PixelBufferPool` when the image is gone, so the next frame reuses it.
+ */
+class XFormDataContainer {
+public:
+    // Takes over the storage, decoded frames are never copied on their way to the data provider
+    XFormDataContainer(PixelBuffer&& src): container(std::move(src)) {
+        
+    }
+    
+    void clear() {
+        container.clear();
+    }
+    
+    uint8_t* data() {
+        return container.data();
+    }
+private:
+    PixelBuffer container;
+};
+
+inline void XFormDataRelease(void *info, const void *, size_t) {
+    XFormDataContainer* mDataContainer = reinterpret_cast<XFormDataContainer*>(info);
+    if (mDataContainer) {
+        mDataContainer->clear();
+        delete mDataContainer;
+    }
+}
@@ -25,7 +25,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -42,89 +47,255 @@ namespace concurrency {
         using result_type = R;
     };
 
-    template<typename Function, typename... Args>
-    void parallel_for(const int numThreads, const int numIterations, Function &&func, Args &&... args) {
-        static_assert(std::is_invocable_v<Function, int, Args...>, "func must take an int parameter for iteration id");
+    /**
+     * Process-wide work-stealing pool. Workers are started lazily on first use, each worker
+     * owns a deque: it pops its own tasks from the back and steals from the front of others.
+     * The amount of workers is the global concurrency budget, so any number of simultaneous
+     * `parallel_for` calls never creates more than `budget` threads in total.
+     */
+    class ThreadPool {
+    public:
+        using Task = std::function<void()>;
 
-        std::vector<std::thread> threads;
+        static ThreadPool &shared() {
+            static ThreadPool pool(ThreadPool::budget().load(std::memory_order_acquire));
+            return pool;
+        }
 
-        int segmentHeight = numIterations / numThreads;
+        /**
+         * Sets the maximum amount of pool workers, must be called before the pool is first used
+         * to take effect. Values less than 1 fall back to hardware concurrency.
+         */
+        static void setConcurrencyBudget(int workers) {
+            budget().store(workers, std::memory_order_release);
+        }
 
-        auto parallelWorker = [&](int start, int end) {
-            for (int y = start; y < end; ++y) {
-                {
-                    std::invoke(func, y, std::forward<Args>(args)...);
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                stopping = true;
+            }
+            sleepCondition.notify_all();
+            for (auto &worker: workers) {
+                if (worker.joinable()) {
+                    worker.join();
                 }
             }
+        }
+
+        int size() const {
+            return static_cast<int>(workers.size());
+        }
+
+        void submit(Task task) {
+            size_t index;
+            if (currentWorker() >= 0 && currentPool() == this) {
+                index = static_cast<size_t>(currentWorker());
+            } else {
+                index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            }
+            {
+                std::lock_guard<std::mutex> lock(queues[index]->mutex);
+                queues[index]->tasks.emplace_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                pending += 1;
+            }
+            sleepCondition.notify_one();
+        }
+
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
         };
 
-        if (numThreads > 1) {
-            // Launch N-1 worker threads
-            for (int i = 1; i < numThreads; ++i) {
-                int start = i * segmentHeight;
-                int end = (i + 1) * segmentHeight;
-                if (i == numThreads - 1) {
-                    end = numIterations;
+        explicit ThreadPool(int requestedWorkers) {
+            int count = requestedWorkers;
+            if (count < 1) {
+                count = static_cast<int>(std::thread::hardware_concurrency());
+            }
+            count = std::max(count, 1);
+            for (int i = 0; i < count; ++i) {
+                queues.emplace_back(std::make_unique<WorkQueue>());
+            }
+            workers.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                workers.emplace_back(&ThreadPool::workerLoop, this, i);
+            }
+        }
+
+        static std::atomic<int> &budget() {
+            static std::atomic<int> value(0);
+            return value;
+        }
+
+        static int &currentWorker() {
+            static thread_local int id = -1;
+            return id;
+        }
+
+        static ThreadPool *&currentPool() {
+            static thread_local ThreadPool *pool = nullptr;
+            return pool;
+        }
+
+        bool popLocal(size_t index, Task &task) {
+            auto &queue = *queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                return false;
+            }
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        bool steal(size_t thief, Task &task) {
+            for (size_t i = 1; i < queues.size(); ++i) {
+                auto &queue = *queues[(thief + i) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (!queue.tasks.empty()) {
+                    task = std::move(queue.tasks.front());
+                    queue.tasks.pop_front();
+                    return true;
                 }
-                threads.emplace_back(parallelWorker, start, end);
             }
+            return false;
         }
 
-        int start = 0;
-        int end = segmentHeight;
-        if (numThreads == 1) {
-            end = numIterations;
+        void workerLoop(int index) {
+            currentWorker() = index;
+            currentPool() = this;
+            const size_t queueIndex = static_cast<size_t>(index);
+            while (true) {
+                {
+                    std::unique_lock<std::mutex> lock(sleepMutex);
+                    sleepCondition.wait(lock, [this] { return stopping || pending > 0; });
+                    if (pending == 0 && stopping) {
+                        return;
+                    }
+                    pending -= 1;
+                }
+                Task task;
+                // A pending ticket guarantees a task is queued somewhere, it may take a few
+                // sweeps if other workers are racing for the same deque
+                while (!popLocal(queueIndex, task) && !steal(queueIndex, task)) {
+                    std::this_thread::yield();
+                }
+                task();
+            }
         }
-        parallelWorker(start, end);
 
-        // Join all threads
-        for (auto &thread: threads) {
-            if (thread.joinable()) {
-                thread.join();
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<size_t> nextQueue{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        size_t pending = 0;
+        bool stopping = false;
+    };
+
+    /**
+     * Segment distribution shared between the calling thread and pool workers.
+     * Segments are claimed with an atomic counter, so the caller keeps executing segments
+     * that were not yet picked by workers; this never waits on queued work and nested
+     * or concurrent calls cannot deadlock on a saturated pool.
+     */
+    class SegmentedJob {
+    public:
+        SegmentedJob(int segments, std::function<void(int)> body) : segments(segments), body(std::move(body)) {}
+
+        void run() {
+            int segment;
+            while ((segment = next.fetch_add(1, std::memory_order_relaxed)) < segments) {
+                body(segment);
+                if (completed.fetch_add(1, std::memory_order_acq_rel) + 1 == segments) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    condition.notify_all();
+                }
             }
         }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return completed.load(std::memory_order_acquire) == segments; });
+        }
+
+    private:
+        const int segments;
+        std::function<void(int)> body;
+        std::atomic<int> next{0};
+        std::atomic<int> completed{0};
+        std::mutex mutex;
+        std::condition_variable condition;
+    };
+
+    template<typename Segment>
+    void run_segments(const int numSegments, Segment &&segment) {
+        if (numSegments <= 1) {
+            segment(0);
+            return;
+        }
+        auto &pool = ThreadPool::shared();
+        auto job = std::make_shared<SegmentedJob>(numSegments, std::function<void(int)>(std::ref(segment)));
+        const int helpers = std::min(numSegments - 1, pool.size());
+        for (int i = 0; i < helpers; ++i) {
+            pool.submit([job] { job->run(); });
+        }
+        job->run();
+        job->wait();
     }
 
     template<typename Function, typename... Args>
-    void parallel_for_with_thread_id(const int numThreads, const int numIterations, Function &&func, Args &&... args) {
-        static_assert(std::is_invocable_v<Function, int, int, Args...>, "func must take an int parameter for threadId, and iteration Id");
-
-        std::vector<std::thread> threads;
+    void parallel_for(const int numThreads, const int numIterations, Function &&func, Args &&... args) {
+        static_assert(std::is_invocable_v<Function, int, Args...>, "func must take an int parameter for iteration id");
 
-        int segmentHeight = numIterations / numThreads;
+        const int segments = std::max(std::min(numThreads, numIterations), 1);
+        const int segmentHeight = numIterations / segments;
 
-        auto parallel_worker = [&](int threadId, int start, int end) {
+        auto parallelWorker = [&](int segment) {
+            int start = segment * segmentHeight;
+            int end = (segment + 1) * segmentHeight;
+            if (segment == segments - 1) {
+                end = numIterations;
+            }
             for (int y = start; y < end; ++y) {
                 {
-                    std::invoke(func, threadId, y, std::forward<Args>(args)...);
+                    std::invoke(func, y, args...);
                 }
             }
         };
 
-        if (numThreads > 1) {
-            // Launch N-1 worker threads
-            for (int i = 1; i < numThreads; ++i) {
-                int start = i * segmentHeight;
-                int end = (i + 1) * segmentHeight;
-                if (i == numThreads - 1) {
-                    end = numIterations;
-                }
-                threads.emplace_back(parallel_worker, i, start, end);
-            }
-        }
+        run_segments(segments, parallelWorker);
+    }
 
-        int start = 0;
-        int end = segmentHeight;
-        if (numThreads == 1) {
-            end = numIterations;
-        }
-        parallel_worker(0, start, end);
+    template<typename Function, typename... Args>
+    void parallel_for_with_thread_id(const int numThreads, const int numIterations, Function &&func, Args &&... args) {
+        static_assert(std::is_invocable_v<Function, int, int, Args...>, "func must take an int parameter for threadId, and iteration Id");
 
-        // Join all threads
-        for (auto &thread: threads) {
-            if (thread.joinable()) {
-                thread.join();
+        const int segments = std::max(std::min(numThreads, numIterations), 1);
+        const int segmentHeight = numIterations / segments;
+
+        // Every segment is executed exactly once by a single thread, thus segment index is a
+        // stable thread id for per-thread scratch buffers
+        auto parallelWorker = [&](int threadId) {
+            int start = threadId * segmentHeight;
+            int end = (threadId + 1) * segmentHeight;
+            if (threadId == segments - 1) {
+                end = numIterations;
             }
-        }
+            for (int y = start; y < end; ++y) {
+                {
+                    std::invoke(func, threadId, y, args...);
+                }
+            }
+        };
+
+        run_segments(segments, parallelWorker);
     }
 }
@@ -26,6 +26,13 @@
 #import <Foundation/Foundation.h>
 #import "PlatformImage.h"
 
+typedef NS_ENUM(NSUInteger, AVIFFrameCachePolicy) {
+    /// Keeps every converted frame while they fit the byte budget
+    kKeepAllFrames NS_SWIFT_NAME(keepAll),
+    /// Keeps only the most recently used frames, up to the capacity
+    kRingBuffer NS_SWIFT_NAME(ringBuffer)
+};
+
 @interface AVIFAnimatedDecoder : NSObject
 -(nullable id)initWithData:(nonnull NSData*)data;
 -(nullable CGImageRef)get:(int)frame;
@@ -35,4 +42,10 @@
 -(int)frameDuration:(int)frame;
 -(CGSize)imageSize;
 -(int)duration;
+/// Converted frames are cached within `budget` bytes, 0 disables the cache. Capacity is used only by the ring buffer policy
+-(void)setCachePolicy:(AVIFFrameCachePolicy)policy capacity:(int)capacity budget:(NSUInteger)budget;
+/// Amount of frames decoded in background ahead of the last requested one, 0 disables prefetching
+-(void)setPrefetchCount:(int)prefetchCount;
+-(uint64_t)cacheHits;
+-(uint64_t)cacheMisses;
 @end
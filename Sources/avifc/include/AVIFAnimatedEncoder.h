@@ -31,7 +31,34 @@
 @interface AVIFAnimatedEncoder : NSObject
 - (nullable void*)create:(PreferredCodec)preferredCodec error:(NSError * _Nullable * _Nullable)error;
 - (void* _Nullable)addImage:(Image * _Nonnull)platformImage duration:(NSUInteger)timescale error:(NSError * _Nullable * _Nullable)error;
+/// Queues the frame and returns: pixels are extracted and converted to YUV on a worker stage while the previous frames
+/// are encoded, frames are encoded in the order they were added. Blocks while `maxPendingFrames` frames are in flight.
+/// A failure is reported by `waitForPendingImages` or by the call finishing the file
+- (BOOL)addImageAsync:(Image * _Nonnull)platformImage duration:(NSUInteger)duration error:(NSError * _Nullable * _Nullable)error;
+- (BOOL)waitForPendingImages:(NSError * _Nullable * _Nullable)error;
+/// Must be called before the first `addImageAsync`, defaults to 3
+- (void)setMaxPendingFrames:(NSInteger)count;
+- (NSInteger)pendingFrames;
+/// How many times and for how long `addImageAsync` waited for a free slot
+- (NSUInteger)backPressureCount;
+- (NSTimeInterval)backPressureTime;
+/// Time spent converting frames to YUV and encoding them, for frames added by either call
+- (NSTimeInterval)conversionTime;
+- (NSTimeInterval)encodeTime;
+/// Frames converted per second of `conversionTime`, that is excluding the codec, for benchmarking the conversion
+- (double)conversionFramesPerSecond;
+/// Frames of the same size and alpha presence reuse the planes of the previous ones instead of allocating their own
+- (NSUInteger)reusedImagesCount;
+- (NSUInteger)allocatedImagesCount;
 - (NSData* _Nullable)encode:(NSError * _Nullable *_Nullable)error;
+/// Writes the animation to the file at `path` as it is assembled, without holding the encoded file in memory
+- (BOOL)encodeToPath:(nonnull NSString*)path error:(NSError * _Nullable *_Nullable)error;
+/// Starts writing the animation to the file at `path` while frames are added, so encoded frames are not kept in memory.
+/// Must be called before the first `addImage`, the file is completed by `finishStreaming`.
+/// While streaming is active `encode` and `encodeToPath` fail without touching the encoder
+- (BOOL)startStreamingToPath:(nonnull NSString*)path error:(NSError * _Nullable *_Nullable)error;
+- (BOOL)finishStreaming:(NSError * _Nullable *_Nullable)error;
+/// Settings apply to the frames added after the call, the call waits for the frames queued by `addImageAsync`
 - (void)setSpeed:(NSInteger)speed;
 - (void)setCompressionQuality:(double)quality;
 - (void)setLoopsCount:(NSInteger)loopsCount;
@@ -66,6 +66,8 @@ typedef NS_ENUM(NSUInteger, EnclosedColorSpace) {
 
 @interface Image (ColorData)
 -(nullable EnclosedImage*)rgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight;
+/// Same as `rgbaPixels` but colors are left premultiplied by alpha, for consumers that unpremultiply on the fly
+-(nullable EnclosedImage*)premultipliedRgbaPixels:(nonnull uint32_t*)imageWidth imageHeight:(nonnull uint32_t*)imageHeight;
 @end
 
 
@@ -148,122 +148,248 @@ void avifReformatAlpha(const avifAlphaParams * params)
     }
 }
 
-avifResult avifRGBImagePremultiplyAlpha(avifRGBImage * rgb)
+// ---------------------------------------------------------------------------
+// Alpha (un)multiply kernels
+//
+// Every kernel processes a single row. The 8-bit and the integer kernels have no data dependent branches so that
+// compilers can vectorize them, and use integer arithmetic that matches the float formulas of the 16-bit kernels for every
+// (color, alpha) pair.
+
+// Depths up to 12 bits use the integer kernels: color * alpha and color * max stay below 2^24, so the float formulas
+// compute the exact quotient rounded once, and the quotient is never within float precision of a rounding boundary.
+// Their result is round(n / d) == floor((2 * n + d) / (2 * d)), where the division by 2 * d < 2^13 of a numerator below
+// 2^25 is exactly a multiplication by ceil(2^38 / (2 * d)) and a shift by 38.
+#define AVIF_ALPHA_INTEGER_MAX_DEPTH 12
+#define AVIF_ALPHA_RECIPROCAL_SHIFT 38
+
+// The image is split into bands of whole rows that are processed independently.
+typedef struct avifAlphaMultiplyContext
 {
-    // no data
-    if (!rgb->pixels || !rgb->rowBytes) {
-        return AVIF_RESULT_REFORMAT_FAILED;
+    avifRGBImage * rgb;
+    uint32_t rowsPerJob;
+    avifBool unmultiply;
+    // 8-bit unmultiply: round(color * 255 / alpha) == (color * reciprocals[alpha] + 0x8000) >> 16, clamped to 255
+    uint32_t reciprocals[256];
+    // Integer kernels: reciprocal of 2 * max for premultiply, of 2 * alpha for every alpha up to max for unmultiply
+    // (0 for alpha 0), see AVIF_ALPHA_RECIPROCAL_SHIFT.
+    uint64_t maxReciprocal;
+    uint64_t * alphaReciprocals;
+} avifAlphaMultiplyContext;
+
+static inline void avifPremultiplyRow8(uint8_t * pixel, uint32_t width, uint32_t alphaOffset, uint32_t colorOffset)
+{
+    for (uint32_t i = 0; i < width; ++i) {
+        const uint32_t a = pixel[alphaOffset];
+        for (uint32_t c = colorOffset; c < colorOffset + 3; ++c) {
+            // round(color * a / 255), exact for all color * a <= 255 * 255
+            const uint32_t t = pixel[c] * a + 128;
+            pixel[c] = (uint8_t)((t + (t >> 8)) >> 8);
+        }
+        pixel += 4;
     }
+}
 
-    // no alpha.
-    if (!avifRGBFormatHasAlpha(rgb->format)) {
-        return AVIF_RESULT_INVALID_ARGUMENT;
+static inline void avifUnpremultiplyRow8(uint8_t * pixel, uint32_t width, uint32_t alphaOffset, uint32_t colorOffset, const uint32_t * reciprocals)
+{
+    for (uint32_t i = 0; i < width; ++i) {
+        const uint32_t reciprocal = reciprocals[pixel[alphaOffset]];
+        for (uint32_t c = colorOffset; c < colorOffset + 3; ++c) {
+            const uint32_t v = (pixel[c] * reciprocal + 0x8000) >> 16;
+            pixel[c] = (uint8_t)AVIF_MIN(v, 255);
+        }
+        pixel += 4;
     }
+}
 
-    avifResult libyuvResult = avifRGBImagePremultiplyAlphaLibYUV(rgb);
-    if (libyuvResult != AVIF_RESULT_NOT_IMPLEMENTED) {
-        return libyuvResult;
+// Above 8 bits and up to AVIF_ALPHA_INTEGER_MAX_DEPTH. Samples above max are clamped first, like alpha values above max
+// are treated as opaque by the 16-bit kernels.
+static inline void avifPremultiplyRowInteger(uint16_t * pixel, uint32_t width, uint32_t alphaOffset, uint32_t colorOffset, uint32_t max, uint64_t maxReciprocal)
+{
+    for (uint32_t i = 0; i < width; ++i) {
+        const uint64_t a = AVIF_MIN(pixel[alphaOffset], max);
+        for (uint32_t c = colorOffset; c < colorOffset + 3; ++c) {
+            const uint64_t color = AVIF_MIN(pixel[c], max);
+            pixel[c] = (uint16_t)(((2 * color * a + max) * maxReciprocal) >> AVIF_ALPHA_RECIPROCAL_SHIFT);
+        }
+        pixel += 4;
     }
+}
 
-    assert(rgb->depth >= 8 && rgb->depth <= 16);
+static inline void avifUnpremultiplyRowInteger(uint16_t * pixel, uint32_t width, uint32_t alphaOffset, uint32_t colorOffset, uint32_t max, const uint64_t * alphaReciprocals)
+{
+    for (uint32_t i = 0; i < width; ++i) {
+        const uint32_t a = AVIF_MIN(pixel[alphaOffset], max);
+        const uint64_t reciprocal = alphaReciprocals[a];
+        for (uint32_t c = colorOffset; c < colorOffset + 3; ++c) {
+            const uint64_t color = AVIF_MIN(pixel[c], max);
+            const uint64_t v = ((2 * color * max + a) * reciprocal) >> AVIF_ALPHA_RECIPROCAL_SHIFT;
+            pixel[c] = (uint16_t)AVIF_MIN(v, max);
+        }
+        pixel += 4;
+    }
+}
 
-    uint32_t max = (1 << rgb->depth) - 1;
-    float maxF = (float)max;
-
-    if (rgb->depth > 8) {
-        if (rgb->format == AVIF_RGB_FORMAT_RGBA || rgb->format == AVIF_RGB_FORMAT_BGRA) {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint16_t * pixel = (uint16_t *)row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint16_t a = pixel[3];
-                    if (a >= max) {
-                        // opaque is no-op
-                    } else if (a == 0) {
-                        // result must be zero
-                        pixel[0] = 0;
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                    } else {
-                        // a < maxF is always true now, so we don't need clamp here
-                        pixel[0] = (uint16_t)avifRoundf((float)pixel[0] * (float)a / maxF);
-                        pixel[1] = (uint16_t)avifRoundf((float)pixel[1] * (float)a / maxF);
-                        pixel[2] = (uint16_t)avifRoundf((float)pixel[2] * (float)a / maxF);
-                    }
-                    pixel += 4;
-                }
-                row += rgb->rowBytes;
-            }
+// 16 bits, where color * alpha no longer fits the float mantissa and integer arithmetic would not reproduce the rounding
+// of the float formulas. Opaque and transparent pixels are common and skip the division.
+static inline void avifPremultiplyRow16(uint16_t * pixel, uint32_t width, uint32_t alphaOffset, uint32_t colorOffset, uint32_t max)
+{
+    const float maxF = (float)max;
+    for (uint32_t i = 0; i < width; ++i) {
+        const uint16_t a = pixel[alphaOffset];
+        if (a >= max) {
+            // opaque is no-op
+        } else if (a == 0) {
+            // result must be zero
+            pixel[colorOffset] = 0;
+            pixel[colorOffset + 1] = 0;
+            pixel[colorOffset + 2] = 0;
         } else {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint16_t * pixel = (uint16_t *)row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint16_t a = pixel[0];
-                    if (a >= max) {
-                    } else if (a == 0) {
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                        pixel[3] = 0;
-                    } else {
-                        pixel[1] = (uint16_t)avifRoundf((float)pixel[1] * (float)a / maxF);
-                        pixel[2] = (uint16_t)avifRoundf((float)pixel[2] * (float)a / maxF);
-                        pixel[3] = (uint16_t)avifRoundf((float)pixel[3] * (float)a / maxF);
-                    }
-                    pixel += 4;
+            // a < maxF is always true now, so we don't need clamp here
+            pixel[colorOffset] = (uint16_t)avifRoundf((float)pixel[colorOffset] * (float)a / maxF);
+            pixel[colorOffset + 1] = (uint16_t)avifRoundf((float)pixel[colorOffset + 1] * (float)a / maxF);
+            pixel[colorOffset + 2] = (uint16_t)avifRoundf((float)pixel[colorOffset + 2] * (float)a / maxF);
+        }
+        pixel += 4;
+    }
+}
+
+static inline void avifUnpremultiplyRow16(uint16_t * pixel, uint32_t width, uint32_t alphaOffset, uint32_t colorOffset, uint32_t max)
+{
+    const float maxF = (float)max;
+    for (uint32_t i = 0; i < width; ++i) {
+        const uint16_t a = pixel[alphaOffset];
+        if (a >= max) {
+            // opaque is no-op
+        } else if (a == 0) {
+            // prevent division by zero
+            pixel[colorOffset] = 0;
+            pixel[colorOffset + 1] = 0;
+            pixel[colorOffset + 2] = 0;
+        } else {
+            const float c1 = avifRoundf((float)pixel[colorOffset] * maxF / (float)a);
+            const float c2 = avifRoundf((float)pixel[colorOffset + 1] * maxF / (float)a);
+            const float c3 = avifRoundf((float)pixel[colorOffset + 2] * maxF / (float)a);
+            pixel[colorOffset] = (uint16_t)AVIF_MIN(c1, maxF);
+            pixel[colorOffset + 1] = (uint16_t)AVIF_MIN(c2, maxF);
+            pixel[colorOffset + 2] = (uint16_t)AVIF_MIN(c3, maxF);
+        }
+        pixel += 4;
+    }
+}
+
+static void avifRGBImageAlphaMultiplyJob(void * context, uint32_t jobIndex)
+{
+    const avifAlphaMultiplyContext * ctx = (const avifAlphaMultiplyContext *)context;
+    const avifRGBImage * rgb = ctx->rgb;
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, rgb->height);
+    // Alpha comes last for RGBA and BGRA, and first for ARGB and ABGR.
+    const avifBool alphaLast = rgb->format == AVIF_RGB_FORMAT_RGBA || rgb->format == AVIF_RGB_FORMAT_BGRA;
+    const uint32_t max = (1 << rgb->depth) - 1;
+
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        uint8_t * row = &rgb->pixels[(size_t)j * rgb->rowBytes];
+        // The offsets are passed as constants so that every call is specialized for its layout.
+        if (rgb->depth > 8 && rgb->depth <= AVIF_ALPHA_INTEGER_MAX_DEPTH) {
+            uint16_t * pixel = (uint16_t *)row;
+            if (ctx->unmultiply) {
+                if (alphaLast) {
+                    avifUnpremultiplyRowInteger(pixel, rgb->width, 3, 0, max, ctx->alphaReciprocals);
+                } else {
+                    avifUnpremultiplyRowInteger(pixel, rgb->width, 0, 1, max, ctx->alphaReciprocals);
+                }
+            } else {
+                if (alphaLast) {
+                    avifPremultiplyRowInteger(pixel, rgb->width, 3, 0, max, ctx->maxReciprocal);
+                } else {
+                    avifPremultiplyRowInteger(pixel, rgb->width, 0, 1, max, ctx->maxReciprocal);
                 }
-                row += rgb->rowBytes;
             }
-        }
-    } else {
-        if (rgb->format == AVIF_RGB_FORMAT_RGBA || rgb->format == AVIF_RGB_FORMAT_BGRA) {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint8_t * pixel = row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint8_t a = pixel[3];
-                    // uint8_t can't exceed 255
-                    if (a == max) {
-                    } else if (a == 0) {
-                        pixel[0] = 0;
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                    } else {
-                        pixel[0] = (uint8_t)avifRoundf((float)pixel[0] * (float)a / maxF);
-                        pixel[1] = (uint8_t)avifRoundf((float)pixel[1] * (float)a / maxF);
-                        pixel[2] = (uint8_t)avifRoundf((float)pixel[2] * (float)a / maxF);
-                    }
-                    pixel += 4;
+        } else if (rgb->depth > 8) {
+            uint16_t * pixel = (uint16_t *)row;
+            if (ctx->unmultiply) {
+                if (alphaLast) {
+                    avifUnpremultiplyRow16(pixel, rgb->width, 3, 0, max);
+                } else {
+                    avifUnpremultiplyRow16(pixel, rgb->width, 0, 1, max);
+                }
+            } else {
+                if (alphaLast) {
+                    avifPremultiplyRow16(pixel, rgb->width, 3, 0, max);
+                } else {
+                    avifPremultiplyRow16(pixel, rgb->width, 0, 1, max);
                 }
-                row += rgb->rowBytes;
             }
         } else {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint8_t * pixel = row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint8_t a = pixel[0];
-                    if (a == max) {
-                    } else if (a == 0) {
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                        pixel[3] = 0;
-                    } else {
-                        pixel[1] = (uint8_t)avifRoundf((float)pixel[1] * (float)a / maxF);
-                        pixel[2] = (uint8_t)avifRoundf((float)pixel[2] * (float)a / maxF);
-                        pixel[3] = (uint8_t)avifRoundf((float)pixel[3] * (float)a / maxF);
-                    }
-                    pixel += 4;
+            if (ctx->unmultiply) {
+                if (alphaLast) {
+                    avifUnpremultiplyRow8(row, rgb->width, 3, 0, ctx->reciprocals);
+                } else {
+                    avifUnpremultiplyRow8(row, rgb->width, 0, 1, ctx->reciprocals);
+                }
+            } else {
+                if (alphaLast) {
+                    avifPremultiplyRow8(row, rgb->width, 3, 0);
+                } else {
+                    avifPremultiplyRow8(row, rgb->width, 0, 1);
                 }
-                row += rgb->rowBytes;
+            }
+        }
+    }
+}
+
+static avifResult avifRGBImageAlphaMultiply(avifRGBImage * rgb, avifBool unmultiply)
+{
+    assert(rgb->depth >= 8 && rgb->depth <= 16);
+
+    avifAlphaMultiplyContext context;
+    context.rgb = rgb;
+    context.unmultiply = unmultiply;
+    context.alphaReciprocals = NULL;
+    if (unmultiply && rgb->depth == 8) {
+        context.reciprocals[0] = 0;
+        for (uint32_t a = 1; a < 255; ++a) {
+            context.reciprocals[a] = ((255u << 16) / a) + 1;
+        }
+        context.reciprocals[255] = 1 << 16;
+    }
+    if (rgb->depth > 8 && rgb->depth <= AVIF_ALPHA_INTEGER_MAX_DEPTH) {
+        const uint64_t one = (uint64_t)1 << AVIF_ALPHA_RECIPROCAL_SHIFT;
+        const uint32_t max = (1 << rgb->depth) - 1;
+        context.maxReciprocal = (one + 2 * max - 1) / (2 * max);
+        if (unmultiply) {
+            context.alphaReciprocals = (uint64_t *)avifAlloc(sizeof(uint64_t) * (max + 1));
+            AVIF_CHECKERR(context.alphaReciprocals != NULL, AVIF_RESULT_OUT_OF_MEMORY);
+            context.alphaReciprocals[0] = 0;
+            for (uint32_t a = 1; a <= max; ++a) {
+                context.alphaReciprocals[a] = (one + 2 * a - 1) / (2 * a);
             }
         }
     }
 
-    return AVIF_RESULT_OK;
+    // Bands of fewer than 64K pixels are not worth a thread.
+    const uint64_t pixelCount = (uint64_t)rgb->width * rgb->height;
+    uint32_t jobs = AVIF_CLAMP(rgb->maxThreads, 1, 8);
+    jobs = (uint32_t)AVIF_MIN(jobs, AVIF_MAX(pixelCount / 65536, 1));
+    jobs = AVIF_MIN(jobs, AVIF_MAX(rgb->height, 1));
+    context.rowsPerJob = (rgb->height + jobs - 1) / jobs;
+    if (context.rowsPerJob) {
+        jobs = (rgb->height + context.rowsPerJob - 1) / context.rowsPerJob;
+    }
+
+    avifResult result = AVIF_RESULT_OK;
+    if (jobs <= 1) {
+        if (rgb->height) {
+            avifRGBImageAlphaMultiplyJob(&context, 0);
+        }
+    } else if (!avifRunJobs(jobs, jobs, avifRGBImageAlphaMultiplyJob, &context)) {
+        result = AVIF_RESULT_REFORMAT_FAILED;
+    }
+    avifFree(context.alphaReciprocals);
+    return result;
 }
 
-avifResult avifRGBImageUnpremultiplyAlpha(avifRGBImage * rgb)
+avifResult avifRGBImagePremultiplyAlpha(avifRGBImage * rgb)
 {
     // no data
     if (!rgb->pixels || !rgb->rowBytes) {
@@ -272,118 +398,33 @@ avifResult avifRGBImageUnpremultiplyAlpha(avifRGBImage * rgb)
 
     // no alpha.
     if (!avifRGBFormatHasAlpha(rgb->format)) {
-        return AVIF_RESULT_REFORMAT_FAILED;
+        return AVIF_RESULT_INVALID_ARGUMENT;
     }
 
-    avifResult libyuvResult = avifRGBImageUnpremultiplyAlphaLibYUV(rgb);
+    avifResult libyuvResult = avifRGBImagePremultiplyAlphaLibYUV(rgb);
     if (libyuvResult != AVIF_RESULT_NOT_IMPLEMENTED) {
         return libyuvResult;
     }
 
-    assert(rgb->depth >= 8 && rgb->depth <= 16);
+    return avifRGBImageAlphaMultiply(rgb, AVIF_FALSE);
+}
 
-    uint32_t max = (1 << rgb->depth) - 1;
-    float maxF = (float)max;
-
-    if (rgb->depth > 8) {
-        if (rgb->format == AVIF_RGB_FORMAT_RGBA || rgb->format == AVIF_RGB_FORMAT_BGRA) {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint16_t * pixel = (uint16_t *)row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint16_t a = pixel[3];
-                    if (a >= max) {
-                        // opaque is no-op
-                    } else if (a == 0) {
-                        // prevent division by zero
-                        pixel[0] = 0;
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                    } else {
-                        float c1 = avifRoundf((float)pixel[0] * maxF / (float)a);
-                        float c2 = avifRoundf((float)pixel[1] * maxF / (float)a);
-                        float c3 = avifRoundf((float)pixel[2] * maxF / (float)a);
-                        pixel[0] = (uint16_t)AVIF_MIN(c1, maxF);
-                        pixel[1] = (uint16_t)AVIF_MIN(c2, maxF);
-                        pixel[2] = (uint16_t)AVIF_MIN(c3, maxF);
-                    }
-                    pixel += 4;
-                }
-                row += rgb->rowBytes;
-            }
-        } else {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint16_t * pixel = (uint16_t *)row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint16_t a = pixel[0];
-                    if (a >= max) {
-                    } else if (a == 0) {
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                        pixel[3] = 0;
-                    } else {
-                        float c1 = avifRoundf((float)pixel[1] * maxF / (float)a);
-                        float c2 = avifRoundf((float)pixel[2] * maxF / (float)a);
-                        float c3 = avifRoundf((float)pixel[3] * maxF / (float)a);
-                        pixel[1] = (uint16_t)AVIF_MIN(c1, maxF);
-                        pixel[2] = (uint16_t)AVIF_MIN(c2, maxF);
-                        pixel[3] = (uint16_t)AVIF_MIN(c3, maxF);
-                    }
-                    pixel += 4;
-                }
-                row += rgb->rowBytes;
-            }
-        }
-    } else {
-        if (rgb->format == AVIF_RGB_FORMAT_RGBA || rgb->format == AVIF_RGB_FORMAT_BGRA) {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint8_t * pixel = row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint8_t a = pixel[3];
-                    if (a == max) {
-                    } else if (a == 0) {
-                        pixel[0] = 0;
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                    } else {
-                        float c1 = avifRoundf((float)pixel[0] * maxF / (float)a);
-                        float c2 = avifRoundf((float)pixel[1] * maxF / (float)a);
-                        float c3 = avifRoundf((float)pixel[2] * maxF / (float)a);
-                        pixel[0] = (uint8_t)AVIF_MIN(c1, maxF);
-                        pixel[1] = (uint8_t)AVIF_MIN(c2, maxF);
-                        pixel[2] = (uint8_t)AVIF_MIN(c3, maxF);
-                    }
-                    pixel += 4;
-                }
-                row += rgb->rowBytes;
-            }
-        } else {
-            uint8_t * row = rgb->pixels;
-            for (uint32_t j = 0; j < rgb->height; ++j) {
-                uint8_t * pixel = row;
-                for (uint32_t i = 0; i < rgb->width; ++i) {
-                    uint8_t a = pixel[0];
-                    if (a == max) {
-                    } else if (a == 0) {
-                        pixel[1] = 0;
-                        pixel[2] = 0;
-                        pixel[3] = 0;
-                    } else {
-                        float c1 = avifRoundf((float)pixel[1] * maxF / (float)a);
-                        float c2 = avifRoundf((float)pixel[2] * maxF / (float)a);
-                        float c3 = avifRoundf((float)pixel[3] * maxF / (float)a);
-                        pixel[1] = (uint8_t)AVIF_MIN(c1, maxF);
-                        pixel[2] = (uint8_t)AVIF_MIN(c2, maxF);
-                        pixel[3] = (uint8_t)AVIF_MIN(c3, maxF);
-                    }
-                    pixel += 4;
-                }
-                row += rgb->rowBytes;
-            }
-        }
+avifResult avifRGBImageUnpremultiplyAlpha(avifRGBImage * rgb)
+{
+    // no data
+    if (!rgb->pixels || !rgb->rowBytes) {
+        return AVIF_RESULT_REFORMAT_FAILED;
+    }
+
+    // no alpha.
+    if (!avifRGBFormatHasAlpha(rgb->format)) {
+        return AVIF_RESULT_REFORMAT_FAILED;
+    }
+
+    avifResult libyuvResult = avifRGBImageUnpremultiplyAlphaLibYUV(rgb);
+    if (libyuvResult != AVIF_RESULT_NOT_IMPLEMENTED) {
+        return libyuvResult;
     }
 
-    return AVIF_RESULT_OK;
+    return avifRGBImageAlphaMultiply(rgb, AVIF_TRUE);
 }
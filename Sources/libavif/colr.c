@@ -506,6 +506,111 @@ avifTransferFunction avifTransferCharacteristicsGetLinearToGammaFunction(avifTra
     return avifToGamma709; // Provide a reasonable default.
 }
 
+float * avifTransferCharacteristicsCreateGammaToLinearTable(avifTransferCharacteristics atc, uint32_t depth)
+{
+    const avifTransferFunction toLinear = avifTransferCharacteristicsGetGammaToLinearFunction(atc);
+    const uint32_t maxValue = (1u << depth) - 1;
+    const float maxValueF = (float)maxValue;
+    float * table = (float *)avifAlloc(sizeof(float) * (maxValue + 1));
+    if (table == NULL) {
+        return NULL;
+    }
+    for (uint32_t v = 0; v <= maxValue; ++v) {
+        // Same normalization as avifGetRGBAPixel().
+        table[v] = toLinear(v / maxValueF);
+    }
+    return table;
+}
+
+const float * avifGammaToLinearTablesGet(avifGammaToLinearTables * tables, avifTransferCharacteristics atc, uint32_t depth)
+{
+    for (uint32_t i = 0; i < tables->count; ++i) {
+        if (tables->entries[i].atc == atc && tables->entries[i].depth == depth) {
+            return tables->entries[i].table;
+        }
+    }
+    if (tables->count == AVIF_GAMMA_TO_LINEAR_TABLES_MAX) {
+        return NULL;
+    }
+    float * table = avifTransferCharacteristicsCreateGammaToLinearTable(atc, depth);
+    if (table == NULL) {
+        return NULL;
+    }
+    tables->entries[tables->count].atc = atc;
+    tables->entries[tables->count].depth = depth;
+    tables->entries[tables->count].table = table;
+    ++tables->count;
+    return table;
+}
+
+void avifGammaToLinearTablesFree(avifGammaToLinearTables * tables)
+{
+    for (uint32_t i = 0; i < tables->count; ++i) {
+        avifFree(tables->entries[i].table);
+    }
+    tables->count = 0;
+}
+
+// Largest linear value of the transfer characteristics whose linear to gamma function is flat above it, or 0 if the
+// function does not saturate (or is not continuous, or is the identity) and is not worth approximating.
+static float avifTransferCharacteristicsGetMaxLinear(avifTransferCharacteristics atc)
+{
+    switch (atc) {
+        case AVIF_TRANSFER_CHARACTERISTICS_BT709:
+        case AVIF_TRANSFER_CHARACTERISTICS_BT470M:
+        case AVIF_TRANSFER_CHARACTERISTICS_BT470BG:
+        case AVIF_TRANSFER_CHARACTERISTICS_BT601:
+        case AVIF_TRANSFER_CHARACTERISTICS_SMPTE240:
+        case AVIF_TRANSFER_CHARACTERISTICS_SRGB:
+        case AVIF_TRANSFER_CHARACTERISTICS_BT2020_10BIT:
+        case AVIF_TRANSFER_CHARACTERISTICS_BT2020_12BIT:
+            return 1.0f;
+        case AVIF_TRANSFER_CHARACTERISTICS_PQ:
+            return PQ_MAX_NITS / SDR_WHITE_NITS;
+        case AVIF_TRANSFER_CHARACTERISTICS_HLG:
+            return HLG_PEAK_LUMINANCE_NITS / SDR_WHITE_NITS;
+        default:
+            return 0.0f;
+    }
+}
+
+void avifTransferCurveInitLinearToGamma(avifTransferCurve * curve, avifTransferCharacteristics atc)
+{
+    // Unknown characteristics fall back to BT.709 like avifTransferCharacteristicsGetLinearToGammaFunction().
+    curve->toGamma = avifTransferCharacteristicsGetLinearToGammaFunction(atc);
+    curve->maxLinear = avifTransferCharacteristicsGetMaxLinear(
+        (curve->toGamma == avifToGamma709) ? AVIF_TRANSFER_CHARACTERISTICS_BT709 : atc);
+    if (curve->maxLinear == 0.0f) {
+        return;
+    }
+    // Samples are spaced evenly in the fourth root of the normalized linear value, which is dense where the curves are
+    // steep (near black) and sparse where they are flat.
+    for (int i = 0; i <= AVIF_TRANSFER_CURVE_SIZE; ++i) {
+        const double u = (double)i / AVIF_TRANSFER_CURVE_SIZE;
+        curve->table[i] = curve->toGamma((float)(u * u * u * u * curve->maxLinear));
+    }
+}
+
+void avifTransferCurveApply(const avifTransferCurve * curve, float * values, uint32_t count)
+{
+    if (curve->maxLinear == 0.0f) {
+        for (uint32_t i = 0; i < count; ++i) {
+            values[i] = curve->toGamma(values[i]);
+        }
+        return;
+    }
+    const float invMaxLinear = 1.0f / curve->maxLinear;
+    for (uint32_t i = 0; i < count; ++i) {
+        // Negative values and NaN map to 0, like the flat part of the functions below 0.
+        float normalized = values[i] * invMaxLinear;
+        normalized = (normalized > 0.0f) ? AVIF_MIN(normalized, 1.0f) : 0.0f;
+        const float position = sqrtf(sqrtf(normalized)) * AVIF_TRANSFER_CURVE_SIZE;
+        const int index = AVIF_MIN((int)position, AVIF_TRANSFER_CURVE_SIZE - 1);
+        const float fraction = position - (float)index;
+        values[i] = curve->table[index] + (curve->table[index + 1] - curve->table[index]) * fraction;
+    }
+}
+
 void avifColorPrimariesComputeYCoeffs(avifColorPrimaries colorPrimaries, float coeffs[3])
 {
     float primaries[8];
@@ -62,6 +62,273 @@ static inline float lerp(float a, float b, float w)
 
 #define SDR_WHITE_NITS 203.0f
 
+// Gain maps of up to this depth get a table of the gain of every possible value, instead of a powf() and an exp2f() per
+// sample.
+#define GAIN_TABLE_MAX_DEPTH 12
+
+// An RGB image read as linear values by avifRGBImageApplyGainMap() and avifRGBImageComputeGainMap().
+typedef struct avifGainMapSource
+{
+    const avifRGBImage * image;
+    avifRGBColorSpaceInfo info;
+    avifTransferFunction gammaToLinear;
+    const float * linearTable; // gammaToLinear() of every integer sample, or NULL to call gammaToLinear() per sample.
+} avifGainMapSource;
+
+// Results of one band of rows. Each band only writes its own entry.
+typedef struct avifGainMapComputeBand
+{
+    float channelMin[3];   // Minimum of the color converted image, see 'colorSpacesDiffer'.
+    float baseMax;         // Maximum of the linear base values.
+    float altMax;          // Maximum of the linear alternate values.
+    float log2RatioMin[3]; // Before multiplying by 'sign'.
+    float log2RatioMax[3];
+    int * histograms[3]; // numBuckets[c] counts of sign * log2 ratio per channel, NULL if not needed.
+} avifGainMapComputeBand;
+
+// The gain map is computed in passes over bands of rows: the log2 ratios of every pixel are recomputed by each pass
+// instead of being kept in full frame buffers, and per band results are merged between passes.
+typedef struct avifGainMapComputeContext
+{
+    avifGammaToLinearTables linearTables; // Tables of base and alt.
+    avifGainMapSource base;
+    avifGainMapSource alt;
+    uint32_t width;
+    uint32_t height;
+    uint32_t rowsPerJob;
+    avifBool colorSpacesDiffer;
+    avifBool useBaseColorSpace;
+    avifBool singleChannel;
+    int numGainMapChannels;
+    double rgbConversionCoeffs[3][3];
+    float yCoeffs[3];
+    float baseOffset[3];
+    float alternateOffset[3];
+    avifGainMapComputeBand * bands;
+
+    // Known after the first pass over the log2 ratios.
+    float sign; // sign(alternateHdrHeadroom - baseHdrHeadroom), the gain map stores HDR over SDR.
+    float histogramMin[3];
+    float histogramMax[3];
+    int numBuckets[3];
+
+    // Known after the histograms, used to write the gain map.
+    float gainMapMinLog2[3];
+    float gainMapMaxLog2[3];
+    float gainMapGamma[3];
+    const avifRGBImage * gainMapRGB;
+    const avifRGBColorSpaceInfo * gainMapRGBInfo;
+} avifGainMapComputeContext;
+
+// The table, if any, is taken from 'tables', which must outlive the source.
+static avifResult avifGainMapSourceInit(avifGainMapSource * source,
+                                        const avifRGBImage * image,
+                                        avifTransferCharacteristics transferCharacteristics,
+                                        avifGammaToLinearTables * tables)
+{
+    source->image = image;
+    source->gammaToLinear = avifTransferCharacteristicsGetGammaToLinearFunction(transferCharacteristics);
+    source->linearTable = NULL;
+    if (!avifGetRGBColorSpaceInfo(image, &source->info)) {
+        return AVIF_RESULT_NOT_IMPLEMENTED;
+    }
+    // Linearizing the samples of an image is worth a table of up to 12 bits, and of 16 bits unless the image has fewer
+    // pixels than the table has entries (avifRGBImageComputeGainMap() even linearizes all the samples in every pass).
+    const uint32_t tableSize = (uint32_t)source->info.maxChannel + 1;
+    if (!image->isFloat && image->format != AVIF_RGB_FORMAT_RGB_565 &&
+        (image->depth <= GAIN_TABLE_MAX_DEPTH || tableSize <= (uint64_t)image->width * image->height)) {
+        source->linearTable = avifGammaToLinearTablesGet(tables, transferCharacteristics, image->depth);
+        AVIF_CHECKERR(source->linearTable != NULL, AVIF_RESULT_OUT_OF_MEMORY);
+    }
+    return AVIF_RESULT_OK;
+}
+
+// Reads the linear R, G and B values and the alpha value of the pixel at (x, y).
+static inline void avifGainMapSourceGetLinear(const avifGainMapSource * source, uint32_t x, uint32_t y, float rgba[4])
+{
+    if (source->linearTable != NULL) {
+        const avifRGBColorSpaceInfo * info = &source->info;
+        const uint8_t * pixel = &source->image->pixels[(size_t)y * source->image->rowBytes + (size_t)x * info->pixelBytes];
+        const uint32_t offsets[3] = { info->offsetBytesR, info->offsetBytesG, info->offsetBytesB };
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t sample = (info->channelBytes > 1) ? *((const uint16_t *)&pixel[offsets[c]]) : pixel[offsets[c]];
+            rgba[c] = source->linearTable[AVIF_MIN(sample, (uint32_t)info->maxChannel)];
+        }
+        if (avifRGBFormatHasAlpha(source->image->format)) {
+            const uint32_t alpha = (info->channelBytes > 1) ? *((const uint16_t *)&pixel[info->offsetBytesA]) : pixel[info->offsetBytesA];
+            rgba[3] = alpha / info->maxChannelF;
+        } else {
+            rgba[3] = 1.0f;
+        }
+        return;
+    }
+    avifGetRGBAPixel(source->image, x, y, &source->info, rgba);
+    for (int c = 0; c < 3; ++c) {
+        rgba[c] = source->gammaToLinear(rgba[c]);
+    }
+}
+
+// Parameters shared by the bands of avifRGBImageApplyGainMap(). Every band covers rowsPerJob rows (the last one may be
+// shorter) and only writes its own rows of toneMappedImage, its own entry of rgbMaxLinear and the entries of its rows in
+// rowSumLinear.
+typedef struct avifGainMapApplyContext
+{
+    avifGammaToLinearTables linearTables; // Table of base.
+    avifGainMapSource base;
+    const avifRGBImage * toneMappedImage;
+    const avifRGBColorSpaceInfo * toneMappedPixelRGBInfo;
+    avifTransferCurve linearToGamma;
+    uint32_t rowsPerJob;
+
+    // Conversion without gain map (weight == 0).
+    avifBool convertPixels;
+    avifBool primariesDiffer;
+    double conversionCoeffs[3][3];
+
+    // Gain map application.
+    const avifRGBImage * gainMap;
+    const avifRGBColorSpaceInfo * gainMapRGBInfo;
+    const float * gainTables[3]; // Indexed by the integer gain map sample, NULL if the gain map is too deep.
+    float weight;
+    float gammaInv[3];
+    float gainMapMin[3];
+    float gainMapMax[3];
+    float baseOffset[3];
+    float alternateOffset[3];
+    avifBool needsInputColorConversion;
+    avifBool needsOutputColorConversion;
+    double inputConversionCoeffs[3][3];
+    double outputConversionCoeffs[3][3];
+    float * rgbMaxLinear;  // One entry per band.
+    double * rowSumLinear; // One entry per row, so that the sum over the image does not depend on the bands.
+} avifGainMapApplyContext;
+
+// Multiplier of the linear base value for the normalized gain map sample 'gainMapValue' of channel c.
+static inline float avifGainMapGetGain(const avifGainMapApplyContext * ctx, int c, float gainMapValue)
+{
+    // Undo gamma & affine transform; the result is in log2 space.
+    const float gainMapLog2 = lerp(ctx->gainMapMin[c], ctx->gainMapMax[c], powf(gainMapValue, ctx->gammaInv[c]));
+    return exp2f(gainMapLog2 * ctx->weight);
+}
+
+static void avifGainMapConvertJob(void * context, uint32_t jobIndex)
+{
+    avifGainMapApplyContext * ctx = (avifGainMapApplyContext *)context;
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, ctx->base.image->height);
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        for (uint32_t i = 0; i < ctx->base.image->width; ++i) {
+            float basePixelRGBA[4];
+            if (ctx->convertPixels) {
+                avifGainMapSourceGetLinear(&ctx->base, i, j, basePixelRGBA);
+                if (ctx->primariesDiffer) {
+                    avifLinearRGBConvertColorSpace(basePixelRGBA, ctx->conversionCoeffs);
+                }
+                avifTransferCurveApply(&ctx->linearToGamma, basePixelRGBA, 3);
+                for (int c = 0; c < 3; ++c) {
+                    basePixelRGBA[c] = AVIF_CLAMP(basePixelRGBA[c], 0.0f, 1.0f);
+                }
+            } else {
+                avifGetRGBAPixel(ctx->base.image, i, j, &ctx->base.info, basePixelRGBA);
+            }
+            avifSetRGBAPixel(ctx->toneMappedImage, i, j, ctx->toneMappedPixelRGBInfo, basePixelRGBA);
+        }
+    }
+}
+
+static void avifGainMapApplyJob(void * context, uint32_t jobIndex)
+{
+    avifGainMapApplyContext * ctx = (avifGainMapApplyContext *)context;
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, ctx->base.image->height);
+    const avifRGBImage * gainMap = ctx->gainMap;
+    const avifRGBColorSpaceInfo * gainMapRGBInfo = ctx->gainMapRGBInfo;
+    const uint32_t gainMapOffsets[3] = { gainMapRGBInfo->offsetBytesR, gainMapRGBInfo->offsetBytesG, gainMapRGBInfo->offsetBytesB };
+
+    float rgbMaxLinear = 0; // Max tone mapped pixel value across R, G and B channels.
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        const uint8_t * gainMapRow = &gainMap->pixels[(size_t)j * gainMap->rowBytes];
+        double rgbSumLinear = 0; // Sum of max(r, g, b) for mapped pixels of this row.
+        for (uint32_t i = 0; i < ctx->base.image->width; ++i) {
+            float basePixelRGBA[4];
+            avifGainMapSourceGetLinear(&ctx->base, i, j, basePixelRGBA);
+            float gains[3];
+            if (ctx->gainTables[0] != NULL) {
+                const uint8_t * gainMapPixel = &gainMapRow[i * gainMapRGBInfo->pixelBytes];
+                for (int c = 0; c < 3; ++c) {
+                    const uint32_t sample = (gainMapRGBInfo->channelBytes > 1) ? *((const uint16_t *)&gainMapPixel[gainMapOffsets[c]])
+                                                                               : gainMapPixel[gainMapOffsets[c]];
+                    gains[c] = ctx->gainTables[c][AVIF_MIN(sample, (uint32_t)gainMapRGBInfo->maxChannel)];
+                }
+            } else {
+                float gainMapRGBA[4];
+                avifGetRGBAPixel(gainMap, i, j, gainMapRGBInfo, gainMapRGBA);
+                for (int c = 0; c < 3; ++c) {
+                    gains[c] = avifGainMapGetGain(ctx, c, gainMapRGBA[c]);
+                }
+            }
+
+            // Apply gain map.
+            float toneMappedPixelRGBA[4];
+            float pixelRgbMaxLinear = 0.0f; //  = max(r, g, b) for this pixel
+
+            if (ctx->needsInputColorConversion) {
+                // Convert basePixelRGBA to gainMapMathPrimaries.
+                avifLinearRGBConvertColorSpace(basePixelRGBA, ctx->inputConversionCoeffs);
+            }
+
+            for (int c = 0; c < 3; ++c) {
+                const float toneMappedLinear = (basePixelRGBA[c] + ctx->baseOffset[c]) * gains[c] - ctx->alternateOffset[c];
+
+                if (toneMappedLinear > rgbMaxLinear) {
+                    rgbMaxLinear = toneMappedLinear;
+                }
+                if (toneMappedLinear > pixelRgbMaxLinear) {
+                    pixelRgbMaxLinear = toneMappedLinear;
+                }
+
+                toneMappedPixelRGBA[c] = toneMappedLinear;
+            }
+
+            if (ctx->needsOutputColorConversion) {
+                // Convert toneMappedPixelRGBA to outputColorPrimaries.
+                avifLinearRGBConvertColorSpace(toneMappedPixelRGBA, ctx->outputConversionCoeffs);
+            }
+
+            avifTransferCurveApply(&ctx->linearToGamma, toneMappedPixelRGBA, 3);
+            for (int c = 0; c < 3; ++c) {
+                toneMappedPixelRGBA[c] = AVIF_CLAMP(toneMappedPixelRGBA[c], 0.0f, 1.0f);
+            }
+
+            toneMappedPixelRGBA[3] = basePixelRGBA[3]; // Alpha is unaffected by tone mapping.
+            rgbSumLinear += pixelRgbMaxLinear;
+            avifSetRGBAPixel(ctx->toneMappedImage, i, j, ctx->toneMappedPixelRGBInfo, toneMappedPixelRGBA);
+        }
+        ctx->rowSumLinear[j] = rgbSumLinear;
+    }
+    ctx->rgbMaxLinear[jobIndex] = rgbMaxLinear;
+}
+
+// Splits the rows of the image into at most maxThreads bands (capped at 8, like avifImageYUVToRGB()). Sets
+// ctx->rowsPerJob and returns the number of bands.
+static uint32_t avifGainMapApplyJobCount(avifGainMapApplyContext * ctx, int maxThreads)
+{
+    const uint32_t height = ctx->base.image->height;
+    uint32_t jobs = AVIF_CLAMP(maxThreads, 1, 8);
+    jobs = AVIF_MIN(jobs, AVIF_MAX(height, 1));
+    ctx->rowsPerJob = (height + jobs - 1) / jobs;
+    return ctx->rowsPerJob ? (height + ctx->rowsPerJob - 1) / ctx->rowsPerJob : 1;
+}
+
+static avifBool avifGainMapRunJobs(avifGainMapApplyContext * ctx, uint32_t jobs, avifJobFunc func)
+{
+    if (jobs == 1) {
+        func(ctx, 0);
+        return AVIF_TRUE;
+    }
+    return avifRunJobs(jobs, jobs, func, ctx);
+}
+
 avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
                                     avifColorPrimaries baseColorPrimaries,
                                     avifTransferCharacteristics baseTransferCharacteristics,
@@ -99,6 +366,11 @@ avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
     avifRGBImage rgbGainMap;
     // Basic zero-initialization for now, avifRGBImageSetDefaults() is called later on.
     memset(&rgbGainMap, 0, sizeof(rgbGainMap));
+    float * gainTables = NULL;
+    float * bandMaxLinear = NULL;
+    double * rowSumLinear = NULL;
+    avifGainMapApplyContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
 
     avifResult res = AVIF_RESULT_OK;
     toneMappedImage->width = width;
@@ -120,58 +392,52 @@ avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
         goto cleanup;
     }
 
-    avifRGBColorSpaceInfo baseRGBInfo;
     avifRGBColorSpaceInfo toneMappedPixelRGBInfo;
-    if (!avifGetRGBColorSpaceInfo(baseImage, &baseRGBInfo) || !avifGetRGBColorSpaceInfo(toneMappedImage, &toneMappedPixelRGBInfo)) {
+    if (!avifGetRGBColorSpaceInfo(toneMappedImage, &toneMappedPixelRGBInfo)) {
         avifDiagnosticsPrintf(diag, "Unsupported RGB color space");
         res = AVIF_RESULT_NOT_IMPLEMENTED;
         goto cleanup;
     }
+    res = avifGainMapSourceInit(&ctx.base, baseImage, baseTransferCharacteristics, &ctx.linearTables);
+    if (res != AVIF_RESULT_OK) {
+        if (res == AVIF_RESULT_NOT_IMPLEMENTED) {
+            avifDiagnosticsPrintf(diag, "Unsupported RGB color space");
+        }
+        goto cleanup;
+    }
 
-    const avifTransferFunction gammaToLinear = avifTransferCharacteristicsGetGammaToLinearFunction(baseTransferCharacteristics);
-    const avifTransferFunction linearToGamma = avifTransferCharacteristicsGetLinearToGammaFunction(outputTransferCharacteristics);
+    ctx.toneMappedImage = toneMappedImage;
+    ctx.toneMappedPixelRGBInfo = &toneMappedPixelRGBInfo;
+    avifTransferCurveInitLinearToGamma(&ctx.linearToGamma, outputTransferCharacteristics);
+    // Rows are independent, every band writes its own rows of toneMappedImage.
+    const uint32_t jobs = avifGainMapApplyJobCount(&ctx, toneMappedImage->maxThreads);
 
     // Early exit if the gain map does not need to be applied.
     if (weight == 0.0f) {
-        const avifBool primariesDiffer = (baseColorPrimaries != outputColorPrimaries);
-        double conversionCoeffs[3][3];
-        if (primariesDiffer && !avifColorPrimariesComputeRGBToRGBMatrix(baseColorPrimaries, outputColorPrimaries, conversionCoeffs)) {
+        ctx.primariesDiffer = (baseColorPrimaries != outputColorPrimaries);
+        if (ctx.primariesDiffer && !avifColorPrimariesComputeRGBToRGBMatrix(baseColorPrimaries, outputColorPrimaries, ctx.conversionCoeffs)) {
             avifDiagnosticsPrintf(diag, "Unsupported RGB color space conversion");
             res = AVIF_RESULT_NOT_IMPLEMENTED;
             goto cleanup;
         }
         // Just convert from one rgb format to another.
-        for (uint32_t j = 0; j < height; ++j) {
-            for (uint32_t i = 0; i < width; ++i) {
-                float basePixelRGBA[4];
-                avifGetRGBAPixel(baseImage, i, j, &baseRGBInfo, basePixelRGBA);
-                if (outputTransferCharacteristics != baseTransferCharacteristics || primariesDiffer) {
-                    for (int c = 0; c < 3; ++c) {
-                        basePixelRGBA[c] = gammaToLinear(basePixelRGBA[c]);
-                    }
-                    if (primariesDiffer) {
-                        avifLinearRGBConvertColorSpace(basePixelRGBA, conversionCoeffs);
-                    }
-                    for (int c = 0; c < 3; ++c) {
-                        basePixelRGBA[c] = AVIF_CLAMP(linearToGamma(basePixelRGBA[c]), 0.0f, 1.0f);
-                    }
-                }
-                avifSetRGBAPixel(toneMappedImage, i, j, &toneMappedPixelRGBInfo, basePixelRGBA);
-            }
+        ctx.convertPixels = (outputTransferCharacteristics != baseTransferCharacteristics) || ctx.primariesDiffer;
+        if (!avifGainMapRunJobs(&ctx, jobs, avifGainMapConvertJob)) {
+            res = AVIF_RESULT_UNKNOWN_ERROR;
         }
         goto cleanup;
     }
 
-    double inputConversionCoeffs[3][3];
-    double outputConversionCoeffs[3][3];
+    ctx.needsInputColorConversion = needsInputColorConversion;
+    ctx.needsOutputColorConversion = needsOutputColorConversion;
     if (needsInputColorConversion &&
-        !avifColorPrimariesComputeRGBToRGBMatrix(baseColorPrimaries, gainMapMathPrimaries, inputConversionCoeffs)) {
+        !avifColorPrimariesComputeRGBToRGBMatrix(baseColorPrimaries, gainMapMathPrimaries, ctx.inputConversionCoeffs)) {
         avifDiagnosticsPrintf(diag, "Unsupported RGB color space conversion");
         res = AVIF_RESULT_NOT_IMPLEMENTED;
         goto cleanup;
     }
     if (needsOutputColorConversion &&
-        !avifColorPrimariesComputeRGBToRGBMatrix(gainMapMathPrimaries, outputColorPrimaries, outputConversionCoeffs)) {
+        !avifColorPrimariesComputeRGBToRGBMatrix(gainMapMathPrimaries, outputColorPrimaries, ctx.outputConversionCoeffs)) {
         avifDiagnosticsPrintf(diag, "Unsupported RGB color space conversion");
         res = AVIF_RESULT_NOT_IMPLEMENTED;
         goto cleanup;
@@ -192,6 +458,7 @@ avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
     const avifImage * const gainMapImage = (rescaledGainMap != NULL) ? rescaledGainMap : gainMap->image;
 
     avifRGBImageSetDefaults(&rgbGainMap, gainMapImage);
+    rgbGainMap.maxThreads = toneMappedImage->maxThreads;
     res = avifRGBImageAllocatePixels(&rgbGainMap);
     if (res != AVIF_RESULT_OK) {
         goto cleanup;
@@ -208,75 +475,57 @@ avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
         goto cleanup;
     }
 
-    float rgbMaxLinear = 0; // Max tone mapped pixel value across R, G and B channels.
-    float rgbSumLinear = 0; // Sum of max(r, g, b) for mapped pixels.
     // The gain map metadata contains the encoding gamma, and 1/gamma should be used for decoding.
-    const float gammaInv[3] = { 1.0f / avifUnsignedFractionToFloat(gainMap->gainMapGamma[0]),
-                                1.0f / avifUnsignedFractionToFloat(gainMap->gainMapGamma[1]),
-                                1.0f / avifUnsignedFractionToFloat(gainMap->gainMapGamma[2]) };
-    const float gainMapMin[3] = { avifSignedFractionToFloat(gainMap->gainMapMin[0]),
-                                  avifSignedFractionToFloat(gainMap->gainMapMin[1]),
-                                  avifSignedFractionToFloat(gainMap->gainMapMin[2]) };
-    const float gainMapMax[3] = { avifSignedFractionToFloat(gainMap->gainMapMax[0]),
-                                  avifSignedFractionToFloat(gainMap->gainMapMax[1]),
-                                  avifSignedFractionToFloat(gainMap->gainMapMax[2]) };
-    const float baseOffset[3] = { avifSignedFractionToFloat(gainMap->baseOffset[0]),
-                                  avifSignedFractionToFloat(gainMap->baseOffset[1]),
-                                  avifSignedFractionToFloat(gainMap->baseOffset[2]) };
-    const float alternateOffset[3] = { avifSignedFractionToFloat(gainMap->alternateOffset[0]),
-                                       avifSignedFractionToFloat(gainMap->alternateOffset[1]),
-                                       avifSignedFractionToFloat(gainMap->alternateOffset[2]) };
-    for (uint32_t j = 0; j < height; ++j) {
-        for (uint32_t i = 0; i < width; ++i) {
-            float basePixelRGBA[4];
-            avifGetRGBAPixel(baseImage, i, j, &baseRGBInfo, basePixelRGBA);
-            float gainMapRGBA[4];
-            avifGetRGBAPixel(&rgbGainMap, i, j, &gainMapRGBInfo, gainMapRGBA);
-
-            // Apply gain map.
-            float toneMappedPixelRGBA[4];
-            float pixelRgbMaxLinear = 0.0f; //  = max(r, g, b) for this pixel
-
-            for (int c = 0; c < 3; ++c) {
-                basePixelRGBA[c] = gammaToLinear(basePixelRGBA[c]);
-            }
-
-            if (needsInputColorConversion) {
-                // Convert basePixelRGBA to gainMapMathPrimaries.
-                avifLinearRGBConvertColorSpace(basePixelRGBA, inputConversionCoeffs);
-            }
-
-            for (int c = 0; c < 3; ++c) {
-                const float baseLinear = basePixelRGBA[c];
-                const float gainMapValue = gainMapRGBA[c];
-
-                // Undo gamma & affine transform; the result is in log2 space.
-                const float gainMapLog2 = lerp(gainMapMin[c], gainMapMax[c], powf(gainMapValue, gammaInv[c]));
-                const float toneMappedLinear = (baseLinear + baseOffset[c]) * exp2f(gainMapLog2 * weight) - alternateOffset[c];
-
-                if (toneMappedLinear > rgbMaxLinear) {
-                    rgbMaxLinear = toneMappedLinear;
-                }
-                if (toneMappedLinear > pixelRgbMaxLinear) {
-                    pixelRgbMaxLinear = toneMappedLinear;
-                }
-
-                toneMappedPixelRGBA[c] = toneMappedLinear;
-            }
-
-            if (needsOutputColorConversion) {
-                // Convert toneMappedPixelRGBA to outputColorPrimaries.
-                avifLinearRGBConvertColorSpace(toneMappedPixelRGBA, outputConversionCoeffs);
+    for (int c = 0; c < 3; ++c) {
+        ctx.gammaInv[c] = 1.0f / avifUnsignedFractionToFloat(gainMap->gainMapGamma[c]);
+        ctx.gainMapMin[c] = avifSignedFractionToFloat(gainMap->gainMapMin[c]);
+        ctx.gainMapMax[c] = avifSignedFractionToFloat(gainMap->gainMapMax[c]);
+        ctx.baseOffset[c] = avifSignedFractionToFloat(gainMap->baseOffset[c]);
+        ctx.alternateOffset[c] = avifSignedFractionToFloat(gainMap->alternateOffset[c]);
+    }
+    ctx.weight = weight;
+    ctx.gainMap = &rgbGainMap;
+    ctx.gainMapRGBInfo = &gainMapRGBInfo;
+
+    // avifRGBImageSetDefaults() gives an integer RGBA gain map, so every sample is one of maxChannel + 1 values.
+    if (rgbGainMap.depth <= GAIN_TABLE_MAX_DEPTH && !rgbGainMap.isFloat && rgbGainMap.format != AVIF_RGB_FORMAT_RGB_565) {
+        const uint32_t tableSize = (uint32_t)gainMapRGBInfo.maxChannel + 1;
+        gainTables = (float *)avifAlloc(sizeof(float) * 3 * tableSize);
+        if (gainTables == NULL) {
+            res = AVIF_RESULT_OUT_OF_MEMORY;
+            goto cleanup;
+        }
+        for (int c = 0; c < 3; ++c) {
+            float * table = &gainTables[c * tableSize];
+            for (uint32_t v = 0; v < tableSize; ++v) {
+                // Same normalization as avifGetRGBAPixel().
+                table[v] = avifGainMapGetGain(&ctx, c, v / gainMapRGBInfo.maxChannelF);
             }
+            ctx.gainTables[c] = table;
+        }
+    }
 
-            for (int c = 0; c < 3; ++c) {
-                toneMappedPixelRGBA[c] = AVIF_CLAMP(linearToGamma(toneMappedPixelRGBA[c]), 0.0f, 1.0f);
-            }
+    bandMaxLinear = (float *)avifAlloc(sizeof(float) * jobs);
+    rowSumLinear = (double *)avifAlloc(sizeof(double) * height);
+    if (bandMaxLinear == NULL || rowSumLinear == NULL) {
+        res = AVIF_RESULT_OUT_OF_MEMORY;
+        goto cleanup;
+    }
+    ctx.rgbMaxLinear = bandMaxLinear;
+    ctx.rowSumLinear = rowSumLinear;
+    if (!avifGainMapRunJobs(&ctx, jobs, avifGainMapApplyJob)) {
+        res = AVIF_RESULT_UNKNOWN_ERROR;
+        goto cleanup;
+    }
 
-            toneMappedPixelRGBA[3] = basePixelRGBA[3]; // Alpha is unaffected by tone mapping.
-            rgbSumLinear += pixelRgbMaxLinear;
-            avifSetRGBAPixel(toneMappedImage, i, j, &toneMappedPixelRGBInfo, toneMappedPixelRGBA);
-        }
+    float rgbMaxLinear = 0; // Max tone mapped pixel value across R, G and B channels.
+    for (uint32_t i = 0; i < jobs; ++i) {
+        rgbMaxLinear = AVIF_MAX(rgbMaxLinear, ctx.rgbMaxLinear[i]);
+    }
+    // Rows are summed in order whatever the number of bands, so the average is the same for any maxThreads.
+    double rgbSumLinear = 0; // Sum of max(r, g, b) for mapped pixels.
+    for (uint32_t j = 0; j < height; ++j) {
+        rgbSumLinear += ctx.rowSumLinear[j];
     }
     if (clli != NULL) {
         // For exact CLLI value definitions, see ISO/IEC 23008-2 section D.3.35
@@ -285,11 +534,15 @@ avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
 
         // Convert extended SDR (where 1.0 is SDR white) to nits.
         clli->maxCLL = (uint16_t)AVIF_CLAMP(avifRoundf(rgbMaxLinear * SDR_WHITE_NITS), 0.0f, (float)UINT16_MAX);
-        const float rgbAverageLinear = rgbSumLinear / (width * height);
+        const float rgbAverageLinear = (float)(rgbSumLinear / ((double)width * height));
         clli->maxPALL = (uint16_t)AVIF_CLAMP(avifRoundf(rgbAverageLinear * SDR_WHITE_NITS), 0.0f, (float)UINT16_MAX);
     }
 
 cleanup:
+    avifFree(bandMaxLinear);
+    avifFree(rowSumLinear);
+    avifFree(gainTables);
+    avifGammaToLinearTablesFree(&ctx.linearTables);
     avifRGBImageFreePixels(&rgbGainMap);
     if (rescaledGainMap != NULL) {
         avifImageDestroy(rescaledGainMap);
@@ -316,6 +569,7 @@ avifResult avifImageApplyGainMap(const avifImage * baseImage,
 
     avifRGBImage baseImageRgb;
     avifRGBImageSetDefaults(&baseImageRgb, baseImage);
+    baseImageRgb.maxThreads = toneMappedImage->maxThreads;
     AVIF_CHECKRES(avifRGBImageAllocatePixels(&baseImageRgb));
     avifResult res = avifImageYUVToRGB(baseImage, &baseImageRgb);
     if (res != AVIF_RESULT_OK) {
@@ -355,35 +609,27 @@ static float avifBucketIdxToValue(int idx, float bucketMin, float bucketMax, int
     return idx * (bucketMax - bucketMin) / numBuckets + bucketMin;
 }
 
-avifResult avifFindMinMaxWithoutOutliers(const float * gainMapF, int numPixels, float * rangeMin, float * rangeMax)
-{
-    const float bucketSize = 0.01f;        // Size of one bucket. Empirical value.
-    const float maxOutliersRatio = 0.001f; // 0.1%
-    const int maxOutliersOnEachSide = (int)avifRoundf(numPixels * maxOutliersRatio / 2.0f);
+#define GAIN_MAP_BUCKET_SIZE 0.01f         // Size of one bucket. Empirical value.
+#define GAIN_MAP_MAX_OUTLIERS_RATIO 0.001f // 0.1%
+#define GAIN_MAP_MAX_NUM_BUCKETS 10000
 
-    float min = gainMapF[0];
-    float max = gainMapF[0];
-    for (int i = 1; i < numPixels; ++i) {
-        min = AVIF_MIN(min, gainMapF[i]);
-        max = AVIF_MAX(max, gainMapF[i]);
+// Returns the number of histogram buckets avifFindMinMaxWithoutOutliers() uses for 'numPixels' values in [min, max], or 0
+// if no outliers need to be removed and [min, max] is the result.
+static int avifGainMapNumBuckets(float min, float max, int numPixels)
+{
+    const int maxOutliersOnEachSide = (int)avifRoundf(numPixels * GAIN_MAP_MAX_OUTLIERS_RATIO / 2.0f);
+    if ((max - min) <= (GAIN_MAP_BUCKET_SIZE * 2) || maxOutliersOnEachSide == 0) {
+        return 0;
     }
+    return AVIF_MIN((int)ceilf((max - min) / GAIN_MAP_BUCKET_SIZE), GAIN_MAP_MAX_NUM_BUCKETS);
+}
 
+// Narrows [min, max] down to the range without outliers, given the histogram of all the values.
+static void avifFindMinMaxFromHistogram(const int * histogram, int numBuckets, int numPixels, float min, float max, float * rangeMin, float * rangeMax)
+{
+    const int maxOutliersOnEachSide = (int)avifRoundf(numPixels * GAIN_MAP_MAX_OUTLIERS_RATIO / 2.0f);
     *rangeMin = min;
     *rangeMax = max;
-    if ((max - min) <= (bucketSize * 2) || maxOutliersOnEachSide == 0) {
-        return AVIF_RESULT_OK;
-    }
-
-    const int maxNumBuckets = 10000;
-    const int numBuckets = AVIF_MIN((int)ceilf((max - min) / bucketSize), maxNumBuckets);
-    int * histogram = avifAlloc(sizeof(int) * numBuckets);
-    if (histogram == NULL) {
-        return AVIF_RESULT_OUT_OF_MEMORY;
-    }
-    memset(histogram, 0, sizeof(int) * numBuckets);
-    for (int i = 0; i < numPixels; ++i) {
-        ++(histogram[avifValueToBucketIdx(gainMapF[i], min, max, numBuckets)]);
-    }
 
     int leftOutliers = 0;
     for (int i = 0; i < numBuckets; ++i) {
@@ -407,6 +653,33 @@ avifResult avifFindMinMaxWithoutOutliers(const float * gainMapF, int numPixels,
             *rangeMax = avifBucketIdxToValue(i, min, max, numBuckets);
         }
     }
+}
+
+avifResult avifFindMinMaxWithoutOutliers(const float * gainMapF, int numPixels, float * rangeMin, float * rangeMax)
+{
+    float min = gainMapF[0];
+    float max = gainMapF[0];
+    for (int i = 1; i < numPixels; ++i) {
+        min = AVIF_MIN(min, gainMapF[i]);
+        max = AVIF_MAX(max, gainMapF[i]);
+    }
+
+    *rangeMin = min;
+    *rangeMax = max;
+    const int numBuckets = avifGainMapNumBuckets(min, max, numPixels);
+    if (numBuckets == 0) {
+        return AVIF_RESULT_OK;
+    }
+
+    int * histogram = avifAlloc(sizeof(int) * numBuckets);
+    if (histogram == NULL) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    memset(histogram, 0, sizeof(int) * numBuckets);
+    for (int i = 0; i < numPixels; ++i) {
+        ++(histogram[avifValueToBucketIdx(gainMapF[i], min, max, numBuckets)]);
+    }
+    avifFindMinMaxFromHistogram(histogram, numBuckets, numPixels, min, max, rangeMin, rangeMax);
 
     avifFree(histogram);
     return AVIF_RESULT_OK;
@@ -488,6 +761,152 @@ static avifResult avifChooseColorSpaceForGainMapMath(avifColorPrimaries basePrim
     return AVIF_RESULT_OK;
 }
 
+// Computes the log2 ratios of the alternate over the base pixel at (x, y), and the base and alternate values they come
+// from (grayscale values for single channel gain maps).
+static inline void avifGainMapComputeLog2Ratios(const avifGainMapComputeContext * ctx, uint32_t x, uint32_t y, float ratiosLog2[3], float base[3], float alt[3])
+{
+    float baseRGBA[4];
+    avifGainMapSourceGetLinear(&ctx->base, x, y, baseRGBA);
+    float altRGBA[4];
+    avifGainMapSourceGetLinear(&ctx->alt, x, y, altRGBA);
+
+    if (ctx->colorSpacesDiffer) {
+        if (ctx->useBaseColorSpace) {
+            // convert altRGBA to baseRGBA's color space
+            avifLinearRGBConvertColorSpace(altRGBA, (double(*)[3])ctx->rgbConversionCoeffs);
+        } else {
+            // convert baseRGBA to altRGBA's color space
+            avifLinearRGBConvertColorSpace(baseRGBA, (double(*)[3])ctx->rgbConversionCoeffs);
+        }
+    }
+
+    for (int c = 0; c < ctx->numGainMapChannels; ++c) {
+        base[c] = baseRGBA[c];
+        alt[c] = altRGBA[c];
+        if (ctx->singleChannel) {
+            // Convert to grayscale.
+            base[c] = ctx->yCoeffs[0] * baseRGBA[0] + ctx->yCoeffs[1] * baseRGBA[1] + ctx->yCoeffs[2] * baseRGBA[2];
+            alt[c] = ctx->yCoeffs[0] * altRGBA[0] + ctx->yCoeffs[1] * altRGBA[1] + ctx->yCoeffs[2] * altRGBA[2];
+        }
+        const float ratio = (alt[c] + ctx->alternateOffset[c]) / (base[c] + ctx->baseOffset[c]);
+        ratiosLog2[c] = log2f(AVIF_MAX(ratio, kEpsilon));
+    }
+}
+
+// Finds the minimum of each channel of the image that gets color converted, to offset negative values.
+static void avifGainMapChannelMinJob(void * context, uint32_t jobIndex)
+{
+    avifGainMapComputeContext * ctx = (avifGainMapComputeContext *)context;
+    avifGainMapComputeBand * band = &ctx->bands[jobIndex];
+    const avifGainMapSource * source = ctx->useBaseColorSpace ? &ctx->alt : &ctx->base;
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, ctx->height);
+    for (int c = 0; c < 3; ++c) {
+        band->channelMin[c] = 0.0f;
+    }
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        for (uint32_t i = 0; i < ctx->width; ++i) {
+            float rgba[4];
+            avifGainMapSourceGetLinear(source, i, j, rgba);
+            avifLinearRGBConvertColorSpace(rgba, ctx->rgbConversionCoeffs);
+            for (int c = 0; c < 3; ++c) {
+                band->channelMin[c] = AVIF_MIN(band->channelMin[c], rgba[c]);
+            }
+        }
+    }
+}
+
+// Finds the range of the log2 ratios and the headrooms of both images.
+static void avifGainMapRangeJob(void * context, uint32_t jobIndex)
+{
+    avifGainMapComputeContext * ctx = (avifGainMapComputeContext *)context;
+    avifGainMapComputeBand * band = &ctx->bands[jobIndex];
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, ctx->height);
+    band->baseMax = 1.0f;
+    band->altMax = 1.0f;
+    for (int c = 0; c < 3; ++c) {
+        band->log2RatioMin[c] = FLT_MAX;
+        band->log2RatioMax[c] = -FLT_MAX;
+    }
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        for (uint32_t i = 0; i < ctx->width; ++i) {
+            float ratiosLog2[3], base[3], alt[3];
+            avifGainMapComputeLog2Ratios(ctx, i, j, ratiosLog2, base, alt);
+            for (int c = 0; c < ctx->numGainMapChannels; ++c) {
+                band->baseMax = AVIF_MAX(band->baseMax, base[c]);
+                band->altMax = AVIF_MAX(band->altMax, alt[c]);
+                band->log2RatioMin[c] = AVIF_MIN(band->log2RatioMin[c], ratiosLog2[c]);
+                band->log2RatioMax[c] = AVIF_MAX(band->log2RatioMax[c], ratiosLog2[c]);
+            }
+        }
+    }
+}
+
+// Builds the histograms of the band, for the channels that have outliers to remove.
+static void avifGainMapHistogramJob(void * context, uint32_t jobIndex)
+{
+    avifGainMapComputeContext * ctx = (avifGainMapComputeContext *)context;
+    avifGainMapComputeBand * band = &ctx->bands[jobIndex];
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, ctx->height);
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        for (uint32_t i = 0; i < ctx->width; ++i) {
+            float ratiosLog2[3], base[3], alt[3];
+            avifGainMapComputeLog2Ratios(ctx, i, j, ratiosLog2, base, alt);
+            for (int c = 0; c < ctx->numGainMapChannels; ++c) {
+                if (band->histograms[c] != NULL) {
+                    const float v = ratiosLog2[c] * ctx->sign;
+                    ++(band->histograms[c][avifValueToBucketIdx(v, ctx->histogramMin[c], ctx->histogramMax[c], ctx->numBuckets[c])]);
+                }
+            }
+        }
+    }
+}
+
+// Maps the log2 ratios of the band to [0, 1] and stores them in the RGB gain map.
+static void avifGainMapWriteJob(void * context, uint32_t jobIndex)
+{
+    avifGainMapComputeContext * ctx = (avifGainMapComputeContext *)context;
+    const uint32_t startRow = jobIndex * ctx->rowsPerJob;
+    const uint32_t endRow = AVIF_MIN(startRow + ctx->rowsPerJob, ctx->height);
+    for (uint32_t j = startRow; j < endRow; ++j) {
+        for (uint32_t i = 0; i < ctx->width; ++i) {
+            float ratiosLog2[3], base[3], alt[3];
+            avifGainMapComputeLog2Ratios(ctx, i, j, ratiosLog2, base, alt);
+            float rgbaPixel[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            for (int c = 0; c < ctx->numGainMapChannels; ++c) {
+                const float range = AVIF_MAX(ctx->gainMapMaxLog2[c] - ctx->gainMapMinLog2[c], 0.0f);
+                if (range == 0.0f) {
+                    // If the range is 0, the gain map values will be multiplied by zero when tonemapping so the values
+                    // don't matter, but we still need to make sure that they are in [0,1].
+                    rgbaPixel[c] = 0.0f;
+                } else {
+                    // Remap [min; max] range to [0; 1]
+                    float v = ratiosLog2[c] * ctx->sign;
+                    v = AVIF_CLAMP(v, ctx->gainMapMinLog2[c], ctx->gainMapMaxLog2[c]);
+                    v = powf((v - ctx->gainMapMinLog2[c]) / range, ctx->gainMapGamma[c]);
+                    rgbaPixel[c] = AVIF_CLAMP(v, 0.0f, 1.0f);
+                }
+            }
+            if (ctx->singleChannel) {
+                rgbaPixel[1] = rgbaPixel[0];
+                rgbaPixel[2] = rgbaPixel[0];
+            }
+            avifSetRGBAPixel(ctx->gainMapRGB, i, j, ctx->gainMapRGBInfo, rgbaPixel);
+        }
+    }
+}
+
+static avifBool avifGainMapComputeRunJobs(avifGainMapComputeContext * ctx, uint32_t jobs, avifJobFunc func)
+{
+    if (jobs == 1) {
+        func(ctx, 0);
+        return AVIF_TRUE;
+    }
+    return avifRunJobs(jobs, jobs, func, ctx);
+}
+
 avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
                                       avifColorPrimaries baseColorPrimaries,
                                       avifTransferCharacteristics baseTransferCharacteristics,
@@ -515,14 +934,9 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
     const int width = baseRgbImage->width;
     const int height = baseRgbImage->height;
 
-    avifRGBColorSpaceInfo baseRGBInfo;
-    avifRGBColorSpaceInfo altRGBInfo;
-    if (!avifGetRGBColorSpaceInfo(baseRgbImage, &baseRGBInfo) || !avifGetRGBColorSpaceInfo(altRgbImage, &altRGBInfo)) {
-        avifDiagnosticsPrintf(diag, "Unsupported RGB color space");
-        return AVIF_RESULT_NOT_IMPLEMENTED;
-    }
-
-    float * gainMapF[3] = { 0 }; // Temporary buffers for the gain map as floating point values, one per RGB channel.
+    avifGainMapComputeContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    uint32_t jobs = 1;
     avifRGBImage gainMapRGB;
     memset(&gainMapRGB, 0, sizeof(gainMapRGB));
     avifImage * gainMapImage = gainMap->image;
@@ -530,34 +944,51 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
     avifResult res = AVIF_RESULT_OK;
     // --- After this point, the function should exit with 'goto cleanup' to free allocated resources.
 
-    const avifBool singleChannel = (gainMap->image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400);
-    const int numGainMapChannels = singleChannel ? 1 : 3;
-    for (int c = 0; c < numGainMapChannels; ++c) {
-        gainMapF[c] = avifAlloc(width * height * sizeof(float));
-        if (gainMapF[c] == NULL) {
-            res = AVIF_RESULT_OUT_OF_MEMORY;
-            goto cleanup;
+    // base and alt share one table when they have the same transfer characteristics and depth.
+    res = avifGainMapSourceInit(&ctx.base, baseRgbImage, baseTransferCharacteristics, &ctx.linearTables);
+    if (res == AVIF_RESULT_OK) {
+        res = avifGainMapSourceInit(&ctx.alt, altRgbImage, altTransferCharacteristics, &ctx.linearTables);
+    }
+    if (res != AVIF_RESULT_OK) {
+        if (res == AVIF_RESULT_NOT_IMPLEMENTED) {
+            avifDiagnosticsPrintf(diag, "Unsupported RGB color space");
         }
+        goto cleanup;
+    }
+
+    // Bands of rows are independent, like in avifImageYUVToRGB().
+    jobs = AVIF_CLAMP(baseRgbImage->maxThreads, 1, 8);
+    jobs = AVIF_MIN(jobs, (uint32_t)AVIF_MAX(height, 1));
+    ctx.rowsPerJob = (height + jobs - 1) / jobs;
+    jobs = ctx.rowsPerJob ? (height + ctx.rowsPerJob - 1) / ctx.rowsPerJob : 1;
+    ctx.bands = (avifGainMapComputeBand *)avifAlloc(sizeof(avifGainMapComputeBand) * jobs);
+    if (ctx.bands == NULL) {
+        res = AVIF_RESULT_OUT_OF_MEMORY;
+        goto cleanup;
     }
+    memset(ctx.bands, 0, sizeof(avifGainMapComputeBand) * jobs);
+
+    ctx.width = width;
+    ctx.height = height;
+    ctx.colorSpacesDiffer = colorSpacesDiffer;
+    ctx.singleChannel = (gainMap->image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400);
+    ctx.numGainMapChannels = ctx.singleChannel ? 1 : 3;
 
     avifGainMapSetDefaults(gainMap);
     gainMap->useBaseColorSpace = (gainMapMathPrimaries == baseColorPrimaries);
+    ctx.useBaseColorSpace = gainMap->useBaseColorSpace;
 
-    float (*baseGammaToLinear)(float) = avifTransferCharacteristicsGetGammaToLinearFunction(baseTransferCharacteristics);
-    float (*altGammaToLinear)(float) = avifTransferCharacteristicsGetGammaToLinearFunction(altTransferCharacteristics);
-    float yCoeffs[3];
-    avifColorPrimariesComputeYCoeffs(gainMapMathPrimaries, yCoeffs);
+    avifColorPrimariesComputeYCoeffs(gainMapMathPrimaries, ctx.yCoeffs);
 
-    double rgbConversionCoeffs[3][3];
     if (colorSpacesDiffer) {
         if (gainMap->useBaseColorSpace) {
-            if (!avifColorPrimariesComputeRGBToRGBMatrix(altColorPrimaries, baseColorPrimaries, rgbConversionCoeffs)) {
+            if (!avifColorPrimariesComputeRGBToRGBMatrix(altColorPrimaries, baseColorPrimaries, ctx.rgbConversionCoeffs)) {
                 avifDiagnosticsPrintf(diag, "Unsupported RGB color space conversion");
                 res = AVIF_RESULT_NOT_IMPLEMENTED;
                 goto cleanup;
             }
         } else {
-            if (!avifColorPrimariesComputeRGBToRGBMatrix(baseColorPrimaries, altColorPrimaries, rgbConversionCoeffs)) {
+            if (!avifColorPrimariesComputeRGBToRGBMatrix(baseColorPrimaries, altColorPrimaries, ctx.rgbConversionCoeffs)) {
                 avifDiagnosticsPrintf(diag, "Unsupported RGB color space conversion");
                 res = AVIF_RESULT_NOT_IMPLEMENTED;
                 goto cleanup;
@@ -565,40 +996,23 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
         }
     }
 
-    float baseOffset[3] = { avifSignedFractionToFloat(gainMap->baseOffset[0]),
-                            avifSignedFractionToFloat(gainMap->baseOffset[1]),
-                            avifSignedFractionToFloat(gainMap->baseOffset[2]) };
-    float alternateOffset[3] = { avifSignedFractionToFloat(gainMap->alternateOffset[0]),
-                                 avifSignedFractionToFloat(gainMap->alternateOffset[1]),
-                                 avifSignedFractionToFloat(gainMap->alternateOffset[2]) };
+    for (int c = 0; c < 3; ++c) {
+        ctx.baseOffset[c] = avifSignedFractionToFloat(gainMap->baseOffset[c]);
+        ctx.alternateOffset[c] = avifSignedFractionToFloat(gainMap->alternateOffset[c]);
+    }
 
     // If we are converting from one colorspace to another, some RGB values may be negative and an offset must be added to
     // avoid clamping (although the choice of color space to do the gain map computation with
     // avifChooseColorSpaceForGainMapMath() should mostly avoid this).
     if (colorSpacesDiffer) {
-        // Color convert pure red, pure green and pure blue in turn and see if they result in negative values.
-        float rgba[4] = { 0.0f };
+        if (!avifGainMapComputeRunJobs(&ctx, jobs, avifGainMapChannelMinJob)) {
+            res = AVIF_RESULT_UNKNOWN_ERROR;
+            goto cleanup;
+        }
         float channelMin[3] = { 0.0f };
-        for (int j = 0; j < height; ++j) {
-            for (int i = 0; i < width; ++i) {
-                avifGetRGBAPixel(gainMap->useBaseColorSpace ? altRgbImage : baseRgbImage,
-                                 i,
-                                 j,
-                                 gainMap->useBaseColorSpace ? &altRGBInfo : &baseRGBInfo,
-                                 rgba);
-
-                // Convert to linear.
-                for (int c = 0; c < 3; ++c) {
-                    if (gainMap->useBaseColorSpace) {
-                        rgba[c] = altGammaToLinear(rgba[c]);
-                    } else {
-                        rgba[c] = baseGammaToLinear(rgba[c]);
-                    }
-                }
-                avifLinearRGBConvertColorSpace(rgba, rgbConversionCoeffs);
-                for (int c = 0; c < 3; ++c) {
-                    channelMin[c] = AVIF_MIN(channelMin[c], rgba[c]);
-                }
+        for (uint32_t i = 0; i < jobs; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                channelMin[c] = AVIF_MIN(channelMin[c], ctx.bands[i].channelMin[c]);
             }
         }
 
@@ -609,58 +1023,29 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
             if (channelMin[c] < -kEpsilon) {
                 // Increase the offset to avoid negative values.
                 if (gainMap->useBaseColorSpace) {
-                    alternateOffset[c] = AVIF_MIN(alternateOffset[c] - channelMin[c], maxOffset);
+                    ctx.alternateOffset[c] = AVIF_MIN(ctx.alternateOffset[c] - channelMin[c], maxOffset);
                 } else {
-                    baseOffset[c] = AVIF_MIN(baseOffset[c] - channelMin[c], maxOffset);
+                    ctx.baseOffset[c] = AVIF_MIN(ctx.baseOffset[c] - channelMin[c], maxOffset);
                 }
             }
         }
     }
 
-    // Compute raw gain map values.
+    // Compute the range of the raw gain map values.
+    if (!avifGainMapComputeRunJobs(&ctx, jobs, avifGainMapRangeJob)) {
+        res = AVIF_RESULT_UNKNOWN_ERROR;
+        goto cleanup;
+    }
     float baseMax = 1.0f;
     float altMax = 1.0f;
-    for (int j = 0; j < height; ++j) {
-        for (int i = 0; i < width; ++i) {
-            float baseRGBA[4];
-            avifGetRGBAPixel(baseRgbImage, i, j, &baseRGBInfo, baseRGBA);
-            float altRGBA[4];
-            avifGetRGBAPixel(altRgbImage, i, j, &altRGBInfo, altRGBA);
-
-            // Convert to linear.
-            for (int c = 0; c < 3; ++c) {
-                baseRGBA[c] = baseGammaToLinear(baseRGBA[c]);
-                altRGBA[c] = altGammaToLinear(altRGBA[c]);
-            }
-
-            if (colorSpacesDiffer) {
-                if (gainMap->useBaseColorSpace) {
-                    // convert altRGBA to baseRGBA's color space
-                    avifLinearRGBConvertColorSpace(altRGBA, rgbConversionCoeffs);
-                } else {
-                    // convert baseRGBA to altRGBA's color space
-                    avifLinearRGBConvertColorSpace(baseRGBA, rgbConversionCoeffs);
-                }
-            }
-
-            for (int c = 0; c < numGainMapChannels; ++c) {
-                float base = baseRGBA[c];
-                float alt = altRGBA[c];
-                if (singleChannel) {
-                    // Convert to grayscale.
-                    base = yCoeffs[0] * baseRGBA[0] + yCoeffs[1] * baseRGBA[1] + yCoeffs[2] * baseRGBA[2];
-                    alt = yCoeffs[0] * altRGBA[0] + yCoeffs[1] * altRGBA[1] + yCoeffs[2] * altRGBA[2];
-                }
-                if (base > baseMax) {
-                    baseMax = base;
-                }
-                if (alt > altMax) {
-                    altMax = alt;
-                }
-                const float ratio = (alt + alternateOffset[c]) / (base + baseOffset[c]);
-                const float ratioLog2 = log2f(AVIF_MAX(ratio, kEpsilon));
-                gainMapF[c][j * width + i] = ratioLog2;
-            }
+    float log2RatioMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float log2RatioMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (uint32_t i = 0; i < jobs; ++i) {
+        baseMax = AVIF_MAX(baseMax, ctx.bands[i].baseMax);
+        altMax = AVIF_MAX(altMax, ctx.bands[i].altMax);
+        for (int c = 0; c < ctx.numGainMapChannels; ++c) {
+            log2RatioMin[c] = AVIF_MIN(log2RatioMin[c], ctx.bands[i].log2RatioMin[c]);
+            log2RatioMax[c] = AVIF_MAX(log2RatioMax[c], ctx.bands[i].log2RatioMax[c]);
         }
     }
 
@@ -676,61 +1061,66 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
     // Multiply the gainmap by sign(alternateHdrHeadroom - baseHdrHeadroom), to
     // ensure that it stores the log-ratio of the HDR representation to the SDR
     // representation.
-    if (alternateHeadroom < baseHeadroom) {
-        for (int c = 0; c < numGainMapChannels; ++c) {
-            for (int j = 0; j < height; ++j) {
-                for (int i = 0; i < width; ++i) {
-                    gainMapF[c][j * width + i] *= -1.f;
-                }
+    ctx.sign = (alternateHeadroom < baseHeadroom) ? -1.0f : 1.0f;
+
+    // Find approximate min/max for each channel, discarding outliers. See avifFindMinMaxWithoutOutliers(), the
+    // histograms of the bands are added up instead of bucketing a buffer of the whole gain map.
+    avifBool needsHistograms = AVIF_FALSE;
+    for (int c = 0; c < ctx.numGainMapChannels; ++c) {
+        ctx.histogramMin[c] = (ctx.sign < 0.0f) ? -log2RatioMax[c] : log2RatioMin[c];
+        ctx.histogramMax[c] = (ctx.sign < 0.0f) ? -log2RatioMin[c] : log2RatioMax[c];
+        ctx.gainMapMinLog2[c] = ctx.histogramMin[c];
+        ctx.gainMapMaxLog2[c] = ctx.histogramMax[c];
+        ctx.numBuckets[c] = avifGainMapNumBuckets(ctx.histogramMin[c], ctx.histogramMax[c], width * height);
+        if (ctx.numBuckets[c] == 0) {
+            continue;
+        }
+        needsHistograms = AVIF_TRUE;
+        for (uint32_t i = 0; i < jobs; ++i) {
+            ctx.bands[i].histograms[c] = (int *)avifAlloc(sizeof(int) * ctx.numBuckets[c]);
+            if (ctx.bands[i].histograms[c] == NULL) {
+                res = AVIF_RESULT_OUT_OF_MEMORY;
+                goto cleanup;
             }
+            memset(ctx.bands[i].histograms[c], 0, sizeof(int) * ctx.numBuckets[c]);
         }
     }
-
-    // Find approximate min/max for each channel, discarding outliers.
-    float gainMapMinLog2[3] = { 0.0f, 0.0f, 0.0f };
-    float gainMapMaxLog2[3] = { 0.0f, 0.0f, 0.0f };
-    for (int c = 0; c < numGainMapChannels; ++c) {
-        res = avifFindMinMaxWithoutOutliers(gainMapF[c], width * height, &gainMapMinLog2[c], &gainMapMaxLog2[c]);
-        if (res != AVIF_RESULT_OK) {
+    if (needsHistograms) {
+        if (!avifGainMapComputeRunJobs(&ctx, jobs, avifGainMapHistogramJob)) {
+            res = AVIF_RESULT_UNKNOWN_ERROR;
             goto cleanup;
         }
+        for (int c = 0; c < ctx.numGainMapChannels; ++c) {
+            if (ctx.numBuckets[c] == 0) {
+                continue;
+            }
+            // Merge into the histogram of the first band.
+            int * histogram = ctx.bands[0].histograms[c];
+            for (uint32_t i = 1; i < jobs; ++i) {
+                for (int b = 0; b < ctx.numBuckets[c]; ++b) {
+                    histogram[b] += ctx.bands[i].histograms[c][b];
+                }
+            }
+            avifFindMinMaxFromHistogram(histogram,
+                                        ctx.numBuckets[c],
+                                        width * height,
+                                        ctx.histogramMin[c],
+                                        ctx.histogramMax[c],
+                                        &ctx.gainMapMinLog2[c],
+                                        &ctx.gainMapMaxLog2[c]);
+        }
     }
 
     // Populate the gain map metadata's min and max values.
     for (int c = 0; c < 3; ++c) {
-        if (!avifDoubleToSignedFraction(gainMapMinLog2[singleChannel ? 0 : c], &gainMap->gainMapMin[c]) ||
-            !avifDoubleToSignedFraction(gainMapMaxLog2[singleChannel ? 0 : c], &gainMap->gainMapMax[c]) ||
-            !avifDoubleToSignedFraction(alternateOffset[c], &gainMap->alternateOffset[c]) ||
-            !avifDoubleToSignedFraction(baseOffset[c], &gainMap->baseOffset[c])) {
+        if (!avifDoubleToSignedFraction(ctx.gainMapMinLog2[ctx.singleChannel ? 0 : c], &gainMap->gainMapMin[c]) ||
+            !avifDoubleToSignedFraction(ctx.gainMapMaxLog2[ctx.singleChannel ? 0 : c], &gainMap->gainMapMax[c]) ||
+            !avifDoubleToSignedFraction(ctx.alternateOffset[c], &gainMap->alternateOffset[c]) ||
+            !avifDoubleToSignedFraction(ctx.baseOffset[c], &gainMap->baseOffset[c])) {
             res = AVIF_RESULT_INVALID_ARGUMENT;
             goto cleanup;
         }
-    }
-
-    // Scale the gain map values to map [min, max] range to [0, 1].
-    for (int c = 0; c < numGainMapChannels; ++c) {
-        const float range = AVIF_MAX(gainMapMaxLog2[c] - gainMapMinLog2[c], 0.0f);
-
-        if (range == 0.0f) {
-            for (int j = 0; j < height; ++j) {
-                for (int i = 0; i < width; ++i) {
-                    // If the range is 0, the gain map values will be multiplied by zero when tonemapping so the values
-                    // don't matter, but we still need to make sure that gainMapF is in [0,1].
-                    gainMapF[c][j * width + i] = 0.0f;
-                }
-            }
-        } else {
-            // Remap [min; max] range to [0; 1]
-            const float gainMapGamma = avifUnsignedFractionToFloat(gainMap->gainMapGamma[c]);
-            for (int j = 0; j < height; ++j) {
-                for (int i = 0; i < width; ++i) {
-                    float v = gainMapF[c][j * width + i];
-                    v = AVIF_CLAMP(v, gainMapMinLog2[c], gainMapMaxLog2[c]);
-                    v = powf((v - gainMapMinLog2[c]) / range, gainMapGamma);
-                    gainMapF[c][j * width + i] = AVIF_CLAMP(v, 0.0f, 1.0f);
-                }
-            }
-        }
+        ctx.gainMapGamma[c] = avifUnsignedFractionToFloat(gainMap->gainMapGamma[c]);
     }
 
     // Convert the gain map to YUV.
@@ -754,17 +1144,15 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
     avifRGBColorSpaceInfo gainMapRGBInfo;
     if (!avifGetRGBColorSpaceInfo(&gainMapRGB, &gainMapRGBInfo)) {
         avifDiagnosticsPrintf(diag, "Unsupported RGB color space");
-        return AVIF_RESULT_NOT_IMPLEMENTED;
+        res = AVIF_RESULT_NOT_IMPLEMENTED;
+        goto cleanup;
     }
-    for (int j = 0; j < height; ++j) {
-        for (int i = 0; i < width; ++i) {
-            const int offset = j * width + i;
-            const float r = gainMapF[0][offset];
-            const float g = singleChannel ? r : gainMapF[1][offset];
-            const float b = singleChannel ? r : gainMapF[2][offset];
-            const float rgbaPixel[4] = { r, g, b, 1.0f };
-            avifSetRGBAPixel(&gainMapRGB, i, j, &gainMapRGBInfo, rgbaPixel);
-        }
+    ctx.gainMapRGB = &gainMapRGB;
+    ctx.gainMapRGBInfo = &gainMapRGBInfo;
+    // Scale the gain map values to map [min, max] range to [0, 1].
+    if (!avifGainMapComputeRunJobs(&ctx, jobs, avifGainMapWriteJob)) {
+        res = AVIF_RESULT_UNKNOWN_ERROR;
+        goto cleanup;
     }
 
     res = avifImageRGBToYUV(gainMapImage, &gainMapRGB);
@@ -775,13 +1163,19 @@ avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
     // Scale down the gain map if requested.
     // Another way would be to scale the source images, but it seems to perform worse.
     if (requestedWidth != gainMapImage->width || requestedHeight != gainMapImage->height) {
-        AVIF_CHECKRES(avifImageScale(gainMap->image, requestedWidth, requestedHeight, diag));
+        res = avifImageScale(gainMap->image, requestedWidth, requestedHeight, diag);
     }
 
 cleanup:
-    for (int c = 0; c < 3; ++c) {
-        avifFree(gainMapF[c]);
+    if (ctx.bands != NULL) {
+        for (uint32_t i = 0; i < jobs; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                avifFree(ctx.bands[i].histograms[c]);
+            }
+        }
+        avifFree(ctx.bands);
     }
+    avifGammaToLinearTablesFree(&ctx.linearTables);
     avifRGBImageFreePixels(&gainMapRGB);
     if (res != AVIF_RESULT_OK) {
         avifImageFreePlanes(gainMapImage, AVIF_PLANES_ALL);
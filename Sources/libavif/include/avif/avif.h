@@ -1014,9 +1014,9 @@ typedef struct avifRGBImage
                           // the alpha bits as if they were all 1.
     avifBool alphaPremultiplied; // indicates if RGB value is pre-multiplied by alpha. Default: false
     avifBool isFloat; // indicates if RGBA values are in half float (f16) format. Valid only when depth == 16. Default: false
-    int maxThreads; // Number of threads to be used for the YUV to RGB conversion. Note that this value is ignored for RGB to YUV
-                    // conversion. Setting this to zero has the same effect as setting it to one. Negative values are invalid.
-                    // Default: 1.
+    int maxThreads; // Number of threads to be used for the YUV to RGB and RGB to YUV conversions and for alpha premultiplication
+                    // and unpremultiplication. The output does not depend on it. Setting this to zero has the same effect as
+                    // setting it to one. Negative values are invalid. Default: 1.
 
     uint8_t * pixels;
     uint32_t rowBytes;
@@ -1132,6 +1132,20 @@ typedef struct avifIO
 AVIF_API avifIO * avifIOCreateMemoryReader(const uint8_t * data, size_t size);
 // Returns NULL if the file cannot be opened or if the reader cannot be allocated.
 AVIF_API avifIO * avifIOCreateFileReader(const char * filename);
+
+typedef enum avifIOAccessPattern
+{
+    // Only the pages touched by reads are loaded, e.g. when only the header is parsed.
+    AVIF_IO_ACCESS_PATTERN_RANDOM = 0,
+    // Aggressive read-ahead, e.g. when all the frames of a sequence are decoded in order.
+    AVIF_IO_ACCESS_PATTERN_SEQUENTIAL = 1
+} avifIOAccessPattern;
+
+// Maps the file into memory instead of copying it: the reader is persistent and returns pointers into the mapping.
+// Returns NULL if the file cannot be opened or mapped (for example if it is empty), if the reader cannot be allocated,
+// or if memory mapping is not supported on this platform; avifIOCreateFileReader() can be used as a fallback.
+// The file must not be truncated while the reader exists.
+AVIF_API avifIO * avifIOCreateMappedFileReader(const char * filename, avifIOAccessPattern accessPattern);
 AVIF_API void avifIODestroy(avifIO * io);
 
 // ---------------------------------------------------------------------------
@@ -1260,6 +1274,8 @@ typedef struct avifDecoder
     avifCodecChoice codecChoice;
 
     // Defaults to 1. If < 2, multithreading is disabled. See also 'Understanding maxThreads' above.
+    // For grid images, the tiles are decoded in parallel and the threads are split between the tiles
+    // and the AV1 decoder instances, each tile then getting its own decoder instance.
     int maxThreads;
 
     // AVIF files can have multiple sets of images in them. This specifies which to decode.
@@ -1423,6 +1439,7 @@ AVIF_API avifResult avifDecoderSetSource(avifDecoder * decoder, avifDecoderSourc
 // avifDecoderDestroy(decoder) has no effects on 'io'.
 AVIF_API void avifDecoderSetIO(avifDecoder * decoder, avifIO * io);
 AVIF_API avifResult avifDecoderSetIOMemory(avifDecoder * decoder, const uint8_t * data, size_t size);
+// Memory maps the file with AVIF_IO_ACCESS_PATTERN_RANDOM when possible, and reads it with stdio otherwise.
 AVIF_API avifResult avifDecoderSetIOFile(avifDecoder * decoder, const char * filename);
 AVIF_API avifResult avifDecoderParse(avifDecoder * decoder);
 AVIF_API avifResult avifDecoderNextImage(avifDecoder * decoder);
@@ -1652,6 +1669,23 @@ AVIF_API avifResult avifEncoderAddImageGrid(avifEncoder * encoder,
                                             avifAddImageFlags addImageFlags);
 AVIF_API avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output);
 
+// Receives the next size bytes of the file written by avifEncoderFinishToSink(). Returning anything but AVIF_RESULT_OK
+// stops the write and is returned by avifEncoderFinishToSink().
+typedef avifResult (*avifEncoderSinkWriteFunc)(void * userData, const uint8_t * data, size_t size);
+
+// Alternative to avifEncoderFinish() that hands the file to write() in order instead of returning it in a contiguous
+// buffer. Only the boxes before the media data are assembled in memory, the encoded samples are passed to write()
+// directly from the encoder, so the whole file is never held in memory twice.
+AVIF_API avifResult avifEncoderFinishToSink(avifEncoder * encoder, avifEncoderSinkWriteFunc write, void * userData);
+
+// Streams an image sequence to write() while it is being encoded, instead of keeping every encoded frame until
+// avifEncoderFinish(). Must be called before the first avifEncoderAddImage(). Each avifEncoderAddImage() call hands the
+// frames output by the codec so far to write() and releases them, so memory use is bounded by the codec lookahead.
+// avifEncoderFinish() then writes the boxes describing the sequence to write() as well, and leaves its output empty.
+// Only image sequences are supported: grids, layered images and AVIF_ADD_IMAGE_FLAG_SINGLE are rejected, and so is
+// avifEncoderFinishToSink().
+AVIF_API avifResult avifEncoderSetStreamingSink(avifEncoder * encoder, avifEncoderSinkWriteFunc write, void * userData);
+
 // Codec-specific, optional "advanced" tuning settings, in the form of string key/value pairs,
 // to be consumed by the codec in the next avifEncoderAddImage() call.
 // See the codec documentation to know if a setting is persistent or applied only to the next frame.
@@ -1676,6 +1710,30 @@ AVIF_API uint32_t avifImagePlaneHeight(const avifImage * image, int channel);
 // either the brand 'avif' or 'avis' (or both), without performing any allocations.
 AVIF_NODISCARD AVIF_API avifBool avifPeekCompatibleFileType(const avifROData * input);
 
+// Basic description of an AVIF file, as returned by avifPeekImageInfo().
+typedef struct avifImageInfo
+{
+    uint32_t width;  // Of the primary item, or from the tkhd of the color track for sequences
+    uint32_t height; // Of the primary item, or from the tkhd of the color track for sequences
+    uint32_t depth;  // 8, 10 or 12; 0 if unknown
+    avifPixelFormat yuvFormat;
+    avifBool alphaPresent;
+    avifBool gainMapPresent;
+    avifBool isSequence;  // AVIF_TRUE if the values come from a track, as avifDecoderParse() would pick by default
+    uint32_t frameCount;  // 1 for still images, sample count of the color track for sequences
+    avifColorPrimaries colorPrimaries;                   // From an nclx colr property, unspecified otherwise
+    avifTransferCharacteristics transferCharacteristics; // From an nclx colr property, unspecified otherwise
+    avifMatrixCoefficients matrixCoefficients;           // From an nclx colr property, unspecified otherwise
+} avifImageInfo;
+
+// Fills info by reading only the ftyp, meta and moov boxes found in input, straight from the buffer
+// and without performing any allocations. This is much cheaper than avifDecoderParse() when only the
+// dimensions or a few properties are needed, but does not validate the file.
+// input usually only needs to hold the first few kilobytes of the file. Returns
+// AVIF_RESULT_TRUNCATED_DATA when the needed boxes are not entirely in input (or follow a box that
+// is not), in which case more data may be provided or avifDecoderParse() used instead.
+AVIF_NODISCARD AVIF_API avifResult avifPeekImageInfo(const avifROData * input, avifImageInfo * info);
+
 // ---------------------------------------------------------------------------
 // Gain Map utilities.
 // Gain Maps are a HIGHLY EXPERIMENTAL FEATURE, see comments in the avifGainMap
@@ -1684,6 +1742,7 @@ AVIF_NODISCARD AVIF_API avifBool avifPeekCompatibleFileType(const avifROData * i
 // Performs tone mapping on a base image using the provided gain map.
 // The HDR headroom is log2 of the ratio of HDR to SDR white brightness of the display to tone map for.
 // 'toneMappedImage' should have the 'format', 'depth', and 'isFloat' fields set to the desired values.
+// Up to 'toneMappedImage->maxThreads' threads are used, each on its own band of rows.
 // If non NULL, 'clli' will be filled with the light level information of the tone mapped image.
 // NOTE: only used in tests for now, might be added to the public API at some point.
 AVIF_API avifResult avifImageApplyGainMap(const avifImage * baseImage,
@@ -1712,6 +1771,7 @@ AVIF_API avifResult avifRGBImageApplyGainMap(const avifRGBImage * baseImage,
 // gainMap->image should be initialized with avifImageCreate(), with the width,
 // height, depth and yuvFormat fields set to the desired output values for the
 // gain map. All of these fields may differ from the source images.
+// Up to 'baseRgbImage->maxThreads' threads are used, each on its own band of rows.
 AVIF_API avifResult avifRGBImageComputeGainMap(const avifRGBImage * baseRgbImage,
                                                avifColorPrimaries baseColorPrimaries,
                                                avifTransferCharacteristics baseTransferCharacteristics,
@@ -104,6 +104,51 @@ avifTransferFunction avifTransferCharacteristicsGetGammaToLinearFunction(avifTra
 // Same as above in the opposite direction. toGamma(toLinear(v)) ~= v.
 avifTransferFunction avifTransferCharacteristicsGetLinearToGammaFunction(avifTransferCharacteristics atc);
 
+// Returns a table of the gamma to linear function for every sample value of 'depth' bits: table[v] is exactly the
+// function of v / ((1 << depth) - 1), as read by avifGetRGBAPixel(). Built once per (transfer characteristics, depth)
+// by the caller and freed with avifFree(). Returns NULL if the allocation fails.
+float * avifTransferCharacteristicsCreateGammaToLinearTable(avifTransferCharacteristics atc, uint32_t depth);
+
+#define AVIF_GAMMA_TO_LINEAR_TABLES_MAX 4
+
+// Gamma to linear tables kept for the whole of a conversion and shared by its images and threads: every
+// (transfer characteristics, depth) pair is built once, on its first request. Zero-initialized before use and freed
+// with avifGammaToLinearTablesFree().
+typedef struct avifGammaToLinearTables
+{
+    struct
+    {
+        avifTransferCharacteristics atc;
+        uint32_t depth;
+        float * table;
+    } entries[AVIF_GAMMA_TO_LINEAR_TABLES_MAX];
+    uint32_t count;
+} avifGammaToLinearTables;
+
+// Returns the table of avifTransferCharacteristicsCreateGammaToLinearTable() for (atc, depth), building it if needed.
+// Returns NULL if the allocation fails or if AVIF_GAMMA_TO_LINEAR_TABLES_MAX different tables were already built.
+// Not thread-safe, tables are requested before the jobs start.
+const float * avifGammaToLinearTablesGet(avifGammaToLinearTables * tables, avifTransferCharacteristics atc, uint32_t depth);
+void avifGammaToLinearTablesFree(avifGammaToLinearTables * tables);
+
+#define AVIF_TRANSFER_CURVE_SIZE 2048
+
+// Linear to gamma function of float values, evaluated piecewise linearly from AVIF_TRANSFER_CURVE_SIZE + 1 samples.
+// The absolute error against avifTransferCharacteristicsGetLinearToGammaFunction() is below 2.5e-6 (1% of a 12-bit
+// step) for BT.709, BT.601, BT.2020, BT.470, SMPTE 240M, sRGB and HLG, and below 5e-6 for PQ, half of which is the float
+// rounding of the function itself. Integer samples written from it are within one code value of those written from the
+// function. The other transfer characteristics are evaluated with the exact function. See Tests/native.
+typedef struct avifTransferCurve
+{
+    avifTransferFunction toGamma;
+    float maxLinear; // The function is flat above this value, 0 if the exact function is used.
+    float table[AVIF_TRANSFER_CURVE_SIZE + 1];
+} avifTransferCurve;
+
+void avifTransferCurveInitLinearToGamma(avifTransferCurve * curve, avifTransferCharacteristics atc);
+// Converts 'count' linear values to gamma in place.
+void avifTransferCurveApply(const avifTransferCurve * curve, float * values, uint32_t count);
+
 // Computes the RGB->YUV conversion coefficients kr, kg, kb, such that Y=kr*R+kg*G+kb*B.
 void avifColorPrimariesComputeYCoeffs(avifColorPrimaries colorPrimaries, float coeffs[3]);
 
@@ -385,6 +430,17 @@ AVIF_NODISCARD avifBool avifDimensionsTooLarge(uint32_t width, uint32_t height,
 // unit tests.
 void avifSetTileConfiguration(int threads, uint32_t width, uint32_t height, int * tileRowsLog2, int * tileColsLog2);
 
+// ---------------------------------------------------------------------------
+// Threading
+
+typedef void (*avifJobFunc)(void * context, uint32_t jobIndex);
+
+// Calls func(context, jobIndex) once for every jobIndex in [0, jobCount), using at most threadCount threads including the
+// calling thread. Jobs are handed out in increasing index order as threads become free, so jobs must not depend on each
+// other. If some threads cannot be created, the remaining jobs still run on the threads that do exist. Returns AVIF_FALSE
+// if a thread could not be joined; in every case all jobs have been executed when this returns.
+avifBool avifRunJobs(uint32_t threadCount, uint32_t jobCount, avifJobFunc func, void * context);
+
 // ---------------------------------------------------------------------------
 // Scaling
 
@@ -490,8 +546,9 @@ void avifCodecDecodeInputDestroy(avifCodecDecodeInput * decodeInput);
 
 typedef struct avifEncodeSample
 {
-    avifRWData data;
-    avifBool sync; // is sync sample (keyframe)
+    avifRWData data; // data.data is freed once streamed, except for the first sample, data.size is kept
+    avifBool sync;   // is sync sample (keyframe)
+    uint64_t offset; // position in the file once passed to the streaming sink of the encoder, 0 until then
 } avifEncodeSample;
 AVIF_ARRAY_DECLARE(avifEncodeSampleArray, avifEncodeSample, sample);
 
@@ -728,6 +785,8 @@ size_t avifRWStreamOffset(const avifRWStream * stream);
 void avifRWStreamSetOffset(avifRWStream * stream, size_t offset);
 
 void avifRWStreamFinishWrite(avifRWStream * stream);
+// Makes sure that size more bytes can be written without growing the underlying buffer.
+avifResult avifRWStreamReserve(avifRWStream * stream, size_t size);
 // The following functions require byte alignment.
 avifResult avifRWStreamWrite(avifRWStream * stream, const void * data, size_t size);
 avifResult avifRWStreamWriteChars(avifRWStream * stream, const char * chars, size_t size);
@@ -1,12 +1,23 @@
 // Copyright 2020 Joe Drago. All rights reserved.
 // SPDX-License-Identifier: BSD-2-Clause
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L // posix_madvise()
+#endif
+
 #include "avif/internal.h"
 
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 void avifIODestroy(avifIO * io)
 {
     if (io && io->destroy) {
@@ -168,3 +179,109 @@ avifIO * avifIOCreateFileReader(const char * filename)
     }
     return (avifIO *)reader;
 }
+
+// --------------------------------------------------------------------------------------
+// avifIOMappedFileReader
+
+#if !defined(_WIN32)
+
+// Reads below this size are served from the mapping without any advice; the kernel faults these pages in on demand.
+#define AVIF_IO_MAPPED_WILLNEED_THRESHOLD (64 * 1024)
+
+typedef struct avifIOMappedFileReader
+{
+    avifIO io; // this must be the first member for easy casting to avifIO*
+    uint8_t * mapping;
+    size_t mappingSize;
+    size_t pageSize;
+} avifIOMappedFileReader;
+
+static avifResult avifIOMappedFileReaderRead(struct avifIO * io, uint32_t readFlags, uint64_t offset, size_t size, avifROData * out)
+{
+    if (readFlags != 0) {
+        // Unsupported readFlags
+        return AVIF_RESULT_IO_ERROR;
+    }
+
+    avifIOMappedFileReader * reader = (avifIOMappedFileReader *)io;
+
+    // Sanitize/clamp incoming request
+    if (offset > reader->mappingSize) {
+        // The offset is past the EOF.
+        return AVIF_RESULT_IO_ERROR;
+    }
+    uint64_t availableSize = reader->mappingSize - offset;
+    if (size > availableSize) {
+        size = (size_t)availableSize;
+    }
+
+    if (size >= AVIF_IO_MAPPED_WILLNEED_THRESHOLD) {
+        // Large reads are sample payloads which are about to be consumed as a whole. Ask for the whole range at once
+        // instead of faulting it page by page. posix_madvise() requires a page aligned address.
+        const size_t alignedOffset = (size_t)offset - ((size_t)offset % reader->pageSize);
+        (void)posix_madvise(reader->mapping + alignedOffset, size + ((size_t)offset - alignedOffset), POSIX_MADV_WILLNEED);
+    }
+
+    out->data = reader->mapping + offset;
+    out->size = size;
+    return AVIF_RESULT_OK;
+}
+
+static void avifIOMappedFileReaderDestroy(struct avifIO * io)
+{
+    avifIOMappedFileReader * reader = (avifIOMappedFileReader *)io;
+    munmap(reader->mapping, reader->mappingSize);
+    avifFree(io);
+}
+
+avifIO * avifIOCreateMappedFileReader(const char * filename, avifIOAccessPattern accessPattern)
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode) || fileStat.st_size <= 0 ||
+        (uint64_t)fileStat.st_size > (uint64_t)SIZE_MAX) {
+        // Empty files cannot be mapped.
+        close(fd);
+        return NULL;
+    }
+    const size_t mappingSize = (size_t)fileStat.st_size;
+    void * mapping = mmap(NULL, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+    (void)posix_madvise(mapping,
+                        mappingSize,
+                        accessPattern == AVIF_IO_ACCESS_PATTERN_SEQUENTIAL ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_RANDOM);
+
+    avifIOMappedFileReader * reader = (avifIOMappedFileReader *)avifAlloc(sizeof(avifIOMappedFileReader));
+    if (!reader) {
+        munmap(mapping, mappingSize);
+        return NULL;
+    }
+    memset(reader, 0, sizeof(avifIOMappedFileReader));
+    reader->mapping = (uint8_t *)mapping;
+    reader->mappingSize = mappingSize;
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    reader->pageSize = pageSize > 0 ? (size_t)pageSize : 4096;
+    reader->io.destroy = avifIOMappedFileReaderDestroy;
+    reader->io.read = avifIOMappedFileReaderRead;
+    reader->io.sizeHint = (uint64_t)mappingSize;
+    reader->io.persistent = AVIF_TRUE;
+    return (avifIO *)reader;
+}
+
+#else
+
+avifIO * avifIOCreateMappedFileReader(const char * filename, avifIOAccessPattern accessPattern)
+{
+    (void)filename;
+    (void)accessPattern;
+    return NULL;
+}
+
+#endif
@@ -1791,11 +1791,13 @@ static avifResult avifDecoderDataAllocateImagePlanes(avifDecoderData * data, con
 
 // Copies over the pixels from the tile into dstImage.
 // Verifies that the relevant properties of the tile match those of the first tile in case of a grid.
+// Errors are reported to diag, which is not necessarily data->diag when tiles are copied from several threads.
 static avifResult avifDecoderDataCopyTileToImage(avifDecoderData * data,
                                                  const avifTileInfo * info,
                                                  avifImage * dstImage,
                                                  const avifTile * tile,
-                                                 unsigned int tileIndex)
+                                                 unsigned int tileIndex,
+                                                 avifDiagnostics * diag)
 {
     const avifTile * firstTile = &data->tiles.tile[info->firstTileIndex];
     if (tile != firstTile) {
@@ -1805,7 +1807,7 @@ static avifResult avifDecoderDataCopyTileToImage(avifDecoderData * data,
             (tile->image->yuvRange != firstTile->image->yuvRange) || (tile->image->colorPrimaries != firstTile->image->colorPrimaries) ||
             (tile->image->transferCharacteristics != firstTile->image->transferCharacteristics) ||
             (tile->image->matrixCoefficients != firstTile->image->matrixCoefficients)) {
-            avifDiagnosticsPrintf(data->diag, "Grid image contains mismatched tiles");
+            avifDiagnosticsPrintf(diag, "Grid image contains mismatched tiles");
             return AVIF_RESULT_INVALID_IMAGE_GRID;
         }
     }
@@ -4863,6 +4865,466 @@ avifBool avifPeekCompatibleFileType(const avifROData * input)
     return avifFileTypeIsCompatible(&ftyp);
 }
 
+// ---------------------------------------------------------------------------
+// avifPeekImageInfo()
+//
+// Reads the boxes straight from the input buffer. Relations between items, references and
+// properties are resolved by scanning the boxes again instead of building the tables that
+// avifDecoderParse() allocates.
+
+typedef struct avifPeekMeta
+{
+    avifROData iinf; // Payloads of the boxes, empty if absent
+    avifROData iref;
+    avifROData ipco;
+    avifROData ipma;
+    uint32_t primaryItemID;
+} avifPeekMeta;
+
+// Properties of an item or of a sample entry which avifPeekImageInfo() is interested in.
+typedef struct avifPeekProperties
+{
+    avifBool ispeSeen;
+    uint32_t width;
+    uint32_t height;
+    avifBool av1CSeen;
+    uint32_t depth;
+    avifPixelFormat yuvFormat;
+    uint32_t pixiDepth;
+    avifBool nclxSeen;
+    uint16_t colorPrimaries;
+    uint16_t transferCharacteristics;
+    uint16_t matrixCoefficients;
+    avifBool isAlpha;
+} avifPeekProperties;
+
+// Finds the childIndex-th box in raw if type is NULL, or the first box of the given type otherwise.
+static avifBool avifPeekFindBox(const uint8_t * raw, size_t rawLen, const char * type, uint32_t childIndex, uint8_t outType[4], avifROData * payload)
+{
+    BEGIN_STREAM(s, raw, rawLen, NULL, NULL);
+    for (uint32_t index = 0; avifROStreamHasBytesLeft(&s, 1); ++index) {
+        avifBoxHeader header;
+        AVIF_CHECK(avifROStreamReadBoxHeader(&s, &header));
+        if (type ? !memcmp(header.type, type, 4) : (index == childIndex)) {
+            if (outType) {
+                memcpy(outType, header.type, 4);
+            }
+            payload->data = avifROStreamCurrent(&s);
+            payload->size = header.size;
+            return AVIF_TRUE;
+        }
+        AVIF_CHECK(avifROStreamSkip(&s, header.size));
+    }
+    return AVIF_FALSE;
+}
+
+static void avifPeekProperty(const uint8_t type[4], const avifROData * payload, avifPeekProperties * properties)
+{
+    BEGIN_STREAM(s, payload->data, payload->size, NULL, NULL);
+    if (!memcmp(type, "ispe", 4)) {
+        uint32_t width, height;
+        if (avifROStreamReadAndEnforceVersion(&s, 0, NULL) && avifROStreamReadU32(&s, &width) && avifROStreamReadU32(&s, &height)) {
+            properties->ispeSeen = AVIF_TRUE;
+            properties->width = width;
+            properties->height = height;
+        }
+    } else if (!memcmp(type, "av1C", 4)) {
+        // Section 2.3.3 of https://aomediacodec.github.io/av1-isobmff/
+        uint8_t bytes[3];
+        if (avifROStreamRead(&s, bytes, 3)) {
+            const avifBool highBitdepth = (bytes[2] >> 6) & 1;
+            const avifBool twelveBit = (bytes[2] >> 5) & 1;
+            const avifBool monochrome = (bytes[2] >> 4) & 1;
+            const avifBool chromaSubsamplingX = (bytes[2] >> 3) & 1;
+            const avifBool chromaSubsamplingY = (bytes[2] >> 2) & 1;
+            properties->av1CSeen = AVIF_TRUE;
+            properties->depth = highBitdepth ? (twelveBit ? 12 : 10) : 8;
+            if (monochrome) {
+                properties->yuvFormat = AVIF_PIXEL_FORMAT_YUV400;
+            } else if (chromaSubsamplingX && chromaSubsamplingY) {
+                properties->yuvFormat = AVIF_PIXEL_FORMAT_YUV420;
+            } else if (chromaSubsamplingX) {
+                properties->yuvFormat = AVIF_PIXEL_FORMAT_YUV422;
+            } else {
+                properties->yuvFormat = AVIF_PIXEL_FORMAT_YUV444;
+            }
+        }
+    } else if (!memcmp(type, "pixi", 4)) {
+        uint8_t channelCount, bitsPerChannel;
+        if (avifROStreamReadAndEnforceVersion(&s, 0, NULL) && avifROStreamRead(&s, &channelCount, 1) && (channelCount > 0) &&
+            avifROStreamRead(&s, &bitsPerChannel, 1)) {
+            properties->pixiDepth = bitsPerChannel;
+        }
+    } else if (!memcmp(type, "colr", 4)) {
+        uint8_t colorType[4];
+        uint16_t colorPrimaries, transferCharacteristics, matrixCoefficients;
+        if (!properties->nclxSeen && avifROStreamRead(&s, colorType, 4) && !memcmp(colorType, "nclx", 4) &&
+            avifROStreamReadU16(&s, &colorPrimaries) && avifROStreamReadU16(&s, &transferCharacteristics) &&
+            avifROStreamReadU16(&s, &matrixCoefficients)) {
+            properties->nclxSeen = AVIF_TRUE;
+            properties->colorPrimaries = colorPrimaries;
+            properties->transferCharacteristics = transferCharacteristics;
+            properties->matrixCoefficients = matrixCoefficients;
+        }
+    } else if (!memcmp(type, "auxC", 4)) {
+        char auxType[64];
+        if (avifROStreamReadAndEnforceVersion(&s, 0, NULL) && avifROStreamReadString(&s, auxType, sizeof(auxType))) {
+            properties->isAlpha = !strcmp(auxType, AVIF_URN_ALPHA0) || !strcmp(auxType, AVIF_URN_ALPHA1);
+        }
+    }
+}
+
+static avifBool avifPeekItemProperties(const avifPeekMeta * meta, uint32_t itemID, avifPeekProperties * properties)
+{
+    // Section 8.11.14 of ISO/IEC 14496-12.
+    BEGIN_STREAM(s, meta->ipma.data, meta->ipma.size, NULL, NULL);
+    uint8_t version;
+    uint32_t flags;
+    AVIF_CHECK(avifROStreamReadVersionAndFlags(&s, &version, &flags));
+    uint32_t entryCount;
+    AVIF_CHECK(avifROStreamReadU32(&s, &entryCount));
+    for (uint32_t entryIndex = 0; entryIndex < entryCount; ++entryIndex) {
+        uint32_t entryItemID;
+        if (version < 1) {
+            uint16_t tmp;
+            AVIF_CHECK(avifROStreamReadU16(&s, &tmp));
+            entryItemID = tmp;
+        } else {
+            AVIF_CHECK(avifROStreamReadU32(&s, &entryItemID));
+        }
+        uint8_t associationCount;
+        AVIF_CHECK(avifROStreamRead(&s, &associationCount, 1));
+        for (uint8_t associationIndex = 0; associationIndex < associationCount; ++associationIndex) {
+            uint32_t propertyIndex;
+            if (flags & 0x1) {
+                uint16_t tmp;
+                AVIF_CHECK(avifROStreamReadU16(&s, &tmp));
+                propertyIndex = tmp & 0x7fff;
+            } else {
+                uint8_t tmp;
+                AVIF_CHECK(avifROStreamRead(&s, &tmp, 1));
+                propertyIndex = tmp & 0x7f;
+            }
+            if ((entryItemID != itemID) || (propertyIndex == 0)) {
+                continue;
+            }
+            uint8_t type[4];
+            avifROData payload;
+            if (avifPeekFindBox(meta->ipco.data, meta->ipco.size, NULL, propertyIndex - 1, type, &payload)) {
+                avifPeekProperty(type, &payload, properties);
+            }
+        }
+        if (entryItemID == itemID) {
+            return AVIF_TRUE;
+        }
+    }
+    return AVIF_FALSE;
+}
+
+// Copies the type of the item itemID to outType. If itemID is 0, tells whether any item is of type outType instead.
+static avifBool avifPeekItemType(const avifPeekMeta * meta, uint32_t itemID, uint8_t outType[4])
+{
+    // Section 8.11.6 of ISO/IEC 14496-12.
+    BEGIN_STREAM(s, meta->iinf.data, meta->iinf.size, NULL, NULL);
+    uint8_t version;
+    AVIF_CHECK(avifROStreamReadVersionAndFlags(&s, &version, NULL));
+    AVIF_CHECK(avifROStreamSkip(&s, (version == 0) ? 2 : 4)); // entry_count
+    while (avifROStreamHasBytesLeft(&s, 1)) {
+        avifBoxHeader header;
+        AVIF_CHECK(avifROStreamReadBoxHeader(&s, &header));
+        const size_t nextOffset = avifROStreamOffset(&s) + header.size;
+        if (!memcmp(header.type, "infe", 4)) {
+            uint8_t infeVersion;
+            uint32_t infeItemID = 0;
+            AVIF_CHECK(avifROStreamReadVersionAndFlags(&s, &infeVersion, NULL));
+            if (infeVersion == 2) {
+                uint16_t tmp;
+                AVIF_CHECK(avifROStreamReadU16(&s, &tmp));
+                infeItemID = tmp;
+            } else if (infeVersion == 3) {
+                AVIF_CHECK(avifROStreamReadU32(&s, &infeItemID));
+            }
+            if ((infeItemID != 0) && (infeItemID == itemID || itemID == 0)) {
+                AVIF_CHECK(avifROStreamSkip(&s, 2)); // item_protection_index
+                uint8_t type[4];
+                AVIF_CHECK(avifROStreamRead(&s, type, 4));
+                if (itemID != 0) {
+                    memcpy(outType, type, 4);
+                    return AVIF_TRUE;
+                }
+                if (!memcmp(type, outType, 4)) {
+                    return AVIF_TRUE;
+                }
+            }
+        }
+        avifROStreamSetOffset(&s, nextOffset);
+    }
+    return AVIF_FALSE;
+}
+
+// Calls visitor for every reference of the given type, stops and returns AVIF_TRUE as soon as visitor does.
+typedef avifBool (*avifPeekReferenceVisitor)(const avifPeekMeta * meta, uint32_t fromItemID, uint32_t toItemID, void * context);
+
+static avifBool avifPeekReferences(const avifPeekMeta * meta, const char * type, avifPeekReferenceVisitor visitor, void * context)
+{
+    // Section 8.11.12 of ISO/IEC 14496-12.
+    BEGIN_STREAM(s, meta->iref.data, meta->iref.size, NULL, NULL);
+    uint8_t version;
+    AVIF_CHECK(avifROStreamReadVersionAndFlags(&s, &version, NULL));
+    while (avifROStreamHasBytesLeft(&s, 1)) {
+        avifBoxHeader header;
+        AVIF_CHECK(avifROStreamReadBoxHeader(&s, &header));
+        const size_t nextOffset = avifROStreamOffset(&s) + header.size;
+        if (!memcmp(header.type, type, 4)) {
+            uint32_t fromItemID;
+            if (version == 0) {
+                uint16_t tmp;
+                AVIF_CHECK(avifROStreamReadU16(&s, &tmp));
+                fromItemID = tmp;
+            } else {
+                AVIF_CHECK(avifROStreamReadU32(&s, &fromItemID));
+            }
+            uint16_t referenceCount;
+            AVIF_CHECK(avifROStreamReadU16(&s, &referenceCount));
+            for (uint16_t referenceIndex = 0; referenceIndex < referenceCount; ++referenceIndex) {
+                uint32_t toItemID;
+                if (version == 0) {
+                    uint16_t tmp;
+                    AVIF_CHECK(avifROStreamReadU16(&s, &tmp));
+                    toItemID = tmp;
+                } else {
+                    AVIF_CHECK(avifROStreamReadU32(&s, &toItemID));
+                }
+                if (visitor(meta, fromItemID, toItemID, context)) {
+                    return AVIF_TRUE;
+                }
+            }
+        }
+        avifROStreamSetOffset(&s, nextOffset);
+    }
+    return AVIF_FALSE;
+}
+
+static avifBool avifPeekAlphaVisitor(const avifPeekMeta * meta, uint32_t fromItemID, uint32_t toItemID, void * context)
+{
+    (void)context;
+    if (toItemID != meta->primaryItemID) {
+        return AVIF_FALSE;
+    }
+    avifPeekProperties properties;
+    memset(&properties, 0, sizeof(properties));
+    return avifPeekItemProperties(meta, fromItemID, &properties) && properties.isAlpha;
+}
+
+static avifBool avifPeekFirstTileVisitor(const avifPeekMeta * meta, uint32_t fromItemID, uint32_t toItemID, void * context)
+{
+    if (fromItemID != meta->primaryItemID) {
+        return AVIF_FALSE;
+    }
+    *(uint32_t *)context = toItemID;
+    return AVIF_TRUE;
+}
+
+static void avifPeekApplyProperties(const avifPeekProperties * properties, avifImageInfo * info)
+{
+    if (properties->av1CSeen) {
+        info->depth = properties->depth;
+        info->yuvFormat = properties->yuvFormat;
+    } else if (properties->pixiDepth) {
+        info->depth = properties->pixiDepth;
+    }
+    if (properties->nclxSeen) {
+        info->colorPrimaries = (avifColorPrimaries)properties->colorPrimaries;
+        info->transferCharacteristics = (avifTransferCharacteristics)properties->transferCharacteristics;
+        info->matrixCoefficients = (avifMatrixCoefficients)properties->matrixCoefficients;
+    }
+}
+
+static avifResult avifPeekMetaInfo(const avifROData * metaPayload, avifImageInfo * info)
+{
+    // Section 8.11.1 of ISO/IEC 14496-12.
+    BEGIN_STREAM(s, metaPayload->data, metaPayload->size, NULL, NULL);
+    AVIF_CHECKERR(avifROStreamReadAndEnforceVersion(&s, 0, NULL), AVIF_RESULT_BMFF_PARSE_FAILED);
+
+    avifPeekMeta meta;
+    memset(&meta, 0, sizeof(meta));
+    const uint8_t * children = avifROStreamCurrent(&s);
+    const size_t childrenSize = avifROStreamRemainingBytes(&s);
+    avifROData pitm;
+    AVIF_CHECKERR(avifPeekFindBox(children, childrenSize, "pitm", 0, NULL, &pitm), AVIF_RESULT_BMFF_PARSE_FAILED);
+    AVIF_CHECKERR(avifPeekFindBox(children, childrenSize, "iinf", 0, NULL, &meta.iinf), AVIF_RESULT_BMFF_PARSE_FAILED);
+    avifROData iprp;
+    AVIF_CHECKERR(avifPeekFindBox(children, childrenSize, "iprp", 0, NULL, &iprp), AVIF_RESULT_BMFF_PARSE_FAILED);
+    AVIF_CHECKERR(avifPeekFindBox(iprp.data, iprp.size, "ipco", 0, NULL, &meta.ipco), AVIF_RESULT_BMFF_PARSE_FAILED);
+    AVIF_CHECKERR(avifPeekFindBox(iprp.data, iprp.size, "ipma", 0, NULL, &meta.ipma), AVIF_RESULT_BMFF_PARSE_FAILED);
+    const avifBool hasReferences = avifPeekFindBox(children, childrenSize, "iref", 0, NULL, &meta.iref);
+
+    BEGIN_STREAM(pitmStream, pitm.data, pitm.size, NULL, NULL);
+    uint8_t pitmVersion;
+    AVIF_CHECKERR(avifROStreamReadVersionAndFlags(&pitmStream, &pitmVersion, NULL), AVIF_RESULT_BMFF_PARSE_FAILED);
+    if (pitmVersion == 0) {
+        uint16_t tmp;
+        AVIF_CHECKERR(avifROStreamReadU16(&pitmStream, &tmp), AVIF_RESULT_BMFF_PARSE_FAILED);
+        meta.primaryItemID = tmp;
+    } else {
+        AVIF_CHECKERR(avifROStreamReadU32(&pitmStream, &meta.primaryItemID), AVIF_RESULT_BMFF_PARSE_FAILED);
+    }
+
+    avifPeekProperties properties;
+    memset(&properties, 0, sizeof(properties));
+    AVIF_CHECKERR(avifPeekItemProperties(&meta, meta.primaryItemID, &properties) && properties.ispeSeen, AVIF_RESULT_BMFF_PARSE_FAILED);
+    info->width = properties.width;
+    info->height = properties.height;
+    avifPeekApplyProperties(&properties, info);
+
+    uint8_t primaryType[4];
+    if (!properties.av1CSeen && hasReferences && avifPeekItemType(&meta, meta.primaryItemID, primaryType) &&
+        !memcmp(primaryType, "grid", 4)) {
+        // The coding parameters of a grid are the ones of its tiles
+        uint32_t tileItemID = 0;
+        if (avifPeekReferences(&meta, "dimg", avifPeekFirstTileVisitor, &tileItemID)) {
+            avifPeekProperties tileProperties;
+            memset(&tileProperties, 0, sizeof(tileProperties));
+            if (avifPeekItemProperties(&meta, tileItemID, &tileProperties) && tileProperties.av1CSeen) {
+                info->depth = tileProperties.depth;
+                info->yuvFormat = tileProperties.yuvFormat;
+            }
+        }
+    }
+
+    info->alphaPresent = hasReferences && avifPeekReferences(&meta, "auxl", avifPeekAlphaVisitor, NULL);
+    uint8_t gainMapType[4] = { 't', 'm', 'a', 'p' };
+    info->gainMapPresent = avifPeekItemType(&meta, 0, gainMapType);
+    info->isSequence = AVIF_FALSE;
+    info->frameCount = 1;
+    return AVIF_RESULT_OK;
+}
+
+static avifResult avifPeekTracksInfo(const avifROData * moovPayload, avifImageInfo * info)
+{
+    avifBool colorTrackSeen = AVIF_FALSE;
+    uint8_t type[4];
+    avifROData trak;
+    for (uint32_t childIndex = 0; avifPeekFindBox(moovPayload->data, moovPayload->size, NULL, childIndex, type, &trak); ++childIndex) {
+        if (memcmp(type, "trak", 4)) {
+            continue;
+        }
+        avifROData tref, auxl;
+        if (avifPeekFindBox(trak.data, trak.size, "tref", 0, NULL, &tref) && avifPeekFindBox(tref.data, tref.size, "auxl", 0, NULL, &auxl)) {
+            // Only alpha auxiliary tracks are supported by libavif
+            info->alphaPresent = AVIF_TRUE;
+            continue;
+        }
+        if (colorTrackSeen) {
+            continue;
+        }
+
+        avifROData mdia, minf, stbl, stsd, stsz, tkhd;
+        if (!avifPeekFindBox(trak.data, trak.size, "tkhd", 0, NULL, &tkhd) || !avifPeekFindBox(trak.data, trak.size, "mdia", 0, NULL, &mdia) ||
+            !avifPeekFindBox(mdia.data, mdia.size, "minf", 0, NULL, &minf) || !avifPeekFindBox(minf.data, minf.size, "stbl", 0, NULL, &stbl) ||
+            !avifPeekFindBox(stbl.data, stbl.size, "stsd", 0, NULL, &stsd)) {
+            continue;
+        }
+
+        // Section 12.1.3 of ISO/IEC 14496-12: VisualSampleEntry is followed by the codec configuration boxes.
+        BEGIN_STREAM(stsdStream, stsd.data, stsd.size, NULL, NULL);
+        uint32_t entryCount;
+        avifBoxHeader sampleEntryHeader;
+        if (!avifROStreamReadAndEnforceVersion(&stsdStream, 0, NULL) || !avifROStreamReadU32(&stsdStream, &entryCount) || (entryCount == 0) ||
+            !avifROStreamReadBoxHeader(&stsdStream, &sampleEntryHeader) || memcmp(sampleEntryHeader.type, "av01", 4)) {
+            continue;
+        }
+        const size_t visualSampleEntrySize = 78;
+        if (sampleEntryHeader.size < visualSampleEntrySize) {
+            return AVIF_RESULT_BMFF_PARSE_FAILED;
+        }
+        const uint8_t * sampleEntryChildren = avifROStreamCurrent(&stsdStream) + visualSampleEntrySize;
+        const size_t sampleEntryChildrenSize = sampleEntryHeader.size - visualSampleEntrySize;
+        avifPeekProperties properties;
+        memset(&properties, 0, sizeof(properties));
+        avifROData property;
+        for (uint32_t propertyIndex = 0;
+             avifPeekFindBox(sampleEntryChildren, sampleEntryChildrenSize, NULL, propertyIndex, type, &property);
+             ++propertyIndex) {
+            avifPeekProperty(type, &property, &properties);
+        }
+        avifPeekApplyProperties(&properties, info);
+
+        // Section 8.3.2 of ISO/IEC 14496-12.
+        BEGIN_STREAM(tkhdStream, tkhd.data, tkhd.size, NULL, NULL);
+        uint8_t tkhdVersion;
+        AVIF_CHECKERR(avifROStreamReadVersionAndFlags(&tkhdStream, &tkhdVersion, NULL), AVIF_RESULT_BMFF_PARSE_FAILED);
+        // Times, track_ID, duration and the fields up to and including the matrix.
+        AVIF_CHECKERR(avifROStreamSkip(&tkhdStream, ((tkhdVersion == 1) ? 32 : 20) + 8 + 8 + 36), AVIF_RESULT_BMFF_PARSE_FAILED);
+        uint32_t width, height;
+        AVIF_CHECKERR(avifROStreamReadU32(&tkhdStream, &width), AVIF_RESULT_BMFF_PARSE_FAILED);
+        AVIF_CHECKERR(avifROStreamReadU32(&tkhdStream, &height), AVIF_RESULT_BMFF_PARSE_FAILED);
+        info->width = width >> 16;
+        info->height = height >> 16;
+
+        // Section 8.7.3.2 of ISO/IEC 14496-12.
+        info->frameCount = 0;
+        if (avifPeekFindBox(stbl.data, stbl.size, "stsz", 0, NULL, &stsz)) {
+            BEGIN_STREAM(stszStream, stsz.data, stsz.size, NULL, NULL);
+            uint32_t sampleSize, sampleCount;
+            if (avifROStreamReadAndEnforceVersion(&stszStream, 0, NULL) && avifROStreamReadU32(&stszStream, &sampleSize) &&
+                avifROStreamReadU32(&stszStream, &sampleCount)) {
+                info->frameCount = sampleCount;
+            }
+        }
+        colorTrackSeen = AVIF_TRUE;
+    }
+    AVIF_CHECKERR(colorTrackSeen, AVIF_RESULT_BMFF_PARSE_FAILED);
+    info->isSequence = AVIF_TRUE;
+    return AVIF_RESULT_OK;
+}
+
+avifResult avifPeekImageInfo(const avifROData * input, avifImageInfo * info)
+{
+    memset(info, 0, sizeof(avifImageInfo));
+    info->colorPrimaries = AVIF_COLOR_PRIMARIES_UNSPECIFIED;
+    info->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED;
+    info->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED;
+
+    BEGIN_STREAM(s, input->data, input->size, NULL, NULL);
+    avifFileType ftyp;
+    memset(&ftyp, 0, sizeof(avifFileType));
+    avifBool ftypSeen = AVIF_FALSE;
+    avifROData meta = { NULL, 0 };
+    avifROData moov = { NULL, 0 };
+    while (avifROStreamHasBytesLeft(&s, 1)) {
+        avifBoxHeader header;
+        if (!avifROStreamReadBoxHeaderPartial(&s, &header, /*topLevel=*/AVIF_TRUE) || header.isSizeZeroBox ||
+            (header.size > avifROStreamRemainingBytes(&s))) {
+            // Boxes past this one, usually mdat, are out of reach
+            break;
+        }
+        if (!ftypSeen) {
+            AVIF_CHECKERR(!memcmp(header.type, "ftyp", 4), AVIF_RESULT_INVALID_FTYP);
+            AVIF_CHECKERR(avifParseFileTypeBox(&ftyp, avifROStreamCurrent(&s), header.size, NULL), AVIF_RESULT_INVALID_FTYP);
+            AVIF_CHECKERR(avifFileTypeIsCompatible(&ftyp), AVIF_RESULT_INVALID_FTYP);
+            ftypSeen = AVIF_TRUE;
+        } else if (!memcmp(header.type, "meta", 4) && !meta.data) {
+            meta.data = avifROStreamCurrent(&s);
+            meta.size = header.size;
+        } else if (!memcmp(header.type, "moov", 4) && !moov.data) {
+            moov.data = avifROStreamCurrent(&s);
+            moov.size = header.size;
+        }
+        AVIF_CHECKERR(avifROStreamSkip(&s, header.size), AVIF_RESULT_BMFF_PARSE_FAILED);
+    }
+    AVIF_CHECKERR(ftypSeen, AVIF_RESULT_TRUNCATED_DATA);
+
+    // Same choice as AVIF_DECODER_SOURCE_AUTO in avifDecoderReset().
+    if (!memcmp(ftyp.majorBrand, "avis", 4) || (memcmp(ftyp.majorBrand, "avif", 4) && moov.data)) {
+        AVIF_CHECKERR(moov.data, AVIF_RESULT_TRUNCATED_DATA);
+        return avifPeekTracksInfo(&moov, info);
+    }
+    // Without a major brand to honor, a moov box may still follow if avis is among the compatible brands.
+    AVIF_CHECKERR(meta.data && (!memcmp(ftyp.majorBrand, "avif", 4) || !avifFileTypeHasBrand(&ftyp, "avis")), AVIF_RESULT_TRUNCATED_DATA);
+    return avifPeekMetaInfo(&meta, info);
+}
+
 static avifBool avifBrandArrayHasBrand(avifBrandArray * brands, const char * brand)
 {
     for (uint32_t brandIndex = 0; brandIndex < brands->count; ++brandIndex) {
@@ -4934,7 +5396,11 @@ avifResult avifDecoderSetIOMemory(avifDecoder * decoder, const uint8_t * data, s
 
 avifResult avifDecoderSetIOFile(avifDecoder * decoder, const char * filename)
 {
-    avifIO * io = avifIOCreateFileReader(filename);
+    // Parsing only touches the boxes it needs, and sample reads prefetch their own range, so no read-ahead is requested.
+    avifIO * io = avifIOCreateMappedFileReader(filename, AVIF_IO_ACCESS_PATTERN_RANDOM);
+    if (!io) {
+        io = avifIOCreateFileReader(filename);
+    }
     if (!io) {
         return AVIF_RESULT_IO_ERROR;
     }
@@ -5221,6 +5687,20 @@ static avifBool avifTilesCanBeDecodedWithSameCodecInstance(const avifDecoderData
     return AVIF_TRUE;
 }
 
+// Returns AVIF_TRUE if at least one of the items is a grid that may be decoded with one codec instance per worker thread.
+static avifBool avifDecoderShouldDecodeTilesInParallel(const avifDecoder * decoder)
+{
+    if (decoder->maxThreads < 2) {
+        return AVIF_FALSE;
+    }
+    for (int c = 0; c < AVIF_ITEM_CATEGORY_COUNT; ++c) {
+        if (decoder->data->tileInfos[c].tileCount > 1) {
+            return AVIF_TRUE;
+        }
+    }
+    return AVIF_FALSE;
+}
+
 static avifResult avifDecoderCreateCodecs(avifDecoder * decoder)
 {
     avifDecoderData * data = decoder->data;
@@ -5246,9 +5726,11 @@ static avifResult avifDecoderCreateCodecs(avifDecoder * decoder)
         //   - If the image has a single tile, it must not have a single tile alpha plane (in this case we will steal the planes
         //     from the decoder, so we cannot use the same decoder for both the color and the alpha planes).
         //   - All tiles have the same type (AV1 or AV2).
+        //   - The tiles are not going to be decoded in parallel (see avifDecoderShouldDecodeTilesInParallel()).
         // Otherwise, we will use |tiles.count| decoder instances (one instance for each tile).
         avifBool canUseSingleCodecInstance = (data->tiles.count == 1) ||
-                                             (decoder->imageCount == 1 && avifTilesCanBeDecodedWithSameCodecInstance(data));
+                                             (decoder->imageCount == 1 && avifTilesCanBeDecodedWithSameCodecInstance(data) &&
+                                              !avifDecoderShouldDecodeTilesInParallel(decoder));
         if (canUseSingleCodecInstance) {
             AVIF_CHECKRES(avifCodecCreateInternal(decoder->codecChoice, &decoder->data->tiles.tile[0], &decoder->diag, &data->codec));
             for (unsigned int i = 0; i < decoder->data->tiles.count; ++i) {
@@ -6391,6 +6873,188 @@ static avifResult avifGetErrorForItemCategory(avifItemCategory itemCategory)
     return avifIsAlpha(itemCategory) ? AVIF_RESULT_DECODE_ALPHA_FAILED : AVIF_RESULT_DECODE_COLOR_FAILED;
 }
 
+// Decodes the sample of a single tile into tile->image and scales it to the output dimensions of the tile.
+// Errors are reported to diag, which is not necessarily decoder->diag when tiles are decoded in parallel.
+static avifResult avifDecoderDecodeTileImage(const avifDecoder * decoder, avifTile * tile, const avifDecodeSample * sample, avifDiagnostics * diag)
+{
+    avifBool isLimitedRangeAlpha = AVIF_FALSE;
+    if (!tile->codec->getNextImage(tile->codec, sample, avifIsAlpha(tile->input->itemCategory), &isLimitedRangeAlpha, tile->image)) {
+        avifDiagnosticsPrintf(diag, "tile->codec->getNextImage() failed");
+        return avifGetErrorForItemCategory(tile->input->itemCategory);
+    }
+
+    // Section 2.3.4 of AV1 Codec ISO Media File Format Binding v1.2.0 says:
+    //   the full_range_flag in the colr box shall match the color_range
+    //   flag in the Sequence Header OBU.
+    // See https://aomediacodec.github.io/av1-isobmff/v1.2.0.html#av1codecconfigurationbox-semantics.
+    // If a 'colr' box of colour_type 'nclx' was parsed, a mismatch between
+    // the 'colr' decoder->image->yuvRange and the AV1 OBU
+    // tile->image->yuvRange should be treated as an error.
+    // However codec_svt.c was not encoding the color_range field for
+    // multiple years, so there probably are files in the wild that will
+    // fail decoding if this is enforced. Thus this pattern is allowed.
+    // Section 12.1.5.1 of ISO 14496-12 (ISOBMFF) says:
+    //   If colour information is supplied in both this [colr] box, and also
+    //   in the video bitstream, this box takes precedence, and over-rides
+    //   the information in the bitstream.
+    // So decoder->image->yuvRange is kept because it was either the 'colr'
+    // value set when the 'colr' box was parsed, or it was the AV1 OBU value
+    // extracted from the sequence header OBU of the first tile of the first
+    // frame (if no 'colr' box of colour_type 'nclx' was found).
+
+    // Alpha plane with limited range is not allowed by the latest revision
+    // of the specification. However, it was allowed in version 1.0.0 of the
+    // specification. To allow such files, simply convert the alpha plane to
+    // full range.
+    if (avifIsAlpha(tile->input->itemCategory) && isLimitedRangeAlpha) {
+        avifResult result = avifImageLimitedToFullAlpha(tile->image);
+        if (result != AVIF_RESULT_OK) {
+            avifDiagnosticsPrintf(diag, "avifImageLimitedToFullAlpha failed");
+            return result;
+        }
+    }
+
+    // Scale the decoded image so that it corresponds to this tile's output dimensions
+    if ((tile->width != tile->image->width) || (tile->height != tile->image->height)) {
+        if (avifImageScaleWithLimit(tile->image,
+                                    tile->width,
+                                    tile->height,
+                                    decoder->imageSizeLimit,
+                                    decoder->imageDimensionLimit,
+                                    diag) != AVIF_RESULT_OK) {
+            return avifGetErrorForItemCategory(tile->input->itemCategory);
+        }
+    }
+    return AVIF_RESULT_OK;
+}
+
+typedef struct avifTileDecodeJob
+{
+    avifResult result;
+    avifDiagnostics diag;
+} avifTileDecodeJob;
+
+typedef struct avifTileDecodeContext
+{
+    avifDecoder * decoder;
+    const avifTileInfo * info;
+    avifImage * dstImage;
+    uint32_t nextImageIndex;
+    unsigned int firstJobTileIndex; // Index within the grid of the tile decoded by the first job.
+    int codecMaxThreads;
+    avifTileDecodeJob * jobs;
+} avifTileDecodeContext;
+
+static void avifDecoderDecodeTileJob(void * context, uint32_t jobIndex)
+{
+    avifTileDecodeContext * ctx = (avifTileDecodeContext *)context;
+    avifTileDecodeJob * job = &ctx->jobs[jobIndex];
+    const unsigned int tileIndex = ctx->firstJobTileIndex + jobIndex;
+    avifTile * tile = &ctx->decoder->data->tiles.tile[ctx->info->firstTileIndex + tileIndex];
+    const avifDecodeSample * sample = &tile->input->samples.sample[ctx->nextImageIndex];
+
+    // Each tile owns its codec instance here, so redirecting its diagnostics is not visible to other jobs.
+    avifDiagnostics * codecDiag = tile->codec->diag;
+    tile->codec->diag = &job->diag;
+    tile->codec->maxThreads = ctx->codecMaxThreads;
+    tile->codec->imageSizeLimit = ctx->decoder->imageSizeLimit;
+    job->result = avifDecoderDecodeTileImage(ctx->decoder, tile, sample, &job->diag);
+    tile->codec->diag = codecDiag;
+    if (job->result != AVIF_RESULT_OK) {
+        return;
+    }
+    // Tiles cover disjoint areas of dstImage so they can be copied concurrently.
+    job->result = avifDecoderDataCopyTileToImage(ctx->decoder->data, ctx->info, ctx->dstImage, tile, tileIndex, &job->diag);
+}
+
+// Returns AVIF_TRUE if the tiles of info starting at firstTileIndex can be handed to avifDecoderDecodeTilesInParallel().
+static avifBool avifDecoderCanDecodeTilesInParallel(const avifDecoder * decoder,
+                                                    uint32_t nextImageIndex,
+                                                    const avifTileInfo * info,
+                                                    unsigned int firstTileIndex)
+{
+#if defined(AVIF_CODEC_AVM)
+    // The AVM path adjusts tile->image after decoding based on item properties. Keep it sequential.
+    (void)decoder;
+    (void)nextImageIndex;
+    (void)info;
+    (void)firstTileIndex;
+    return AVIF_FALSE;
+#else
+    const avifBool isGrid = (info->grid.rows > 0) && (info->grid.columns > 0);
+    if (decoder->maxThreads < 2 || !isGrid || firstTileIndex == 0 || info->tileCount - firstTileIndex < 2) {
+        return AVIF_FALSE;
+    }
+#if defined(AVIF_ENABLE_EXPERIMENTAL_SAMPLE_TRANSFORM)
+    // Sample Transform input tiles are kept as they are and not copied to the destination image.
+    const avifItemCategory itemCategory = decoder->data->tiles.tile[info->firstTileIndex].input->itemCategory;
+    if (decoder->data->meta->sampleTransformExpression.count > 0 ||
+        (itemCategory >= AVIF_SAMPLE_TRANSFORM_MIN_CATEGORY && itemCategory <= AVIF_SAMPLE_TRANSFORM_MAX_CATEGORY)) {
+        return AVIF_FALSE;
+    }
+#endif
+    for (unsigned int tileIndex = firstTileIndex; tileIndex < info->tileCount; ++tileIndex) {
+        const avifTile * tile = &decoder->data->tiles.tile[info->firstTileIndex + tileIndex];
+        // A shared codec instance can only decode one tile at a time.
+        if (tile->codec == decoder->data->codec || tile->codec == decoder->data->codecAlpha) {
+            return AVIF_FALSE;
+        }
+        // Incremental decoding outputs tiles in order as data arrives, which is done sequentially.
+        const avifDecodeSample * sample = &tile->input->samples.sample[nextImageIndex];
+        if (sample->data.size < sample->size) {
+            return AVIF_FALSE;
+        }
+    }
+    return AVIF_TRUE;
+#endif
+}
+
+// Decodes the tiles of info starting at firstTileIndex with up to decoder->maxThreads threads. The threads are split between
+// tiles and the codec instances. The planes of the destination image must already be allocated.
+static avifResult avifDecoderDecodeTilesInParallel(avifDecoder * decoder,
+                                                   uint32_t nextImageIndex,
+                                                   avifTileInfo * info,
+                                                   unsigned int firstTileIndex,
+                                                   avifImage * dstImage)
+{
+    const uint32_t jobCount = info->tileCount - firstTileIndex;
+    const uint32_t tileThreads = AVIF_MIN((uint32_t)decoder->maxThreads, jobCount);
+
+    avifTileDecodeContext context;
+    context.decoder = decoder;
+    context.info = info;
+    context.dstImage = dstImage;
+    context.nextImageIndex = nextImageIndex;
+    context.firstJobTileIndex = firstTileIndex;
+    // Give the leftover threads to the codecs, e.g. 16 threads and 4 tiles lead to 4 tile workers each using 4 codec threads.
+    context.codecMaxThreads = AVIF_MAX(decoder->maxThreads / (int)tileThreads, 1);
+    context.jobs = (avifTileDecodeJob *)avifAlloc(sizeof(avifTileDecodeJob) * jobCount);
+    AVIF_CHECKERR(context.jobs != NULL, AVIF_RESULT_OUT_OF_MEMORY);
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        context.jobs[i].result = AVIF_RESULT_UNKNOWN_ERROR;
+        avifDiagnosticsClearError(&context.jobs[i].diag);
+    }
+
+    if (!avifRunJobs(tileThreads, jobCount, avifDecoderDecodeTileJob, &context)) {
+        avifFree(context.jobs);
+        avifDiagnosticsPrintf(&decoder->diag, "Failed to join tile decoding threads");
+        return avifGetErrorForItemCategory(decoder->data->tiles.tile[info->firstTileIndex].input->itemCategory);
+    }
+
+    // Report the first failure in tile order, as the sequential path would have.
+    avifResult result = AVIF_RESULT_OK;
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        if (context.jobs[i].result != AVIF_RESULT_OK) {
+            result = context.jobs[i].result;
+            avifDiagnosticsPrintf(&decoder->diag, "%s", context.jobs[i].diag.error);
+            break;
+        }
+        ++info->decodedTileCount;
+    }
+    avifFree(context.jobs);
+    return result;
+}
+
 static avifResult avifDecoderDecodeTiles(avifDecoder * decoder, uint32_t nextImageIndex, avifTileInfo * info)
 {
     const unsigned int oldDecodedTileCount = info->decodedTileCount;
@@ -6404,57 +7068,20 @@ static avifResult avifDecoderDecodeTiles(avifDecoder * decoder, uint32_t nextIma
             return AVIF_RESULT_OK;
         }
 
-        avifBool isLimitedRangeAlpha = AVIF_FALSE;
-        tile->codec->maxThreads = decoder->maxThreads;
-        tile->codec->imageSizeLimit = decoder->imageSizeLimit;
-        if (!tile->codec->getNextImage(tile->codec, sample, avifIsAlpha(tile->input->itemCategory), &isLimitedRangeAlpha, tile->image)) {
-            avifDiagnosticsPrintf(&decoder->diag, "tile->codec->getNextImage() failed");
-            return avifGetErrorForItemCategory(tile->input->itemCategory);
-        }
-
-        // Section 2.3.4 of AV1 Codec ISO Media File Format Binding v1.2.0 says:
-        //   the full_range_flag in the colr box shall match the color_range
-        //   flag in the Sequence Header OBU.
-        // See https://aomediacodec.github.io/av1-isobmff/v1.2.0.html#av1codecconfigurationbox-semantics.
-        // If a 'colr' box of colour_type 'nclx' was parsed, a mismatch between
-        // the 'colr' decoder->image->yuvRange and the AV1 OBU
-        // tile->image->yuvRange should be treated as an error.
-        // However codec_svt.c was not encoding the color_range field for
-        // multiple years, so there probably are files in the wild that will
-        // fail decoding if this is enforced. Thus this pattern is allowed.
-        // Section 12.1.5.1 of ISO 14496-12 (ISOBMFF) says:
-        //   If colour information is supplied in both this [colr] box, and also
-        //   in the video bitstream, this box takes precedence, and over-rides
-        //   the information in the bitstream.
-        // So decoder->image->yuvRange is kept because it was either the 'colr'
-        // value set when the 'colr' box was parsed, or it was the AV1 OBU value
-        // extracted from the sequence header OBU of the first tile of the first
-        // frame (if no 'colr' box of colour_type 'nclx' was found).
-
-        // Alpha plane with limited range is not allowed by the latest revision
-        // of the specification. However, it was allowed in version 1.0.0 of the
-        // specification. To allow such files, simply convert the alpha plane to
-        // full range.
-        if (avifIsAlpha(tile->input->itemCategory) && isLimitedRangeAlpha) {
-            avifResult result = avifImageLimitedToFullAlpha(tile->image);
-            if (result != AVIF_RESULT_OK) {
-                avifDiagnosticsPrintf(&decoder->diag, "avifImageLimitedToFullAlpha failed");
-                return result;
-            }
-        }
-
-        // Scale the decoded image so that it corresponds to this tile's output dimensions
-        if ((tile->width != tile->image->width) || (tile->height != tile->image->height)) {
-            if (avifImageScaleWithLimit(tile->image,
-                                        tile->width,
-                                        tile->height,
-                                        decoder->imageSizeLimit,
-                                        decoder->imageDimensionLimit,
-                                        &decoder->diag) != AVIF_RESULT_OK) {
-                return avifGetErrorForItemCategory(tile->input->itemCategory);
+        if (avifDecoderCanDecodeTilesInParallel(decoder, nextImageIndex, info, tileIndex)) {
+            // The first tile was decoded sequentially and the planes of the destination image were allocated for it.
+            avifImage * dstImage = decoder->image;
+            if (tile->input->itemCategory == AVIF_ITEM_GAIN_MAP) {
+                AVIF_ASSERT_OR_RETURN(dstImage->gainMap && dstImage->gainMap->image);
+                dstImage = dstImage->gainMap->image;
             }
+            return avifDecoderDecodeTilesInParallel(decoder, nextImageIndex, info, tileIndex, dstImage);
         }
 
+        tile->codec->maxThreads = decoder->maxThreads;
+        tile->codec->imageSizeLimit = decoder->imageSizeLimit;
+        AVIF_CHECKRES(avifDecoderDecodeTileImage(decoder, tile, sample, &decoder->diag));
+
 #if defined(AVIF_CODEC_AVM)
         avifDecoderItem * tileItem = NULL;
         for (uint32_t itemIndex = 0; itemIndex < decoder->data->meta->items.count; ++itemIndex) {
@@ -6512,7 +7139,7 @@ static avifResult avifDecoderDecodeTiles(avifDecoder * decoder, uint32_t nextIma
             if (tileIndex == 0) {
                 AVIF_CHECKRES(avifDecoderDataAllocateImagePlanes(decoder->data, info, dstImage));
             }
-            AVIF_CHECKRES(avifDecoderDataCopyTileToImage(decoder->data, info, dstImage, tile, tileIndex));
+            AVIF_CHECKRES(avifDecoderDataCopyTileToImage(decoder->data, info, dstImage, tile, tileIndex, &decoder->diag));
         } else {
             AVIF_ASSERT_OR_RETURN(info->tileCount == 1);
             AVIF_ASSERT_OR_RETURN(tileIndex == 0);
@@ -7,13 +7,6 @@
 #include <stdint.h>
 #include <string.h>
 
-#if defined(_WIN32)
-#include <process.h>
-#include <windows.h>
-#else
-#include <pthread.h>
-#endif
-
 struct YUVBlock
 {
     float y;
@@ -172,13 +165,13 @@ static avifBool avifPrepareReformatState(const avifImage * image, const avifRGBI
 }
 
 // Formulas 20-31 from https://www.itu.int/rec/T-REC-H.273-201612-S
-static int avifYUVColorSpaceInfoYToUNorm(avifYUVColorSpaceInfo * info, float v)
+static int avifYUVColorSpaceInfoYToUNorm(const avifYUVColorSpaceInfo * info, float v)
 {
     int unorm = (int)avifRoundf(v * info->rangeY + info->biasY);
     return AVIF_CLAMP(unorm, 0, info->maxChannel);
 }
 
-static int avifYUVColorSpaceInfoUVToUNorm(avifYUVColorSpaceInfo * info, float v)
+static int avifYUVColorSpaceInfoUVToUNorm(const avifYUVColorSpaceInfo * info, float v)
 {
     int unorm;
 
@@ -196,47 +189,15 @@ static int avifYUVColorSpaceInfoUVToUNorm(avifYUVColorSpaceInfo * info, float v)
     return AVIF_CLAMP(unorm, 0, info->maxChannel);
 }
 
-avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
+// Converts the rows of image (which may be a band of rows of a taller image, starting on an even row) from rgb, unless
+// convertedWithLibSharpYUV, and reformats its alpha.
+static avifResult avifImageRGBToYUVImpl(avifImage * image,
+                                        const avifRGBImage * rgb,
+                                        const avifReformatState * state,
+                                        avifAlphaMultiplyMode alphaMode,
+                                        avifBool convertedWithLibSharpYUV)
 {
-    if (!rgb->pixels || rgb->format == AVIF_RGB_FORMAT_RGB_565) {
-        return AVIF_RESULT_REFORMAT_FAILED;
-    }
-
-    avifReformatState state;
-    if (!avifPrepareReformatState(image, rgb, &state)) {
-        return AVIF_RESULT_REFORMAT_FAILED;
-    }
-
-    if (rgb->isFloat) {
-        return AVIF_RESULT_NOT_IMPLEMENTED;
-    }
-
-    const avifBool hasAlpha = avifRGBFormatHasAlpha(rgb->format) && !rgb->ignoreAlpha;
-    avifResult allocationResult = avifImageAllocatePlanes(image, hasAlpha ? AVIF_PLANES_ALL : AVIF_PLANES_YUV);
-    if (allocationResult != AVIF_RESULT_OK) {
-        return allocationResult;
-    }
-
-    avifAlphaMultiplyMode alphaMode = AVIF_ALPHA_MULTIPLY_MODE_NO_OP;
-    if (hasAlpha) {
-        if (!rgb->alphaPremultiplied && image->alphaPremultiplied) {
-            alphaMode = AVIF_ALPHA_MULTIPLY_MODE_MULTIPLY;
-        } else if (rgb->alphaPremultiplied && !image->alphaPremultiplied) {
-            alphaMode = AVIF_ALPHA_MULTIPLY_MODE_UNMULTIPLY;
-        }
-    }
-
-    avifBool converted = AVIF_FALSE;
-
-    // Try converting with libsharpyuv.
-    if ((rgb->chromaDownsampling == AVIF_CHROMA_DOWNSAMPLING_SHARP_YUV) && (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420)) {
-        const avifResult libSharpYUVResult = avifImageRGBToYUVLibSharpYUV(image, rgb, &state);
-        if (libSharpYUVResult != AVIF_RESULT_OK) {
-            // Return the error if sharpyuv was requested but failed for any reason, including libsharpyuv not being available.
-            return libSharpYUVResult;
-        }
-        converted = AVIF_TRUE;
-    }
+    avifBool converted = convertedWithLibSharpYUV;
 
     if (!converted && !rgb->avoidLibYUV && (alphaMode == AVIF_ALPHA_MULTIPLY_MODE_NO_OP)) {
         avifResult libyuvResult = avifImageRGBToYUVLibYUV(image, rgb);
@@ -248,19 +209,19 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
     }
 
     if (!converted) {
-        const float kr = state.yuv.kr;
-        const float kg = state.yuv.kg;
-        const float kb = state.yuv.kb;
+        const float kr = state->yuv.kr;
+        const float kg = state->yuv.kg;
+        const float kb = state->yuv.kb;
 
         struct YUVBlock yuvBlock[2][2];
         float rgbPixel[3];
-        const uint32_t rgbPixelBytes = state.rgb.pixelBytes;
-        const uint32_t offsetBytesR = state.rgb.offsetBytesR;
-        const uint32_t offsetBytesG = state.rgb.offsetBytesG;
-        const uint32_t offsetBytesB = state.rgb.offsetBytesB;
-        const uint32_t offsetBytesA = state.rgb.offsetBytesA;
+        const uint32_t rgbPixelBytes = state->rgb.pixelBytes;
+        const uint32_t offsetBytesR = state->rgb.offsetBytesR;
+        const uint32_t offsetBytesG = state->rgb.offsetBytesG;
+        const uint32_t offsetBytesB = state->rgb.offsetBytesB;
+        const uint32_t offsetBytesA = state->rgb.offsetBytesA;
         const uint32_t rgbRowBytes = rgb->rowBytes;
-        const float rgbMaxChannelF = state.rgb.maxChannelF;
+        const float rgbMaxChannelF = state->rgb.maxChannelF;
         uint8_t * yPlane = image->yuvPlanes[AVIF_CHAN_Y];
         uint8_t * uPlane = image->yuvPlanes[AVIF_CHAN_U];
         uint8_t * vPlane = image->yuvPlanes[AVIF_CHAN_V];
@@ -284,7 +245,7 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
                         int j = outerJ + bJ;
 
                         // Unpack RGB into normalized float
-                        if (state.rgb.channelBytes > 1) {
+                        if (state->rgb.channelBytes > 1) {
                             rgbPixel[0] = *((uint16_t *)(&rgb->pixels[offsetBytesR + (i * rgbPixelBytes) + (j * rgbRowBytes)])) /
                                           rgbMaxChannelF;
                             rgbPixel[1] = *((uint16_t *)(&rgb->pixels[offsetBytesG + (i * rgbPixelBytes) + (j * rgbRowBytes)])) /
@@ -299,7 +260,7 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
 
                         if (alphaMode != AVIF_ALPHA_MULTIPLY_MODE_NO_OP) {
                             float a;
-                            if (state.rgb.channelBytes > 1) {
+                            if (state->rgb.channelBytes > 1) {
                                 a = *((uint16_t *)(&rgb->pixels[offsetBytesA + (i * rgbPixelBytes) + (j * rgbRowBytes)])) / rgbMaxChannelF;
                             } else {
                                 a = rgb->pixels[offsetBytesA + (i * rgbPixelBytes) + (j * rgbRowBytes)] / rgbMaxChannelF;
@@ -333,17 +294,17 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
                         }
 
                         // RGB -> YUV conversion
-                        if (state.yuv.mode == AVIF_REFORMAT_MODE_IDENTITY) {
+                        if (state->yuv.mode == AVIF_REFORMAT_MODE_IDENTITY) {
                             // Formulas 41,42,43 from https://www.itu.int/rec/T-REC-H.273-201612-S
                             yuvBlock[bI][bJ].y = rgbPixel[1]; // G
                             yuvBlock[bI][bJ].u = rgbPixel[2]; // B
                             yuvBlock[bI][bJ].v = rgbPixel[0]; // R
-                        } else if (state.yuv.mode == AVIF_REFORMAT_MODE_YCGCO) {
+                        } else if (state->yuv.mode == AVIF_REFORMAT_MODE_YCGCO) {
                             // Formulas 44,45,46 from https://www.itu.int/rec/T-REC-H.273-201612-S
                             yuvBlock[bI][bJ].y = 0.5f * rgbPixel[1] + 0.25f * (rgbPixel[0] + rgbPixel[2]);
                             yuvBlock[bI][bJ].u = 0.5f * rgbPixel[1] - 0.25f * (rgbPixel[0] + rgbPixel[2]);
                             yuvBlock[bI][bJ].v = 0.5f * (rgbPixel[0] - rgbPixel[2]);
-                        } else if (state.yuv.mode == AVIF_REFORMAT_MODE_YCGCO_RE || state.yuv.mode == AVIF_REFORMAT_MODE_YCGCO_RO) {
+                        } else if (state->yuv.mode == AVIF_REFORMAT_MODE_YCGCO_RE || state->yuv.mode == AVIF_REFORMAT_MODE_YCGCO_RO) {
                             // Formulas 58,59,60,61 from https://www.itu.int/rec/T-REC-H.273-202407-P
                             const int R = (int)avifRoundf(AVIF_CLAMP(rgbPixel[0] * rgbMaxChannelF, 0.0f, rgbMaxChannelF));
                             const int G = (int)avifRoundf(AVIF_CLAMP(rgbPixel[1] * rgbMaxChannelF, 0.0f, rgbMaxChannelF));
@@ -351,9 +312,9 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
                             const int Co = R - B;
                             const int t = B + (Co >> 1);
                             const int Cg = G - t;
-                            yuvBlock[bI][bJ].y = (t + (Cg >> 1)) / state.yuv.rangeY;
-                            yuvBlock[bI][bJ].u = Cg / state.yuv.rangeUV;
-                            yuvBlock[bI][bJ].v = Co / state.yuv.rangeUV;
+                            yuvBlock[bI][bJ].y = (t + (Cg >> 1)) / state->yuv.rangeY;
+                            yuvBlock[bI][bJ].u = Cg / state->yuv.rangeUV;
+                            yuvBlock[bI][bJ].v = Co / state->yuv.rangeUV;
                         } else {
                             float Y = (kr * rgbPixel[0]) + (kg * rgbPixel[1]) + (kb * rgbPixel[2]);
                             yuvBlock[bI][bJ].y = Y;
@@ -361,22 +322,22 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
                             yuvBlock[bI][bJ].v = (rgbPixel[0] - Y) / (2 * (1 - kr));
                         }
 
-                        if (state.yuv.channelBytes > 1) {
+                        if (state->yuv.channelBytes > 1) {
                             uint16_t * pY = (uint16_t *)&yPlane[(i * 2) + (j * yRowBytes)];
-                            *pY = (uint16_t)avifYUVColorSpaceInfoYToUNorm(&state.yuv, yuvBlock[bI][bJ].y);
+                            *pY = (uint16_t)avifYUVColorSpaceInfoYToUNorm(&state->yuv, yuvBlock[bI][bJ].y);
                             if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) {
                                 // YUV444, full chroma
                                 uint16_t * pU = (uint16_t *)&uPlane[(i * 2) + (j * uRowBytes)];
-                                *pU = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, yuvBlock[bI][bJ].u);
+                                *pU = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, yuvBlock[bI][bJ].u);
                                 uint16_t * pV = (uint16_t *)&vPlane[(i * 2) + (j * vRowBytes)];
-                                *pV = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, yuvBlock[bI][bJ].v);
+                                *pV = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, yuvBlock[bI][bJ].v);
                             }
                         } else {
-                            yPlane[i + (j * yRowBytes)] = (uint8_t)avifYUVColorSpaceInfoYToUNorm(&state.yuv, yuvBlock[bI][bJ].y);
+                            yPlane[i + (j * yRowBytes)] = (uint8_t)avifYUVColorSpaceInfoYToUNorm(&state->yuv, yuvBlock[bI][bJ].y);
                             if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) {
                                 // YUV444, full chroma
-                                uPlane[i + (j * uRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, yuvBlock[bI][bJ].u);
-                                vPlane[i + (j * vRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, yuvBlock[bI][bJ].v);
+                                uPlane[i + (j * uRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, yuvBlock[bI][bJ].u);
+                                vPlane[i + (j * vRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, yuvBlock[bI][bJ].v);
                             }
                         }
                     }
@@ -404,14 +365,14 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
                     const int chromaShiftY = 1;
                     int uvI = outerI >> chromaShiftX;
                     int uvJ = outerJ >> chromaShiftY;
-                    if (state.yuv.channelBytes > 1) {
+                    if (state->yuv.channelBytes > 1) {
                         uint16_t * pU = (uint16_t *)&uPlane[(uvI * 2) + (uvJ * uRowBytes)];
-                        *pU = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgU);
+                        *pU = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgU);
                         uint16_t * pV = (uint16_t *)&vPlane[(uvI * 2) + (uvJ * vRowBytes)];
-                        *pV = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgV);
+                        *pV = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgV);
                     } else {
-                        uPlane[uvI + (uvJ * uRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgU);
-                        vPlane[uvI + (uvJ * vRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgV);
+                        uPlane[uvI + (uvJ * uRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgU);
+                        vPlane[uvI + (uvJ * vRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgV);
                     }
                 } else if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422) {
                     // YUV422, average 2 samples (1x2), twice
@@ -430,14 +391,14 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
                         const int chromaShiftX = 1;
                         int uvI = outerI >> chromaShiftX;
                         int uvJ = outerJ + bJ;
-                        if (state.yuv.channelBytes > 1) {
+                        if (state->yuv.channelBytes > 1) {
                             uint16_t * pU = (uint16_t *)&uPlane[(uvI * 2) + (uvJ * uRowBytes)];
-                            *pU = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgU);
+                            *pU = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgU);
                             uint16_t * pV = (uint16_t *)&vPlane[(uvI * 2) + (uvJ * vRowBytes)];
-                            *pV = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgV);
+                            *pV = (uint16_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgV);
                         } else {
-                            uPlane[uvI + (uvJ * uRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgU);
-                            vPlane[uvI + (uvJ * vRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state.yuv, avgV);
+                            uPlane[uvI + (uvJ * uRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgU);
+                            vPlane[uvI + (uvJ * vRowBytes)] = (uint8_t)avifYUVColorSpaceInfoUVToUNorm(&state->yuv, avgV);
                         }
                     }
                 }
@@ -454,14 +415,14 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
         params.dstPlane = image->alphaPlane;
         params.dstRowBytes = image->alphaRowBytes;
         params.dstOffsetBytes = 0;
-        params.dstPixelBytes = state.yuv.channelBytes;
+        params.dstPixelBytes = state->yuv.channelBytes;
 
         if (avifRGBFormatHasAlpha(rgb->format) && !rgb->ignoreAlpha) {
             params.srcDepth = rgb->depth;
             params.srcPlane = rgb->pixels;
             params.srcRowBytes = rgb->rowBytes;
-            params.srcOffsetBytes = state.rgb.offsetBytesA;
-            params.srcPixelBytes = state.rgb.pixelBytes;
+            params.srcOffsetBytes = state->rgb.offsetBytesA;
+            params.srcPixelBytes = state->rgb.pixelBytes;
 
             avifReformatAlpha(&params);
         } else {
@@ -473,6 +434,122 @@ avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
     return AVIF_RESULT_OK;
 }
 
+typedef struct
+{
+    avifImage image;
+    avifRGBImage rgb;
+    avifResult result;
+} RGBToYUVBand;
+
+typedef struct
+{
+    RGBToYUVBand * bands;
+    const avifReformatState * state;
+    avifAlphaMultiplyMode alphaMode;
+    avifBool convertedWithLibSharpYUV;
+} RGBToYUVContext;
+
+static void avifImageRGBToYUVJob(void * context, uint32_t jobIndex)
+{
+    RGBToYUVContext * ctx = (RGBToYUVContext *)context;
+    RGBToYUVBand * band = &ctx->bands[jobIndex];
+    band->result = avifImageRGBToYUVImpl(&band->image, &band->rgb, ctx->state, ctx->alphaMode, ctx->convertedWithLibSharpYUV);
+}
+
+avifResult avifImageRGBToYUV(avifImage * image, const avifRGBImage * rgb)
+{
+    if (!rgb->pixels || rgb->format == AVIF_RGB_FORMAT_RGB_565) {
+        return AVIF_RESULT_REFORMAT_FAILED;
+    }
+
+    avifReformatState state;
+    if (!avifPrepareReformatState(image, rgb, &state)) {
+        return AVIF_RESULT_REFORMAT_FAILED;
+    }
+
+    if (rgb->isFloat) {
+        return AVIF_RESULT_NOT_IMPLEMENTED;
+    }
+
+    const avifBool hasAlpha = avifRGBFormatHasAlpha(rgb->format) && !rgb->ignoreAlpha;
+    avifResult allocationResult = avifImageAllocatePlanes(image, hasAlpha ? AVIF_PLANES_ALL : AVIF_PLANES_YUV);
+    if (allocationResult != AVIF_RESULT_OK) {
+        return allocationResult;
+    }
+
+    avifAlphaMultiplyMode alphaMode = AVIF_ALPHA_MULTIPLY_MODE_NO_OP;
+    if (hasAlpha) {
+        if (!rgb->alphaPremultiplied && image->alphaPremultiplied) {
+            alphaMode = AVIF_ALPHA_MULTIPLY_MODE_MULTIPLY;
+        } else if (rgb->alphaPremultiplied && !image->alphaPremultiplied) {
+            alphaMode = AVIF_ALPHA_MULTIPLY_MODE_UNMULTIPLY;
+        }
+    }
+
+    avifBool converted = AVIF_FALSE;
+
+    // Try converting with libsharpyuv.
+    if ((rgb->chromaDownsampling == AVIF_CHROMA_DOWNSAMPLING_SHARP_YUV) && (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420)) {
+        const avifResult libSharpYUVResult = avifImageRGBToYUVLibSharpYUV(image, rgb, &state);
+        if (libSharpYUVResult != AVIF_RESULT_OK) {
+            // Return the error if sharpyuv was requested but failed for any reason, including libsharpyuv not being available.
+            return libSharpYUVResult;
+        }
+        converted = AVIF_TRUE;
+    }
+
+    // In practice, we rarely need more than 8 threads for RGB to YUV conversion, like for YUV to RGB.
+    uint32_t jobs = AVIF_CLAMP(rgb->maxThreads, 1, 8);
+    // Each band needs at least 2 rows (to account for potential U/V subsampling).
+    if (jobs == 1 || (image->height / 2) < jobs) {
+        return avifImageRGBToYUVImpl(image, rgb, &state, alphaMode, converted);
+    }
+
+    // Bands start on even rows so that every 2x2 block of 4:2:0 chroma averaging lies in a single band, and the output
+    // is the same as with a single job.
+    uint32_t rowsPerJob = image->height / jobs;
+    if (rowsPerJob % 2) {
+        ++rowsPerJob;
+        jobs = (image->height + rowsPerJob - 1) / rowsPerJob; // ceil
+    }
+    const size_t byteCount = sizeof(RGBToYUVBand) * jobs;
+    RGBToYUVBand * bands = (RGBToYUVBand *)avifAlloc(byteCount);
+    if (!bands) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    memset(bands, 0, byteCount);
+    const uint32_t rowsForLastJob = image->height - rowsPerJob * (jobs - 1);
+    avifResult result = AVIF_RESULT_OK;
+    uint32_t startRow = 0;
+    for (uint32_t i = 0; i < jobs; ++i, startRow += rowsPerJob) {
+        RGBToYUVBand * band = &bands[i];
+        const avifCropRect rect = { .x = 0, .y = startRow, .width = image->width, .height = (i == jobs - 1) ? rowsForLastJob : rowsPerJob };
+        // The view shares the planes allocated above, every band writes its own rows.
+        if (avifImageSetViewRect(&band->image, image, &rect) != AVIF_RESULT_OK) {
+            result = AVIF_RESULT_REFORMAT_FAILED;
+            break;
+        }
+        band->rgb = *rgb;
+        band->rgb.maxThreads = 1;
+        band->rgb.pixels += startRow * (size_t)rgb->rowBytes;
+        band->rgb.height = band->image.height;
+    }
+
+    if (result == AVIF_RESULT_OK) {
+        RGBToYUVContext context = { bands, &state, alphaMode, converted };
+        if (!avifRunJobs(jobs, jobs, avifImageRGBToYUVJob, &context)) {
+            result = AVIF_RESULT_REFORMAT_FAILED;
+        }
+        for (uint32_t i = 0; i < jobs; ++i) {
+            if (bands[i].result != AVIF_RESULT_OK) {
+                result = bands[i].result;
+            }
+        }
+    }
+    avifFree(bands);
+    return result;
+}
+
 // Allocates and fills look-up tables for going from YUV limited/full unorm -> full range RGB FP32.
 // Review this when implementing YCgCo limited range support.
 static avifBool avifCreateYUVToRGBLookUpTables(float ** unormFloatTableY, float ** unormFloatTableUV, uint32_t depth, const avifReformatState * state)
@@ -549,11 +626,31 @@ static void avifGetRGB565(const uint8_t * ptrR, uint8_t * R, uint8_t * G, uint8_
     *B = (uint8_t)((b5 << 3) | (b5 >> 2));
 }
 
+// Bilinear chroma from the table values of the closest sample, of the adjacent samples on the same row and on the same
+// column, and of the diagonal sample. Shared by avifImageYUVAnyToRGBAnySlow() and avifImageYUVToRGBBilinear() so that
+// both evaluate (and round) the exact same expression.
+static inline float avifBilinearChroma(float closest, float adjacentCol, float adjacentRow, float diagonal)
+{
+    return (closest * (9.0f / 16.0f)) + (adjacentCol * (3.0f / 16.0f)) + (adjacentRow * (3.0f / 16.0f)) + (diagonal * (1.0f / 16.0f));
+}
+
+// Normal YUV to unclamped RGB, shared like avifBilinearChroma().
+static inline void avifYUVCoefficientsToRGB(float Y, float Cb, float Cr, float kr, float kg, float kb, float * R, float * G, float * B)
+{
+    *R = Y + (2 * (1 - kr)) * Cr;
+    *B = Y + (2 * (1 - kb)) * Cb;
+    *G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
+}
+
 // Note: This function handles alpha (un)multiply.
+// image may be a band of rows of a taller image, starting at row bandOffsetY of a image of sourceHeight rows. Its planes
+// must then point into the planes of the source image, as bilinear upsampling reads the chroma rows adjacent to the band.
 static avifResult avifImageYUVAnyToRGBAnySlow(const avifImage * image,
                                               avifRGBImage * rgb,
                                               const avifReformatState * state,
-                                              avifAlphaMultiplyMode alphaMultiplyMode)
+                                              avifAlphaMultiplyMode alphaMultiplyMode,
+                                              uint32_t bandOffsetY,
+                                              uint32_t sourceHeight)
 {
     // Aliases for some state
     const float kr = state->yuv.kr;
@@ -682,7 +779,10 @@ static avifResult avifImageYUVAnyToRGBAnySlow(const avifImage * image,
                     // For YUV422, uvJ will always be a fresh value (always corresponds to j), so
                     // we'll simply duplicate the sample as if we were on the top or bottom row and
                     // it'll behave as plain old linear (1D) upsampling, which is all we want.
-                    if ((j == 0) || ((j == (image->height - 1)) && ((j % 2) != 0)) || (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422)) {
+                    // Borders are those of the source image, bands start on an even row so the parity of j is unchanged.
+                    const uint32_t sourceJ = bandOffsetY + j;
+                    if ((sourceJ == 0) || ((sourceJ == (sourceHeight - 1)) && ((sourceJ % 2) != 0)) ||
+                        (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422)) {
                         uAdjRow = 0;
                         vAdjRow = 0;
                     } else {
@@ -695,24 +795,27 @@ static avifResult avifImageYUVAnyToRGBAnySlow(const avifImage * image,
                         }
                     }
 
+                    // Adjacent row offsets can be negative on the first row of a band, so index from the closest sample
+                    const uint8_t * uClosest = &uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes)];
+                    const uint8_t * vClosest = &vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes)];
                     if (image->depth == 8) {
-                        unormU[0][0] = uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes)];
-                        unormV[0][0] = vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes)];
-                        unormU[1][0] = uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes) + uAdjCol];
-                        unormV[1][0] = vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes) + vAdjCol];
-                        unormU[0][1] = uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes) + uAdjRow];
-                        unormV[0][1] = vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes) + vAdjRow];
-                        unormU[1][1] = uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes) + uAdjCol + uAdjRow];
-                        unormV[1][1] = vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes) + vAdjCol + vAdjRow];
+                        unormU[0][0] = uClosest[0];
+                        unormV[0][0] = vClosest[0];
+                        unormU[1][0] = uClosest[uAdjCol];
+                        unormV[1][0] = vClosest[vAdjCol];
+                        unormU[0][1] = uClosest[uAdjRow];
+                        unormV[0][1] = vClosest[vAdjRow];
+                        unormU[1][1] = uClosest[uAdjCol + uAdjRow];
+                        unormV[1][1] = vClosest[vAdjCol + vAdjRow];
                     } else {
-                        unormU[0][0] = *((const uint16_t *)&uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes)]);
-                        unormV[0][0] = *((const uint16_t *)&vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes)]);
-                        unormU[1][0] = *((const uint16_t *)&uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes) + uAdjCol]);
-                        unormV[1][0] = *((const uint16_t *)&vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes) + vAdjCol]);
-                        unormU[0][1] = *((const uint16_t *)&uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes) + uAdjRow]);
-                        unormV[0][1] = *((const uint16_t *)&vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes) + vAdjRow]);
-                        unormU[1][1] = *((const uint16_t *)&uPlane[(uvJ * uRowBytes) + (uvI * yuvChannelBytes) + uAdjCol + uAdjRow]);
-                        unormV[1][1] = *((const uint16_t *)&vPlane[(uvJ * vRowBytes) + (uvI * yuvChannelBytes) + vAdjCol + vAdjRow]);
+                        unormU[0][0] = *((const uint16_t *)uClosest);
+                        unormV[0][0] = *((const uint16_t *)vClosest);
+                        unormU[1][0] = *((const uint16_t *)&uClosest[uAdjCol]);
+                        unormV[1][0] = *((const uint16_t *)&vClosest[vAdjCol]);
+                        unormU[0][1] = *((const uint16_t *)&uClosest[uAdjRow]);
+                        unormV[0][1] = *((const uint16_t *)&vClosest[vAdjRow]);
+                        unormU[1][1] = *((const uint16_t *)&uClosest[uAdjCol + uAdjRow]);
+                        unormV[1][1] = *((const uint16_t *)&vClosest[vAdjCol + vAdjRow]);
 
                         // clamp incoming data to protect against bad LUT lookups
                         for (int bJ = 0; bJ < 2; ++bJ) {
@@ -730,10 +833,14 @@ static avifResult avifImageYUVAnyToRGBAnySlow(const avifImage * image,
                         Cr = unormFloatTableUV[unormV[0][0]];
                     } else {
                         // Bilinear filtering with weights
-                        Cb = (unormFloatTableUV[unormU[0][0]] * (9.0f / 16.0f)) + (unormFloatTableUV[unormU[1][0]] * (3.0f / 16.0f)) +
-                             (unormFloatTableUV[unormU[0][1]] * (3.0f / 16.0f)) + (unormFloatTableUV[unormU[1][1]] * (1.0f / 16.0f));
-                        Cr = (unormFloatTableUV[unormV[0][0]] * (9.0f / 16.0f)) + (unormFloatTableUV[unormV[1][0]] * (3.0f / 16.0f)) +
-                             (unormFloatTableUV[unormV[0][1]] * (3.0f / 16.0f)) + (unormFloatTableUV[unormV[1][1]] * (1.0f / 16.0f));
+                        Cb = avifBilinearChroma(unormFloatTableUV[unormU[0][0]],
+                                                unormFloatTableUV[unormU[1][0]],
+                                                unormFloatTableUV[unormU[0][1]],
+                                                unormFloatTableUV[unormU[1][1]]);
+                        Cr = avifBilinearChroma(unormFloatTableUV[unormV[0][0]],
+                                                unormFloatTableUV[unormV[1][0]],
+                                                unormFloatTableUV[unormV[0][1]],
+                                                unormFloatTableUV[unormV[1][1]]);
                     }
                 }
             }
@@ -765,9 +872,7 @@ static avifResult avifImageYUVAnyToRGBAnySlow(const avifImage * image,
                     R /= rgbMaxChannelF;
                 } else {
                     // Normal YUV
-                    R = Y + (2 * (1 - kr)) * Cr;
-                    B = Y + (2 * (1 - kb)) * Cb;
-                    G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
+                    avifYUVCoefficientsToRGB(Y, Cb, Cr, kr, kg, kb, &R, &G, &B);
                 }
             } else {
                 // Monochrome: just populate all channels with luma (state->yuv.mode is irrelevant)
@@ -1269,6 +1374,221 @@ static avifResult avifImageYUV8ToRGB8Mono(const avifImage * image, avifRGBImage
     return AVIF_RESULT_OK;
 }
 
+// YUV to RGB conversion with bilinear chroma upsampling, for the 4:2:0 and 4:2:2 images that the float fast paths above
+// leave to avifImageYUVAnyToRGBAnySlow(). The output is the same as the slow path, byte for byte: it reads the same
+// samples through the same tables, with the same weights and border rules, and evaluates the same float expressions
+// through avifBilinearChroma() and avifYUVCoefficientsToRGB(). It only saves the per-pixel branches on the depth, RGB
+// format, matrix and upsampling, and the table look-ups of the chroma samples, done once per chroma column of a row
+// instead of four times per pixel. The kernels below are instantiated for each sample size and RGB pixel store.
+// Still converted by avifImageYUVAnyToRGBAnySlow():
+//   - the identity and YCgCo (including YCgCo-Re and YCgCo-Ro) matrix coefficients,
+//   - alpha multiply or unmultiply, which the slow path applies before rounding.
+
+typedef struct avifYUVToRGBBilinear
+{
+    const float * unormFloatTableY;
+    const float * unormFloatTableUV;
+    float kr;
+    float kg;
+    float kb;
+    float rgbMaxChannelF;
+    uint16_t yuvMaxChannel;
+    uint32_t lastChromaX;
+    float * uColumns; // Table values of the closest chroma row, per chroma column.
+    float * vColumns;
+    float * uAdjColumns; // Table values of the adjacent chroma row, per chroma column.
+    float * vAdjColumns;
+} avifYUVToRGBBilinear;
+
+#define AVIF_YUV_SAMPLE_8(row, i) (((const uint8_t *)(row))[i])
+// Clamps incoming data like avifImageYUVAnyToRGBAnySlow().
+#define AVIF_YUV_SAMPLE_16(row, i) AVIF_MIN(((const uint16_t *)(row))[i], yuvMaxChannel)
+
+// Same rounding as avifImageYUVAnyToRGBAnySlow().
+#define AVIF_STORE_RGB_8(R, G, B)                                        \
+    avifStoreRGB8Pixel(AVIF_RGB_FORMAT_RGB,                              \
+                       (uint8_t)(0.5f + ((R) * rgbMaxChannelF)),         \
+                       (uint8_t)(0.5f + ((G) * rgbMaxChannelF)),         \
+                       (uint8_t)(0.5f + ((B) * rgbMaxChannelF)),         \
+                       ptrR,                                             \
+                       ptrG,                                             \
+                       ptrB)
+#define AVIF_STORE_RGB_565(R, G, B)                                      \
+    avifStoreRGB8Pixel(AVIF_RGB_FORMAT_RGB_565,                          \
+                       (uint8_t)(0.5f + ((R) * rgbMaxChannelF)),         \
+                       (uint8_t)(0.5f + ((G) * rgbMaxChannelF)),         \
+                       (uint8_t)(0.5f + ((B) * rgbMaxChannelF)),         \
+                       ptrR,                                             \
+                       ptrG,                                             \
+                       ptrB)
+#define AVIF_STORE_RGB_16(R, G, B)                                              \
+    do {                                                                        \
+        *((uint16_t *)ptrR) = (uint16_t)(0.5f + ((R) * rgbMaxChannelF));        \
+        *((uint16_t *)ptrG) = (uint16_t)(0.5f + ((G) * rgbMaxChannelF));        \
+        *((uint16_t *)ptrB) = (uint16_t)(0.5f + ((B) * rgbMaxChannelF));        \
+    } while (0)
+
+typedef void (*avifYUVToRGBBilinearRowFunc)(const avifYUVToRGBBilinear * ctx,
+                                            uint32_t width,
+                                            const uint8_t * yRow,
+                                            const uint8_t * uRow,
+                                            const uint8_t * vRow,
+                                            const uint8_t * uAdjRow,
+                                            const uint8_t * vAdjRow,
+                                            uint8_t * ptrR,
+                                            uint8_t * ptrG,
+                                            uint8_t * ptrB,
+                                            uint32_t rgbPixelBytes);
+
+// Converts pixel i, of chroma column x, in AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW().
+#define AVIF_YUV_TO_RGB_BILINEAR_PIXEL(SAMPLE, STORE, i, adjacentX)                                                     \
+    do {                                                                                                                \
+        const float Cb = avifBilinearChroma(uColumns[x], uColumns[adjacentX], uAdjColumns[x], uAdjColumns[adjacentX]);  \
+        const float Cr = avifBilinearChroma(vColumns[x], vColumns[adjacentX], vAdjColumns[x], vAdjColumns[adjacentX]);  \
+        float R, G, B;                                                                                                  \
+        avifYUVCoefficientsToRGB(unormFloatTableY[SAMPLE(yRow, i)], Cb, Cr, kr, kg, kb, &R, &G, &B);                    \
+        const float Rc = AVIF_CLAMP(R, 0.0f, 1.0f);                                                                     \
+        const float Gc = AVIF_CLAMP(G, 0.0f, 1.0f);                                                                     \
+        const float Bc = AVIF_CLAMP(B, 0.0f, 1.0f);                                                                     \
+        STORE(Rc, Gc, Bc);                                                                                              \
+        ptrR += rgbPixelBytes;                                                                                          \
+        ptrG += rgbPixelBytes;                                                                                          \
+        ptrB += rgbPixelBytes;                                                                                          \
+    } while (0)
+
+// Both pixels of chroma column x are converted together: the horizontally adjacent column is the previous one for the
+// even pixel and the next one for the odd pixel, and is x itself on the image borders, like in
+// avifImageYUVAnyToRGBAnySlow().
+#define AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(NAME, SAMPLE, STORE)                                                        \
+    static void NAME(const avifYUVToRGBBilinear * ctx,                                                                  \
+                     uint32_t width,                                                                                    \
+                     const uint8_t * yRow,                                                                              \
+                     const uint8_t * uRow,                                                                              \
+                     const uint8_t * vRow,                                                                              \
+                     const uint8_t * uAdjRow,                                                                           \
+                     const uint8_t * vAdjRow,                                                                           \
+                     uint8_t * ptrR,                                                                                    \
+                     uint8_t * ptrG,                                                                                    \
+                     uint8_t * ptrB,                                                                                    \
+                     uint32_t rgbPixelBytes)                                                                            \
+    {                                                                                                                   \
+        /* Local copies, as the compiler cannot assume that the RGB stores leave *ctx unchanged. */                     \
+        const float * const unormFloatTableY = ctx->unormFloatTableY;                                                   \
+        const float * const unormFloatTableUV = ctx->unormFloatTableUV;                                                 \
+        const float kr = ctx->kr;                                                                                       \
+        const float kg = ctx->kg;                                                                                       \
+        const float kb = ctx->kb;                                                                                       \
+        const float rgbMaxChannelF = ctx->rgbMaxChannelF;                                                               \
+        const uint16_t yuvMaxChannel = ctx->yuvMaxChannel;                                                              \
+        const uint32_t lastChromaX = ctx->lastChromaX;                                                                  \
+        float * const uColumns = ctx->uColumns;                                                                         \
+        float * const vColumns = ctx->vColumns;                                                                         \
+        float * const uAdjColumns = ctx->uAdjColumns;                                                                   \
+        float * const vAdjColumns = ctx->vAdjColumns;                                                                   \
+        (void)yuvMaxChannel;                                                                                            \
+        for (uint32_t x = 0; x <= lastChromaX; ++x) {                                                                   \
+            uColumns[x] = unormFloatTableUV[SAMPLE(uRow, x)];                                                           \
+            vColumns[x] = unormFloatTableUV[SAMPLE(vRow, x)];                                                           \
+            uAdjColumns[x] = unormFloatTableUV[SAMPLE(uAdjRow, x)];                                                     \
+            vAdjColumns[x] = unormFloatTableUV[SAMPLE(vAdjRow, x)];                                                     \
+        }                                                                                                               \
+        for (uint32_t x = 0; x <= lastChromaX; ++x) {                                                                   \
+            AVIF_YUV_TO_RGB_BILINEAR_PIXEL(SAMPLE, STORE, 2 * x, (x == 0) ? 0 : x - 1);                                 \
+            if (2 * x + 1 < width) {                                                                                    \
+                AVIF_YUV_TO_RGB_BILINEAR_PIXEL(SAMPLE, STORE, 2 * x + 1, (x == lastChromaX) ? x : x + 1);               \
+            }                                                                                                           \
+        }                                                                                                               \
+    }
+
+AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(avifYUV8ToRGB8BilinearRow, AVIF_YUV_SAMPLE_8, AVIF_STORE_RGB_8)
+AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(avifYUV8ToRGB565BilinearRow, AVIF_YUV_SAMPLE_8, AVIF_STORE_RGB_565)
+AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(avifYUV8ToRGB16BilinearRow, AVIF_YUV_SAMPLE_8, AVIF_STORE_RGB_16)
+AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(avifYUV16ToRGB8BilinearRow, AVIF_YUV_SAMPLE_16, AVIF_STORE_RGB_8)
+AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(avifYUV16ToRGB565BilinearRow, AVIF_YUV_SAMPLE_16, AVIF_STORE_RGB_565)
+AVIF_DEFINE_YUV_TO_RGB_BILINEAR_ROW(avifYUV16ToRGB16BilinearRow, AVIF_YUV_SAMPLE_16, AVIF_STORE_RGB_16)
+
+// image may be a band of rows, see avifImageYUVAnyToRGBAnySlow().
+static avifResult avifImageYUVToRGBBilinear(const avifImage * image,
+                                            avifRGBImage * rgb,
+                                            const avifReformatState * state,
+                                            uint32_t bandOffsetY,
+                                            uint32_t sourceHeight)
+{
+    assert(state->yuv.mode == AVIF_REFORMAT_MODE_YUV_COEFFICIENTS);
+    assert(image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420 || image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422);
+
+    avifYUVToRGBBilinearRowFunc rowFunc;
+    if (image->depth == 8) {
+        rowFunc = (rgb->depth > 8)                            ? avifYUV8ToRGB16BilinearRow
+                  : (rgb->format == AVIF_RGB_FORMAT_RGB_565) ? avifYUV8ToRGB565BilinearRow
+                                                              : avifYUV8ToRGB8BilinearRow;
+    } else {
+        rowFunc = (rgb->depth > 8)                            ? avifYUV16ToRGB16BilinearRow
+                  : (rgb->format == AVIF_RGB_FORMAT_RGB_565) ? avifYUV16ToRGB565BilinearRow
+                                                              : avifYUV16ToRGB8BilinearRow;
+    }
+
+    float * unormFloatTableY = NULL;
+    float * unormFloatTableUV = NULL;
+    AVIF_CHECKERR(avifCreateYUVToRGBLookUpTables(&unormFloatTableY, &unormFloatTableUV, image->depth, state), AVIF_RESULT_OUT_OF_MEMORY);
+    avifYUVToRGBBilinear ctx;
+    ctx.unormFloatTableY = unormFloatTableY;
+    ctx.unormFloatTableUV = unormFloatTableUV;
+    ctx.kr = state->yuv.kr;
+    ctx.kg = state->yuv.kg;
+    ctx.kb = state->yuv.kb;
+    ctx.rgbMaxChannelF = state->rgb.maxChannelF;
+    ctx.yuvMaxChannel = (uint16_t)state->yuv.maxChannel;
+    ctx.lastChromaX = ((image->width + 1) >> 1) - 1;
+    const size_t chromaWidth = (size_t)ctx.lastChromaX + 1;
+    ctx.uColumns = (float *)avifAlloc(4 * chromaWidth * sizeof(float));
+    if (ctx.uColumns == NULL) {
+        avifFreeYUVToRGBLookUpTables(&unormFloatTableY, &unormFloatTableUV);
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    ctx.vColumns = &ctx.uColumns[chromaWidth];
+    ctx.uAdjColumns = &ctx.uColumns[2 * chromaWidth];
+    ctx.vAdjColumns = &ctx.uColumns[3 * chromaWidth];
+
+    const uint32_t uRowBytes = image->yuvRowBytes[AVIF_CHAN_U];
+    const uint32_t vRowBytes = image->yuvRowBytes[AVIF_CHAN_V];
+    for (uint32_t j = 0; j < image->height; ++j) {
+        const uint32_t uvJ = j >> state->yuv.formatInfo.chromaShiftY;
+        const uint8_t * uRow = &image->yuvPlanes[AVIF_CHAN_U][(size_t)uvJ * uRowBytes];
+        const uint8_t * vRow = &image->yuvPlanes[AVIF_CHAN_V][(size_t)uvJ * vRowBytes];
+        // Same adjacent chroma row as avifImageYUVAnyToRGBAnySlow(): none for 4:2:2 and on the borders of the source
+        // image, the next one on odd rows and the previous one on even rows. Bands start on an even row.
+        const uint32_t sourceJ = bandOffsetY + j;
+        const uint8_t * uAdjRow = uRow;
+        const uint8_t * vAdjRow = vRow;
+        if ((sourceJ != 0) && !((sourceJ == (sourceHeight - 1)) && ((sourceJ % 2) != 0)) &&
+            (image->yuvFormat != AVIF_PIXEL_FORMAT_YUV422)) {
+            if ((j % 2) != 0) {
+                uAdjRow += uRowBytes;
+                vAdjRow += vRowBytes;
+            } else {
+                uAdjRow -= uRowBytes;
+                vAdjRow -= vRowBytes;
+            }
+        }
+        uint8_t * rgbRow = &rgb->pixels[(size_t)j * rgb->rowBytes];
+        rowFunc(&ctx,
+                image->width,
+                &image->yuvPlanes[AVIF_CHAN_Y][(size_t)j * image->yuvRowBytes[AVIF_CHAN_Y]],
+                uRow,
+                vRow,
+                uAdjRow,
+                vAdjRow,
+                &rgbRow[state->rgb.offsetBytesR],
+                &rgbRow[state->rgb.offsetBytesG],
+                &rgbRow[state->rgb.offsetBytesB],
+                state->rgb.pixelBytes);
+    }
+    avifFree(ctx.uColumns);
+    avifFreeYUVToRGBLookUpTables(&unormFloatTableY, &unormFloatTableUV);
+    return AVIF_RESULT_OK;
+}
+
 // This constant comes from libyuv. For details, see here:
 // https://chromium.googlesource.com/libyuv/libyuv/+/2f87e9a7/source/row_common.cc#3537
 #define F16_MULTIPLIER 1.9259299444e-34f
@@ -1305,7 +1625,12 @@ static avifResult avifRGBImageToF16(avifRGBImage * rgb)
     return AVIF_RESULT_OK;
 }
 
-static avifResult avifImageYUVToRGBImpl(const avifImage * image, avifRGBImage * rgb, avifReformatState * state, avifAlphaMultiplyMode alphaMultiplyMode)
+static avifResult avifImageYUVToRGBImpl(const avifImage * image,
+                                        avifRGBImage * rgb,
+                                        avifReformatState * state,
+                                        avifAlphaMultiplyMode alphaMultiplyMode,
+                                        uint32_t bandOffsetY,
+                                        uint32_t sourceHeight)
 {
     avifBool convertedWithLibYUV = AVIF_FALSE;
     // Reformat alpha, if user asks for it, or (un)multiply processing needs it.
@@ -1420,9 +1745,17 @@ static avifResult avifImageYUVToRGBImpl(const avifImage * image, avifRGBImage *
             }
         }
 
+        if ((convertResult == AVIF_RESULT_NOT_IMPLEMENTED) && hasColor &&
+            (state->yuv.mode == AVIF_REFORMAT_MODE_YUV_COEFFICIENTS) &&
+            ((image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) || (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422)) &&
+            (rgb->chromaUpsampling != AVIF_CHROMA_UPSAMPLING_FASTEST) && (rgb->chromaUpsampling != AVIF_CHROMA_UPSAMPLING_NEAREST) &&
+            (alphaMultiplyMode == AVIF_ALPHA_MULTIPLY_MODE_NO_OP)) {
+            convertResult = avifImageYUVToRGBBilinear(image, rgb, state, bandOffsetY, sourceHeight);
+        }
+
         if (convertResult == AVIF_RESULT_NOT_IMPLEMENTED) {
             // If we get here, there is no fast path for this combination. Time to be slow!
-            convertResult = avifImageYUVAnyToRGBAnySlow(image, rgb, state, alphaMultiplyMode);
+            convertResult = avifImageYUVAnyToRGBAnySlow(image, rgb, state, alphaMultiplyMode, bandOffsetY, sourceHeight);
 
             // The slow path also handles alpha (un)multiply, so forget the operation here.
             alphaMultiplyMode = AVIF_ALPHA_MULTIPLY_MODE_NO_OP;
@@ -1456,57 +1789,26 @@ static avifResult avifImageYUVToRGBImpl(const avifImage * image, avifRGBImage *
 
 typedef struct
 {
-#if defined(_WIN32)
-    HANDLE thread;
-#else
-    pthread_t thread;
-#endif
     avifImage image;
     avifRGBImage rgb;
-    avifReformatState * state;
-    avifAlphaMultiplyMode alphaMultiplyMode;
     avifResult result;
-    avifBool threadCreated;
-} YUVToRGBThreadData;
-
-#if defined(_WIN32)
-static unsigned int __stdcall avifImageYUVToRGBThreadWorker(void * arg)
-#else
-static void * avifImageYUVToRGBThreadWorker(void * arg)
-#endif
-{
-    YUVToRGBThreadData * data = (YUVToRGBThreadData *)arg;
-    data->result = avifImageYUVToRGBImpl(&data->image, &data->rgb, data->state, data->alphaMultiplyMode);
-#if defined(_WIN32)
-    return 0;
-#else
-    return NULL;
-#endif
-}
+} YUVToRGBBand;
 
-static avifBool avifCreateYUVToRGBThread(YUVToRGBThreadData * tdata)
+typedef struct
 {
-#if defined(_WIN32)
-    tdata->thread = (HANDLE)_beginthreadex(/*security=*/NULL,
-                                           /*stack_size=*/0,
-                                           &avifImageYUVToRGBThreadWorker,
-                                           tdata,
-                                           /*initflag=*/0,
-                                           /*thrdaddr=*/NULL);
-    return tdata->thread != NULL;
-#else
-    // TODO: Set the thread name for ease of debugging.
-    return pthread_create(&tdata->thread, NULL, &avifImageYUVToRGBThreadWorker, tdata) == 0;
-#endif
-}
+    YUVToRGBBand * bands;
+    uint32_t rowsPerBand;
+    uint32_t sourceHeight;
+    avifReformatState * state;
+    avifAlphaMultiplyMode alphaMultiplyMode;
+} YUVToRGBContext;
 
-static avifBool avifJoinYUVToRGBThread(YUVToRGBThreadData * tdata)
+static void avifImageYUVToRGBJob(void * context, uint32_t jobIndex)
 {
-#if defined(_WIN32)
-    return WaitForSingleObject(tdata->thread, INFINITE) == WAIT_OBJECT_0 && CloseHandle(tdata->thread) != 0;
-#else
-    return pthread_join(tdata->thread, NULL) == 0;
-#endif
+    YUVToRGBContext * ctx = (YUVToRGBContext *)context;
+    YUVToRGBBand * band = &ctx->bands[jobIndex];
+    band->result =
+        avifImageYUVToRGBImpl(&band->image, &band->rgb, ctx->state, ctx->alphaMultiplyMode, jobIndex * ctx->rowsPerBand, ctx->sourceHeight);
 }
 
 avifResult avifImageYUVToRGB(const avifImage * image, avifRGBImage * rgb)
@@ -1542,71 +1844,63 @@ avifResult avifImageYUVToRGB(const avifImage * image, avifRGBImage * rgb)
     // In practice, we rarely need more than 8 threads for YUV to RGB conversion.
     uint32_t jobs = AVIF_CLAMP(rgb->maxThreads, 1, 8);
 
-    // When yuv format is 420 and chromaUpsampling could be BILINEAR, there is a dependency across the horizontal borders of each
-    // job. So we disallow multithreading in that case.
-    if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420 && (rgb->chromaUpsampling == AVIF_CHROMA_UPSAMPLING_AUTOMATIC ||
-                                                         rgb->chromaUpsampling == AVIF_CHROMA_UPSAMPLING_BEST_QUALITY ||
-                                                         rgb->chromaUpsampling == AVIF_CHROMA_UPSAMPLING_BILINEAR)) {
+#if defined(AVIF_LIBYUV_ENABLED)
+    // libyuv upsamples 4:2:0 chroma of every band on its own, clamping at the band borders, so bands would not match the
+    // output of a single job. The built-in bilinear path reads the chroma rows adjacent to each band instead.
+    if (!rgb->avoidLibYUV && image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420 &&
+        (rgb->chromaUpsampling == AVIF_CHROMA_UPSAMPLING_AUTOMATIC || rgb->chromaUpsampling == AVIF_CHROMA_UPSAMPLING_BEST_QUALITY ||
+         rgb->chromaUpsampling == AVIF_CHROMA_UPSAMPLING_BILINEAR)) {
         jobs = 1;
     }
+#endif
 
-    // Each thread worker needs at least 2 Y rows (to account for potential U/V subsampling).
+    // Each band needs at least 2 Y rows (to account for potential U/V subsampling).
     if (jobs == 1 || (image->height / 2) < jobs) {
-        return avifImageYUVToRGBImpl(image, rgb, &state, alphaMultiplyMode);
+        return avifImageYUVToRGBImpl(image, rgb, &state, alphaMultiplyMode, 0, image->height);
     }
 
-    const size_t byteCount = sizeof(YUVToRGBThreadData) * jobs;
-    YUVToRGBThreadData * threadData = (YUVToRGBThreadData *)avifAlloc(byteCount);
-    if (!threadData) {
-        return AVIF_RESULT_OUT_OF_MEMORY;
-    }
-    memset(threadData, 0, byteCount);
+    // Bands start on even rows so that every band begins with its own chroma row, and bilinear upsampling at a band
+    // border reads the neighbouring chroma row of the source planes, exactly like a single job does.
     uint32_t rowsPerJob = image->height / jobs;
     if (rowsPerJob % 2) {
         ++rowsPerJob;
         jobs = (image->height + rowsPerJob - 1) / rowsPerJob; // ceil
     }
+    const size_t byteCount = sizeof(YUVToRGBBand) * jobs;
+    YUVToRGBBand * bands = (YUVToRGBBand *)avifAlloc(byteCount);
+    if (!bands) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    memset(bands, 0, byteCount);
     const uint32_t rowsForLastJob = image->height - rowsPerJob * (jobs - 1);
+    avifResult result = AVIF_RESULT_OK;
     uint32_t startRow = 0;
-    uint32_t i;
-    for (i = 0; i < jobs; ++i, startRow += rowsPerJob) {
-        YUVToRGBThreadData * tdata = &threadData[i];
+    for (uint32_t i = 0; i < jobs; ++i, startRow += rowsPerJob) {
+        YUVToRGBBand * band = &bands[i];
         const avifCropRect rect = { .x = 0, .y = startRow, .width = image->width, .height = (i == jobs - 1) ? rowsForLastJob : rowsPerJob };
-        if (avifImageSetViewRect(&tdata->image, image, &rect) != AVIF_RESULT_OK) {
-            tdata->result = AVIF_RESULT_REFORMAT_FAILED;
+        if (avifImageSetViewRect(&band->image, image, &rect) != AVIF_RESULT_OK) {
+            result = AVIF_RESULT_REFORMAT_FAILED;
             break;
         }
-
-        tdata->rgb = *rgb;
-        tdata->rgb.pixels += startRow * (size_t)rgb->rowBytes;
-        tdata->rgb.height = tdata->image.height;
-
-        tdata->state = &state;
-        tdata->alphaMultiplyMode = alphaMultiplyMode;
-
-        if (i > 0) {
-            tdata->threadCreated = avifCreateYUVToRGBThread(tdata);
-            if (!tdata->threadCreated) {
-                tdata->result = AVIF_RESULT_REFORMAT_FAILED;
-                break;
-            }
-        }
-    }
-    // If above loop ran successfully, run the first job in the current thread.
-    if (i == jobs) {
-        avifImageYUVToRGBThreadWorker(&threadData[0]);
+        band->rgb = *rgb;
+        // Bands already run on their own threads, alpha (un)multiply of a band must not start more.
+        band->rgb.maxThreads = 1;
+        band->rgb.pixels += startRow * (size_t)rgb->rowBytes;
+        band->rgb.height = band->image.height;
     }
-    avifResult result = AVIF_RESULT_OK;
-    for (i = 0; i < jobs; ++i) {
-        YUVToRGBThreadData * tdata = &threadData[i];
-        if (tdata->threadCreated && !avifJoinYUVToRGBThread(tdata)) {
+
+    if (result == AVIF_RESULT_OK) {
+        YUVToRGBContext context = { bands, rowsPerJob, image->height, &state, alphaMultiplyMode };
+        if (!avifRunJobs(jobs, jobs, avifImageYUVToRGBJob, &context)) {
             result = AVIF_RESULT_REFORMAT_FAILED;
         }
-        if (tdata->result != AVIF_RESULT_OK) {
-            result = tdata->result;
+        for (uint32_t i = 0; i < jobs; ++i) {
+            if (bands[i].result != AVIF_RESULT_OK) {
+                result = bands[i].result;
+            }
         }
     }
-    avifFree(threadData);
+    avifFree(bands);
     return result;
 }
 
@@ -331,15 +331,32 @@ avifBool avifROStreamReadAndEnforceVersion(avifROStream * stream, uint8_t enforc
 // ---------------------------------------------------------------------------
 // avifRWStream
 
+// stream->raw->size is the capacity of the stream, stream->offset is the amount of bytes written so far.
+// avifRWStreamFinishWrite() trims the capacity down to the written size.
 #define AVIF_STREAM_BUFFER_INCREMENT (1024 * 1024)
 static avifResult makeRoom(avifRWStream * stream, size_t size)
 {
-    size_t neededSize = stream->offset + size;
-    size_t newSize = stream->raw->size;
-    while (newSize < neededSize) {
-        newSize += AVIF_STREAM_BUFFER_INCREMENT;
+    AVIF_CHECKERR(size <= SIZE_MAX - stream->offset, AVIF_RESULT_OUT_OF_MEMORY);
+    const size_t neededSize = stream->offset + size;
+    if (neededSize <= stream->raw->size) {
+        return AVIF_RESULT_OK;
     }
-    return avifRWDataRealloc(stream->raw, newSize);
+    // Grow by half of the current capacity so large outputs are copied a logarithmic amount of times,
+    // small streams keep growing by whole increments.
+    size_t growth = AVIF_MAX(stream->raw->size / 2, AVIF_STREAM_BUFFER_INCREMENT);
+    if (growth > SIZE_MAX - stream->raw->size) {
+        growth = SIZE_MAX - stream->raw->size;
+    }
+    return avifRWDataRealloc(stream->raw, AVIF_MAX(neededSize, stream->raw->size + growth));
+}
+
+avifResult avifRWStreamReserve(avifRWStream * stream, size_t size)
+{
+    AVIF_CHECKERR(size <= SIZE_MAX - stream->offset, AVIF_RESULT_OUT_OF_MEMORY);
+    if (stream->offset + size > stream->raw->size) {
+        return avifRWDataRealloc(stream->raw, stream->offset + size);
+    }
+    return AVIF_RESULT_OK;
 }
 
 void avifRWStreamStart(avifRWStream * stream, avifRWData * raw)
@@ -366,7 +383,12 @@ void avifRWStreamFinishWrite(avifRWStream * stream)
 {
     if (stream->raw->size != stream->offset) {
         if (stream->offset) {
-            stream->raw->size = stream->offset;
+            const size_t unusedSize = stream->raw->size - stream->offset;
+            // Give back large overestimates of the output size, shrinking the buffer costs a copy so a smaller slack is kept
+            if ((unusedSize <= AVIF_STREAM_BUFFER_INCREMENT) || (unusedSize <= stream->offset / 4) ||
+                (avifRWDataRealloc(stream->raw, stream->offset) != AVIF_RESULT_OK)) {
+                stream->raw->size = stream->offset;
+            }
         } else {
             avifRWDataFree(stream->raw);
         }
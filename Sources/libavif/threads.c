@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "avif/internal.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#include <process.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+// Jobs are handed out one index at a time, so a slow job (e.g. a tile with more detail) does not stall a statically
+// assigned range of other jobs.
+typedef struct avifJobQueue
+{
+#if defined(_WIN32)
+    CRITICAL_SECTION mutex;
+#else
+    pthread_mutex_t mutex;
+#endif
+    uint32_t nextJob;
+    uint32_t jobCount;
+    avifJobFunc func;
+    void * context;
+} avifJobQueue;
+
+typedef struct avifJobThread
+{
+#if defined(_WIN32)
+    HANDLE thread;
+#else
+    pthread_t thread;
+#endif
+    avifJobQueue * queue;
+    avifBool threadCreated;
+} avifJobThread;
+
+static avifBool avifJobQueueNext(avifJobQueue * queue, uint32_t * jobIndex)
+{
+#if defined(_WIN32)
+    EnterCriticalSection(&queue->mutex);
+#else
+    pthread_mutex_lock(&queue->mutex);
+#endif
+    const avifBool hasJob = queue->nextJob < queue->jobCount;
+    if (hasJob) {
+        *jobIndex = queue->nextJob++;
+    }
+#if defined(_WIN32)
+    LeaveCriticalSection(&queue->mutex);
+#else
+    pthread_mutex_unlock(&queue->mutex);
+#endif
+    return hasJob;
+}
+
+static void avifJobQueueDrain(avifJobQueue * queue)
+{
+    uint32_t jobIndex;
+    while (avifJobQueueNext(queue, &jobIndex)) {
+        queue->func(queue->context, jobIndex);
+    }
+}
+
+#if defined(_WIN32)
+static unsigned int __stdcall avifJobThreadWorker(void * arg)
+#else
+static void * avifJobThreadWorker(void * arg)
+#endif
+{
+    avifJobThread * thread = (avifJobThread *)arg;
+    avifJobQueueDrain(thread->queue);
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static avifBool avifCreateJobThread(avifJobThread * thread)
+{
+#if defined(_WIN32)
+    thread->thread = (HANDLE)_beginthreadex(/*security=*/NULL,
+                                            /*stack_size=*/0,
+                                            &avifJobThreadWorker,
+                                            thread,
+                                            /*initflag=*/0,
+                                            /*thrdaddr=*/NULL);
+    return thread->thread != NULL;
+#else
+    return pthread_create(&thread->thread, NULL, &avifJobThreadWorker, thread) == 0;
+#endif
+}
+
+static avifBool avifJoinJobThread(avifJobThread * thread)
+{
+#if defined(_WIN32)
+    return WaitForSingleObject(thread->thread, INFINITE) == WAIT_OBJECT_0 && CloseHandle(thread->thread) != 0;
+#else
+    return pthread_join(thread->thread, NULL) == 0;
+#endif
+}
+
+static void avifRunJobsSerially(uint32_t jobCount, avifJobFunc func, void * context)
+{
+    for (uint32_t i = 0; i < jobCount; ++i) {
+        func(context, i);
+    }
+}
+
+avifBool avifRunJobs(uint32_t threadCount, uint32_t jobCount, avifJobFunc func, void * context)
+{
+    if (jobCount == 0) {
+        return AVIF_TRUE;
+    }
+    threadCount = AVIF_CLAMP(threadCount, 1, jobCount);
+    if (threadCount == 1) {
+        avifRunJobsSerially(jobCount, func, context);
+        return AVIF_TRUE;
+    }
+
+    avifJobQueue queue;
+    memset(&queue, 0, sizeof(queue));
+#if defined(_WIN32)
+    InitializeCriticalSection(&queue.mutex);
+#else
+    if (pthread_mutex_init(&queue.mutex, NULL) != 0) {
+        avifRunJobsSerially(jobCount, func, context);
+        return AVIF_TRUE;
+    }
+#endif
+    queue.jobCount = jobCount;
+    queue.func = func;
+    queue.context = context;
+
+    // The calling thread is one of the workers.
+    const uint32_t extraThreadCount = threadCount - 1;
+    const size_t byteCount = sizeof(avifJobThread) * extraThreadCount;
+    avifJobThread * threads = (avifJobThread *)avifAlloc(byteCount);
+    avifBool success = AVIF_TRUE;
+    if (threads) {
+        memset(threads, 0, byteCount);
+        for (uint32_t i = 0; i < extraThreadCount; ++i) {
+            threads[i].queue = &queue;
+            threads[i].threadCreated = avifCreateJobThread(&threads[i]);
+            if (!threads[i].threadCreated) {
+                // Not fatal: the remaining jobs are picked up by the threads that do exist.
+                break;
+            }
+        }
+    }
+    avifJobQueueDrain(&queue);
+    if (threads) {
+        for (uint32_t i = 0; i < extraThreadCount; ++i) {
+            if (threads[i].threadCreated && !avifJoinJobThread(&threads[i])) {
+                success = AVIF_FALSE;
+            }
+        }
+        avifFree(threads);
+    }
+
+#if defined(_WIN32)
+    DeleteCriticalSection(&queue.mutex);
+#else
+    pthread_mutex_destroy(&queue.mutex);
+#endif
+    return success;
+}
@@ -143,6 +143,7 @@ avifResult avifCodecEncodeOutputAddSample(avifCodecEncodeOutput * encodeOutput,
         return result;
     }
     sample->sync = sync;
+    sample->offset = 0;
     return AVIF_RESULT_OK;
 }
 
@@ -177,6 +178,7 @@ typedef struct avifEncoderItem
     const char * infeContentType;
     size_t infeContentTypeSize;
     avifOffsetFixupArray mdatFixups;
+    uint32_t streamedSampleCount; // Leading samples of encodeOutput already passed to the streaming sink of the encoder
 
     uint16_t irefToID; // if non-zero, make an iref from this id -> irefToID
     const char * irefType;
@@ -249,6 +251,10 @@ typedef struct avifEncoderData
     // Fields specific to AV1/AV2
     const char * imageItemType;  // "av01" for AV1 ("av02" for AV2 if AVIF_CODEC_AVM)
     const char * configPropName; // "av1C" for AV1 ("av2C" for AV2 if AVIF_CODEC_AVM)
+    // Set by avifEncoderSetStreamingSink(), samples are passed to streamingWrite as soon as they are encoded
+    avifEncoderSinkWriteFunc streamingWrite;
+    void * streamingUserData;
+    uint64_t streamedSize; // Amount of bytes passed to streamingWrite so far
 } avifEncoderData;
 
 static void avifEncoderDataDestroy(avifEncoderData * data);
@@ -2151,10 +2157,21 @@ static avifResult avifEncoderAddImageInternal(avifEncoder * encoder,
     return AVIF_RESULT_OK;
 }
 
+static avifResult avifEncoderStreamSamples(avifEncoder * encoder);
+
 avifResult avifEncoderAddImage(avifEncoder * encoder, const avifImage * image, uint64_t durationInTimescales, avifAddImageFlags addImageFlags)
 {
     avifDiagnosticsClearError(&encoder->diag);
-    return avifEncoderAddImageInternal(encoder, 1, 1, &image, durationInTimescales, addImageFlags);
+    if (encoder->data->streamingWrite == NULL) {
+        return avifEncoderAddImageInternal(encoder, 1, 1, &image, durationInTimescales, addImageFlags);
+    }
+
+    if ((addImageFlags & AVIF_ADD_IMAGE_FLAG_SINGLE) || (encoder->extraLayerCount > 0)) {
+        avifDiagnosticsPrintf(&encoder->diag, "Only image sequences can be streamed");
+        return AVIF_RESULT_INVALID_ARGUMENT;
+    }
+    AVIF_CHECKRES(avifEncoderAddImageInternal(encoder, 1, 1, &image, durationInTimescales, addImageFlags));
+    return avifEncoderStreamSamples(encoder);
 }
 
 avifResult avifEncoderAddImageGrid(avifEncoder * encoder,
@@ -2167,32 +2184,197 @@ avifResult avifEncoderAddImageGrid(avifEncoder * encoder,
     if ((gridCols == 0) || (gridCols > 256) || (gridRows == 0) || (gridRows > 256)) {
         return AVIF_RESULT_INVALID_IMAGE_GRID;
     }
+    if (encoder->data->streamingWrite != NULL) {
+        avifDiagnosticsPrintf(&encoder->diag, "Only image sequences can be streamed");
+        return AVIF_RESULT_INVALID_ARGUMENT;
+    }
     if (encoder->extraLayerCount == 0) {
         addImageFlags |= AVIF_ADD_IMAGE_FLAG_SINGLE; // image grids cannot be image sequences
     }
     return avifEncoderAddImageInternal(encoder, gridCols, gridRows, cellImages, 1, addImageFlags);
 }
 
-static size_t avifEncoderFindExistingChunk(avifRWStream * s, size_t mdatStartOffset, const uint8_t * data, size_t size)
+// ---------------------------------------------------------------------------
+// avifMdatChunkIndex - Provides mdat chunk deduplication
+
+typedef struct avifMdatChunk
+{
+    uint64_t hash;
+    const uint8_t * data; // Encoded sample or metadata payload the chunk was written from, owned by the encoder
+    size_t offset;
+    size_t size;
+    uint32_t next; // 1-indexed position of the next chunk in the same bucket, 0 ends the chain
+} avifMdatChunk;
+AVIF_ARRAY_DECLARE(avifMdatChunkArray, avifMdatChunk, chunk);
+
+// Chunks written to the mdat box so far, looked up by content hash. Only whole chunks are found, unlike a search of the
+// raw mdat bytes, which is enough since identical items or samples are written as identical chunks.
+typedef struct avifMdatChunkIndex
+{
+    avifMdatChunkArray chunks;
+    uint32_t * buckets; // 1-indexed position of the first chunk of every bucket, 0 for an empty bucket
+    uint32_t bucketCount; // Always a power of two
+} avifMdatChunkIndex;
+
+static avifBool avifMdatChunkIndexCreate(avifMdatChunkIndex * index)
 {
-    const size_t mdatCurrentOffset = avifRWStreamOffset(s);
-    const size_t mdatSearchSize = mdatCurrentOffset - mdatStartOffset;
-    if (mdatSearchSize < size) {
-        return 0;
+    memset(index, 0, sizeof(avifMdatChunkIndex));
+    if (!avifArrayCreate(&index->chunks, sizeof(avifMdatChunk), 16)) {
+        return AVIF_FALSE;
+    }
+    index->bucketCount = 64;
+    index->buckets = (uint32_t *)avifAlloc(sizeof(uint32_t) * index->bucketCount);
+    if (index->buckets == NULL) {
+        avifArrayDestroy(&index->chunks);
+        return AVIF_FALSE;
     }
-    const size_t mdatEndSearchOffset = mdatCurrentOffset - size;
-    for (size_t searchOffset = mdatStartOffset; searchOffset <= mdatEndSearchOffset; ++searchOffset) {
-        if (!memcmp(data, &s->raw->data[searchOffset], size)) {
-            return searchOffset;
+    memset(index->buckets, 0, sizeof(uint32_t) * index->bucketCount);
+    return AVIF_TRUE;
+}
+
+static void avifMdatChunkIndexDestroy(avifMdatChunkIndex * index)
+{
+    avifArrayDestroy(&index->chunks);
+    avifFree(index->buckets);
+    index->buckets = NULL;
+}
+
+// Word-wise multiply-xorshift hash. It is only used to find candidates, which are then compared byte by byte.
+static uint64_t avifMdatChunkHash(const uint8_t * data, size_t size)
+{
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, &data[i], sizeof(word));
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    }
+    if (i < size) {
+        uint64_t tail = 0;
+        memcpy(&tail, &data[i], size - i);
+        hash ^= tail;
+    }
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+// Returns the offset of a previously written chunk identical to data, or 0 if there is none.
+static size_t avifMdatChunkIndexFind(const avifMdatChunkIndex * index, const uint8_t * data, size_t size, uint64_t hash)
+{
+    for (uint32_t position = index->buckets[hash & (index->bucketCount - 1)]; position != 0;) {
+        const avifMdatChunk * chunk = &index->chunks.chunk[position - 1];
+        if ((chunk->hash == hash) && (chunk->size == size) && !memcmp(data, chunk->data, size)) {
+            return chunk->offset;
         }
+        position = chunk->next;
     }
     return 0;
 }
 
+static avifResult avifMdatChunkIndexAdd(avifMdatChunkIndex * index, uint64_t hash, const uint8_t * data, size_t offset, size_t size)
+{
+    if (index->chunks.count >= index->bucketCount) {
+        // Keep chains short, rehash every chunk into twice as many buckets
+        AVIF_CHECKERR(index->bucketCount <= UINT32_MAX / 2, AVIF_RESULT_OUT_OF_MEMORY);
+        const uint32_t bucketCount = index->bucketCount * 2;
+        uint32_t * buckets = (uint32_t *)avifAlloc(sizeof(uint32_t) * bucketCount);
+        AVIF_CHECKERR(buckets != NULL, AVIF_RESULT_OUT_OF_MEMORY);
+        memset(buckets, 0, sizeof(uint32_t) * bucketCount);
+        for (uint32_t i = 0; i < index->chunks.count; ++i) {
+            avifMdatChunk * chunk = &index->chunks.chunk[i];
+            const uint32_t bucket = (uint32_t)(chunk->hash & (bucketCount - 1));
+            chunk->next = buckets[bucket];
+            buckets[bucket] = i + 1;
+        }
+        avifFree(index->buckets);
+        index->buckets = buckets;
+        index->bucketCount = bucketCount;
+    }
+
+    avifMdatChunk * chunk = (avifMdatChunk *)avifArrayPush(&index->chunks);
+    AVIF_CHECKERR(chunk != NULL, AVIF_RESULT_OUT_OF_MEMORY);
+    const uint32_t bucket = (uint32_t)(hash & (index->bucketCount - 1));
+    chunk->hash = hash;
+    chunk->data = data;
+    chunk->offset = offset;
+    chunk->size = size;
+    chunk->next = index->buckets[bucket];
+    index->buckets[bucket] = index->chunks.count;
+    return AVIF_RESULT_OK;
+}
+
+// ---------------------------------------------------------------------------
+// avifMdatWriter - Writes the payload of the mdat box, either into the output stream or as a list of spans streamed to a
+// sink once the boxes before the mdat payload are complete
+
+typedef struct avifMdatSpan
+{
+    const uint8_t * data;
+    size_t size;
+} avifMdatSpan;
+AVIF_ARRAY_DECLARE(avifMdatSpanArray, avifMdatSpan, span);
+
+typedef struct avifMdatWriter
+{
+    avifRWStream * s;
+    size_t baseOffset;                 // Offset in the file of the first byte of s
+    avifMdatSpanArray * deferredSpans; // If not NULL, payloads are recorded here instead of being copied into s
+    size_t deferredSize;               // Sum of the sizes of deferredSpans
+} avifMdatWriter;
+
+// Returns the offset in the file of the next byte written to the mdat payload.
+static size_t avifMdatWriterOffset(const avifMdatWriter * writer)
+{
+    return writer->baseOffset + avifRWStreamOffset(writer->s) + writer->deferredSize;
+}
+
+static avifResult avifMdatWriterWrite(avifMdatWriter * writer, const uint8_t * data, size_t size)
+{
+    if (writer->deferredSpans == NULL) {
+        return avifRWStreamWrite(writer->s, data, size);
+    }
+    if (size == 0) {
+        return AVIF_RESULT_OK;
+    }
+    avifMdatSpan * span = (avifMdatSpan *)avifArrayPush(writer->deferredSpans);
+    AVIF_CHECKERR(span != NULL, AVIF_RESULT_OUT_OF_MEMORY);
+    span->data = data;
+    span->size = size;
+    writer->deferredSize += size;
+    return AVIF_RESULT_OK;
+}
+
+// Returns the expected size of the file written by avifEncoderFinish(): every encoded sample and metadata payload once
+// if includePayload is true, plus an allowance for the boxes describing them. Deduplicated chunks make it an overestimate.
+static size_t avifEncoderExpectedOutputSize(const avifEncoder * encoder, avifBool includePayload)
+{
+    size_t size = 4096; // ftyp, meta and moov boxes that do not depend on the amount of items or samples
+    for (uint32_t itemIndex = 0; itemIndex < encoder->data->items.count; ++itemIndex) {
+        const avifEncoderItem * item = &encoder->data->items.item[itemIndex];
+        size += 256; // infe, iloc, ipma and item property entries
+        if (includePayload) {
+            size += item->metadataPayload.size;
+        }
+        if (item->encodeOutput != NULL) {
+            for (uint32_t sampleIndex = 0; sampleIndex < item->encodeOutput->samples.count; ++sampleIndex) {
+                size += 32; // stsz, stts and stss entries
+                if (includePayload) {
+                    size += item->encodeOutput->samples.sample[sampleIndex].data.size;
+                }
+            }
+        }
+    }
+    return size;
+}
+
 static avifResult avifEncoderWriteMediaDataBox(avifEncoder * encoder,
                                                avifRWStream * s,
                                                avifEncoderItemReferenceArray * layeredColorItems,
-                                               avifEncoderItemReferenceArray * layeredAlphaItems)
+                                               avifEncoderItemReferenceArray * layeredAlphaItems,
+                                               avifMdatChunkIndex * chunkIndex,
+                                               avifMdatSpanArray * deferredSpans)
 {
     encoder->ioStats.colorOBUSize = 0;
     encoder->ioStats.alphaOBUSize = 0;
@@ -2200,7 +2382,8 @@ static avifResult avifEncoderWriteMediaDataBox(avifEncoder * encoder,
 
     avifBoxMarker mdat;
     AVIF_CHECKRES(avifRWStreamWriteBox(s, "mdat", AVIF_BOX_SIZE_TBD, &mdat));
-    const size_t mdatStartOffset = avifRWStreamOffset(s);
+    // In streaming mode, s starts after everything that was already passed to the streaming sink
+    avifMdatWriter writer = { s, (size_t)encoder->data->streamedSize, deferredSpans, 0 };
     for (uint32_t itemPasses = 0; itemPasses < 3; ++itemPasses) {
         // Use multiple passes to pack in the following order:
         //   * Pass 0: metadata (Exif/XMP/gain map metadata)
@@ -2250,22 +2433,44 @@ static avifResult avifEncoderWriteMediaDataBox(avifEncoder * encoder,
 
             size_t chunkOffset = 0;
 
-            // Deduplication - See if an identical chunk to this has already been written.
-            // Doing it when item->encodeOutput->samples.count > 1 would require contiguous memory.
-            if (item->encodeOutput->samples.count == 1) {
+            if (item->streamedSampleCount > 0) {
+                // Streaming - The samples are already in the file, in mdat boxes of their own.
+                AVIF_ASSERT_OR_RETURN(item->streamedSampleCount == item->encodeOutput->samples.count);
+                chunkOffset = (size_t)item->encodeOutput->samples.sample[0].offset;
+                for (uint32_t sampleIndex = 0; sampleIndex < item->encodeOutput->samples.count; ++sampleIndex) {
+                    const size_t sampleSize = item->encodeOutput->samples.sample[sampleIndex].data.size;
+                    if (isAlpha) {
+                        encoder->ioStats.alphaOBUSize += sampleSize;
+                    } else if (item->itemCategory == AVIF_ITEM_COLOR) {
+                        encoder->ioStats.colorOBUSize += sampleSize;
+                    }
+                }
+            } else if (item->encodeOutput->samples.count == 1) {
+                // Deduplication - See if an identical chunk to this has already been written.
+                // Doing it when item->encodeOutput->samples.count > 1 would require contiguous memory.
                 avifEncodeSample * sample = &item->encodeOutput->samples.sample[0];
-                chunkOffset = avifEncoderFindExistingChunk(s, mdatStartOffset, sample->data.data, sample->data.size);
+                chunkOffset =
+                    avifMdatChunkIndexFind(chunkIndex, sample->data.data, sample->data.size, avifMdatChunkHash(sample->data.data, sample->data.size));
             } else if (item->encodeOutput->samples.count == 0) {
-                chunkOffset = avifEncoderFindExistingChunk(s, mdatStartOffset, item->metadataPayload.data, item->metadataPayload.size);
+                chunkOffset = avifMdatChunkIndexFind(chunkIndex,
+                                                     item->metadataPayload.data,
+                                                     item->metadataPayload.size,
+                                                     avifMdatChunkHash(item->metadataPayload.data, item->metadataPayload.size));
             }
 
             if (!chunkOffset) {
                 // We've never seen this chunk before; write it out
-                chunkOffset = avifRWStreamOffset(s);
+                chunkOffset = avifMdatWriterOffset(&writer);
                 if (item->encodeOutput->samples.count > 0) {
                     for (uint32_t sampleIndex = 0; sampleIndex < item->encodeOutput->samples.count; ++sampleIndex) {
                         avifEncodeSample * sample = &item->encodeOutput->samples.sample[sampleIndex];
-                        AVIF_CHECKRES(avifRWStreamWrite(s, sample->data.data, sample->data.size));
+                        // Every sample is indexed on its own, so single sample items can reuse a sample of a sequence
+                        AVIF_CHECKRES(avifMdatChunkIndexAdd(chunkIndex,
+                                                            avifMdatChunkHash(sample->data.data, sample->data.size),
+                                                            sample->data.data,
+                                                            avifMdatWriterOffset(&writer),
+                                                            sample->data.size));
+                        AVIF_CHECKRES(avifMdatWriterWrite(&writer, sample->data.data, sample->data.size));
 
                         if (isAlpha) {
                             encoder->ioStats.alphaOBUSize += sample->data.size;
@@ -2276,7 +2481,12 @@ static avifResult avifEncoderWriteMediaDataBox(avifEncoder * encoder,
                         }
                     }
                 } else {
-                    AVIF_CHECKRES(avifRWStreamWrite(s, item->metadataPayload.data, item->metadataPayload.size));
+                    AVIF_CHECKRES(avifMdatChunkIndexAdd(chunkIndex,
+                                                        avifMdatChunkHash(item->metadataPayload.data, item->metadataPayload.size),
+                                                        item->metadataPayload.data,
+                                                        chunkOffset,
+                                                        item->metadataPayload.size));
+                    AVIF_CHECKRES(avifMdatWriterWrite(&writer, item->metadataPayload.data, item->metadataPayload.size));
                 }
             }
 
@@ -2317,11 +2527,13 @@ static avifResult avifEncoderWriteMediaDataBox(avifEncoder * encoder,
                         hasMoreSample = AVIF_TRUE;
                     }
                     avifRWData * data = &item->encodeOutput->samples.sample[layerIndex].data;
-                    size_t chunkOffset = avifEncoderFindExistingChunk(s, mdatStartOffset, data->data, data->size);
+                    const uint64_t hash = avifMdatChunkHash(data->data, data->size);
+                    size_t chunkOffset = avifMdatChunkIndexFind(chunkIndex, data->data, data->size, hash);
                     if (!chunkOffset) {
                         // We've never seen this chunk before; write it out
-                        chunkOffset = avifRWStreamOffset(s);
-                        AVIF_CHECKRES(avifRWStreamWrite(s, data->data, data->size));
+                        chunkOffset = avifMdatWriterOffset(&writer);
+                        AVIF_CHECKRES(avifMdatChunkIndexAdd(chunkIndex, hash, data->data, chunkOffset, data->size));
+                        AVIF_CHECKRES(avifMdatWriterWrite(&writer, data->data, data->size));
                         if (samplePass == 0) {
                             encoder->ioStats.alphaOBUSize += data->size;
                         } else {
@@ -2341,6 +2553,15 @@ static avifResult avifEncoderWriteMediaDataBox(avifEncoder * encoder,
         AVIF_ASSERT_OR_RETURN(layerIndex <= AVIF_MAX_AV1_LAYER_COUNT);
     }
     avifRWStreamFinishBox(s, mdat);
+    if (writer.deferredSize > 0) {
+        // The deferred payload is part of the box even though it is not in s
+        const size_t mdatSize = avifRWStreamOffset(s) + writer.deferredSize - mdat;
+        AVIF_CHECKERR(mdatSize <= UINT32_MAX, AVIF_RESULT_INVALID_ARGUMENT);
+        const size_t prevOffset = avifRWStreamOffset(s);
+        avifRWStreamSetOffset(s, mdat);
+        AVIF_CHECKRES(avifRWStreamWriteU32(s, (uint32_t)mdatSize));
+        avifRWStreamSetOffset(s, prevOffset);
+    }
     return AVIF_RESULT_OK;
 }
 
@@ -3164,7 +3385,149 @@ static avifResult avifRWStreamWriteProperties(avifItemPropertyDedup * const dedu
     return AVIF_RESULT_OK;
 }
 
-avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
+static avifResult avifEncoderWriteFileTypeBox(const avifEncoder * encoder, avifRWStream * s, avifBool isSequence, avifBool useAvioBrand)
+{
+    const avifImage * imageMetadata = encoder->data->imageMetadata;
+
+    const char * majorBrand = "avif";
+    if (isSequence) {
+        majorBrand = "avis";
+    }
+
+    uint32_t minorVersion = 0;
+#if defined(AVIF_CODEC_AVM)
+    if (avifEncoderGetCodecType(encoder) == AVIF_CODEC_TYPE_AV2) {
+        // TODO(yguyon): Experimental AV2-AVIF is AVIF version 2 for now (change once it is ratified).
+        minorVersion = 2;
+    }
+#endif
+
+    avifBoxMarker ftyp;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "ftyp", AVIF_BOX_SIZE_TBD, &ftyp));
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, majorBrand, 4));               // unsigned int(32) major_brand;
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, minorVersion));                  // unsigned int(32) minor_version;
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, "avif", 4));                   // unsigned int(32) compatible_brands[];
+    if (useAvioBrand) {                                                    //
+        AVIF_CHECKRES(avifRWStreamWriteChars(s, "avio", 4));               // ... compatible_brands[]
+    }                                                                      //
+    if (isSequence) {                                                      //
+        AVIF_CHECKRES(avifRWStreamWriteChars(s, "avis", 4));               // ... compatible_brands[]
+        AVIF_CHECKRES(avifRWStreamWriteChars(s, "msf1", 4));               // ... compatible_brands[]
+        AVIF_CHECKRES(avifRWStreamWriteChars(s, "iso8", 4));               // ... compatible_brands[]
+    }                                                                      //
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, "mif1", 4));                   // ... compatible_brands[]
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, "miaf", 4));                   // ... compatible_brands[]
+    if ((imageMetadata->depth == 8) || (imageMetadata->depth == 10)) {     //
+        if (imageMetadata->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) {        //
+            AVIF_CHECKRES(avifRWStreamWriteChars(s, "MA1B", 4));           // ... compatible_brands[]
+        } else if (imageMetadata->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) { //
+            AVIF_CHECKRES(avifRWStreamWriteChars(s, "MA1A", 4));           // ... compatible_brands[]
+        }
+    }
+    for (uint32_t itemIndex = 0; itemIndex < encoder->data->items.count; ++itemIndex) {
+        if (!memcmp(encoder->data->items.item[itemIndex].type, "tmap", 4)) {
+            // ISO/IEC 23008-12:2024/AMD 1:2024(E)
+            // This brand enables file players to identify and decode HEIF files containing tone-map derived image
+            // items. When present, this brand shall be among the brands included in the compatible_brands
+            // array of the FileTypeBox.
+            AVIF_CHECKRES(avifRWStreamWriteChars(s, "tmap", 4));  // ... compatible_brands[]
+            break;
+        }
+    }
+    avifRWStreamFinishBox(s, ftyp);
+    return AVIF_RESULT_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Streaming - Image sequence samples are passed to a sink as soon as they are encoded, the boxes describing them follow
+// in avifEncoderFinish()
+
+avifResult avifEncoderSetStreamingSink(avifEncoder * encoder, avifEncoderSinkWriteFunc write, void * userData)
+{
+    avifDiagnosticsClearError(&encoder->diag);
+    if ((write == NULL) || (encoder->data->items.count > 0) || (encoder->extraLayerCount > 0)) {
+        return AVIF_RESULT_INVALID_ARGUMENT;
+    }
+    encoder->data->streamingWrite = write;
+    encoder->data->streamingUserData = userData;
+    return AVIF_RESULT_OK;
+}
+
+// Writes the samples encoded since the last call as a single mdat box, preceded by the ftyp box the first time.
+// The data of every streamed sample but the first one, which avifEncoderFinish() parses, is released.
+static avifResult avifEncoderStreamSamples(avifEncoder * encoder)
+{
+    avifEncoderData * data = encoder->data;
+    if (data->streamedSize == 0) {
+        // Only sequences are streamed. Whether all samples are sync samples is not known yet, so "avio" is omitted.
+        avifRWData ftyp = AVIF_DATA_EMPTY;
+        avifRWStream s;
+        avifRWStreamStart(&s, &ftyp);
+        avifResult result = avifEncoderWriteFileTypeBox(encoder, &s, /*isSequence=*/AVIF_TRUE, /*useAvioBrand=*/AVIF_FALSE);
+        avifRWStreamFinishWrite(&s);
+        if (result == AVIF_RESULT_OK) {
+            result = data->streamingWrite(data->streamingUserData, ftyp.data, ftyp.size);
+        }
+        data->streamedSize += ftyp.size;
+        avifRWDataFree(&ftyp);
+        AVIF_CHECKRES(result);
+    }
+
+    uint64_t payloadSize = 0;
+    for (uint32_t itemIndex = 0; itemIndex < data->items.count; ++itemIndex) {
+        const avifEncoderItem * item = &data->items.item[itemIndex];
+        for (uint32_t sampleIndex = item->streamedSampleCount; sampleIndex < item->encodeOutput->samples.count; ++sampleIndex) {
+            payloadSize += item->encodeOutput->samples.sample[sampleIndex].data.size;
+        }
+    }
+    if (payloadSize == 0) {
+        return AVIF_RESULT_OK;
+    }
+
+    uint8_t header[16];
+    size_t headerSize;
+    if (payloadSize + 8 <= UINT32_MAX) {
+        headerSize = 8;
+        const uint32_t size = avifHTONL((uint32_t)(payloadSize + headerSize)); // unsigned int(32) size;
+        memcpy(&header[0], &size, sizeof(size));
+        memcpy(&header[4], "mdat", 4);
+    } else {
+        headerSize = 16;
+        const uint32_t size = avifHTONL(1); // unsigned int(32) size; (1 means largesize follows)
+        const uint64_t largeSize = avifHTON64(payloadSize + headerSize); // unsigned int(64) largesize;
+        memcpy(&header[0], &size, sizeof(size));
+        memcpy(&header[4], "mdat", 4);
+        memcpy(&header[8], &largeSize, sizeof(largeSize));
+    }
+    AVIF_CHECKRES(data->streamingWrite(data->streamingUserData, header, headerSize));
+    data->streamedSize += headerSize;
+
+    // Alpha coming before color, as in avifEncoderWriteMediaDataBox()
+    for (int itemPass = 0; itemPass < 2; ++itemPass) {
+        for (uint32_t itemIndex = 0; itemIndex < data->items.count; ++itemIndex) {
+            avifEncoderItem * item = &data->items.item[itemIndex];
+            if (avifIsAlpha(item->itemCategory) != (itemPass == 0)) {
+                continue;
+            }
+            for (; item->streamedSampleCount < item->encodeOutput->samples.count; ++item->streamedSampleCount) {
+                avifEncodeSample * sample = &item->encodeOutput->samples.sample[item->streamedSampleCount];
+                AVIF_CHECKRES(data->streamingWrite(data->streamingUserData, sample->data.data, sample->data.size));
+                sample->offset = data->streamedSize;
+                data->streamedSize += sample->data.size;
+                if (item->streamedSampleCount > 0) {
+                    // Keep the size for the sample tables
+                    avifFree(sample->data.data);
+                    sample->data.data = NULL;
+                }
+            }
+        }
+    }
+    return AVIF_RESULT_OK;
+}
+
+// If deferredSpans is not NULL, output receives the file up to the mdat payload, and the payload is left in the encoder's
+// samples and listed in deferredSpans in file order.
+static avifResult avifEncoderFinishInternal(avifEncoder * encoder, avifRWData * output, avifMdatSpanArray * deferredSpans)
 {
     avifDiagnosticsClearError(&encoder->diag);
     if (encoder->data->items.count == 0) {
@@ -3201,6 +3564,12 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
         }
     }
 
+    const avifBool streaming = (encoder->data->streamingWrite != NULL);
+    if (streaming) {
+        // Pass the samples output by encodeFinish() to the sink, the rest of the file describes all of them
+        AVIF_CHECKRES(avifEncoderStreamSamples(encoder));
+    }
+
     // -----------------------------------------------------------------------
     // Harvest configuration properties from sequence headers
 
@@ -3220,7 +3589,7 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
 
 #if defined(AVIF_ENABLE_EXPERIMENTAL_MINI)
     // Decide whether to go for a reduced MinimizedImageBox or a full regular MetaBox.
-    if ((encoder->headerFormat & AVIF_HEADER_MINI) && avifEncoderIsMiniCompatible(encoder)) {
+    if (!streaming && (encoder->headerFormat & AVIF_HEADER_MINI) && avifEncoderIsMiniCompatible(encoder)) {
         AVIF_CHECKRES(avifEncoderWriteFileTypeBoxAndMiniBox(encoder, output));
         return AVIF_RESULT_OK;
     }
@@ -3234,25 +3603,14 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
 
     avifRWStream s;
     avifRWStreamStart(&s, output);
+    // All samples are known by now, allocate the output once instead of growing it while writing
+    AVIF_CHECKRES(avifRWStreamReserve(&s, avifEncoderExpectedOutputSize(encoder, !streaming && (deferredSpans == NULL))));
 
     // -----------------------------------------------------------------------
     // Write ftyp
 
-    // Layered sequence is not supported for now.
-    const avifBool isSequence = (encoder->extraLayerCount == 0) && (encoder->data->frames.count > 1);
-
-    const char * majorBrand = "avif";
-    if (isSequence) {
-        majorBrand = "avis";
-    }
-
-    uint32_t minorVersion = 0;
-#if defined(AVIF_CODEC_AVM)
-    if (codecType == AVIF_CODEC_TYPE_AV2) {
-        // TODO(yguyon): Experimental AV2-AVIF is AVIF version 2 for now (change once it is ratified).
-        minorVersion = 2;
-    }
-#endif
+    // Layered sequence is not supported for now. Streamed files always are sequences, as announced by their ftyp box.
+    const avifBool isSequence = streaming || ((encoder->extraLayerCount == 0) && (encoder->data->frames.count > 1));
 
     // According to section 5.2 of AV1 Image File Format specification v1.1.0:
     //   If the primary item or all the items referenced by the primary item are AV1 image items made only
@@ -3294,39 +3652,10 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
         useAvioBrand = AVIF_FALSE; // Should be (encoder->extraLayerCount == 0) to be fully compliant.
     }
 
-    avifBoxMarker ftyp;
-    AVIF_CHECKRES(avifRWStreamWriteBox(&s, "ftyp", AVIF_BOX_SIZE_TBD, &ftyp));
-    AVIF_CHECKRES(avifRWStreamWriteChars(&s, majorBrand, 4));              // unsigned int(32) major_brand;
-    AVIF_CHECKRES(avifRWStreamWriteU32(&s, minorVersion));                 // unsigned int(32) minor_version;
-    AVIF_CHECKRES(avifRWStreamWriteChars(&s, "avif", 4));                  // unsigned int(32) compatible_brands[];
-    if (useAvioBrand) {                                                    //
-        AVIF_CHECKRES(avifRWStreamWriteChars(&s, "avio", 4));              // ... compatible_brands[]
-    }                                                                      //
-    if (isSequence) {                                                      //
-        AVIF_CHECKRES(avifRWStreamWriteChars(&s, "avis", 4));              // ... compatible_brands[]
-        AVIF_CHECKRES(avifRWStreamWriteChars(&s, "msf1", 4));              // ... compatible_brands[]
-        AVIF_CHECKRES(avifRWStreamWriteChars(&s, "iso8", 4));              // ... compatible_brands[]
-    }                                                                      //
-    AVIF_CHECKRES(avifRWStreamWriteChars(&s, "mif1", 4));                  // ... compatible_brands[]
-    AVIF_CHECKRES(avifRWStreamWriteChars(&s, "miaf", 4));                  // ... compatible_brands[]
-    if ((imageMetadata->depth == 8) || (imageMetadata->depth == 10)) {     //
-        if (imageMetadata->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) {        //
-            AVIF_CHECKRES(avifRWStreamWriteChars(&s, "MA1B", 4));          // ... compatible_brands[]
-        } else if (imageMetadata->yuvFormat == AVIF_PIXEL_FORMAT_YUV444) { //
-            AVIF_CHECKRES(avifRWStreamWriteChars(&s, "MA1A", 4));          // ... compatible_brands[]
-        }
-    }
-    for (uint32_t itemIndex = 0; itemIndex < encoder->data->items.count; ++itemIndex) {
-        if (!memcmp(encoder->data->items.item[itemIndex].type, "tmap", 4)) {
-            // ISO/IEC 23008-12:2024/AMD 1:2024(E)
-            // This brand enables file players to identify and decode HEIF files containing tone-map derived image
-            // items. When present, this brand shall be among the brands included in the compatible_brands
-            // array of the FileTypeBox.
-            AVIF_CHECKRES(avifRWStreamWriteChars(&s, "tmap", 4)); // ... compatible_brands[]
-            break;
-        }
+    if (!streaming) {
+        // The ftyp box of a streamed file was written along with its first samples
+        AVIF_CHECKRES(avifEncoderWriteFileTypeBox(encoder, &s, isSequence, useAvioBrand));
     }
-    avifRWStreamFinishBox(&s, ftyp);
 
     // -----------------------------------------------------------------------
     // Start meta
@@ -3783,12 +4112,16 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
             avifRWStreamSetOffset(&s, prevOffset);
             avifRWStreamFinishBox(&s, stts);
 
+            // Streamed samples are spread over several mdat boxes, each of them is described as a chunk of its own
+            const avifBool streamedTrack = (item->streamedSampleCount > 0);
+            const uint32_t samplesPerChunk = streamedTrack ? 1 : item->encodeOutput->samples.count;
+
             avifBoxMarker stsc;
             AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "stsc", AVIF_BOX_SIZE_TBD, 0, 0, &stsc));
-            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));                                 // unsigned int(32) entry_count;
-            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));                                 // unsigned int(32) first_chunk;
-            AVIF_CHECKRES(avifRWStreamWriteU32(&s, item->encodeOutput->samples.count)); // unsigned int(32) samples_per_chunk;
-            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1)); // unsigned int(32) sample_description_index;
+            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));               // unsigned int(32) entry_count;
+            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));               // unsigned int(32) first_chunk;
+            AVIF_CHECKRES(avifRWStreamWriteU32(&s, samplesPerChunk)); // unsigned int(32) samples_per_chunk;
+            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));               // unsigned int(32) sample_description_index;
             avifRWStreamFinishBox(&s, stsc);
 
             avifBoxMarker stsz;
@@ -3801,12 +4134,29 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
             }
             avifRWStreamFinishBox(&s, stsz);
 
-            avifBoxMarker stco;
-            AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "stco", AVIF_BOX_SIZE_TBD, 0, 0, &stco));
-            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));           // unsigned int(32) entry_count;
-            AVIF_CHECKRES(avifEncoderItemAddMdatFixup(item, &s)); //
-            AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));           // unsigned int(32) chunk_offset; (set later)
-            avifRWStreamFinishBox(&s, stco);
+            if (streamedTrack) {
+                const avifEncodeSample * lastSample = &item->encodeOutput->samples.sample[item->encodeOutput->samples.count - 1];
+                const avifBool largeOffsets = (lastSample->offset > UINT32_MAX);
+                avifBoxMarker stco;
+                AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, largeOffsets ? "co64" : "stco", AVIF_BOX_SIZE_TBD, 0, 0, &stco));
+                AVIF_CHECKRES(avifRWStreamWriteU32(&s, item->encodeOutput->samples.count)); // unsigned int(32) entry_count;
+                for (uint32_t sampleIndex = 0; sampleIndex < item->encodeOutput->samples.count; ++sampleIndex) {
+                    const uint64_t chunkOffset = item->encodeOutput->samples.sample[sampleIndex].offset;
+                    if (largeOffsets) {
+                        AVIF_CHECKRES(avifRWStreamWriteU64(&s, chunkOffset)); // unsigned int(64) chunk_offset;
+                    } else {
+                        AVIF_CHECKRES(avifRWStreamWriteU32(&s, (uint32_t)chunkOffset)); // unsigned int(32) chunk_offset;
+                    }
+                }
+                avifRWStreamFinishBox(&s, stco);
+            } else {
+                avifBoxMarker stco;
+                AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "stco", AVIF_BOX_SIZE_TBD, 0, 0, &stco));
+                AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));           // unsigned int(32) entry_count;
+                AVIF_CHECKRES(avifEncoderItemAddMdatFixup(item, &s)); //
+                AVIF_CHECKRES(avifRWStreamWriteU32(&s, 1));           // unsigned int(32) chunk_offset; (set later)
+                avifRWStreamFinishBox(&s, stco);
+            }
 
             avifBool hasNonSyncSample = AVIF_FALSE;
             for (uint32_t sampleIndex = 0; sampleIndex < item->encodeOutput->samples.count; ++sampleIndex) {
@@ -3848,17 +4198,22 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
 
     avifEncoderItemReferenceArray layeredColorItems;
     avifEncoderItemReferenceArray layeredAlphaItems;
+    avifMdatChunkIndex chunkIndex;
     if (!avifArrayCreate(&layeredColorItems, sizeof(avifEncoderItemReference), 1)) {
         result = AVIF_RESULT_OUT_OF_MEMORY;
     }
     if (!avifArrayCreate(&layeredAlphaItems, sizeof(avifEncoderItemReference), 1)) {
         result = AVIF_RESULT_OUT_OF_MEMORY;
     }
+    if (!avifMdatChunkIndexCreate(&chunkIndex)) {
+        result = AVIF_RESULT_OUT_OF_MEMORY;
+    }
     if (result == AVIF_RESULT_OK) {
-        result = avifEncoderWriteMediaDataBox(encoder, &s, &layeredColorItems, &layeredAlphaItems);
+        result = avifEncoderWriteMediaDataBox(encoder, &s, &layeredColorItems, &layeredAlphaItems, &chunkIndex, deferredSpans);
     }
     avifArrayDestroy(&layeredColorItems);
     avifArrayDestroy(&layeredAlphaItems);
+    avifMdatChunkIndexDestroy(&chunkIndex);
     AVIF_CHECKRES(result);
 
     // -----------------------------------------------------------------------
@@ -3866,13 +4221,50 @@ avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
 
     avifRWStreamFinishWrite(&s);
 
+    if (streaming) {
+        // The file ends with the meta and moov boxes, followed by the metadata payloads if any
+        result = encoder->data->streamingWrite(encoder->data->streamingUserData, output->data, output->size);
+        avifRWDataFree(output);
+        return result;
+    }
+
 #if defined(AVIF_ENABLE_COMPLIANCE_WARDEN)
-    AVIF_CHECKRES(avifIsCompliant(output->data, output->size));
+    if (deferredSpans == NULL) {
+        AVIF_CHECKRES(avifIsCompliant(output->data, output->size));
+    }
 #endif
 
     return AVIF_RESULT_OK;
 }
 
+avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output)
+{
+    return avifEncoderFinishInternal(encoder, output, NULL);
+}
+
+avifResult avifEncoderFinishToSink(avifEncoder * encoder, avifEncoderSinkWriteFunc write, void * userData)
+{
+    if (encoder->data->streamingWrite != NULL) {
+        // The streaming sink already received the beginning of the file, avifEncoderFinish() writes the rest of it there
+        return AVIF_RESULT_INVALID_ARGUMENT;
+    }
+    avifMdatSpanArray spans;
+    if (!avifArrayCreate(&spans, sizeof(avifMdatSpan), 16)) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    avifRWData header = AVIF_DATA_EMPTY;
+    avifResult result = avifEncoderFinishInternal(encoder, &header, &spans);
+    if ((result == AVIF_RESULT_OK) && (header.size > 0)) {
+        result = write(userData, header.data, header.size);
+    }
+    for (uint32_t i = 0; (result == AVIF_RESULT_OK) && (i < spans.count); ++i) {
+        result = write(userData, spans.span[i].data, spans.span[i].size);
+    }
+    avifRWDataFree(&header);
+    avifArrayDestroy(&spans);
+    return result;
+}
+
 avifResult avifEncoderWrite(avifEncoder * encoder, const avifImage * image, avifRWData * output)
 {
     avifResult addImageResult = avifEncoderAddImage(encoder, image, 1, AVIF_ADD_IMAGE_FLAG_SINGLE);
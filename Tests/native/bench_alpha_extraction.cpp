@@ -0,0 +1,81 @@
+// Times extractAlpha() of the encoders against a plain per pixel loop, for odd and common frame sizes, and checks that
+// both write the same alpha plane.
+
+#include "AlphaExtraction.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    constexpr int kRuns = 20;
+
+    uint32_t randomState = 17;
+
+    uint32_t nextRandom() {
+        randomState = randomState * 1664525u + 1013904223u;
+        return randomState >> 8;
+    }
+
+    void extractAlphaScalar(const uint8_t *rgba, size_t rgbaStride, uint8_t *alpha, size_t alphaStride,
+                            uint32_t width, uint32_t height) {
+        for (uint32_t y = 0; y < height; ++y) {
+            const uint8_t *src = rgba + rgbaStride * y;
+            uint8_t *dst = alpha + alphaStride * y;
+            for (uint32_t x = 0; x < width; ++x) {
+                dst[x] = src[x * 4 + 3];
+            }
+        }
+    }
+
+    template<typename Extract>
+    double best(Extract extract) {
+        double result = 1e9;
+        for (int run = 0; run < kRuns; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            extract();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            result = std::min(result, elapsed.count());
+        }
+        return result;
+    }
+
+    bool bench(uint32_t width, uint32_t height) {
+        // Padded strides, like CoreGraphics bitmaps and avifImage planes
+        const size_t rgbaStride = static_cast<size_t>(width) * 4 + 64;
+        const size_t alphaStride = width + 32;
+        std::vector<uint8_t> rgba(rgbaStride * height);
+        std::vector<uint8_t> expected(alphaStride * height, 0);
+        std::vector<uint8_t> alpha(alphaStride * height, 0);
+        for (auto &value : rgba) {
+            value = static_cast<uint8_t>(nextRandom());
+        }
+
+        const double scalar = best([&] {
+            extractAlphaScalar(rgba.data(), rgbaStride, expected.data(), alphaStride, width, height);
+        });
+        const double kernels = best([&] {
+            extractAlpha(rgba.data(), rgbaStride, alpha.data(), alphaStride, width, height);
+        });
+        const bool same = std::memcmp(alpha.data(), expected.data(), alpha.size()) == 0;
+        std::printf("%s %ux%u: scalar %.3f ms, extractAlpha %.3f ms (%.1fx)\n",
+                    same ? "ok  " : "FAIL", width, height, scalar * 1e3, kernels * 1e3, scalar / kernels);
+        return same;
+    }
+}
+
+int main() {
+#if defined(__x86_64__) || defined(__i386__)
+    std::printf("AVX2 %s\n", __builtin_cpu_supports("avx2") ? "available" : "not available, SSE2 kernels");
+#endif
+    // Widths that leave a tail for the 32 and 16 pixel loops, and the pool threshold of 256 * 1024 pixels
+    const uint32_t sizes[][2] = { { 511, 511 }, { 1023, 257 }, { 1920, 1080 }, { 1923, 1081 }, { 3840, 2160 } };
+    bool ok = true;
+    for (const auto &size : sizes) {
+        ok &= bench(size[0], size[1]);
+    }
+    return ok ? 0 : 1;
+}
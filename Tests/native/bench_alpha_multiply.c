@@ -0,0 +1,108 @@
+// Times avifRGBImagePremultiplyAlpha() and avifRGBImageUnpremultiplyAlpha() on a 1920x1080 image for each alpha
+// position (RGBA, ARGB, BGRA) and depth, with one job and with rgb->maxThreads 4.
+
+// clock_gettime()
+#define _POSIX_C_SOURCE 199309L
+
+#include "avif/avif.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define RUNS 10
+
+static uint32_t randomState = 13;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Fills the image with random samples, a quarter of the pixels opaque and a quarter transparent.
+static void fill(avifRGBImage * rgb, uint32_t alphaChannel)
+{
+    const uint32_t max = (1u << rgb->depth) - 1;
+    for (uint32_t j = 0; j < rgb->height; ++j) {
+        uint8_t * row = &rgb->pixels[(size_t)j * rgb->rowBytes];
+        for (uint32_t i = 0; i < rgb->width * 4; ++i) {
+            uint32_t value = nextRandom() & max;
+            if (i % 4 == alphaChannel) {
+                const uint32_t kind = nextRandom() & 3;
+                value = (kind == 0) ? max : (kind == 1) ? 0 : value;
+            }
+            if (rgb->depth == 8) {
+                row[i] = (uint8_t)value;
+            } else {
+                ((uint16_t *)row)[i] = (uint16_t)value;
+            }
+        }
+    }
+}
+
+static int bench(avifRGBFormat format, const char * formatName, uint32_t depth, int maxThreads, avifBool unmultiply)
+{
+    avifRGBImage rgb;
+    memset(&rgb, 0, sizeof(rgb));
+    rgb.width = WIDTH;
+    rgb.height = HEIGHT;
+    rgb.depth = depth;
+    rgb.format = format;
+    rgb.maxThreads = maxThreads;
+    if (avifRGBImageAllocatePixels(&rgb) != AVIF_RESULT_OK) {
+        return 1;
+    }
+    fill(&rgb, (format == AVIF_RGB_FORMAT_ARGB) ? 0 : 3);
+    double best = 1e9;
+    for (int run = 0; run < RUNS; ++run) {
+        const double start = now();
+        const avifResult result = unmultiply ? avifRGBImageUnpremultiplyAlpha(&rgb) : avifRGBImagePremultiplyAlpha(&rgb);
+        const double elapsed = now() - start;
+        if (result != AVIF_RESULT_OK) {
+            fprintf(stderr, "alpha multiply failed: %s\n", avifResultToString(result));
+            avifRGBImageFreePixels(&rgb);
+            return 1;
+        }
+        best = (elapsed < best) ? elapsed : best;
+    }
+    printf("%s %2u-bit %-13s maxThreads %d: best of %d %.2f ms, %.1f Mpixels/s\n",
+           formatName,
+           depth,
+           unmultiply ? "unpremultiply" : "premultiply",
+           maxThreads,
+           RUNS,
+           best * 1e3,
+           (double)WIDTH * HEIGHT / best * 1e-6);
+    avifRGBImageFreePixels(&rgb);
+    return 0;
+}
+
+int main(void)
+{
+    const avifRGBFormat formats[] = { AVIF_RGB_FORMAT_RGBA, AVIF_RGB_FORMAT_ARGB, AVIF_RGB_FORMAT_BGRA };
+    const char * formatNames[] = { "RGBA", "ARGB", "BGRA" };
+    // 10 and 12 bits take the integer kernels, 16 bits the float ones.
+    const uint32_t depths[] = { 8, 10, 12, 16 };
+    const int threadCounts[] = { 1, 4 };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+        for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d) {
+            for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+                if (bench(formats[f], formatNames[f], depths[d], threadCounts[t], AVIF_FALSE) ||
+                    bench(formats[f], formatNames[f], depths[d], threadCounts[t], AVIF_TRUE)) {
+                    return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Times avifImageApplyGainMap() on a 1920x1080 image for several rgb->maxThreads, and prints the content light level
+// of each run, which must not depend on the number of threads.
+
+// clock_gettime()
+#define _POSIX_C_SOURCE 199309L
+
+#include "avif/avif.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define WIDTH 1920
+#define HEIGHT 1080
+#define RUNS 10
+
+static uint32_t randomState = 5;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void fillPlanes(avifImage * image)
+{
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_V; ++plane) {
+        uint8_t * row = avifImagePlane(image, plane);
+        if (!row) {
+            continue;
+        }
+        for (uint32_t j = 0; j < avifImagePlaneHeight(image, plane); ++j, row += avifImagePlaneRowBytes(image, plane)) {
+            for (uint32_t i = 0; i < avifImagePlaneWidth(image, plane); ++i) {
+                row[i] = (uint8_t)(i / 8 + j / 8 + (nextRandom() & 15));
+            }
+        }
+    }
+}
+
+int main(void)
+{
+    avifImage * base = avifImageCreate(WIDTH, HEIGHT, 8, AVIF_PIXEL_FORMAT_YUV420);
+    avifGainMap * gainMap = avifGainMapCreate();
+    if (!base || !gainMap || avifImageAllocatePlanes(base, AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+        return 1;
+    }
+    base->colorPrimaries = AVIF_COLOR_PRIMARIES_BT709;
+    base->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_SRGB;
+    base->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT601;
+    fillPlanes(base);
+    // Same size as the base image, the avifpixart scalers are not available here.
+    gainMap->image = avifImageCreate(WIDTH, HEIGHT, 8, AVIF_PIXEL_FORMAT_YUV444);
+    if (!gainMap->image || avifImageAllocatePlanes(gainMap->image, AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+        return 1;
+    }
+    gainMap->image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT601;
+    fillPlanes(gainMap->image);
+    for (int c = 0; c < 3; ++c) {
+        gainMap->gainMapMin[c] = (avifSignedFraction) { -1, 2 };
+        gainMap->gainMapMax[c] = (avifSignedFraction) { 3, 1 };
+        gainMap->gainMapGamma[c] = (avifUnsignedFraction) { 1, 1 };
+        gainMap->baseOffset[c] = (avifSignedFraction) { 1, 64 };
+        gainMap->alternateOffset[c] = (avifSignedFraction) { 1, 64 };
+    }
+    gainMap->baseHdrHeadroom = (avifUnsignedFraction) { 0, 1 };
+    gainMap->alternateHdrHeadroom = (avifUnsignedFraction) { 3, 1 };
+
+    const int threadCounts[] = { 1, 2, 4, 8 };
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+        double best = 1e9;
+        avifContentLightLevelInformationBox clli;
+        for (int run = 0; run < RUNS; ++run) {
+            avifRGBImage toneMapped;
+            memset(&toneMapped, 0, sizeof(toneMapped));
+            toneMapped.depth = 16;
+            toneMapped.format = AVIF_RGB_FORMAT_RGBA;
+            toneMapped.maxThreads = threadCounts[t];
+            avifDiagnostics diag;
+            const double start = now();
+            const avifResult result = avifImageApplyGainMap(base,
+                                                            gainMap,
+                                                            3.0f,
+                                                            AVIF_COLOR_PRIMARIES_BT709,
+                                                            AVIF_TRANSFER_CHARACTERISTICS_PQ,
+                                                            &toneMapped,
+                                                            &clli,
+                                                            &diag);
+            const double elapsed = now() - start;
+            avifRGBImageFreePixels(&toneMapped);
+            if (result != AVIF_RESULT_OK) {
+                fprintf(stderr, "gain map application failed: %s\n", avifResultToString(result));
+                return 1;
+            }
+            best = (elapsed < best) ? elapsed : best;
+        }
+        printf("maxThreads %d: best of %d %.2f ms, %.1f Mpixels/s, maxCLL %u maxPALL %u\n",
+               threadCounts[t],
+               RUNS,
+               best * 1e3,
+               (double)WIDTH * HEIGHT / best * 1e-6,
+               clli.maxCLL,
+               clli.maxPALL);
+    }
+    avifGainMapDestroy(gainMap);
+    avifImageDestroy(base);
+    return 0;
+}
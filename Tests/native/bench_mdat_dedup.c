@@ -0,0 +1,131 @@
+// Times avifEncoderFinish() on a 32x32 grid of 64x64 cells showing only 7 distinct tiles, where writing the mdat box
+// looks up every cell among the chunks written before it. Cells are encoded by the stand-in codec of stub_codec.c, so
+// the time is spent writing the file rather than in AV1. The file is decoded back and must show the source tiles.
+
+// clock_gettime()
+#define _POSIX_C_SOURCE 199309L
+
+#include "avif/avif.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define GRID_COLUMNS 32
+#define GRID_ROWS 32
+#define CELL_SIZE 64
+#define DISTINCT_TILES 7
+#define RUNS 20
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint8_t tileSample(uint32_t tile, int plane, uint32_t x, uint32_t y)
+{
+    return (uint8_t)(tile * 37 + (uint32_t)plane * 11 + x * 3 + y * 5);
+}
+
+static avifImage * createTile(uint32_t tile)
+{
+    avifImage * image = avifImageCreate(CELL_SIZE, CELL_SIZE, 8, AVIF_PIXEL_FORMAT_YUV420);
+    if (!image) {
+        return NULL;
+    }
+    if (avifImageAllocatePlanes(image, AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+        avifImageDestroy(image);
+        return NULL;
+    }
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_V; ++plane) {
+        for (uint32_t y = 0; y < avifImagePlaneHeight(image, plane); ++y) {
+            uint8_t * row = avifImagePlane(image, plane) + (size_t)y * avifImagePlaneRowBytes(image, plane);
+            for (uint32_t x = 0; x < avifImagePlaneWidth(image, plane); ++x) {
+                row[x] = tileSample(tile, plane, x, y);
+            }
+        }
+    }
+    return image;
+}
+
+// Checks that every cell of the decoded grid shows the tile it was encoded from
+static avifBool decodedGridMatches(const avifRWData * output)
+{
+    avifImage * decoded = avifImageCreateEmpty();
+    avifDecoder * decoder = avifDecoderCreate();
+    avifBool matches = decoded && decoder && avifDecoderReadMemory(decoder, decoded, output->data, output->size) == AVIF_RESULT_OK &&
+                       decoded->width == GRID_COLUMNS * CELL_SIZE && decoded->height == GRID_ROWS * CELL_SIZE;
+    for (uint32_t y = 0; matches && y < decoded->height; ++y) {
+        const uint8_t * row = decoded->yuvPlanes[AVIF_CHAN_Y] + (size_t)y * decoded->yuvRowBytes[AVIF_CHAN_Y];
+        for (uint32_t x = 0; x < decoded->width; ++x) {
+            const uint32_t cell = (y / CELL_SIZE) * GRID_COLUMNS + x / CELL_SIZE;
+            if (row[x] != tileSample(cell % DISTINCT_TILES, AVIF_CHAN_Y, x % CELL_SIZE, y % CELL_SIZE)) {
+                matches = AVIF_FALSE;
+                break;
+            }
+        }
+    }
+    if (decoder) {
+        avifDecoderDestroy(decoder);
+    }
+    if (decoded) {
+        avifImageDestroy(decoded);
+    }
+    return matches;
+}
+
+int main(void)
+{
+    avifImage * tiles[DISTINCT_TILES] = { NULL };
+    const avifImage * cells[GRID_COLUMNS * GRID_ROWS];
+    avifRWData output = AVIF_DATA_EMPTY;
+    int failures = 1;
+    for (uint32_t tile = 0; tile < DISTINCT_TILES; ++tile) {
+        tiles[tile] = createTile(tile);
+        if (!tiles[tile]) {
+            fprintf(stderr, "allocating the tiles failed\n");
+            goto cleanup;
+        }
+    }
+    for (uint32_t cell = 0; cell < GRID_COLUMNS * GRID_ROWS; ++cell) {
+        cells[cell] = tiles[cell % DISTINCT_TILES];
+    }
+
+    double finishSeconds = 0.0;
+    for (int run = 0; run < RUNS; ++run) {
+        avifEncoder * encoder = avifEncoderCreate();
+        avifRWDataFree(&output);
+        avifResult result = encoder ? avifEncoderAddImageGrid(encoder, GRID_COLUMNS, GRID_ROWS, cells, AVIF_ADD_IMAGE_FLAG_SINGLE)
+                                    : AVIF_RESULT_OUT_OF_MEMORY;
+        const double start = now();
+        if (result == AVIF_RESULT_OK) {
+            result = avifEncoderFinish(encoder, &output);
+        }
+        finishSeconds += now() - start;
+        if (encoder) {
+            avifEncoderDestroy(encoder);
+        }
+        if (result != AVIF_RESULT_OK) {
+            fprintf(stderr, "encoding the grid failed: %s\n", avifResultToString(result));
+            goto cleanup;
+        }
+    }
+    if (!decodedGridMatches(&output)) {
+        fprintf(stderr, "the decoded grid does not show the source tiles\n");
+        goto cleanup;
+    }
+    printf("%dx%d grid of %dx%d cells, %d distinct tiles: avifEncoderFinish %8.3f ms, %zu byte file\n", GRID_COLUMNS, GRID_ROWS,
+           CELL_SIZE, CELL_SIZE, DISTINCT_TILES, finishSeconds * 1e3 / RUNS, output.size);
+    failures = 0;
+
+cleanup:
+    for (uint32_t tile = 0; tile < DISTINCT_TILES; ++tile) {
+        if (tiles[tile]) {
+            avifImageDestroy(tiles[tile]);
+        }
+    }
+    avifRWDataFree(&output);
+    return failures;
+}
@@ -0,0 +1,516 @@
+// Times avifPeekImageInfo() against avifDecoderParse(), which readSize used on its own before, on files held in memory:
+// a still image with alpha, a grid of tiles and an image sequence with an alpha track. The files are written box by
+// box, since there is no AV1 encoder here, with payloads that are never decoded. Both calls must describe the files the
+// same way.
+
+// clock_gettime()
+#define _POSIX_C_SOURCE 199309L
+
+#include "avif/internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define PEEK_RUNS 20000
+#define PARSE_RUNS 2000
+#define PAYLOAD_SIZE 64
+#define SEQUENCE_FRAMES 60
+#define GRID_COLUMNS 4
+#define GRID_ROWS 4
+#define TILE_SIZE 256
+
+static const char alphaUrn[] = "urn:mpeg:mpegB:cicp:systems:auxiliary:alpha";
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static avifResult writeFtyp(avifRWStream * s, const char * majorBrand, const char * const * brands, int brandCount)
+{
+    avifBoxMarker ftyp;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "ftyp", AVIF_BOX_SIZE_TBD, &ftyp));
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, majorBrand, 4));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    for (int i = 0; i < brandCount; ++i) {
+        AVIF_CHECKRES(avifRWStreamWriteChars(s, brands[i], 4));
+    }
+    avifRWStreamFinishBox(s, ftyp);
+    return AVIF_RESULT_OK;
+}
+
+static avifResult writeHdlr(avifRWStream * s)
+{
+    avifBoxMarker hdlr;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "hdlr", AVIF_BOX_SIZE_TBD, 0, 0, &hdlr));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, "pict", 4));
+    AVIF_CHECKRES(avifRWStreamWriteZeros(s, 12));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, 0));
+    avifRWStreamFinishBox(s, hdlr);
+    return AVIF_RESULT_OK;
+}
+
+// 8-bit 4:2:0 color, or 8-bit monochrome for alpha.
+static avifResult writeAv1C(avifRWStream * s, avifBool monochrome)
+{
+    avifBoxMarker av1C;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "av1C", AVIF_BOX_SIZE_TBD, &av1C));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, 0x81));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, 0x08));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, (uint8_t)((monochrome ? 0x10 : 0) | 0x0C)));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, 0));
+    avifRWStreamFinishBox(s, av1C);
+    return AVIF_RESULT_OK;
+}
+
+static avifResult writeColr(avifRWStream * s)
+{
+    avifBoxMarker colr;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "colr", AVIF_BOX_SIZE_TBD, &colr));
+    AVIF_CHECKRES(avifRWStreamWriteChars(s, "nclx", 4));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, AVIF_COLOR_PRIMARIES_BT709));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, AVIF_TRANSFER_CHARACTERISTICS_SRGB));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, AVIF_MATRIX_COEFFICIENTS_BT601));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, 0x80));
+    avifRWStreamFinishBox(s, colr);
+    return AVIF_RESULT_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Items
+
+typedef struct Item
+{
+    uint16_t id;
+    const char * type;
+    uint16_t auxForID;    // auxl reference, 0 if none
+    uint32_t width;
+    uint32_t height;
+    avifBool monochrome;  // av1 items only
+    uint16_t gridColumns; // grid items only, referencing the items that follow it
+    uint16_t gridRows;
+} Item;
+
+static size_t itemPayloadSize(const Item * item)
+{
+    return !strcmp(item->type, "grid") ? 8 : PAYLOAD_SIZE;
+}
+
+// Property indices in ipco, 1-based: ispe of the colour size, ispe of the tile size, colour av1C, alpha av1C, 8-bit
+// 3 channel pixi, 8-bit 1 channel pixi, colr, auxC.
+enum
+{
+    PROPERTY_ISPE_IMAGE = 1,
+    PROPERTY_ISPE_TILE,
+    PROPERTY_AV1C_COLOR,
+    PROPERTY_AV1C_ALPHA,
+    PROPERTY_PIXI_COLOR,
+    PROPERTY_PIXI_ALPHA,
+    PROPERTY_COLR,
+    PROPERTY_AUXC
+};
+
+static avifResult writeIspe(avifRWStream * s, uint32_t width, uint32_t height)
+{
+    avifBoxMarker ispe;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "ispe", AVIF_BOX_SIZE_TBD, 0, 0, &ispe));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, width));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, height));
+    avifRWStreamFinishBox(s, ispe);
+    return AVIF_RESULT_OK;
+}
+
+static avifResult writePixi(avifRWStream * s, uint8_t channels)
+{
+    avifBoxMarker pixi;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "pixi", AVIF_BOX_SIZE_TBD, 0, 0, &pixi));
+    AVIF_CHECKRES(avifRWStreamWriteU8(s, channels));
+    for (uint8_t c = 0; c < channels; ++c) {
+        AVIF_CHECKRES(avifRWStreamWriteU8(s, 8));
+    }
+    avifRWStreamFinishBox(s, pixi);
+    return AVIF_RESULT_OK;
+}
+
+static avifResult writeItemFile(avifRWData * output, const Item * items, uint16_t itemCount, uint32_t imageWidth, uint32_t imageHeight, uint32_t tileWidth, uint32_t tileHeight)
+{
+    static const char * const brands[] = { "avif", "mif1", "miaf" };
+    avifRWStream s;
+    avifRWStreamStart(&s, output);
+    AVIF_CHECKRES(writeFtyp(&s, "avif", brands, 3));
+
+    avifBoxMarker meta;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "meta", AVIF_BOX_SIZE_TBD, 0, 0, &meta));
+    AVIF_CHECKRES(writeHdlr(&s));
+    avifBoxMarker pitm;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "pitm", AVIF_BOX_SIZE_TBD, 0, 0, &pitm));
+    AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[0].id));
+    avifRWStreamFinishBox(&s, pitm);
+
+    // Extents are patched once the offset of mdat is known.
+    avifBoxMarker iloc;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "iloc", AVIF_BOX_SIZE_TBD, 0, 0, &iloc));
+    AVIF_CHECKRES(avifRWStreamWriteU8(&s, 0x44)); // 4 byte offsets and lengths
+    AVIF_CHECKRES(avifRWStreamWriteU8(&s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU16(&s, itemCount));
+    size_t extentOffsets[GRID_COLUMNS * GRID_ROWS + 2];
+    for (uint16_t i = 0; i < itemCount; ++i) {
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i].id));
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, 0));
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, 1));
+        extentOffsets[i] = avifRWStreamOffset(&s);
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, 0));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, (uint32_t)itemPayloadSize(&items[i])));
+    }
+    avifRWStreamFinishBox(&s, iloc);
+
+    avifBoxMarker iinf;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "iinf", AVIF_BOX_SIZE_TBD, 0, 0, &iinf));
+    AVIF_CHECKRES(avifRWStreamWriteU16(&s, itemCount));
+    for (uint16_t i = 0; i < itemCount; ++i) {
+        avifBoxMarker infe;
+        AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "infe", AVIF_BOX_SIZE_TBD, 2, 0, &infe));
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i].id));
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, 0));
+        AVIF_CHECKRES(avifRWStreamWriteChars(&s, items[i].type, 4));
+        AVIF_CHECKRES(avifRWStreamWriteU8(&s, 0));
+        avifRWStreamFinishBox(&s, infe);
+    }
+    avifRWStreamFinishBox(&s, iinf);
+
+    avifBoxMarker iref;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "iref", AVIF_BOX_SIZE_TBD, 0, 0, &iref));
+    for (uint16_t i = 0; i < itemCount; ++i) {
+        if (items[i].gridColumns) {
+            const uint16_t tiles = (uint16_t)(items[i].gridColumns * items[i].gridRows);
+            avifBoxMarker dimg;
+            AVIF_CHECKRES(avifRWStreamWriteBox(&s, "dimg", AVIF_BOX_SIZE_TBD, &dimg));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i].id));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, tiles));
+            for (uint16_t t = 1; t <= tiles; ++t) {
+                AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i + t].id));
+            }
+            avifRWStreamFinishBox(&s, dimg);
+        }
+        if (items[i].auxForID) {
+            avifBoxMarker auxl;
+            AVIF_CHECKRES(avifRWStreamWriteBox(&s, "auxl", AVIF_BOX_SIZE_TBD, &auxl));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i].id));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, 1));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i].auxForID));
+            avifRWStreamFinishBox(&s, auxl);
+        }
+    }
+    avifRWStreamFinishBox(&s, iref);
+
+    avifBoxMarker iprp;
+    AVIF_CHECKRES(avifRWStreamWriteBox(&s, "iprp", AVIF_BOX_SIZE_TBD, &iprp));
+    avifBoxMarker ipco;
+    AVIF_CHECKRES(avifRWStreamWriteBox(&s, "ipco", AVIF_BOX_SIZE_TBD, &ipco));
+    AVIF_CHECKRES(writeIspe(&s, imageWidth, imageHeight));
+    AVIF_CHECKRES(writeIspe(&s, tileWidth, tileHeight));
+    AVIF_CHECKRES(writeAv1C(&s, AVIF_FALSE));
+    AVIF_CHECKRES(writeAv1C(&s, AVIF_TRUE));
+    AVIF_CHECKRES(writePixi(&s, 3));
+    AVIF_CHECKRES(writePixi(&s, 1));
+    AVIF_CHECKRES(writeColr(&s));
+    avifBoxMarker auxC;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "auxC", AVIF_BOX_SIZE_TBD, 0, 0, &auxC));
+    AVIF_CHECKRES(avifRWStreamWriteChars(&s, alphaUrn, sizeof(alphaUrn)));
+    avifRWStreamFinishBox(&s, auxC);
+    avifRWStreamFinishBox(&s, ipco);
+
+    avifBoxMarker ipma;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "ipma", AVIF_BOX_SIZE_TBD, 0, 0, &ipma));
+    AVIF_CHECKRES(avifRWStreamWriteU32(&s, itemCount));
+    for (uint16_t i = 0; i < itemCount; ++i) {
+        uint8_t associations[4];
+        uint8_t count = 0;
+        const avifBool tile = (items[i].width != imageWidth || items[i].height != imageHeight);
+        associations[count++] = tile ? PROPERTY_ISPE_TILE : PROPERTY_ISPE_IMAGE;
+        if (!strcmp(items[i].type, "av01")) {
+            associations[count++] = 0x80 | (items[i].monochrome ? PROPERTY_AV1C_ALPHA : PROPERTY_AV1C_COLOR);
+        }
+        associations[count++] = items[i].monochrome ? PROPERTY_PIXI_ALPHA : PROPERTY_PIXI_COLOR;
+        associations[count++] = items[i].auxForID ? (0x80 | PROPERTY_AUXC) : PROPERTY_COLR;
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, items[i].id));
+        AVIF_CHECKRES(avifRWStreamWriteU8(&s, count));
+        AVIF_CHECKRES(avifRWStreamWrite(&s, associations, count));
+    }
+    avifRWStreamFinishBox(&s, ipma);
+    avifRWStreamFinishBox(&s, iprp);
+    avifRWStreamFinishBox(&s, meta);
+
+    avifBoxMarker mdat;
+    AVIF_CHECKRES(avifRWStreamWriteBox(&s, "mdat", AVIF_BOX_SIZE_TBD, &mdat));
+    for (uint16_t i = 0; i < itemCount; ++i) {
+        const size_t offset = avifRWStreamOffset(&s);
+        if (items[i].gridColumns) {
+            AVIF_CHECKRES(avifRWStreamWriteU8(&s, 0));
+            AVIF_CHECKRES(avifRWStreamWriteU8(&s, 0));
+            AVIF_CHECKRES(avifRWStreamWriteU8(&s, (uint8_t)(items[i].gridRows - 1)));
+            AVIF_CHECKRES(avifRWStreamWriteU8(&s, (uint8_t)(items[i].gridColumns - 1)));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, (uint16_t)items[i].width));
+            AVIF_CHECKRES(avifRWStreamWriteU16(&s, (uint16_t)items[i].height));
+        } else {
+            AVIF_CHECKRES(avifRWStreamWriteZeros(&s, PAYLOAD_SIZE));
+        }
+        avifRWStreamSetOffset(&s, extentOffsets[i]);
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, (uint32_t)offset));
+        avifRWStreamSetOffset(&s, offset + itemPayloadSize(&items[i]));
+    }
+    avifRWStreamFinishBox(&s, mdat);
+    avifRWStreamFinishWrite(&s);
+    return AVIF_RESULT_OK;
+}
+
+static avifResult writeStill(avifRWData * output)
+{
+    const Item items[] = {
+        { 1, "av01", 0, 1920, 1080, AVIF_FALSE, 0, 0 },
+        { 2, "av01", 1, 1920, 1080, AVIF_TRUE, 0, 0 },
+    };
+    return writeItemFile(output, items, 2, 1920, 1080, 1920, 1080);
+}
+
+static avifResult writeGrid(avifRWData * output)
+{
+    Item items[GRID_COLUMNS * GRID_ROWS + 1];
+    items[0] = (Item) { 1, "grid", 0, GRID_COLUMNS * TILE_SIZE, GRID_ROWS * TILE_SIZE, AVIF_FALSE, GRID_COLUMNS, GRID_ROWS };
+    for (uint16_t t = 1; t <= GRID_COLUMNS * GRID_ROWS; ++t) {
+        items[t] = (Item) { (uint16_t)(t + 1), "av01", 0, TILE_SIZE, TILE_SIZE, AVIF_FALSE, 0, 0 };
+    }
+    return writeItemFile(output, items, GRID_COLUMNS * GRID_ROWS + 1, GRID_COLUMNS * TILE_SIZE, GRID_ROWS * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+}
+
+// ---------------------------------------------------------------------------
+// Sequence
+
+static avifResult writeMatrix(avifRWStream * s)
+{
+    static const uint32_t unity[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+    for (int i = 0; i < 9; ++i) {
+        AVIF_CHECKRES(avifRWStreamWriteU32(s, unity[i]));
+    }
+    return AVIF_RESULT_OK;
+}
+
+// A track of SEQUENCE_FRAMES samples in a single chunk at chunkOffset.
+static avifResult writeTrak(avifRWStream * s, uint32_t trackID, uint32_t auxForID, uint32_t width, uint32_t height, uint32_t chunkOffset)
+{
+    avifBoxMarker trak;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "trak", AVIF_BOX_SIZE_TBD, &trak));
+    avifBoxMarker tkhd;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "tkhd", AVIF_BOX_SIZE_TBD, 0, 1, &tkhd));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, trackID));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, SEQUENCE_FRAMES));
+    AVIF_CHECKRES(avifRWStreamWriteZeros(s, 8));
+    AVIF_CHECKRES(avifRWStreamWriteZeros(s, 8)); // layer, alternate group, volume, reserved
+    AVIF_CHECKRES(writeMatrix(s));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, width << 16));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, height << 16));
+    avifRWStreamFinishBox(s, tkhd);
+    if (auxForID) {
+        avifBoxMarker tref, auxl;
+        AVIF_CHECKRES(avifRWStreamWriteBox(s, "tref", AVIF_BOX_SIZE_TBD, &tref));
+        AVIF_CHECKRES(avifRWStreamWriteBox(s, "auxl", AVIF_BOX_SIZE_TBD, &auxl));
+        AVIF_CHECKRES(avifRWStreamWriteU32(s, auxForID));
+        avifRWStreamFinishBox(s, auxl);
+        avifRWStreamFinishBox(s, tref);
+    }
+
+    avifBoxMarker mdia;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "mdia", AVIF_BOX_SIZE_TBD, &mdia));
+    avifBoxMarker mdhd;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "mdhd", AVIF_BOX_SIZE_TBD, 0, 0, &mdhd));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 30)); // timescale
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, SEQUENCE_FRAMES));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, 21956)); // "und"
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, 0));
+    avifRWStreamFinishBox(s, mdhd);
+    AVIF_CHECKRES(writeHdlr(s));
+    avifBoxMarker minf, stbl;
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "minf", AVIF_BOX_SIZE_TBD, &minf));
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "stbl", AVIF_BOX_SIZE_TBD, &stbl));
+
+    avifBoxMarker stsd, av01;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "stsd", AVIF_BOX_SIZE_TBD, 0, 0, &stsd));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    AVIF_CHECKRES(avifRWStreamWriteBox(s, "av01", AVIF_BOX_SIZE_TBD, &av01));
+    AVIF_CHECKRES(avifRWStreamWriteZeros(s, 6));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, 1)); // data_reference_index
+    AVIF_CHECKRES(avifRWStreamWriteZeros(s, 16));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, (uint16_t)width));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, (uint16_t)height));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0x00480000));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0x00480000));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, 1)); // frame_count
+    AVIF_CHECKRES(avifRWStreamWriteZeros(s, 32));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, 0x0018));
+    AVIF_CHECKRES(avifRWStreamWriteU16(s, 0xFFFF));
+    AVIF_CHECKRES(writeAv1C(s, auxForID != 0));
+    if (!auxForID) {
+        AVIF_CHECKRES(writeColr(s));
+    }
+    avifRWStreamFinishBox(s, av01);
+    avifRWStreamFinishBox(s, stsd);
+
+    avifBoxMarker stts, stsc, stsz, stco;
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "stts", AVIF_BOX_SIZE_TBD, 0, 0, &stts));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, SEQUENCE_FRAMES));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    avifRWStreamFinishBox(s, stts);
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "stsc", AVIF_BOX_SIZE_TBD, 0, 0, &stsc));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, SEQUENCE_FRAMES));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    avifRWStreamFinishBox(s, stsc);
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "stsz", AVIF_BOX_SIZE_TBD, 0, 0, &stsz));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 0));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, SEQUENCE_FRAMES));
+    for (int i = 0; i < SEQUENCE_FRAMES; ++i) {
+        AVIF_CHECKRES(avifRWStreamWriteU32(s, PAYLOAD_SIZE));
+    }
+    avifRWStreamFinishBox(s, stsz);
+    AVIF_CHECKRES(avifRWStreamWriteFullBox(s, "stco", AVIF_BOX_SIZE_TBD, 0, 0, &stco));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, 1));
+    AVIF_CHECKRES(avifRWStreamWriteU32(s, chunkOffset));
+    avifRWStreamFinishBox(s, stco);
+
+    avifRWStreamFinishBox(s, stbl);
+    avifRWStreamFinishBox(s, minf);
+    avifRWStreamFinishBox(s, mdia);
+    avifRWStreamFinishBox(s, trak);
+    return AVIF_RESULT_OK;
+}
+
+// The color and alpha samples follow moov in a single mdat. moov is written twice, the first time to learn its size.
+static avifResult writeSequence(avifRWData * output)
+{
+    static const char * const brands[] = { "avis", "msf1", "iso8", "mif1", "miaf" };
+    size_t mdatOffset = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        avifRWStream s;
+        avifRWStreamStart(&s, output);
+        AVIF_CHECKRES(writeFtyp(&s, "avis", brands, 5));
+        avifBoxMarker moov, mvhd;
+        AVIF_CHECKRES(avifRWStreamWriteBox(&s, "moov", AVIF_BOX_SIZE_TBD, &moov));
+        AVIF_CHECKRES(avifRWStreamWriteFullBox(&s, "mvhd", AVIF_BOX_SIZE_TBD, 0, 0, &mvhd));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, 0));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, 0));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, 30));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, SEQUENCE_FRAMES));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, 0x00010000));
+        AVIF_CHECKRES(avifRWStreamWriteU16(&s, 0x0100));
+        AVIF_CHECKRES(avifRWStreamWriteZeros(&s, 10));
+        AVIF_CHECKRES(writeMatrix(&s));
+        AVIF_CHECKRES(avifRWStreamWriteZeros(&s, 24));
+        AVIF_CHECKRES(avifRWStreamWriteU32(&s, 3));
+        avifRWStreamFinishBox(&s, mvhd);
+        const uint32_t samplesOffset = (uint32_t)(mdatOffset + 8);
+        AVIF_CHECKRES(writeTrak(&s, 1, 0, 1280, 720, samplesOffset));
+        AVIF_CHECKRES(writeTrak(&s, 2, 1, 1280, 720, samplesOffset + SEQUENCE_FRAMES * PAYLOAD_SIZE));
+        avifRWStreamFinishBox(&s, moov);
+        mdatOffset = avifRWStreamOffset(&s);
+        avifBoxMarker mdat;
+        AVIF_CHECKRES(avifRWStreamWriteBox(&s, "mdat", AVIF_BOX_SIZE_TBD, &mdat));
+        AVIF_CHECKRES(avifRWStreamWriteZeros(&s, 2 * SEQUENCE_FRAMES * PAYLOAD_SIZE));
+        avifRWStreamFinishBox(&s, mdat);
+        avifRWStreamFinishWrite(&s);
+    }
+    return AVIF_RESULT_OK;
+}
+
+// ---------------------------------------------------------------------------
+
+static avifResult parse(const avifRWData * file, avifDecoder ** outDecoder)
+{
+    avifDecoder * decoder = avifDecoderCreate();
+    if (!decoder) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    avifResult result = avifDecoderSetIOMemory(decoder, file->data, file->size);
+    if (result == AVIF_RESULT_OK) {
+        result = avifDecoderParse(decoder);
+    }
+    if (outDecoder && result == AVIF_RESULT_OK) {
+        *outDecoder = decoder;
+    } else {
+        avifDecoderDestroy(decoder);
+    }
+    return result;
+}
+
+static int bench(const char * name, const avifRWData * file)
+{
+    const avifROData input = { file->data, file->size };
+    avifImageInfo info;
+    avifDecoder * decoder = NULL;
+    const avifResult peekResult = avifPeekImageInfo(&input, &info);
+    const avifResult parseResult = parse(file, &decoder);
+    if (peekResult != AVIF_RESULT_OK || parseResult != AVIF_RESULT_OK) {
+        printf("FAIL %-8s peek: %s, parse: %s\n", name, avifResultToString(peekResult), avifResultToString(parseResult));
+        return 1;
+    }
+    const avifBool same = info.width == decoder->image->width && info.height == decoder->image->height &&
+                          info.depth == decoder->image->depth && info.yuvFormat == decoder->image->yuvFormat &&
+                          info.alphaPresent == decoder->alphaPresent && (int)info.frameCount == decoder->imageCount;
+    avifDecoderDestroy(decoder);
+
+    double start = now();
+    for (int i = 0; i < PEEK_RUNS; ++i) {
+        if (avifPeekImageInfo(&input, &info) != AVIF_RESULT_OK) {
+            return 1;
+        }
+    }
+    const double peek = (now() - start) / PEEK_RUNS;
+    start = now();
+    for (int i = 0; i < PARSE_RUNS; ++i) {
+        if (parse(file, NULL) != AVIF_RESULT_OK) {
+            return 1;
+        }
+    }
+    const double full = (now() - start) / PARSE_RUNS;
+    printf("%s %-8s %ux%u, %u frames%s: avifPeekImageInfo %.2f us, avifDecoderParse %.2f us (%.1fx)\n",
+           same ? "ok  " : "FAIL",
+           name,
+           info.width,
+           info.height,
+           info.frameCount,
+           info.alphaPresent ? ", alpha" : "",
+           peek * 1e6,
+           full * 1e6,
+           full / peek);
+    return same ? 0 : 1;
+}
+
+int main(void)
+{
+    avifRWData still = AVIF_DATA_EMPTY;
+    avifRWData grid = AVIF_DATA_EMPTY;
+    avifRWData sequence = AVIF_DATA_EMPTY;
+    int failures = 1;
+    if (writeStill(&still) != AVIF_RESULT_OK || writeGrid(&grid) != AVIF_RESULT_OK || writeSequence(&sequence) != AVIF_RESULT_OK) {
+        fprintf(stderr, "writing the files failed\n");
+        goto cleanup;
+    }
+    failures = bench("still", &still) + bench("grid", &grid) + bench("sequence", &sequence);
+
+cleanup:
+    avifRWDataFree(&still);
+    avifRWDataFree(&grid);
+    avifRWDataFree(&sequence);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+// Times concurrency::parallel_for on the shared ThreadPool against spawning and joining threads on every call, like
+// parallel_for did before the pool, for an empty body and for about a millisecond of work per call. Every
+// iteration must run exactly once with both.
+
+#include "concurrency.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    // The former parallel_for: the caller runs the first segment, one new thread runs each of the others
+    template<typename Function>
+    void spawningParallelFor(const int numThreads, const int numIterations, Function &&func) {
+        std::vector<std::thread> threads;
+        const int segmentHeight = numIterations / numThreads;
+        auto parallelWorker = [&](int start, int end) {
+            for (int y = start; y < end; ++y) {
+                func(y);
+            }
+        };
+        for (int i = 1; i < numThreads; ++i) {
+            const int end = (i == numThreads - 1) ? numIterations : (i + 1) * segmentHeight;
+            threads.emplace_back(parallelWorker, i * segmentHeight, end);
+        }
+        parallelWorker(0, numThreads == 1 ? numIterations : segmentHeight);
+        for (auto &thread: threads) {
+            thread.join();
+        }
+    }
+
+    template<typename Call>
+    double microsecondsPerCall(int calls, Call call) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < calls; ++i) {
+            call();
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / calls;
+    }
+
+    // Returns false when an iteration did not run exactly once.
+    bool bench(const char *name, int threads, int iterations, int calls, int workPerIteration) {
+        std::vector<std::atomic<int>> counts(iterations);
+        std::vector<float> sink(iterations);
+        auto body = [&](int y) {
+            float value = static_cast<float>(y);
+            for (int i = 0; i < workPerIteration; ++i) {
+                value = std::sqrt(value + static_cast<float>(i));
+            }
+            sink[y] = value;
+            counts[y].fetch_add(1, std::memory_order_relaxed);
+        };
+        const double pool = microsecondsPerCall(calls, [&] {
+            concurrency::parallel_for(threads, iterations, body);
+        });
+        const double spawning = microsecondsPerCall(calls, [&] {
+            spawningParallelFor(threads, iterations, body);
+        });
+        const bool ok = std::all_of(counts.begin(), counts.end(), [&](const std::atomic<int> &count) {
+            return count.load() == 2 * calls;
+        });
+        std::printf("%s %-6s %d threads, %4d iterations: pool %8.2f us/call, spawning %8.2f us/call (%.1fx)\n",
+                    ok ? "ok  " : "FAIL", name, threads, iterations, pool, spawning, spawning / pool);
+        return ok;
+    }
+}
+
+int main() {
+    concurrency::ThreadPool::setConcurrencyBudget(8);
+    std::printf("%u hardware threads, pool of %d workers\n", std::thread::hardware_concurrency(),
+                concurrency::ThreadPool::shared().size());
+    bool ok = true;
+    for (const int threads: { 2, 4, 8 }) {
+        // Per call overhead, like the row loops of small images
+        ok &= bench("empty", threads, 64, 2000, 0);
+        // Around a millisecond of work split over the threads
+        ok &= bench("loaded", threads, 1024, 200, 256);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+// avifpixart is only shipped as an Apple xcframework. These definitions satisfy the linker for scale.cpp and for the
+// avifc sources under test. The scalers and the conversions to RGB leave their output untouched: no native test checks
+// scaled or converted pixels, test_pixel_buffer_reuse only counts the buffers they are written to.
+// pixart_rgba8_to_yuv8 is a plain full range BT.601 conversion whatever the range and matrix, with chroma averaged over
+// the pixels it covers, so that test_premultiplied_yuv can compare two ways of calling it.
+#include "avifpixart.h"
+
+#include <algorithm>
+
+void pixart_scale_plane_u16(const uint16_t *, uintptr_t, uint32_t, uint32_t, uint16_t *, uint32_t, uint32_t, uintptr_t) {}
+
+void pixart_scale_plane_u8(const uint8_t *, uint32_t, uint32_t, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t) {}
+
+void pixart_rgb_u16_to_ra30(const uint16_t *, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+void pixart_rgba_u16_to_f16(const uint16_t *, uint32_t, uint16_t *, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+void pixart_rgb_u16_to_f16(const uint16_t *, uint32_t, uint16_t *, uint32_t, uint32_t, uint32_t, uint32_t) {}
+
+void pixart_yuv8_to_rgb8(const uint8_t *, uint32_t, const uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                         uint8_t *, uint32_t, uint32_t, uint32_t, YuvRange, YuvMatrix, YuvType) {}
+
+void pixart_yuv400_to_rgb8(const uint8_t *, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t, YuvRange, YuvMatrix) {}
+
+void pixart_yuv400_with_alpha_to_rgba8(const uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                                       uint8_t *, uint32_t, uint32_t, uint32_t, YuvRange, YuvMatrix) {}
+
+void pixart_yuv400_p16_to_rgb16(const uint16_t *, uint32_t, uint16_t *, uint32_t, uint32_t, uint32_t, uint32_t,
+                                YuvRange, YuvMatrix) {}
+
+void pixart_yuv400_p16_with_alpha_to_rgba16(const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                                            uint16_t *, uint32_t, uint32_t, uint32_t, uint32_t, YuvRange, YuvMatrix) {}
+
+void pixart_yuv8_with_alpha_to_rgba8(const uint8_t *, uint32_t, const uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                                     const uint8_t *, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t,
+                                     YuvRange, YuvMatrix, YuvType) {}
+
+void pixart_yuv16_to_rgb16(const uint16_t *, uint32_t, const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                           uint16_t *, uint32_t, uint32_t, uint32_t, uint32_t, YuvRange, YuvMatrix, YuvType) {}
+
+void pixart_yuv16_with_alpha_to_rgba16(const uint16_t *, uint32_t, const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                                       const uint16_t *, uint32_t, uint16_t *, uint32_t, uint32_t, uint32_t, uint32_t,
+                                       YuvRange, YuvMatrix, YuvType) {}
+
+void pixart_icgc12_r_to_rgb10(const uint16_t *, uint32_t, const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                              uint16_t *, uint32_t, uint32_t, uint32_t, YuvRange, AvifYCgCoRType, YuvType) {}
+
+void pixart_icgc_r_alpha12_to_rgba10(const uint16_t *, uint32_t, const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                                     const uint16_t *, uint32_t, uint16_t *, uint32_t, uint32_t, uint32_t,
+                                     YuvRange, AvifYCgCoRType, YuvType) {}
+
+void pixart_icgc_r_type_to_rgb(const uint16_t *, uint32_t, const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                               uint8_t *, uint32_t, uint32_t, uint32_t, YuvRange, AvifYCgCoRType, YuvType) {}
+
+void pixart_icgc_r_type_with_alpha_to_rgba(const uint16_t *, uint32_t, const uint16_t *, uint32_t, const uint16_t *, uint32_t,
+                                           const uint16_t *, uint32_t, uint8_t *, uint32_t, uint32_t, uint32_t,
+                                           YuvRange, AvifYCgCoRType, YuvType) {}
+
+void pixart_rgba8_to_yuv8(uint8_t *y_plane, uint32_t y_stride, uint8_t *u_plane, uint32_t u_stride,
+                          uint8_t *v_plane, uint32_t v_stride, const uint8_t *rgba, uint32_t rgba_stride,
+                          uint32_t width, uint32_t height, YuvRange, YuvMatrix, YuvType yuv_type) {
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t *src = rgba + static_cast<size_t>(rgba_stride) * y;
+        uint8_t *dst = y_plane + static_cast<size_t>(y_stride) * y;
+        for (uint32_t x = 0; x < width; ++x, src += 4) {
+            dst[x] = static_cast<uint8_t>((77 * src[0] + 150 * src[1] + 29 * src[2] + 128) >> 8);
+        }
+    }
+    const uint32_t shiftX = yuv_type == YuvType::Yuv444 ? 0 : 1;
+    const uint32_t shiftY = yuv_type == YuvType::Yuv420 ? 1 : 0;
+    for (uint32_t cy = 0; cy < (height + shiftY) >> shiftY; ++cy) {
+        for (uint32_t cx = 0; cx < (width + shiftX) >> shiftX; ++cx) {
+            int32_t r = 0, g = 0, b = 0, count = 0;
+            for (uint32_t y = cy << shiftY; y < std::min(height, (cy + 1) << shiftY); ++y) {
+                for (uint32_t x = cx << shiftX; x < std::min(width, (cx + 1) << shiftX); ++x) {
+                    const uint8_t *pixel = rgba + static_cast<size_t>(rgba_stride) * y + x * 4;
+                    r += pixel[0];
+                    g += pixel[1];
+                    b += pixel[2];
+                    ++count;
+                }
+            }
+            r /= count;
+            g /= count;
+            b /= count;
+            const int32_t u = (-43 * r - 85 * g + 128 * b + 128 + (128 << 8)) >> 8;
+            const int32_t v = (128 * r - 107 * g - 21 * b + 128 + (128 << 8)) >> 8;
+            u_plane[static_cast<size_t>(u_stride) * cy + cx] = static_cast<uint8_t>(std::min(u, 255));
+            v_plane[static_cast<size_t>(v_stride) * cy + cx] = static_cast<uint8_t>(std::min(v, 255));
+        }
+    }
+}
@@ -0,0 +1,245 @@
+// Stand-in AV1 codec for the tests and benchmarks that encode or decode, registered as "aom" by compiling avif.c with
+// AVIF_CODEC_AOM (see the Makefile). A sample is a sequence header OBU describing the image, so that the av1C written
+// by the encoder is right, followed by a padding OBU holding the raw planes. Decoding copies the planes back, so the
+// round trip is lossless.
+
+#include "avif/internal.h"
+
+#include <string.h>
+
+#define OBU_SEQUENCE_HEADER 1
+#define OBU_PADDING 15
+// Width, height, depth and format of the planes at the start of the padding OBU.
+#define PLANES_HEADER_SIZE 16
+
+typedef struct BitWriter
+{
+    uint8_t bytes[32];
+    uint32_t bitCount;
+} BitWriter;
+
+static void writeBits(BitWriter * writer, uint32_t value, int bitCount)
+{
+    for (int i = bitCount - 1; i >= 0; --i) {
+        if ((value >> i) & 1) {
+            writer->bytes[writer->bitCount >> 3] |= (uint8_t)(0x80 >> (writer->bitCount & 7));
+        }
+        ++writer->bitCount;
+    }
+}
+
+// Section 5.5 of the AV1 specification, with a reduced still picture header and the color config of the image.
+static size_t writeSequenceHeader(uint8_t * output, const avifImage * image, avifPixelFormat format)
+{
+    BitWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    uint32_t profile = 0;
+    if (format == AVIF_PIXEL_FORMAT_YUV444) {
+        profile = 1;
+    }
+    if (format == AVIF_PIXEL_FORMAT_YUV422 || image->depth == 12) {
+        profile = 2;
+    }
+    writeBits(&writer, profile, 3);
+    writeBits(&writer, 1, 1);  // still_picture
+    writeBits(&writer, 1, 1);  // reduced_still_picture_header
+    writeBits(&writer, 31, 5); // seq_level_idx[0]
+    writeBits(&writer, 15, 4); // frame_width_bits_minus_1
+    writeBits(&writer, 15, 4); // frame_height_bits_minus_1
+    writeBits(&writer, image->width - 1, 16);
+    writeBits(&writer, image->height - 1, 16);
+    writeBits(&writer, 0, 6); // superblock size and intra tools
+    writeBits(&writer, 0, 3); // superres, cdef, restoration
+    writeBits(&writer, image->depth > 8, 1);
+    if (profile == 2 && image->depth > 8) {
+        writeBits(&writer, image->depth == 12, 1);
+    }
+    if (profile != 1) {
+        writeBits(&writer, format == AVIF_PIXEL_FORMAT_YUV400, 1);
+    }
+    writeBits(&writer, 0, 1); // color_description_present_flag
+    writeBits(&writer, 1, 1); // color_range
+    if (format != AVIF_PIXEL_FORMAT_YUV400) {
+        if (profile == 2 && image->depth == 12) {
+            writeBits(&writer, format != AVIF_PIXEL_FORMAT_YUV444, 1);
+            if (format != AVIF_PIXEL_FORMAT_YUV444) {
+                writeBits(&writer, format == AVIF_PIXEL_FORMAT_YUV420, 1);
+            }
+        }
+        if (format == AVIF_PIXEL_FORMAT_YUV420) {
+            writeBits(&writer, 0, 2); // chroma_sample_position
+        }
+        writeBits(&writer, 0, 1); // separate_uv_delta_q
+    }
+    writeBits(&writer, 0, 1); // film_grain_params_present
+    const uint32_t size = (writer.bitCount + 7) / 8;
+    output[0] = (OBU_SEQUENCE_HEADER << 3) | 2;
+    output[1] = (uint8_t)size;
+    memcpy(output + 2, writer.bytes, size);
+    return 2 + size;
+}
+
+static int planeCount(avifPixelFormat format, avifBool alpha)
+{
+    return (alpha || format == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3;
+}
+
+static void planeSize(const avifImage * image, avifPixelFormat format, int plane, uint32_t * width, uint32_t * height)
+{
+    avifPixelFormatInfo info;
+    avifGetPixelFormatInfo(format, &info);
+    *width = plane ? ((image->width + info.chromaShiftX) >> info.chromaShiftX) : image->width;
+    *height = plane ? ((image->height + info.chromaShiftY) >> info.chromaShiftY) : image->height;
+}
+
+static avifResult stubEncodeImage(avifCodec * codec,
+                                  avifEncoder * encoder,
+                                  const avifImage * image,
+                                  avifBool alpha,
+                                  int tileRowsLog2,
+                                  int tileColsLog2,
+                                  int quantizer,
+                                  avifEncoderChanges encoderChanges,
+                                  avifBool disableLaggedOutput,
+                                  avifAddImageFlags addImageFlags,
+                                  avifCodecEncodeOutput * output)
+{
+    (void)codec;
+    (void)encoder;
+    (void)tileRowsLog2;
+    (void)tileColsLog2;
+    (void)quantizer;
+    (void)encoderChanges;
+    (void)disableLaggedOutput;
+    (void)addImageFlags;
+    const avifPixelFormat format = alpha ? AVIF_PIXEL_FORMAT_YUV400 : image->yuvFormat;
+    const uint32_t bytesPerSample = (image->depth > 8) ? 2 : 1;
+    size_t payloadSize = PLANES_HEADER_SIZE;
+    for (int plane = 0; plane < planeCount(format, alpha); ++plane) {
+        uint32_t width, height;
+        planeSize(image, format, plane, &width, &height);
+        payloadSize += (size_t)width * height * bytesPerSample;
+    }
+
+    uint8_t sequenceHeader[40];
+    const size_t sequenceHeaderSize = writeSequenceHeader(sequenceHeader, image, format);
+    avifRWData sample = AVIF_DATA_EMPTY;
+    // The padding OBU size is a leb128 of 4 bytes.
+    AVIF_CHECKRES(avifRWDataRealloc(&sample, sequenceHeaderSize + 1 + 4 + payloadSize));
+    uint8_t * p = sample.data;
+    memcpy(p, sequenceHeader, sequenceHeaderSize);
+    p += sequenceHeaderSize;
+    *p++ = (OBU_PADDING << 3) | 2;
+    uint32_t size = (uint32_t)payloadSize;
+    for (int i = 0; i < 4; ++i, size >>= 7) {
+        *p++ = (uint8_t)((size & 0x7f) | ((i < 3) ? 0x80 : 0));
+    }
+    const uint32_t header[4] = { image->width, image->height, image->depth, (uint32_t)format };
+    memcpy(p, header, PLANES_HEADER_SIZE);
+    p += PLANES_HEADER_SIZE;
+    for (int plane = 0; plane < planeCount(format, alpha); ++plane) {
+        const uint8_t * row = alpha ? image->alphaPlane : image->yuvPlanes[plane];
+        const uint32_t rowBytes = alpha ? image->alphaRowBytes : image->yuvRowBytes[plane];
+        uint32_t width, height;
+        planeSize(image, format, plane, &width, &height);
+        for (uint32_t y = 0; y < height; ++y, row += rowBytes, p += (size_t)width * bytesPerSample) {
+            memcpy(p, row, (size_t)width * bytesPerSample);
+        }
+    }
+    const avifResult result = avifCodecEncodeOutputAddSample(output, sample.data, sample.size, AVIF_TRUE);
+    avifRWDataFree(&sample);
+    return result;
+}
+
+static avifBool stubEncodeFinish(avifCodec * codec, avifCodecEncodeOutput * output)
+{
+    (void)codec;
+    (void)output;
+    return AVIF_TRUE;
+}
+
+static avifBool readLeb128(const uint8_t * data, size_t size, size_t * offset, uint32_t * value)
+{
+    *value = 0;
+    for (int shift = 0; *offset < size && shift < 35; shift += 7) {
+        const uint8_t byte = data[(*offset)++];
+        *value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return AVIF_TRUE;
+        }
+    }
+    return AVIF_FALSE;
+}
+
+static avifBool stubGetNextImage(avifCodec * codec, const avifDecodeSample * sample, avifBool alpha, avifBool * isLimitedRangeAlpha, avifImage * image)
+{
+    (void)codec;
+    *isLimitedRangeAlpha = AVIF_FALSE;
+    const uint8_t * data = sample->data.data;
+    const size_t size = sample->data.size;
+    size_t offset = 0;
+    while (offset < size) {
+        const uint32_t obuType = (data[offset++] >> 3) & 15;
+        uint32_t obuSize;
+        if (!readLeb128(data, size, &offset, &obuSize) || obuSize > size - offset) {
+            return AVIF_FALSE;
+        }
+        if (obuType != OBU_PADDING) {
+            offset += obuSize;
+            continue;
+        }
+        uint32_t header[4];
+        if (obuSize < PLANES_HEADER_SIZE) {
+            return AVIF_FALSE;
+        }
+        memcpy(header, data + offset, PLANES_HEADER_SIZE);
+        const uint8_t * planes = data + offset + PLANES_HEADER_SIZE;
+        const avifPixelFormat format = (avifPixelFormat)header[3];
+        avifImageFreePlanes(image, alpha ? AVIF_PLANES_A : AVIF_PLANES_YUV);
+        image->width = header[0];
+        image->height = header[1];
+        image->depth = header[2];
+        if (!alpha) {
+            image->yuvFormat = format;
+        }
+        if (avifImageAllocatePlanes(image, alpha ? AVIF_PLANES_A : AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+            return AVIF_FALSE;
+        }
+        const uint32_t bytesPerSample = (image->depth > 8) ? 2 : 1;
+        for (int plane = 0; plane < planeCount(format, alpha); ++plane) {
+            uint8_t * row = alpha ? image->alphaPlane : image->yuvPlanes[plane];
+            const uint32_t rowBytes = alpha ? image->alphaRowBytes : image->yuvRowBytes[plane];
+            uint32_t width, height;
+            planeSize(image, format, plane, &width, &height);
+            for (uint32_t y = 0; y < height; ++y, row += rowBytes, planes += (size_t)width * bytesPerSample) {
+                memcpy(row, planes, (size_t)width * bytesPerSample);
+            }
+        }
+        return AVIF_TRUE;
+    }
+    return AVIF_FALSE;
+}
+
+static void stubDestroyInternal(avifCodec * codec)
+{
+    (void)codec;
+}
+
+const char * avifCodecVersionAOM(void)
+{
+    return "stub";
+}
+
+avifCodec * avifCodecCreateAOM(void)
+{
+    avifCodec * codec = (avifCodec *)avifAlloc(sizeof(avifCodec));
+    if (codec == NULL) {
+        return NULL;
+    }
+    memset(codec, 0, sizeof(avifCodec));
+    codec->getNextImage = stubGetNextImage;
+    codec->encodeImage = stubEncodeImage;
+    codec->encodeFinish = stubEncodeFinish;
+    codec->destroyInternal = stubDestroyInternal;
+    return codec;
+}
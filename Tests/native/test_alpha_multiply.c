@@ -0,0 +1,166 @@
+// Checks avifRGBImagePremultiplyAlpha() and avifRGBImageUnpremultiplyAlpha() against the float formulas
+// round(color * alpha / max) and min(round(color * max / alpha), max), for every (color, alpha) pair up to 12 bits and
+// for random pairs at 16 bits, with the alpha channel first and last.
+
+#include "avif/internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Rows of alpha values per image, to keep the 12-bit images small.
+#define ROWS_PER_IMAGE 256
+#define RANDOM_ROWS 4096
+
+static uint32_t randomState = 11;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static uint32_t premultiplied(uint32_t color, uint32_t alpha, uint32_t max)
+{
+    const float maxF = (float)max;
+    if (alpha >= max) {
+        return color;
+    }
+    return (uint32_t)avifRoundf((float)color * (float)alpha / maxF);
+}
+
+static uint32_t unpremultiplied(uint32_t color, uint32_t alpha, uint32_t max)
+{
+    const float maxF = (float)max;
+    if (alpha >= max) {
+        return color;
+    }
+    if (alpha == 0) {
+        return 0;
+    }
+    const float c = avifRoundf((float)color * maxF / (float)alpha);
+    return (uint32_t)AVIF_MIN(c, maxF);
+}
+
+static uint32_t getChannel(const avifRGBImage * rgb, uint32_t i, uint32_t j, uint32_t channel)
+{
+    const uint8_t * row = &rgb->pixels[(size_t)j * rgb->rowBytes];
+    return (rgb->depth == 8) ? row[i * 4 + channel] : ((const uint16_t *)row)[i * 4 + channel];
+}
+
+static void setChannel(avifRGBImage * rgb, uint32_t i, uint32_t j, uint32_t channel, uint32_t value)
+{
+    uint8_t * row = &rgb->pixels[(size_t)j * rgb->rowBytes];
+    if (rgb->depth == 8) {
+        row[i * 4 + channel] = (uint8_t)value;
+    } else {
+        ((uint16_t *)row)[i * 4 + channel] = (uint16_t)value;
+    }
+}
+
+// Fills rows with every color value, or random ones, in the first color channel and derived ones in the other two. The
+// alpha value of row j is firstAlpha + j, or random.
+static void fill(avifRGBImage * rgb, uint32_t alphaChannel, uint32_t firstAlpha, avifBool random)
+{
+    const uint32_t max = (1u << rgb->depth) - 1;
+    for (uint32_t j = 0; j < rgb->height; ++j) {
+        const uint32_t alpha = random ? (nextRandom() & max) : firstAlpha + j;
+        for (uint32_t i = 0; i < rgb->width; ++i) {
+            const uint32_t color = random ? (nextRandom() & max) : i;
+            uint32_t channel = (alphaChannel == 0) ? 1 : 0;
+            setChannel(rgb, i, j, channel++, color);
+            setChannel(rgb, i, j, channel++, max - color);
+            setChannel(rgb, i, j, channel, color / 3);
+            setChannel(rgb, i, j, alphaChannel, alpha);
+        }
+    }
+}
+
+// Returns the number of channels that differ from the float formulas.
+static uint32_t compare(const avifRGBImage * rgb, const avifRGBImage * source, uint32_t alphaChannel, avifBool unmultiply)
+{
+    const uint32_t max = (1u << rgb->depth) - 1;
+    uint32_t mismatches = 0;
+    for (uint32_t j = 0; j < rgb->height; ++j) {
+        for (uint32_t i = 0; i < rgb->width; ++i) {
+            const uint32_t alpha = getChannel(source, i, j, alphaChannel);
+            mismatches += (getChannel(rgb, i, j, alphaChannel) != alpha);
+            for (uint32_t c = 0; c < 4; ++c) {
+                if (c == alphaChannel) {
+                    continue;
+                }
+                const uint32_t color = getChannel(source, i, j, c);
+                const uint32_t expected = unmultiply ? unpremultiplied(color, alpha, max) : premultiplied(color, alpha, max);
+                if (getChannel(rgb, i, j, c) != expected) {
+                    if (mismatches == 0) {
+                        printf("  color %u alpha %u: %u, expected %u\n", color, alpha, getChannel(rgb, i, j, c), expected);
+                    }
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    return mismatches;
+}
+
+static int check(uint32_t depth, avifRGBFormat format, avifBool unmultiply)
+{
+    const uint32_t max = (1u << depth) - 1;
+    const avifBool random = (depth > 12);
+    const uint32_t alphaChannel = (format == AVIF_RGB_FORMAT_ARGB) ? 0 : 3;
+    avifRGBImage rgb;
+    avifRGBImage source;
+    memset(&rgb, 0, sizeof(rgb));
+    rgb.width = random ? 1024 : max + 1;
+    rgb.height = random ? RANDOM_ROWS : AVIF_MIN(ROWS_PER_IMAGE, max + 1);
+    rgb.depth = depth;
+    rgb.format = format;
+    rgb.maxThreads = 4;
+    source = rgb;
+    uint32_t mismatches = 0;
+    int failed = 1;
+    if (avifRGBImageAllocatePixels(&rgb) != AVIF_RESULT_OK || avifRGBImageAllocatePixels(&source) != AVIF_RESULT_OK) {
+        fprintf(stderr, "allocation failed\n");
+        goto cleanup;
+    }
+    for (uint32_t firstAlpha = 0; firstAlpha <= (random ? 0 : max); firstAlpha += rgb.height) {
+        fill(&source, alphaChannel, firstAlpha, random);
+        memcpy(rgb.pixels, source.pixels, (size_t)rgb.rowBytes * rgb.height);
+        const avifResult result = unmultiply ? avifRGBImageUnpremultiplyAlpha(&rgb) : avifRGBImagePremultiplyAlpha(&rgb);
+        if (result != AVIF_RESULT_OK) {
+            printf("FAIL %s\n", avifResultToString(result));
+            goto cleanup;
+        }
+        mismatches += compare(&rgb, &source, alphaChannel, unmultiply);
+    }
+    failed = (mismatches != 0);
+    printf("%s %2u-bit %s %s: %u channels differ from the float formula\n",
+           failed ? "FAIL" : "ok  ",
+           depth,
+           (format == AVIF_RGB_FORMAT_ARGB) ? "ARGB" : (format == AVIF_RGB_FORMAT_BGRA) ? "BGRA" : "RGBA",
+           unmultiply ? "unpremultiply" : "premultiply  ",
+           mismatches);
+
+cleanup:
+    avifRGBImageFreePixels(&rgb);
+    avifRGBImageFreePixels(&source);
+    return failed;
+}
+
+int main(void)
+{
+    const uint32_t depths[] = { 8, 10, 12, 16 };
+    const avifRGBFormat formats[] = { AVIF_RGB_FORMAT_RGBA, AVIF_RGB_FORMAT_ARGB, AVIF_RGB_FORMAT_BGRA };
+    int failures = 0;
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d) {
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+            failures += check(depths[d], formats[f], AVIF_FALSE);
+            failures += check(depths[d], formats[f], AVIF_TRUE);
+        }
+    }
+    if (failures != 0) {
+        printf("%d alpha multiply checks failed\n", failures);
+        return 1;
+    }
+    printf("alpha (un)premultiply matches the float formulas\n");
+    return 0;
+}
@@ -0,0 +1,275 @@
+// Checks ChunkedStreamIO, the avifIO of AVIFDataDecoder over an input stream, with a stand-in stream:
+// - reads of bytes that did not arrive yet wait on IO, and are cut at the end once the stream ended,
+// - reads within and across chunks return the stream bytes while the chunks grow from 32 KB to 4 MB, and returned
+//   regions of a chunk stay in place as more bytes arrive,
+// - a file fed in small pieces parses before the stream ends and decodes like the same file in memory,
+// - too large images are rejected as soon as the header arrived, before the stream ends.
+
+#include "ChunkedStreamIO.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+    constexpr size_t kFirstChunkSize = 32 * 1024;
+    constexpr size_t kMaxChunkSize = 4 * 1024 * 1024;
+
+    uint8_t patternByte(uint64_t offset) {
+        return static_cast<uint8_t>((offset * 2654435761u) >> 13);
+    }
+
+    // Stand-in for NSInputStream: hands out the bytes of `data` at most `maxRead` at a time.
+    class StandInStream {
+    public:
+        StandInStream(const std::vector<uint8_t> &data, size_t maxRead) : mData(data), mMaxRead(maxRead) {}
+
+        long read(uint8_t *buffer, size_t length) {
+            const size_t count = std::min({ length, mMaxRead, mData.size() - mOffset });
+            memcpy(buffer, mData.data() + mOffset, count);
+            mOffset += count;
+            return static_cast<long>(count);
+        }
+
+    private:
+        const std::vector<uint8_t> &mData;
+        size_t mMaxRead;
+        size_t mOffset = 0;
+    };
+
+    bool readMatches(ChunkedStreamIO &streamIO, uint64_t offset, size_t size) {
+        avifROData out;
+        if (streamIO.io()->read(streamIO.io(), 0, offset, size, &out) != AVIF_RESULT_OK || out.size != size) {
+            return false;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            if (out.data[i] != patternByte(offset + i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int checkReads() {
+        // Enough for the chunks to reach 4 MB and for two chunks of 4 MB
+        const size_t streamSize = 20 * 1024 * 1024 + 12345;
+        std::vector<uint8_t> data(streamSize);
+        for (size_t i = 0; i < streamSize; ++i) {
+            data[i] = patternByte(i);
+        }
+        StandInStream stream(data, 100000);
+        ChunkedStreamIO streamIO([&stream](uint8_t *buffer, size_t length) { return stream.read(buffer, length); }, 0);
+        avifIO *io = streamIO.io();
+        int failures = 0;
+        avifROData out;
+
+        if (io->read(io, 0, 0, 1, &out) != AVIF_RESULT_WAITING_ON_IO) {
+            std::printf("FAIL a read before any byte arrived does not wait on IO\n");
+            ++failures;
+        }
+        if (io->read(io, 1, 0, 0, &out) != AVIF_RESULT_IO_ERROR) {
+            std::printf("FAIL read flags are not rejected\n");
+            ++failures;
+        }
+
+        // Start of every chunk: 32 KB, 64 KB, ... up to 4 MB, then 4 MB each
+        std::vector<uint64_t> boundaries;
+        for (uint64_t offset = 0, size = kFirstChunkSize; offset < streamSize; offset += size, size = std::min(size * 2, kMaxChunkSize)) {
+            boundaries.push_back(offset);
+        }
+        const uint8_t *firstChunkRegion = nullptr;
+        size_t checkedBoundaries = 1;
+        while (streamIO.pump() == ChunkedStreamIO::Status::Ok) {
+            const uint64_t size = streamIO.size();
+            if (size < streamSize && io->read(io, 0, size - 10, 11, &out) != AVIF_RESULT_WAITING_ON_IO) {
+                std::printf("FAIL a read past the %llu bytes received does not wait on IO\n", static_cast<unsigned long long>(size));
+                ++failures;
+            }
+            if (!firstChunkRegion && size >= 1000) {
+                if (io->read(io, 0, 100, 900, &out) != AVIF_RESULT_OK) {
+                    std::printf("FAIL read within the first chunk\n");
+                    ++failures;
+                }
+                firstChunkRegion = out.data;
+            }
+            // Reads across each chunk boundary as soon as the bytes after it arrived, and reads within the chunk
+            for (; checkedBoundaries < boundaries.size() && boundaries[checkedBoundaries] + 1000 <= size; ++checkedBoundaries) {
+                const uint64_t boundary = boundaries[checkedBoundaries];
+                if (!readMatches(streamIO, boundary - 1000, 2000) || !readMatches(streamIO, boundary - 1, 2) ||
+                    !readMatches(streamIO, boundary, 1000) || !readMatches(streamIO, boundary - 1000, 1000)) {
+                    std::printf("FAIL reads around the chunk boundary at %llu\n", static_cast<unsigned long long>(boundary));
+                    ++failures;
+                }
+            }
+        }
+        if (!streamIO.ended() || streamIO.size() != streamSize) {
+            std::printf("FAIL the stream did not end after %zu bytes\n", streamSize);
+            return failures + 1;
+        }
+        if (checkedBoundaries != boundaries.size()) {
+            std::printf("FAIL only %zu of %zu chunk boundaries were checked\n", checkedBoundaries, boundaries.size());
+            ++failures;
+        }
+        // Reads spanning many chunks, and the region returned from the first chunk, which must not have moved
+        if (!readMatches(streamIO, 1, streamSize - 2) || !readMatches(streamIO, boundaries[3] - 5, kMaxChunkSize * 2)) {
+            std::printf("FAIL reads across several chunks\n");
+            ++failures;
+        }
+        for (size_t i = 0; firstChunkRegion && i < 900; ++i) {
+            if (firstChunkRegion[i] != patternByte(100 + i)) {
+                std::printf("FAIL bytes returned from the first chunk moved or changed\n");
+                ++failures;
+                break;
+            }
+        }
+        // After the end, reads are truncated to the stream and reads past it fail
+        if (io->read(io, 0, streamSize - 10, 100, &out) != AVIF_RESULT_OK || out.size != 10 ||
+            io->read(io, 0, streamSize + 1, 1, &out) != AVIF_RESULT_IO_ERROR || io->sizeHint != streamSize) {
+            std::printf("FAIL reads at the end of the stream\n");
+            ++failures;
+        }
+
+        StandInStream limitedStream(data, 100000);
+        ChunkedStreamIO limitedIO([&limitedStream](uint8_t *buffer, size_t length) { return limitedStream.read(buffer, length); }, 150000);
+        ChunkedStreamIO::Status status;
+        while ((status = limitedIO.pump()) == ChunkedStreamIO::Status::Ok) {
+        }
+        if (status != ChunkedStreamIO::Status::LimitExceeded || limitedIO.size() > 200000) {
+            std::printf("FAIL the content size limit is not enforced\n");
+            ++failures;
+        }
+        std::printf("%s reads of a %zu byte stream in %zu chunks\n", failures ? "FAIL" : "ok  ", streamSize, boundaries.size());
+        return failures;
+    }
+
+    bool encodeFile(std::vector<uint8_t> &file, avifImage **outImage) {
+        avifImage *image = avifImageCreate(333, 257, 8, AVIF_PIXEL_FORMAT_YUV420);
+        if (!image) {
+            return false;
+        }
+        *outImage = image;
+        if (avifImageAllocatePlanes(image, AVIF_PLANES_ALL) != AVIF_RESULT_OK) {
+            return false;
+        }
+        for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+            uint8_t *row = avifImagePlane(image, plane);
+            for (uint32_t y = 0; y < avifImagePlaneHeight(image, plane); ++y, row += avifImagePlaneRowBytes(image, plane)) {
+                for (uint32_t x = 0; x < avifImagePlaneWidth(image, plane); ++x) {
+                    row[x] = patternByte(x * 3 + y * 7 + plane);
+                }
+            }
+        }
+        avifEncoder *encoder = avifEncoderCreate();
+        avifRWData output = AVIF_DATA_EMPTY;
+        const bool encoded = encoder && avifEncoderWrite(encoder, image, &output) == AVIF_RESULT_OK;
+        if (encoded) {
+            file.assign(output.data, output.data + output.size);
+        }
+        avifRWDataFree(&output);
+        if (encoder) {
+            avifEncoderDestroy(encoder);
+        }
+        return encoded;
+    }
+
+    bool samePlanes(const avifImage *a, const avifImage *b) {
+        for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+            const uint8_t *rowA = avifImagePlane(a, plane);
+            const uint8_t *rowB = avifImagePlane(b, plane);
+            if (!rowA || !rowB || avifImagePlaneWidth(a, plane) != avifImagePlaneWidth(b, plane) ||
+                avifImagePlaneHeight(a, plane) != avifImagePlaneHeight(b, plane)) {
+                return false;
+            }
+            for (uint32_t y = 0; y < avifImagePlaneHeight(a, plane); ++y) {
+                if (memcmp(rowA, rowB, avifImagePlaneWidth(a, plane)) != 0) {
+                    return false;
+                }
+                rowA += avifImagePlaneRowBytes(a, plane);
+                rowB += avifImagePlaneRowBytes(b, plane);
+            }
+        }
+        return true;
+    }
+
+    // Drives the decoder like AVIFDataDecoder: pulls more bytes while libavif waits on IO.
+    avifResult parseWhilePumping(avifDecoder *decoder, ChunkedStreamIO &streamIO) {
+        avifResult result = avifDecoderParse(decoder);
+        while (result == AVIF_RESULT_WAITING_ON_IO && streamIO.pump() != ChunkedStreamIO::Status::Failed) {
+            result = avifDecoderParse(decoder);
+        }
+        return result;
+    }
+
+    int checkDecode() {
+        std::vector<uint8_t> file;
+        avifImage *source = nullptr;
+        if (!encodeFile(file, &source)) {
+            if (source) {
+                avifImageDestroy(source);
+            }
+            std::printf("FAIL encoding the test file\n");
+            return 1;
+        }
+        int failures = 0;
+
+        StandInStream stream(file, 777);
+        ChunkedStreamIO streamIO([&stream](uint8_t *buffer, size_t length) { return stream.read(buffer, length); }, 0);
+        avifDecoder *decoder = avifDecoderCreate();
+        if (!decoder) {
+            avifImageDestroy(source);
+            return 1;
+        }
+        avifDecoderSetIO(decoder, streamIO.io());
+        avifResult result = parseWhilePumping(decoder, streamIO);
+        const uint64_t parsedAt = streamIO.size();
+        if (result != AVIF_RESULT_OK || streamIO.ended()) {
+            std::printf("FAIL parse: %s, stream ended: %d\n", avifResultToString(result), streamIO.ended());
+            ++failures;
+        } else {
+            result = avifDecoderNextImage(decoder);
+            while (result == AVIF_RESULT_WAITING_ON_IO && streamIO.pump() != ChunkedStreamIO::Status::Failed) {
+                result = avifDecoderNextImage(decoder);
+            }
+            if (result != AVIF_RESULT_OK || !samePlanes(decoder->image, source)) {
+                std::printf("FAIL decoding through the stream: %s\n", avifResultToString(result));
+                ++failures;
+            }
+        }
+        std::printf("%s %zu byte file in 777 byte reads: parsed after %llu bytes, decoded like the source\n",
+                    failures ? "FAIL" : "ok  ", file.size(), static_cast<unsigned long long>(parsedAt));
+        avifDecoderDestroy(decoder);
+
+        // The same file with a dimension limit below its size
+        StandInStream limitedStream(file, 777);
+        ChunkedStreamIO limitedIO([&limitedStream](uint8_t *buffer, size_t length) { return limitedStream.read(buffer, length); }, 0);
+        decoder = avifDecoderCreate();
+        if (!decoder) {
+            avifImageDestroy(source);
+            return failures + 1;
+        }
+        decoder->imageDimensionLimit = 256;
+        avifDecoderSetIO(decoder, limitedIO.io());
+        result = parseWhilePumping(decoder, limitedIO);
+        const bool rejectedEarly = result != AVIF_RESULT_OK && result != AVIF_RESULT_WAITING_ON_IO && !limitedIO.ended() &&
+                                   limitedIO.size() < file.size() / 4;
+        std::printf("%s a 333x257 image with a 256 dimension limit: %s after %llu of %zu bytes\n",
+                    rejectedEarly ? "ok  " : "FAIL", avifResultToString(result),
+                    static_cast<unsigned long long>(limitedIO.size()), file.size());
+        failures += rejectedEarly ? 0 : 1;
+        avifDecoderDestroy(decoder);
+        avifImageDestroy(source);
+        return failures;
+    }
+}
+
+int main() {
+    const int failures = checkReads() + checkDecode();
+    if (failures != 0) {
+        std::printf("%d chunked stream checks failed\n", failures);
+        return 1;
+    }
+    std::printf("chunked stream IO waits, reads across chunks and decodes incrementally\n");
+    return 0;
+}
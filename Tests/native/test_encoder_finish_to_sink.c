@@ -0,0 +1,168 @@
+// Checks that avifEncoderFinishToSink() hands the sink the very file avifEncoderFinish() returns, for a still image
+// with alpha and metadata, a grid with repeated cells and an image sequence with alpha, encoded by the stand-in codec
+// of stub_codec.c. A sink failure must stop the write and be returned.
+
+#include "avif/avif.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SEQUENCE_FRAMES 12
+#define GRID_COLUMNS 3
+#define GRID_ROWS 2
+
+typedef enum FileKind
+{
+    FILE_STILL,
+    FILE_GRID,
+    FILE_SEQUENCE
+} FileKind;
+
+typedef struct Sink
+{
+    avifRWData file;
+    size_t writes;
+    size_t failAtWrite; // 1-indexed write that fails, 0 never fails
+} Sink;
+
+static avifResult sinkWrite(void * userData, const uint8_t * data, size_t size)
+{
+    Sink * sink = (Sink *)userData;
+    if (++sink->writes == sink->failAtWrite) {
+        return AVIF_RESULT_IO_ERROR;
+    }
+    const size_t offset = sink->file.size;
+    if (avifRWDataRealloc(&sink->file, offset + size) != AVIF_RESULT_OK) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    memcpy(sink->file.data + offset, data, size);
+    return AVIF_RESULT_OK;
+}
+
+static avifImage * createImage(uint32_t width, uint32_t height, avifPixelFormat format, avifBool alpha, uint32_t seed)
+{
+    avifImage * image = avifImageCreate(width, height, 8, format);
+    if (image && avifImageAllocatePlanes(image, alpha ? AVIF_PLANES_ALL : AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+        avifImageDestroy(image);
+        return NULL;
+    }
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+        uint8_t * row = avifImagePlane(image, plane);
+        for (uint32_t y = 0; row && y < avifImagePlaneHeight(image, plane); ++y, row += avifImagePlaneRowBytes(image, plane)) {
+            for (uint32_t x = 0; x < avifImagePlaneWidth(image, plane); ++x) {
+                row[x] = (uint8_t)(seed * 29 + (uint32_t)plane * 7 + x * 3 + y * 5);
+            }
+        }
+    }
+    return image;
+}
+
+// Feeds the images of kind to encoder, ready for finishing
+static avifResult addImages(avifEncoder * encoder, FileKind kind)
+{
+    avifResult result = AVIF_RESULT_OUT_OF_MEMORY;
+    if (kind == FILE_STILL) {
+        static const uint8_t exif[] = { 'M', 'M', 0, 42, 0, 0, 0, 8, 0, 0 };
+        static const char xmp[] = "<x:xmpmeta xmlns:x=\"adobe:ns:meta/\"></x:xmpmeta>";
+        avifImage * image = createImage(301, 203, AVIF_PIXEL_FORMAT_YUV420, AVIF_TRUE, 1);
+        if (image && avifImageSetMetadataExif(image, exif, sizeof(exif)) == AVIF_RESULT_OK &&
+            avifImageSetMetadataXMP(image, (const uint8_t *)xmp, sizeof(xmp) - 1) == AVIF_RESULT_OK) {
+            result = avifEncoderAddImage(encoder, image, 1, AVIF_ADD_IMAGE_FLAG_SINGLE);
+        }
+        if (image) {
+            avifImageDestroy(image);
+        }
+    } else if (kind == FILE_GRID) {
+        // Two distinct cells, the repeated ones are written once
+        avifImage * cells[2] = { createImage(64, 64, AVIF_PIXEL_FORMAT_YUV444, AVIF_FALSE, 2),
+                                 createImage(64, 64, AVIF_PIXEL_FORMAT_YUV444, AVIF_FALSE, 3) };
+        const avifImage * grid[GRID_COLUMNS * GRID_ROWS];
+        for (int i = 0; i < GRID_COLUMNS * GRID_ROWS; ++i) {
+            grid[i] = cells[i % 3 == 0];
+        }
+        if (cells[0] && cells[1]) {
+            result = avifEncoderAddImageGrid(encoder, GRID_COLUMNS, GRID_ROWS, grid, AVIF_ADD_IMAGE_FLAG_SINGLE);
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (cells[i]) {
+                avifImageDestroy(cells[i]);
+            }
+        }
+    } else {
+        result = AVIF_RESULT_OK;
+        for (uint32_t frame = 0; result == AVIF_RESULT_OK && frame < SEQUENCE_FRAMES; ++frame) {
+            avifImage * image = createImage(96, 64, AVIF_PIXEL_FORMAT_YUV420, AVIF_TRUE, frame);
+            if (!image) {
+                return AVIF_RESULT_OUT_OF_MEMORY;
+            }
+            result = avifEncoderAddImage(encoder, image, 1 + frame % 3, AVIF_ADD_IMAGE_FLAG_NONE);
+            avifImageDestroy(image);
+        }
+    }
+    return result;
+}
+
+// Writes the file of kind with avifEncoderFinish() to file, or with avifEncoderFinishToSink() to sink
+static avifResult encode(FileKind kind, avifRWData * file, Sink * sink)
+{
+    avifEncoder * encoder = avifEncoderCreate();
+    if (!encoder) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    encoder->timescale = 30;
+    avifResult result = addImages(encoder, kind);
+    if (result == AVIF_RESULT_OK) {
+        result = file ? avifEncoderFinish(encoder, file) : avifEncoderFinishToSink(encoder, sinkWrite, sink);
+    }
+    avifEncoderDestroy(encoder);
+    return result;
+}
+
+static int check(const char * name, FileKind kind)
+{
+    avifRWData expected = AVIF_DATA_EMPTY;
+    Sink sink = { AVIF_DATA_EMPTY, 0, 0 };
+    Sink failingSink = { AVIF_DATA_EMPTY, 0, 2 };
+    int failures = 0;
+
+    const avifResult finishResult = encode(kind, &expected, NULL);
+    const avifResult sinkResult = encode(kind, NULL, &sink);
+    if (finishResult != AVIF_RESULT_OK || sinkResult != AVIF_RESULT_OK) {
+        printf("FAIL %s: avifEncoderFinish %s, avifEncoderFinishToSink %s\n", name, avifResultToString(finishResult),
+               avifResultToString(sinkResult));
+        ++failures;
+    } else if (sink.file.size != expected.size || memcmp(sink.file.data, expected.data, expected.size) != 0) {
+        printf("FAIL %s: the sink received %zu bytes differing from the %zu bytes of avifEncoderFinish\n", name,
+               sink.file.size, expected.size);
+        ++failures;
+    } else if (sink.writes < 2) {
+        printf("FAIL %s: the file was handed to the sink in a single write\n", name);
+        ++failures;
+    }
+
+    // The failure of the second write is returned and ends the write
+    const avifResult failingResult = encode(kind, NULL, &failingSink);
+    if (failingResult != AVIF_RESULT_IO_ERROR || failingSink.writes != 2) {
+        printf("FAIL %s: a failing sink gives %s after %zu writes\n", name, avifResultToString(failingResult), failingSink.writes);
+        ++failures;
+    }
+    if (!failures) {
+        printf("ok   %s: %zu identical bytes in %zu writes\n", name, expected.size, sink.writes);
+    }
+    avifRWDataFree(&expected);
+    avifRWDataFree(&sink.file);
+    avifRWDataFree(&failingSink.file);
+    return failures;
+}
+
+int main(void)
+{
+    const int failures = check("still image with alpha and metadata", FILE_STILL) + check("3x2 grid", FILE_GRID) +
+                         check("sequence with alpha", FILE_SEQUENCE);
+    if (failures != 0) {
+        printf("%d avifEncoderFinishToSink checks failed\n", failures);
+        return 1;
+    }
+    printf("avifEncoderFinishToSink writes the file of avifEncoderFinish\n");
+    return 0;
+}
@@ -0,0 +1,354 @@
+// Checks sequences streamed with avifEncoderSetStreamingSink(), encoded by the stand-in codec of stub_codec.c:
+// - a small sequence with alpha parses back and every frame decodes to its source with its duration,
+// - the stco or co64 chunk offsets and the stsz sample sizes of every track point exactly at the samples the sink
+//   received, in order, for the small sequence and for a sequence of more than 4 GB, which needs co64.
+// Only the boxes of the large sequence are kept, its samples are counted and dropped.
+
+#include "avif/internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SMALL_FRAMES 24
+#define LARGE_FRAMES 66
+#define LARGE_SIZE 4096
+// Writes at most this large are kept by the sink, larger ones are samples of the large sequence
+#define KEPT_WRITE_SIZE (1024 * 1024)
+
+typedef struct SinkWrite
+{
+    uint64_t offset;
+    size_t size;
+    uint8_t * data; // NULL for dropped writes
+} SinkWrite;
+AVIF_ARRAY_DECLARE(SinkWriteArray, SinkWrite, write);
+
+typedef struct Sink
+{
+    SinkWriteArray writes;
+    uint64_t size;
+} Sink;
+
+static avifResult sinkWrite(void * userData, const uint8_t * data, size_t size)
+{
+    Sink * sink = (Sink *)userData;
+    SinkWrite * write = (SinkWrite *)avifArrayPush(&sink->writes);
+    if (!write) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    write->offset = sink->size;
+    write->size = size;
+    if (size <= KEPT_WRITE_SIZE) {
+        write->data = (uint8_t *)malloc(size ? size : 1);
+        if (!write->data) {
+            return AVIF_RESULT_OUT_OF_MEMORY;
+        }
+        memcpy(write->data, data, size);
+    }
+    sink->size += size;
+    return AVIF_RESULT_OK;
+}
+
+static void sinkDestroy(Sink * sink)
+{
+    for (uint32_t i = 0; i < sink->writes.count; ++i) {
+        free(sink->writes.write[i].data);
+    }
+    avifArrayDestroy(&sink->writes);
+}
+
+// Returns the write starting at offset, or NULL
+static const SinkWrite * findWrite(const Sink * sink, uint64_t offset)
+{
+    for (uint32_t i = 0; i < sink->writes.count; ++i) {
+        if (sink->writes.write[i].offset == offset) {
+            return &sink->writes.write[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t readU32(const uint8_t * p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t readU64(const uint8_t * p)
+{
+    return ((uint64_t)readU32(p) << 32) | readU32(p + 4);
+}
+
+// Finds the child box of the given type in the payload [data, data + size) of a container box, starting after *after if
+// not NULL. Returns the payload of the box and its size.
+static const uint8_t * findBox(const uint8_t * data, size_t size, const char * type, const uint8_t * after, size_t * payloadSize)
+{
+    size_t offset = after ? (size_t)(after - data) : 0;
+    if (after) {
+        // Skip the box found last time, its header precedes its payload
+        const uint8_t * header = after - 8;
+        offset = (size_t)(header - data) + readU32(header);
+    }
+    while (offset + 8 <= size) {
+        const uint32_t boxSize = readU32(data + offset);
+        if (boxSize < 8 || boxSize > size - offset) {
+            return NULL;
+        }
+        if (!memcmp(data + offset + 4, type, 4)) {
+            *payloadSize = boxSize - 8;
+            return data + offset + 8;
+        }
+        offset += boxSize;
+    }
+    return NULL;
+}
+
+// Checks the chunk offsets and sample sizes of every track of the moov box in the last write against the writes of the
+// samples, and returns the amount of tracks described with co64, or -1 on failure
+static int checkSampleTables(const char * name, const Sink * sink, uint32_t frameCount, int * co64Tracks)
+{
+    const SinkWrite * last = &sink->writes.write[sink->writes.count - 1];
+    size_t moovSize;
+    const uint8_t * moov = last->data ? findBox(last->data, last->size, "moov", NULL, &moovSize) : NULL;
+    if (!moov) {
+        printf("FAIL %s: no moov box at the end of the file\n", name);
+        return 1;
+    }
+    uint64_t sampleBytes = 0;
+    uint32_t sampleCount = 0;
+    uint32_t trackCount = 0;
+    *co64Tracks = 0;
+    size_t trakSize;
+    for (const uint8_t * trak = findBox(moov, moovSize, "trak", NULL, &trakSize); trak; trak = findBox(moov, moovSize, "trak", trak, &trakSize)) {
+        size_t mdiaSize, minfSize, stblSize, stszSize, stcoSize;
+        const uint8_t * mdia = findBox(trak, trakSize, "mdia", NULL, &mdiaSize);
+        const uint8_t * minf = mdia ? findBox(mdia, mdiaSize, "minf", NULL, &minfSize) : NULL;
+        const uint8_t * stbl = minf ? findBox(minf, minfSize, "stbl", NULL, &stblSize) : NULL;
+        const uint8_t * stsz = stbl ? findBox(stbl, stblSize, "stsz", NULL, &stszSize) : NULL;
+        const uint8_t * stco = stbl ? findBox(stbl, stblSize, "stco", NULL, &stcoSize) : NULL;
+        const uint8_t * co64 = stbl ? findBox(stbl, stblSize, "co64", NULL, &stcoSize) : NULL;
+        const uint8_t * offsets = co64 ? co64 : stco;
+        const size_t offsetSize = co64 ? 8 : 4;
+        // FullBox version and flags, then sample_size and sample_count of stsz, entry_count of stco
+        if (!stsz || !offsets || stszSize < 12 || readU32(stsz + 4) != 0 || readU32(stsz + 8) != frameCount ||
+            stszSize != 12 + 4 * (size_t)frameCount || readU32(offsets + 4) != frameCount ||
+            stcoSize != 8 + offsetSize * frameCount) {
+            printf("FAIL %s: track %u does not list %u samples in stsz and stco or co64\n", name, trackCount, frameCount);
+            return 1;
+        }
+        uint64_t previousOffset = 0;
+        for (uint32_t i = 0; i < frameCount; ++i) {
+            const uint64_t offset = co64 ? readU64(offsets + 8 + 8 * i) : readU32(offsets + 8 + 4 * i);
+            const uint32_t size = readU32(stsz + 12 + 4 * i);
+            const SinkWrite * write = findWrite(sink, offset);
+            if (!write || write->size != size || offset <= previousOffset) {
+                printf("FAIL %s: sample %u of track %u at %llu, %u bytes, is not a sample the sink received in order\n", name, i,
+                       trackCount, (unsigned long long)offset, size);
+                return 1;
+            }
+            // Samples begin with the sequence header OBU of the stand-in codec
+            if (write->data && (write->data[0] >> 3) != 1) {
+                printf("FAIL %s: sample %u of track %u does not begin with a sequence header\n", name, i, trackCount);
+                return 1;
+            }
+            previousOffset = offset;
+            sampleBytes += size;
+        }
+        sampleCount += frameCount;
+        *co64Tracks += co64 ? 1 : 0;
+        ++trackCount;
+    }
+    // The samples are all the sink received but the ftyp box, the mdat box headers and the boxes written at the end
+    uint64_t otherBytes = sink->writes.write[0].size + last->size;
+    uint32_t otherWrites = 2;
+    for (uint32_t i = 1; i + 1 < sink->writes.count; ++i) {
+        const SinkWrite * write = &sink->writes.write[i];
+        if (write->data && write->size >= 8 && !memcmp(write->data + 4, "mdat", 4)) {
+            otherBytes += write->size;
+            ++otherWrites;
+        }
+    }
+    if (trackCount != 2 || sampleCount + otherWrites != sink->writes.count || sampleBytes + otherBytes != sink->size) {
+        printf("FAIL %s: %u tracks with %u samples do not account for the %u writes of %llu bytes\n", name, trackCount,
+               sampleCount, sink->writes.count, (unsigned long long)sink->size);
+        return 1;
+    }
+    return 0;
+}
+
+static avifImage * createFrame(uint32_t width, uint32_t height, avifPixelFormat format, uint32_t frame)
+{
+    avifImage * image = avifImageCreate(width, height, 8, format);
+    if (image && avifImageAllocatePlanes(image, AVIF_PLANES_ALL) != AVIF_RESULT_OK) {
+        avifImageDestroy(image);
+        return NULL;
+    }
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+        uint8_t * row = avifImagePlane(image, plane);
+        for (uint32_t y = 0; y < avifImagePlaneHeight(image, plane); ++y, row += avifImagePlaneRowBytes(image, plane)) {
+            for (uint32_t x = 0; x < avifImagePlaneWidth(image, plane); ++x) {
+                row[x] = (uint8_t)(frame * 29 + (uint32_t)plane * 7 + x * 3 + y * 5);
+            }
+        }
+    }
+    return image;
+}
+
+static avifBool samePlanes(const avifImage * a, const avifImage * b)
+{
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+        if (!avifImagePlane(a, plane) || !avifImagePlane(b, plane) || avifImagePlaneWidth(a, plane) != avifImagePlaneWidth(b, plane) ||
+            avifImagePlaneHeight(a, plane) != avifImagePlaneHeight(b, plane)) {
+            return AVIF_FALSE;
+        }
+        for (uint32_t y = 0; y < avifImagePlaneHeight(a, plane); ++y) {
+            if (memcmp(avifImagePlane(a, plane) + (size_t)y * avifImagePlaneRowBytes(a, plane),
+                       avifImagePlane(b, plane) + (size_t)y * avifImagePlaneRowBytes(b, plane),
+                       avifImagePlaneWidth(a, plane))) {
+                return AVIF_FALSE;
+            }
+        }
+    }
+    return AVIF_TRUE;
+}
+
+// Streams frameCount frames to sink. A frame is created for every call when reuseFrame is false.
+static avifResult streamSequence(Sink * sink, uint32_t width, uint32_t height, avifPixelFormat format, uint32_t frameCount, avifBool reuseFrame)
+{
+    avifEncoder * encoder = avifEncoderCreate();
+    avifImage * frame = NULL;
+    avifRWData output = AVIF_DATA_EMPTY;
+    avifResult result = encoder ? avifEncoderSetStreamingSink(encoder, sinkWrite, sink) : AVIF_RESULT_OUT_OF_MEMORY;
+    if (encoder) {
+        encoder->timescale = 30;
+    }
+    for (uint32_t i = 0; result == AVIF_RESULT_OK && i < frameCount; ++i) {
+        if (!frame || !reuseFrame) {
+            if (frame) {
+                avifImageDestroy(frame);
+            }
+            frame = createFrame(width, height, format, i);
+        }
+        result = frame ? avifEncoderAddImage(encoder, frame, 1 + i % 3, AVIF_ADD_IMAGE_FLAG_NONE) : AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    if (result == AVIF_RESULT_OK) {
+        result = avifEncoderFinish(encoder, &output);
+        if (result == AVIF_RESULT_OK && output.size != 0) {
+            result = AVIF_RESULT_UNKNOWN_ERROR;
+        }
+    }
+    avifRWDataFree(&output);
+    if (frame) {
+        avifImageDestroy(frame);
+    }
+    if (encoder) {
+        avifEncoderDestroy(encoder);
+    }
+    return result;
+}
+
+static int checkSmallSequence(void)
+{
+    const char name[] = "small sequence with alpha";
+    Sink sink;
+    memset(&sink, 0, sizeof(sink));
+    avifRWData file = AVIF_DATA_EMPTY;
+    avifDecoder * decoder = NULL;
+    int failures = 1;
+    if (!avifArrayCreate(&sink.writes, sizeof(SinkWrite), 64)) {
+        return 1;
+    }
+    avifResult result = streamSequence(&sink, 96, 64, AVIF_PIXEL_FORMAT_YUV420, SMALL_FRAMES, AVIF_FALSE);
+    if (result != AVIF_RESULT_OK) {
+        printf("FAIL %s: streaming failed: %s\n", name, avifResultToString(result));
+        goto cleanup;
+    }
+    int co64Tracks;
+    if (checkSampleTables(name, &sink, SMALL_FRAMES, &co64Tracks)) {
+        goto cleanup;
+    }
+    if (co64Tracks != 0) {
+        printf("FAIL %s: co64 describes a file of %llu bytes\n", name, (unsigned long long)sink.size);
+        goto cleanup;
+    }
+
+    if (avifRWDataRealloc(&file, (size_t)sink.size) != AVIF_RESULT_OK) {
+        goto cleanup;
+    }
+    for (uint32_t i = 0; i < sink.writes.count; ++i) {
+        memcpy(file.data + sink.writes.write[i].offset, sink.writes.write[i].data, sink.writes.write[i].size);
+    }
+    decoder = avifDecoderCreate();
+    if (!decoder || avifDecoderSetIOMemory(decoder, file.data, file.size) != AVIF_RESULT_OK ||
+        (result = avifDecoderParse(decoder)) != AVIF_RESULT_OK || decoder->imageCount != SMALL_FRAMES || !decoder->alphaPresent) {
+        printf("FAIL %s: parsing the streamed file: %s\n", name, avifResultToString(result));
+        goto cleanup;
+    }
+    for (uint32_t i = 0; i < SMALL_FRAMES; ++i) {
+        avifImage * source = createFrame(96, 64, AVIF_PIXEL_FORMAT_YUV420, i);
+        result = avifDecoderNextImage(decoder);
+        const avifBool matches = source && result == AVIF_RESULT_OK && samePlanes(decoder->image, source) &&
+                                 decoder->imageTiming.durationInTimescales == 1 + i % 3;
+        if (source) {
+            avifImageDestroy(source);
+        }
+        if (!matches) {
+            printf("FAIL %s: frame %u decoded with %s does not match its source\n", name, i, avifResultToString(result));
+            goto cleanup;
+        }
+    }
+    printf("ok   %s: %u frames in %u writes of %llu bytes parse and decode back\n", name, SMALL_FRAMES, sink.writes.count,
+           (unsigned long long)sink.size);
+    failures = 0;
+
+cleanup:
+    if (decoder) {
+        avifDecoderDestroy(decoder);
+    }
+    avifRWDataFree(&file);
+    sinkDestroy(&sink);
+    return failures;
+}
+
+static int checkLargeSequence(void)
+{
+    const char name[] = "sequence of more than 4 GB";
+    Sink sink;
+    memset(&sink, 0, sizeof(sink));
+    int failures = 1;
+    if (!avifArrayCreate(&sink.writes, sizeof(SinkWrite), 256)) {
+        return 1;
+    }
+    const avifResult result = streamSequence(&sink, LARGE_SIZE, LARGE_SIZE, AVIF_PIXEL_FORMAT_YUV444, LARGE_FRAMES, AVIF_TRUE);
+    if (result != AVIF_RESULT_OK) {
+        printf("FAIL %s: streaming failed: %s\n", name, avifResultToString(result));
+        goto cleanup;
+    }
+    int co64Tracks;
+    if (checkSampleTables(name, &sink, LARGE_FRAMES, &co64Tracks)) {
+        goto cleanup;
+    }
+    // The last samples of both tracks lie beyond 4 GB
+    if (co64Tracks != 2) {
+        printf("FAIL %s: %d of the tracks use co64 in a file of %llu bytes\n", name, co64Tracks, (unsigned long long)sink.size);
+        goto cleanup;
+    }
+    printf("ok   %s: %u frames in %u writes of %llu bytes, offsets in co64\n", name, LARGE_FRAMES, sink.writes.count,
+           (unsigned long long)sink.size);
+    failures = 0;
+
+cleanup:
+    sinkDestroy(&sink);
+    return failures;
+}
+
+int main(void)
+{
+    const int failures = checkSmallSequence() + checkLargeSequence();
+    if (failures != 0) {
+        printf("%d streaming checks failed\n", failures);
+        return 1;
+    }
+    printf("streamed sequences describe the samples the sink received\n");
+    return 0;
+}
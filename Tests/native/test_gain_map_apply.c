@@ -0,0 +1,215 @@
+// Checks avifRGBImageApplyGainMap() against a double precision evaluation of the gain map math, and checks that neither
+// the tone mapped pixels nor the content light level depend on rgb->maxThreads.
+
+#include "avif/avif.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WIDTH 193
+#define HEIGHT 67
+// Tone mapped values are written with 16 bits. The float math and the tabulated transfer curves (within 5e-6) may
+// move them by this many code values from the double precision result.
+#define MAX_OUTPUT_ERROR 2
+// The content light level is rounded to whole nits.
+#define MAX_CLLI_ERROR 1
+
+static uint32_t randomState = 3;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static double toLinearSRGB(double gamma)
+{
+    return (gamma < 12.92 * 0.0030412825601275209) ? gamma / 12.92 : pow((gamma + 0.0550107189475866) / 1.0550107189475866, 2.4);
+}
+
+// Linear values are in extended SDR range, where 1.0 is 203 nits.
+static double toGammaPQ(double linear)
+{
+    if (linear <= 0.0) {
+        return 0.0;
+    }
+    const double l = pow(fmin(linear * 203.0 / 10000.0, 1.0), 2610.0 / 16384.0);
+    return pow((3424.0 / 4096.0 + 2413.0 / 128.0 * l) / (1.0 + 2392.0 / 128.0 * l), 2523.0 / 32.0);
+}
+
+static double fraction(avifSignedFraction f)
+{
+    return (double)f.n / f.d;
+}
+
+typedef struct Reference
+{
+    uint16_t * pixels; // RGB only.
+    uint16_t maxCLL;
+    uint16_t maxPALL;
+} Reference;
+
+static void computeReference(const avifRGBImage * base, const avifGainMap * gainMap, double weight, Reference * reference)
+{
+    const avifImage * gainMapImage = gainMap->image;
+    const double gainMapMaxValue = (double)((1 << gainMapImage->depth) - 1);
+    double maxLinear = 0.0;
+    double sumLinear = 0.0;
+    for (uint32_t j = 0; j < HEIGHT; ++j) {
+        for (uint32_t i = 0; i < WIDTH; ++i) {
+            const uint8_t * basePixel = &base->pixels[(size_t)j * base->rowBytes + (size_t)i * 4];
+            const uint8_t * gainMapRow = &gainMapImage->yuvPlanes[AVIF_CHAN_Y][(size_t)j * gainMapImage->yuvRowBytes[AVIF_CHAN_Y]];
+            const uint32_t gainMapSample = (gainMapImage->depth == 8) ? gainMapRow[i] : ((const uint16_t *)gainMapRow)[i];
+            double pixelMaxLinear = 0.0;
+            for (int c = 0; c < 3; ++c) {
+                const double baseLinear = toLinearSRGB(basePixel[c] / 255.0);
+                const double gainMapValue = pow(gainMapSample / gainMapMaxValue, 1.0 / ((double)gainMap->gainMapGamma[c].n / gainMap->gainMapGamma[c].d));
+                const double gainLog2 = fraction(gainMap->gainMapMin[c]) +
+                                        gainMapValue * (fraction(gainMap->gainMapMax[c]) - fraction(gainMap->gainMapMin[c]));
+                const double toneMappedLinear = (baseLinear + fraction(gainMap->baseOffset[c])) * exp2(gainLog2 * weight) -
+                                                fraction(gainMap->alternateOffset[c]);
+                pixelMaxLinear = fmax(pixelMaxLinear, toneMappedLinear);
+                reference->pixels[((size_t)j * WIDTH + i) * 3 + c] = (uint16_t)lround(fmin(toGammaPQ(toneMappedLinear), 1.0) * 65535.0);
+            }
+            maxLinear = fmax(maxLinear, pixelMaxLinear);
+            sumLinear += pixelMaxLinear;
+        }
+    }
+    reference->maxCLL = (uint16_t)lround(maxLinear * 203.0);
+    reference->maxPALL = (uint16_t)lround(sumLinear / ((double)WIDTH * HEIGHT) * 203.0);
+}
+
+static avifResult applyGainMap(const avifRGBImage * base, const avifGainMap * gainMap, float hdrHeadroom, int maxThreads, avifRGBImage * toneMapped, avifContentLightLevelInformationBox * clli)
+{
+    memset(toneMapped, 0, sizeof(*toneMapped));
+    toneMapped->depth = 16;
+    toneMapped->format = AVIF_RGB_FORMAT_RGBA;
+    toneMapped->maxThreads = maxThreads;
+    avifDiagnostics diag;
+    return avifRGBImageApplyGainMap(base,
+                                    AVIF_COLOR_PRIMARIES_BT709,
+                                    AVIF_TRANSFER_CHARACTERISTICS_SRGB,
+                                    gainMap,
+                                    hdrHeadroom,
+                                    AVIF_COLOR_PRIMARIES_BT709,
+                                    AVIF_TRANSFER_CHARACTERISTICS_PQ,
+                                    toneMapped,
+                                    clli,
+                                    &diag);
+}
+
+static int checkGainMap(const avifRGBImage * base, uint32_t gainMapDepth, float hdrHeadroom)
+{
+    int failed = 1;
+    avifRGBImage toneMapped;
+    memset(&toneMapped, 0, sizeof(toneMapped));
+    Reference reference;
+    reference.pixels = (uint16_t *)malloc(sizeof(uint16_t) * 3 * WIDTH * HEIGHT);
+    avifGainMap * gainMap = avifGainMapCreate();
+    if (!reference.pixels || !gainMap) {
+        goto cleanup;
+    }
+    gainMap->image = avifImageCreate(WIDTH, HEIGHT, gainMapDepth, AVIF_PIXEL_FORMAT_YUV400);
+    if (!gainMap->image || avifImageAllocatePlanes(gainMap->image, AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+        goto cleanup;
+    }
+    for (uint32_t j = 0; j < HEIGHT; ++j) {
+        uint8_t * row = &gainMap->image->yuvPlanes[AVIF_CHAN_Y][(size_t)j * gainMap->image->yuvRowBytes[AVIF_CHAN_Y]];
+        for (uint32_t i = 0; i < WIDTH; ++i) {
+            const uint32_t value = nextRandom() & ((1u << gainMapDepth) - 1);
+            if (gainMapDepth == 8) {
+                row[i] = (uint8_t)value;
+            } else {
+                ((uint16_t *)row)[i] = (uint16_t)value;
+            }
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        gainMap->gainMapMin[c] = (avifSignedFraction) { -1, 2 };
+        gainMap->gainMapMax[c] = (avifSignedFraction) { 3 + c, 1 };
+        gainMap->gainMapGamma[c] = (avifUnsignedFraction) { 2 + c, 3 };
+        gainMap->baseOffset[c] = (avifSignedFraction) { 1, 64 };
+        gainMap->alternateOffset[c] = (avifSignedFraction) { 1, 32 };
+    }
+    gainMap->baseHdrHeadroom = (avifUnsignedFraction) { 0, 1 };
+    gainMap->alternateHdrHeadroom = (avifUnsignedFraction) { 3, 1 };
+    computeReference(base, gainMap, hdrHeadroom / 3.0, &reference);
+
+    avifContentLightLevelInformationBox clli;
+    if (applyGainMap(base, gainMap, hdrHeadroom, 1, &toneMapped, &clli) != AVIF_RESULT_OK) {
+        printf("FAIL gain map application\n");
+        goto cleanup;
+    }
+    int maxError = 0;
+    for (uint32_t j = 0; j < HEIGHT; ++j) {
+        const uint16_t * row = (const uint16_t *)&toneMapped.pixels[(size_t)j * toneMapped.rowBytes];
+        for (uint32_t i = 0; i < WIDTH; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                const int error = abs((int)row[i * 4 + c] - (int)reference.pixels[((size_t)j * WIDTH + i) * 3 + c]);
+                maxError = (error > maxError) ? error : maxError;
+            }
+        }
+    }
+    const int cllError = abs((int)clli.maxCLL - (int)reference.maxCLL);
+    const int pallError = abs((int)clli.maxPALL - (int)reference.maxPALL);
+    failed = (maxError > MAX_OUTPUT_ERROR) || (cllError > MAX_CLLI_ERROR) || (pallError > MAX_CLLI_ERROR);
+    printf("%s %u-bit gain map, headroom %.1f: max error %d code values, maxCLL %u (reference %u), maxPALL %u (reference %u)\n",
+           failed ? "FAIL" : "ok  ",
+           gainMapDepth,
+           hdrHeadroom,
+           maxError,
+           clli.maxCLL,
+           reference.maxCLL,
+           clli.maxPALL,
+           reference.maxPALL);
+
+    for (int maxThreads = 2; maxThreads <= 9; ++maxThreads) {
+        avifRGBImage banded;
+        avifContentLightLevelInformationBox bandedClli;
+        const avifResult result = applyGainMap(base, gainMap, hdrHeadroom, maxThreads, &banded, &bandedClli);
+        if (result != AVIF_RESULT_OK || memcmp(banded.pixels, toneMapped.pixels, (size_t)toneMapped.rowBytes * HEIGHT) != 0 ||
+            bandedClli.maxCLL != clli.maxCLL || bandedClli.maxPALL != clli.maxPALL) {
+            printf("FAIL %d threads: output or content light level differs from a single thread\n", maxThreads);
+            failed = 1;
+        }
+        avifRGBImageFreePixels(&banded);
+    }
+
+cleanup:
+    avifRGBImageFreePixels(&toneMapped);
+    avifGainMapDestroy(gainMap);
+    free(reference.pixels);
+    return failed;
+}
+
+int main(void)
+{
+    avifRGBImage base;
+    memset(&base, 0, sizeof(base));
+    base.width = WIDTH;
+    base.height = HEIGHT;
+    base.depth = 8;
+    base.format = AVIF_RGB_FORMAT_RGBA;
+    if (avifRGBImageAllocatePixels(&base) != AVIF_RESULT_OK) {
+        return 1;
+    }
+    for (uint32_t j = 0; j < HEIGHT; ++j) {
+        for (uint32_t i = 0; i < WIDTH * 4; ++i) {
+            base.pixels[(size_t)j * base.rowBytes + i] = (uint8_t)nextRandom();
+        }
+    }
+    int failures = 0;
+    failures += checkGainMap(&base, 8, 3.0f);
+    failures += checkGainMap(&base, 8, 1.5f);
+    failures += checkGainMap(&base, 12, 3.0f);
+    failures += checkGainMap(&base, 16, 3.0f);
+    avifRGBImageFreePixels(&base);
+    if (failures != 0) {
+        printf("%d gain map checks failed\n", failures);
+        return 1;
+    }
+    printf("gain map application is within tolerance and independent of maxThreads\n");
+    return 0;
+}
@@ -0,0 +1,500 @@
+// Checks that avifRGBImageComputeGainMap() gives the same metadata and gain map planes for any baseRgbImage->maxThreads,
+// and the same as the full-buffer computation it replaced, kept below as the reference: one float per pixel and channel
+// for the log2 ratios, then one outlier histogram over the whole buffer. The reference has its own copy of the original
+// avifFindMinMaxWithoutOutliers(), which now shares its bucketing with the banded histograms.
+
+#include "avif/internal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// More pixels than a 16-bit table has entries, so 16-bit inputs go through the tabulated transfer curves too.
+#define WIDTH 321
+#define HEIGHT 229
+
+static const float kEpsilon = 1e-10f;
+
+static uint32_t randomState = 7;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static float signedFractionToFloat(avifSignedFraction f)
+{
+    return (f.d == 0) ? 0.0f : (float)f.n / f.d;
+}
+
+static float unsignedFractionToFloat(avifUnsignedFraction f)
+{
+    return (f.d == 0) ? 0.0f : (float)f.n / f.d;
+}
+
+static avifBool chooseColorSpaceForGainMapMath(avifColorPrimaries basePrimaries, avifColorPrimaries altPrimaries, avifColorPrimaries * mathPrimaries)
+{
+    if (basePrimaries == altPrimaries) {
+        *mathPrimaries = basePrimaries;
+        return AVIF_TRUE;
+    }
+    float rgba[4] = { 0 };
+    double baseToAltCoeffs[3][3];
+    double altToBaseCoeffs[3][3];
+    if (!avifColorPrimariesComputeRGBToRGBMatrix(basePrimaries, altPrimaries, baseToAltCoeffs) ||
+        !avifColorPrimariesComputeRGBToRGBMatrix(altPrimaries, basePrimaries, altToBaseCoeffs)) {
+        return AVIF_FALSE;
+    }
+    float baseColorspaceChannelMin = 0;
+    float altColorspaceChannelMin = 0;
+    for (int c = 0; c < 3; ++c) {
+        rgba[0] = rgba[1] = rgba[2] = 0;
+        rgba[c] = 1.0f;
+        avifLinearRGBConvertColorSpace(rgba, altToBaseCoeffs);
+        for (int i = 0; i < 3; ++i) {
+            baseColorspaceChannelMin = AVIF_MIN(baseColorspaceChannelMin, rgba[i]);
+        }
+        rgba[0] = rgba[1] = rgba[2] = 0;
+        rgba[c] = 1.0f;
+        avifLinearRGBConvertColorSpace(rgba, baseToAltCoeffs);
+        for (int i = 0; i < 3; ++i) {
+            altColorspaceChannelMin = AVIF_MIN(altColorspaceChannelMin, rgba[i]);
+        }
+    }
+    *mathPrimaries = (altColorspaceChannelMin <= baseColorspaceChannelMin) ? basePrimaries : altPrimaries;
+    return AVIF_TRUE;
+}
+
+static int valueToBucketIdx(float v, float bucketMin, float bucketMax, int numBuckets)
+{
+    v = AVIF_CLAMP(v, bucketMin, bucketMax);
+    return AVIF_MIN((int)avifRoundf((v - bucketMin) / (bucketMax - bucketMin) * numBuckets), numBuckets - 1);
+}
+
+static float bucketIdxToValue(int idx, float bucketMin, float bucketMax, int numBuckets)
+{
+    return idx * (bucketMax - bucketMin) / numBuckets + bucketMin;
+}
+
+static avifBool findMinMaxWithoutOutliers(const float * gainMapF, int numPixels, float * rangeMin, float * rangeMax)
+{
+    const float bucketSize = 0.01f;
+    const float maxOutliersRatio = 0.001f;
+    const int maxOutliersOnEachSide = (int)avifRoundf(numPixels * maxOutliersRatio / 2.0f);
+
+    float min = gainMapF[0];
+    float max = gainMapF[0];
+    for (int i = 1; i < numPixels; ++i) {
+        min = AVIF_MIN(min, gainMapF[i]);
+        max = AVIF_MAX(max, gainMapF[i]);
+    }
+    *rangeMin = min;
+    *rangeMax = max;
+    if ((max - min) <= (bucketSize * 2) || maxOutliersOnEachSide == 0) {
+        return AVIF_TRUE;
+    }
+
+    const int numBuckets = AVIF_MIN((int)ceilf((max - min) / bucketSize), 10000);
+    int * histogram = (int *)calloc(numBuckets, sizeof(int));
+    if (histogram == NULL) {
+        return AVIF_FALSE;
+    }
+    for (int i = 0; i < numPixels; ++i) {
+        ++(histogram[valueToBucketIdx(gainMapF[i], min, max, numBuckets)]);
+    }
+    int leftOutliers = 0;
+    for (int i = 0; i < numBuckets; ++i) {
+        leftOutliers += histogram[i];
+        if (leftOutliers > maxOutliersOnEachSide) {
+            break;
+        }
+        if (histogram[i] == 0) {
+            *rangeMin = bucketIdxToValue(i + 1, min, max, numBuckets);
+        }
+    }
+    int rightOutliers = 0;
+    for (int i = numBuckets - 1; i >= 0; --i) {
+        rightOutliers += histogram[i];
+        if (rightOutliers > maxOutliersOnEachSide) {
+            break;
+        }
+        if (histogram[i] == 0) {
+            *rangeMax = bucketIdxToValue(i, min, max, numBuckets);
+        }
+    }
+    free(histogram);
+    return AVIF_TRUE;
+}
+
+typedef struct Input
+{
+    const avifRGBImage * rgb;
+    avifColorPrimaries primaries;
+    avifTransferCharacteristics transfer;
+} Input;
+
+// The full-buffer computation, for gain maps of the size of the inputs.
+static avifBool computeReference(const Input * base, const Input * alt, avifGainMap * gainMap)
+{
+    const int width = base->rgb->width;
+    const int height = base->rgb->height;
+    const avifBool colorSpacesDiffer = (base->primaries != alt->primaries);
+    avifColorPrimaries mathPrimaries;
+    avifRGBColorSpaceInfo baseRGBInfo;
+    avifRGBColorSpaceInfo altRGBInfo;
+    if (!chooseColorSpaceForGainMapMath(base->primaries, alt->primaries, &mathPrimaries) ||
+        !avifGetRGBColorSpaceInfo(base->rgb, &baseRGBInfo) || !avifGetRGBColorSpaceInfo(alt->rgb, &altRGBInfo)) {
+        return AVIF_FALSE;
+    }
+    const avifBool singleChannel = (gainMap->image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400);
+    const int numGainMapChannels = singleChannel ? 1 : 3;
+    float * gainMapF[3] = { NULL, NULL, NULL };
+    avifRGBImage gainMapRGB;
+    memset(&gainMapRGB, 0, sizeof(gainMapRGB));
+    avifBool ok = AVIF_FALSE;
+    for (int c = 0; c < numGainMapChannels; ++c) {
+        gainMapF[c] = (float *)malloc(sizeof(float) * width * height);
+        if (gainMapF[c] == NULL) {
+            goto cleanup;
+        }
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        gainMap->gainMapMin[c] = (avifSignedFraction) { 1, 1 };
+        gainMap->gainMapMax[c] = (avifSignedFraction) { 1, 1 };
+        gainMap->baseOffset[c] = (avifSignedFraction) { 1, 64 };
+        gainMap->alternateOffset[c] = (avifSignedFraction) { 1, 64 };
+        gainMap->gainMapGamma[c] = (avifUnsignedFraction) { 1, 1 };
+    }
+    gainMap->useBaseColorSpace = (mathPrimaries == base->primaries);
+
+    avifTransferFunction baseGammaToLinear = avifTransferCharacteristicsGetGammaToLinearFunction(base->transfer);
+    avifTransferFunction altGammaToLinear = avifTransferCharacteristicsGetGammaToLinearFunction(alt->transfer);
+    float yCoeffs[3];
+    avifColorPrimariesComputeYCoeffs(mathPrimaries, yCoeffs);
+    double rgbConversionCoeffs[3][3];
+    if (colorSpacesDiffer &&
+        !avifColorPrimariesComputeRGBToRGBMatrix(gainMap->useBaseColorSpace ? alt->primaries : base->primaries,
+                                                 gainMap->useBaseColorSpace ? base->primaries : alt->primaries,
+                                                 rgbConversionCoeffs)) {
+        goto cleanup;
+    }
+
+    float baseOffset[3];
+    float alternateOffset[3];
+    for (int c = 0; c < 3; ++c) {
+        baseOffset[c] = signedFractionToFloat(gainMap->baseOffset[c]);
+        alternateOffset[c] = signedFractionToFloat(gainMap->alternateOffset[c]);
+    }
+    if (colorSpacesDiffer) {
+        const Input * converted = gainMap->useBaseColorSpace ? alt : base;
+        const avifRGBColorSpaceInfo * convertedInfo = gainMap->useBaseColorSpace ? &altRGBInfo : &baseRGBInfo;
+        avifTransferFunction toLinear = gainMap->useBaseColorSpace ? altGammaToLinear : baseGammaToLinear;
+        float channelMin[3] = { 0.0f, 0.0f, 0.0f };
+        for (int j = 0; j < height; ++j) {
+            for (int i = 0; i < width; ++i) {
+                float rgba[4];
+                avifGetRGBAPixel(converted->rgb, i, j, convertedInfo, rgba);
+                for (int c = 0; c < 3; ++c) {
+                    rgba[c] = toLinear(rgba[c]);
+                }
+                avifLinearRGBConvertColorSpace(rgba, rgbConversionCoeffs);
+                for (int c = 0; c < 3; ++c) {
+                    channelMin[c] = AVIF_MIN(channelMin[c], rgba[c]);
+                }
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            const float maxOffset = 0.1f;
+            if (channelMin[c] < -kEpsilon) {
+                if (gainMap->useBaseColorSpace) {
+                    alternateOffset[c] = AVIF_MIN(alternateOffset[c] - channelMin[c], maxOffset);
+                } else {
+                    baseOffset[c] = AVIF_MIN(baseOffset[c] - channelMin[c], maxOffset);
+                }
+            }
+        }
+    }
+
+    float baseMax = 1.0f;
+    float altMax = 1.0f;
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            float baseRGBA[4];
+            float altRGBA[4];
+            avifGetRGBAPixel(base->rgb, i, j, &baseRGBInfo, baseRGBA);
+            avifGetRGBAPixel(alt->rgb, i, j, &altRGBInfo, altRGBA);
+            for (int c = 0; c < 3; ++c) {
+                baseRGBA[c] = baseGammaToLinear(baseRGBA[c]);
+                altRGBA[c] = altGammaToLinear(altRGBA[c]);
+            }
+            if (colorSpacesDiffer) {
+                avifLinearRGBConvertColorSpace(gainMap->useBaseColorSpace ? altRGBA : baseRGBA, rgbConversionCoeffs);
+            }
+            for (int c = 0; c < numGainMapChannels; ++c) {
+                float baseValue = baseRGBA[c];
+                float altValue = altRGBA[c];
+                if (singleChannel) {
+                    baseValue = yCoeffs[0] * baseRGBA[0] + yCoeffs[1] * baseRGBA[1] + yCoeffs[2] * baseRGBA[2];
+                    altValue = yCoeffs[0] * altRGBA[0] + yCoeffs[1] * altRGBA[1] + yCoeffs[2] * altRGBA[2];
+                }
+                baseMax = AVIF_MAX(baseMax, baseValue);
+                altMax = AVIF_MAX(altMax, altValue);
+                const float ratio = (altValue + alternateOffset[c]) / (baseValue + baseOffset[c]);
+                gainMapF[c][j * width + i] = log2f(AVIF_MAX(ratio, kEpsilon));
+            }
+        }
+    }
+
+    const double baseHeadroom = log2f(AVIF_MAX(baseMax, kEpsilon));
+    const double alternateHeadroom = log2f(AVIF_MAX(altMax, kEpsilon));
+    if (!avifDoubleToUnsignedFraction(baseHeadroom, &gainMap->baseHdrHeadroom) ||
+        !avifDoubleToUnsignedFraction(alternateHeadroom, &gainMap->alternateHdrHeadroom)) {
+        goto cleanup;
+    }
+    if (alternateHeadroom < baseHeadroom) {
+        for (int c = 0; c < numGainMapChannels; ++c) {
+            for (int i = 0; i < width * height; ++i) {
+                gainMapF[c][i] *= -1.f;
+            }
+        }
+    }
+
+    float gainMapMinLog2[3] = { 0.0f, 0.0f, 0.0f };
+    float gainMapMaxLog2[3] = { 0.0f, 0.0f, 0.0f };
+    for (int c = 0; c < numGainMapChannels; ++c) {
+        if (!findMinMaxWithoutOutliers(gainMapF[c], width * height, &gainMapMinLog2[c], &gainMapMaxLog2[c])) {
+            goto cleanup;
+        }
+    }
+    for (int c = 0; c < 3; ++c) {
+        if (!avifDoubleToSignedFraction(gainMapMinLog2[singleChannel ? 0 : c], &gainMap->gainMapMin[c]) ||
+            !avifDoubleToSignedFraction(gainMapMaxLog2[singleChannel ? 0 : c], &gainMap->gainMapMax[c]) ||
+            !avifDoubleToSignedFraction(alternateOffset[c], &gainMap->alternateOffset[c]) ||
+            !avifDoubleToSignedFraction(baseOffset[c], &gainMap->baseOffset[c])) {
+            goto cleanup;
+        }
+    }
+
+    for (int c = 0; c < numGainMapChannels; ++c) {
+        const float range = AVIF_MAX(gainMapMaxLog2[c] - gainMapMinLog2[c], 0.0f);
+        const float gainMapGamma = unsignedFractionToFloat(gainMap->gainMapGamma[c]);
+        for (int i = 0; i < width * height; ++i) {
+            if (range == 0.0f) {
+                gainMapF[c][i] = 0.0f;
+            } else {
+                float v = AVIF_CLAMP(gainMapF[c][i], gainMapMinLog2[c], gainMapMaxLog2[c]);
+                v = powf((v - gainMapMinLog2[c]) / range, gainMapGamma);
+                gainMapF[c][i] = AVIF_CLAMP(v, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    avifImageFreePlanes(gainMap->image, AVIF_PLANES_ALL);
+    if (avifImageAllocatePlanes(gainMap->image, AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+        goto cleanup;
+    }
+    avifRGBImageSetDefaults(&gainMapRGB, gainMap->image);
+    avifRGBColorSpaceInfo gainMapRGBInfo;
+    if (avifRGBImageAllocatePixels(&gainMapRGB) != AVIF_RESULT_OK || !avifGetRGBColorSpaceInfo(&gainMapRGB, &gainMapRGBInfo)) {
+        goto cleanup;
+    }
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            const float r = gainMapF[0][j * width + i];
+            const float rgbaPixel[4] = { r,
+                                         singleChannel ? r : gainMapF[1][j * width + i],
+                                         singleChannel ? r : gainMapF[2][j * width + i],
+                                         1.0f };
+            avifSetRGBAPixel(&gainMapRGB, i, j, &gainMapRGBInfo, rgbaPixel);
+        }
+    }
+    ok = (avifImageRGBToYUV(gainMap->image, &gainMapRGB) == AVIF_RESULT_OK);
+
+cleanup:
+    for (int c = 0; c < 3; ++c) {
+        free(gainMapF[c]);
+    }
+    avifRGBImageFreePixels(&gainMapRGB);
+    return ok;
+}
+
+static avifGainMap * createGainMap(uint32_t depth, avifPixelFormat format)
+{
+    avifGainMap * gainMap = avifGainMapCreate();
+    if (gainMap == NULL) {
+        return NULL;
+    }
+    gainMap->image = avifImageCreate(WIDTH, HEIGHT, depth, format);
+    if (gainMap->image == NULL) {
+        avifGainMapDestroy(gainMap);
+        return NULL;
+    }
+    return gainMap;
+}
+
+static avifBool sameSigned(const avifSignedFraction * a, const avifSignedFraction * b)
+{
+    for (int c = 0; c < 3; ++c) {
+        if (a[c].n != b[c].n || a[c].d != b[c].d) {
+            return AVIF_FALSE;
+        }
+    }
+    return AVIF_TRUE;
+}
+
+static avifBool sameGainMap(const avifGainMap * a, const avifGainMap * b)
+{
+    if (!sameSigned(a->gainMapMin, b->gainMapMin) || !sameSigned(a->gainMapMax, b->gainMapMax) ||
+        !sameSigned(a->baseOffset, b->baseOffset) || !sameSigned(a->alternateOffset, b->alternateOffset) ||
+        a->baseHdrHeadroom.n != b->baseHdrHeadroom.n || a->baseHdrHeadroom.d != b->baseHdrHeadroom.d ||
+        a->alternateHdrHeadroom.n != b->alternateHdrHeadroom.n || a->alternateHdrHeadroom.d != b->alternateHdrHeadroom.d ||
+        a->useBaseColorSpace != b->useBaseColorSpace) {
+        return AVIF_FALSE;
+    }
+    for (int c = 0; c < 3; ++c) {
+        if (a->gainMapGamma[c].n != b->gainMapGamma[c].n || a->gainMapGamma[c].d != b->gainMapGamma[c].d) {
+            return AVIF_FALSE;
+        }
+    }
+    const avifImage * imageA = a->image;
+    const avifImage * imageB = b->image;
+    if (imageA->width != imageB->width || imageA->height != imageB->height || imageA->depth != imageB->depth ||
+        imageA->yuvFormat != imageB->yuvFormat) {
+        return AVIF_FALSE;
+    }
+    const int planes = (imageA->yuvFormat == AVIF_PIXEL_FORMAT_YUV400) ? 1 : 3;
+    for (int plane = 0; plane < planes; ++plane) {
+        const uint32_t rowBytes = avifImagePlaneWidth(imageA, plane) * (imageA->depth > 8 ? 2 : 1);
+        for (uint32_t j = 0; j < avifImagePlaneHeight(imageA, plane); ++j) {
+            if (memcmp(&imageA->yuvPlanes[plane][(size_t)j * imageA->yuvRowBytes[plane]],
+                       &imageB->yuvPlanes[plane][(size_t)j * imageB->yuvRowBytes[plane]],
+                       rowBytes) != 0) {
+                return AVIF_FALSE;
+            }
+        }
+    }
+    return AVIF_TRUE;
+}
+
+static int checkGainMap(const char * name, const Input * base, const Input * alt, uint32_t gainMapDepth, avifPixelFormat gainMapFormat)
+{
+    int failed = 0;
+    avifGainMap * reference = createGainMap(gainMapDepth, gainMapFormat);
+    avifGainMap * singleThread = createGainMap(gainMapDepth, gainMapFormat);
+    if (reference == NULL || singleThread == NULL || !computeReference(base, alt, reference)) {
+        printf("FAIL %s: reference computation\n", name);
+        failed = 1;
+        goto cleanup;
+    }
+    avifDiagnostics diag;
+    avifRGBImage baseRgb = *base->rgb;
+    baseRgb.maxThreads = 1;
+    if (avifRGBImageComputeGainMap(&baseRgb, base->primaries, base->transfer, alt->rgb, alt->primaries, alt->transfer, singleThread, &diag) !=
+        AVIF_RESULT_OK) {
+        printf("FAIL %s: %s\n", name, diag.error);
+        failed = 1;
+        goto cleanup;
+    }
+    if (!sameGainMap(singleThread, reference)) {
+        printf("FAIL %s: gain map differs from the full-buffer computation\n", name);
+        failed = 1;
+    }
+    for (int maxThreads = 2; maxThreads <= 9; ++maxThreads) {
+        avifGainMap * banded = createGainMap(gainMapDepth, gainMapFormat);
+        baseRgb.maxThreads = maxThreads;
+        if (banded == NULL ||
+            avifRGBImageComputeGainMap(&baseRgb, base->primaries, base->transfer, alt->rgb, alt->primaries, alt->transfer, banded, &diag) !=
+                AVIF_RESULT_OK ||
+            !sameGainMap(banded, singleThread)) {
+            printf("FAIL %s: %d threads differ from a single thread\n", name, maxThreads);
+            failed = 1;
+        }
+        if (banded != NULL) {
+            avifGainMapDestroy(banded);
+        }
+    }
+    printf("%s %s: gain map min %d/%u, max %d/%u, alternate headroom %u/%u\n",
+           failed ? "FAIL" : "ok  ",
+           name,
+           singleThread->gainMapMin[0].n,
+           singleThread->gainMapMin[0].d,
+           singleThread->gainMapMax[0].n,
+           singleThread->gainMapMax[0].d,
+           singleThread->alternateHdrHeadroom.n,
+           singleThread->alternateHdrHeadroom.d);
+
+cleanup:
+    if (reference != NULL) {
+        avifGainMapDestroy(reference);
+    }
+    if (singleThread != NULL) {
+        avifGainMapDestroy(singleThread);
+    }
+    return failed;
+}
+
+// Smooth gradients with noise and a few extreme pixels, so that the outlier histogram has work to do.
+static avifBool createImage(uint32_t depth, uint32_t scale, avifRGBImage * rgb)
+{
+    memset(rgb, 0, sizeof(*rgb));
+    rgb->width = WIDTH;
+    rgb->height = HEIGHT;
+    rgb->depth = depth;
+    rgb->format = AVIF_RGB_FORMAT_RGBA;
+    if (avifRGBImageAllocatePixels(rgb) != AVIF_RESULT_OK) {
+        return AVIF_FALSE;
+    }
+    const uint32_t maxValue = (1u << depth) - 1;
+    for (uint32_t j = 0; j < HEIGHT; ++j) {
+        for (uint32_t i = 0; i < WIDTH; ++i) {
+            for (uint32_t c = 0; c < 4; ++c) {
+                uint32_t value = ((i * (c + 1) + j * (3 - c)) * maxValue / (WIDTH + 3 * HEIGHT)) * scale / 4;
+                value += nextRandom() % (maxValue / 16 + 1);
+                if (nextRandom() % 997 == 0) {
+                    value = (c == 0) ? maxValue : 0;
+                }
+                value = AVIF_MIN(value, maxValue);
+                if (depth == 8) {
+                    rgb->pixels[(size_t)j * rgb->rowBytes + i * 4 + c] = (uint8_t)value;
+                } else {
+                    ((uint16_t *)&rgb->pixels[(size_t)j * rgb->rowBytes])[i * 4 + c] = (uint16_t)value;
+                }
+            }
+        }
+    }
+    return AVIF_TRUE;
+}
+
+int main(void)
+{
+    avifRGBImage sdr8, hdr10, hdr16, hdr12;
+    if (!createImage(8, 4, &sdr8) || !createImage(10, 3, &hdr10) || !createImage(16, 2, &hdr16) || !createImage(12, 4, &hdr12)) {
+        return 1;
+    }
+    const Input sdrSRGB = { &sdr8, AVIF_COLOR_PRIMARIES_BT709, AVIF_TRANSFER_CHARACTERISTICS_SRGB };
+    const Input sdrP3 = { &sdr8, AVIF_COLOR_PRIMARIES_SMPTE432, AVIF_TRANSFER_CHARACTERISTICS_SRGB };
+    const Input pq10 = { &hdr10, AVIF_COLOR_PRIMARIES_BT2020, AVIF_TRANSFER_CHARACTERISTICS_PQ };
+    const Input pq16 = { &hdr16, AVIF_COLOR_PRIMARIES_BT709, AVIF_TRANSFER_CHARACTERISTICS_PQ };
+    const Input hlg12 = { &hdr12, AVIF_COLOR_PRIMARIES_SMPTE432, AVIF_TRANSFER_CHARACTERISTICS_HLG };
+
+    int failures = 0;
+    failures += checkGainMap("8-bit sRGB to 10-bit PQ BT.2020, 4:4:4", &sdrSRGB, &pq10, 8, AVIF_PIXEL_FORMAT_YUV444);
+    failures += checkGainMap("8-bit sRGB to 10-bit PQ BT.2020, 4:0:0", &sdrSRGB, &pq10, 8, AVIF_PIXEL_FORMAT_YUV400);
+    failures += checkGainMap("8-bit sRGB to 16-bit PQ, 10-bit 4:4:4", &sdrSRGB, &pq16, 10, AVIF_PIXEL_FORMAT_YUV444);
+    failures += checkGainMap("8-bit P3 to 12-bit HLG P3, 4:4:4", &sdrP3, &hlg12, 8, AVIF_PIXEL_FORMAT_YUV444);
+    failures += checkGainMap("10-bit PQ BT.2020 to 8-bit P3, 4:0:0", &pq10, &sdrP3, 8, AVIF_PIXEL_FORMAT_YUV400);
+    failures += checkGainMap("16-bit PQ to 8-bit sRGB, 4:4:4", &pq16, &sdrSRGB, 8, AVIF_PIXEL_FORMAT_YUV444);
+    avifRGBImageFreePixels(&sdr8);
+    avifRGBImageFreePixels(&hdr10);
+    avifRGBImageFreePixels(&hdr16);
+    avifRGBImageFreePixels(&hdr12);
+    if (failures != 0) {
+        printf("%d gain map computation checks failed\n", failures);
+        return 1;
+    }
+    printf("gain map computation matches the full-buffer computation and is independent of maxThreads\n");
+    return 0;
+}
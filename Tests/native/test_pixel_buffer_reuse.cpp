@@ -0,0 +1,146 @@
+// Counts the frame-sized allocations of handing decoded frames to CoreGraphics the way AVIFImageXForm does: the frame
+// is converted by AvifHandleImage into a PixelBuffer, moved into an XFormDataContainer and released through
+// XFormDataRelease when the image is gone. With a cold PixelBufferPool every frame must take exactly one frame-sized
+// allocation, which the container holds without a copy; once released, frames of the same size must reuse it.
+
+#include "RgbConversion.hpp"
+#include "XFormDataContainer.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+    constexpr int kFrames = 30;
+
+    // Allocations at least this large are frames, smaller ones are containers, band scratches and bookkeeping
+    size_t frameAllocationSize = SIZE_MAX;
+    size_t frameAllocations = 0;
+
+    void *countedAllocation(size_t size) {
+        if (size >= frameAllocationSize) {
+            ++frameAllocations;
+        }
+        void *pointer = std::malloc(size ? size : 1);
+        if (!pointer) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+}
+
+void *operator new(size_t size) {
+    return countedAllocation(size);
+}
+
+void *operator new[](size_t size) {
+    return countedAllocation(size);
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+namespace {
+
+    struct Source {
+        const char *name;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        avifPixelFormat format;
+        bool alpha;
+    };
+
+    avifImage *createImage(const Source &source) {
+        avifImage *image = avifImageCreate(source.width, source.height, source.depth, source.format);
+        if (image && avifImageAllocatePlanes(image, source.alpha ? AVIF_PLANES_ALL : AVIF_PLANES_YUV) != AVIF_RESULT_OK) {
+            avifImageDestroy(image);
+            return nullptr;
+        }
+        return image;
+    }
+
+    // One frame: converted, handed to the container and released like a CGDataProvider releases it
+    bool handOffFrame(const avifImage *image, uint32_t width, uint32_t height, bool allowRA30, uint32_t expectedBitDepth) {
+        int result = AVIF_RESULT_UNKNOWN_ERROR;
+        AvifImageHandle handle = AvifHandleImage(image, width, height, allowRA30, &result);
+        if (result != AVIF_RESULT_OK || handle.bitDepth != expectedBitDepth || handle.data.data() == nullptr) {
+            return false;
+        }
+        const uint8_t *converted = handle.data.data();
+        auto *container = new XFormDataContainer(std::move(handle.data));
+        const bool sameBuffer = container->data() == converted && handle.data.data() == nullptr;
+        XFormDataRelease(container, converted, handle.stride * handle.height);
+        return sameBuffer;
+    }
+
+    int check(const Source &source, uint32_t width, uint32_t height, bool allowRA30, uint32_t bytesPerPixel,
+              uint32_t expectedBitDepth) {
+        avifImage *image = createImage(source);
+        if (!image) {
+            std::printf("FAIL %s: cannot allocate the image\n", source.name);
+            return 1;
+        }
+        frameAllocationSize = static_cast<size_t>(width) * height * bytesPerPixel / 2;
+        PixelBufferPool::shared().trim(0);
+
+        bool converted = true;
+        const size_t before = frameAllocations;
+        converted &= handOffFrame(image, width, height, allowRA30, expectedBitDepth);
+        const size_t coldAllocations = frameAllocations - before;
+        for (int frame = 1; frame < kFrames; ++frame) {
+            converted &= handOffFrame(image, width, height, allowRA30, expectedBitDepth);
+        }
+        const size_t warmAllocations = frameAllocations - before - coldAllocations;
+        // Slightly smaller frames fall in the same pool bucket and take the buffer left by the previous frames
+        converted &= handOffFrame(image, width - 1, height - 1, allowRA30, expectedBitDepth);
+        const size_t smallerAllocations = frameAllocations - before - coldAllocations - warmAllocations;
+        frameAllocationSize = SIZE_MAX;
+        avifImageDestroy(image);
+
+        const bool failed = !converted || coldAllocations != 1 || warmAllocations != 0 || smallerAllocations != 0;
+        std::printf("%s %s to %ux%u%s: %zu frame-sized allocations for the first frame, %zu for %d more frames, %zu for "
+                    "a smaller frame%s\n",
+                    failed ? "FAIL" : "ok  ", source.name, width, height, allowRA30 ? "" : " without RA30", coldAllocations, warmAllocations, kFrames - 1,
+                    smallerAllocations, converted ? "" : ", the conversion failed or the container copied the frame");
+        return failed ? 1 : 0;
+    }
+}
+
+int main() {
+    int failures = 0;
+    const Source yuv420Alpha8 = { "1280x720 8-bit 4:2:0 with alpha", 1280, 720, 8, AVIF_PIXEL_FORMAT_YUV420, true };
+    const Source yuv444Alpha10 = { "1280x720 10-bit 4:4:4 with alpha", 1280, 720, 10, AVIF_PIXEL_FORMAT_YUV444, true };
+    const Source yuv422Rgb10 = { "1280x720 10-bit 4:2:2", 1280, 720, 10, AVIF_PIXEL_FORMAT_YUV422, false };
+    const Source yuv420Large8 = { "1920x1080 8-bit 4:2:0", 1920, 1080, 8, AVIF_PIXEL_FORMAT_YUV420, false };
+    // RGBA 8-bit, converted in one go
+    failures += check(yuv420Alpha8, 1280, 720, true, 4, 8);
+    // RGBA half floats, converted to 16-bit and then to half floats in place
+    failures += check(yuv444Alpha10, 1280, 720, true, 8, 16);
+    // 10-bit RGB, converted band by band and packed to RA30, or converted to half floats in HDR color spaces
+    failures += check(yuv422Rgb10, 1280, 720, true, 4, 10);
+    failures += check(yuv422Rgb10, 1280, 720, false, 6, 16);
+    // Downscaled band by band straight into the frame
+    failures += check(yuv420Large8, 1280, 720, true, 3, 8);
+    failures += check(yuv422Rgb10, 640, 360, true, 4, 10);
+    if (failures != 0) {
+        std::printf("%d pixel buffer reuse checks failed\n", failures);
+        return 1;
+    }
+    std::printf("decoded frames take one pixel buffer and reuse it\n");
+    return 0;
+}
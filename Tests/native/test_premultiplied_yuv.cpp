@@ -0,0 +1,137 @@
+// Checks premultipliedRgba8ToYuv8(), which unpremultiplies, converts and copies alpha band by band in parallel, against
+// the three passes it replaced run over the whole frame: unpremultiply, pixart_rgba8_to_yuv8, then alpha copy. Frames
+// have odd sizes, padded strides and from one to hundreds of bands, in 4:2:0, 4:2:2 and 4:4:4. The pixart conversion
+// is the one of pixart_stub.cpp, both sides call it.
+
+#include "PremultipliedYuv.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+    struct Plane {
+        std::vector<uint8_t> data;
+        uint32_t stride;
+        uint32_t width;
+        uint32_t height;
+
+        Plane(uint32_t planeWidth, uint32_t planeHeight, uint32_t padding)
+                : data(static_cast<size_t>(planeWidth + padding) * planeHeight, 0xCD), stride(planeWidth + padding),
+                  width(planeWidth), height(planeHeight) {}
+
+        bool sameAs(const Plane &other) const {
+            for (uint32_t y = 0; y < height; ++y) {
+                if (memcmp(&data[static_cast<size_t>(stride) * y], &other.data[static_cast<size_t>(other.stride) * y], width) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    struct YuvaPlanes {
+        Plane y, u, v, a;
+
+        YuvaPlanes(uint32_t width, uint32_t height, YuvType yuvType, uint32_t padding)
+                : y(width, height, padding),
+                  u(yuvType == YuvType::Yuv444 ? width : (width + 1) / 2, yuvType == YuvType::Yuv420 ? (height + 1) / 2 : height, padding),
+                  v(u.width, u.height, padding), a(width, height, padding) {}
+    };
+
+    // The straightforward unpremultiplication, rounded like vImageUnpremultiplyData_RGBA8888
+    uint8_t unpremultiply(uint8_t c, uint8_t a) {
+        if (a == 0) {
+            return 0;
+        }
+        return static_cast<uint8_t>(std::min((c * 255u + a / 2u) / a, 255u));
+    }
+
+    void convertInThreePasses(const std::vector<uint8_t> &rgba, uint32_t rgbaStride, uint32_t width, uint32_t height,
+                              YuvType yuvType, YuvaPlanes &out, bool withAlpha) {
+        std::vector<uint8_t> straight(static_cast<size_t>(width) * 4 * height);
+        for (uint32_t y = 0; y < height; ++y) {
+            const uint8_t *src = &rgba[static_cast<size_t>(rgbaStride) * y];
+            uint8_t *dst = &straight[static_cast<size_t>(width) * 4 * y];
+            for (uint32_t x = 0; x < width * 4; x += 4) {
+                dst[x] = unpremultiply(src[x], src[x + 3]);
+                dst[x + 1] = unpremultiply(src[x + 1], src[x + 3]);
+                dst[x + 2] = unpremultiply(src[x + 2], src[x + 3]);
+                dst[x + 3] = src[x + 3];
+            }
+        }
+        pixart_rgba8_to_yuv8(out.y.data.data(), out.y.stride, out.u.data.data(), out.u.stride, out.v.data.data(), out.v.stride,
+                             straight.data(), width * 4, width, height, YuvRange::Pc, YuvMatrix::Bt709, yuvType);
+        if (withAlpha) {
+            for (uint32_t y = 0; y < height; ++y) {
+                for (uint32_t x = 0; x < width; ++x) {
+                    out.a.data[static_cast<size_t>(out.a.stride) * y + x] = rgba[static_cast<size_t>(rgbaStride) * y + x * 4 + 3];
+                }
+            }
+        }
+    }
+
+    int check(uint32_t width, uint32_t height, YuvType yuvType, const char *typeName, bool withAlpha, std::mt19937 &random) {
+        const uint32_t padding = 3 + width % 5;
+        const uint32_t rgbaStride = width * 4 + padding;
+        std::vector<uint8_t> rgba(static_cast<size_t>(rgbaStride) * height);
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                uint8_t *pixel = &rgba[static_cast<size_t>(rgbaStride) * y + x * 4];
+                // Transparent and opaque pixels are frequent, and a few colors exceed their alpha
+                const uint32_t kind = random() % 8;
+                pixel[3] = kind == 0 ? 0 : (kind == 1 ? 255 : static_cast<uint8_t>(random()));
+                for (int c = 0; c < 3; ++c) {
+                    pixel[c] = kind == 2 ? static_cast<uint8_t>(random()) : static_cast<uint8_t>(random() % (pixel[3] + 1u));
+                }
+            }
+        }
+
+        YuvaPlanes expected(width, height, yuvType, padding);
+        YuvaPlanes actual(width, height, yuvType, padding);
+        convertInThreePasses(rgba, rgbaStride, width, height, yuvType, expected, withAlpha);
+        premultipliedRgba8ToYuv8(actual.y.data.data(), actual.y.stride, actual.u.data.data(), actual.u.stride,
+                                 actual.v.data.data(), actual.v.stride,
+                                 withAlpha ? actual.a.data.data() : nullptr, actual.a.stride,
+                                 rgba.data(), rgbaStride, width, height, YuvRange::Pc, YuvMatrix::Bt709, yuvType);
+
+        // Without alpha the plane must stay untouched
+        const bool failed = !actual.y.sameAs(expected.y) || !actual.u.sameAs(expected.u) || !actual.v.sameAs(expected.v) ||
+                            !actual.a.sameAs(expected.a);
+        // Bands of premultipliedRgba8ToYuv8 take 64 KB of RGBA, at least two rows
+        const uint32_t bandRows = std::max<uint32_t>(65536 / (width * 4), 2) & ~1u;
+        std::printf("%s %ux%u %s%s, %u bands\n", failed ? "FAIL" : "ok  ", width, height, typeName, withAlpha ? " with alpha" : "",
+                    (height + bandRows - 1) / bandRows);
+        return failed ? 1 : 0;
+    }
+}
+
+int main() {
+    struct Size {
+        uint32_t width;
+        uint32_t height;
+    };
+    const Size sizes[] = { { 1, 1 }, { 33, 7 }, { 257, 255 }, { 1001, 333 }, { 1920, 1081 }, { 4097, 101 }, { 20001, 5 } };
+    const struct {
+        YuvType type;
+        const char *name;
+    } types[] = { { YuvType::Yuv420, "4:2:0" }, { YuvType::Yuv422, "4:2:2" }, { YuvType::Yuv444, "4:4:4" } };
+
+    std::mt19937 random(42);
+    int failures = 0;
+    for (const Size &size: sizes) {
+        for (const auto &type: types) {
+            failures += check(size.width, size.height, type.type, type.name, true, random);
+        }
+    }
+    failures += check(1001, 333, YuvType::Yuv420, "4:2:0", false, random);
+    if (failures != 0) {
+        std::printf("%d premultiplied YUV checks failed\n", failures);
+        return 1;
+    }
+    std::printf("premultipliedRgba8ToYuv8 matches unpremultiplying, converting and copying alpha in three passes\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+// avifImageRGBToYUV() splits images in bands of rows when rgb->maxThreads is above one. The YUV and alpha planes must be
+// the same, byte for byte, as the ones of a single job, including for 4:2:0 images of odd heights, whose last chroma row
+// only averages one row, and when alpha is multiplied or unmultiplied on the way.
+
+#include "avif/avif.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t randomState = 11;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static avifBool createRandomRGBImage(uint32_t width, uint32_t height, uint32_t depth, avifRGBFormat format, avifRGBImage * rgb)
+{
+    memset(rgb, 0, sizeof(*rgb));
+    rgb->width = width;
+    rgb->height = height;
+    rgb->depth = depth;
+    rgb->format = format;
+    if (avifRGBImageAllocatePixels(rgb) != AVIF_RESULT_OK) {
+        return AVIF_FALSE;
+    }
+    const uint32_t maxChannel = (1u << depth) - 1;
+    const uint32_t channels = avifRGBFormatChannelCount(format);
+    for (uint32_t j = 0; j < height; ++j) {
+        for (uint32_t i = 0; i < width * channels; ++i) {
+            // Transparent and opaque pixels are frequent, so that every alpha case is seen.
+            uint32_t value = nextRandom();
+            const uint32_t kind = nextRandom() % 4;
+            value = (kind == 0) ? 0 : (kind == 1) ? maxChannel : (value & maxChannel);
+            if (depth == 8) {
+                rgb->pixels[(size_t)j * rgb->rowBytes + i] = (uint8_t)value;
+            } else {
+                ((uint16_t *)&rgb->pixels[(size_t)j * rgb->rowBytes])[i] = (uint16_t)value;
+            }
+        }
+    }
+    return AVIF_TRUE;
+}
+
+typedef struct Options
+{
+    avifRGBFormat format;
+    uint32_t rgbDepth;
+    uint32_t yuvDepth;
+    avifBool rgbPremultiplied;
+    avifBool yuvPremultiplied;
+    avifBool ignoreAlpha;
+} Options;
+
+static avifImage * convert(const avifRGBImage * source, avifPixelFormat yuvFormat, const Options * options, int maxThreads)
+{
+    avifImage * image = avifImageCreate(source->width, source->height, options->yuvDepth, yuvFormat);
+    if (!image) {
+        return NULL;
+    }
+    image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT601;
+    image->alphaPremultiplied = options->yuvPremultiplied;
+    avifRGBImage rgb = *source;
+    rgb.alphaPremultiplied = options->rgbPremultiplied;
+    rgb.ignoreAlpha = options->ignoreAlpha;
+    rgb.maxThreads = maxThreads;
+    if (avifImageRGBToYUV(image, &rgb) != AVIF_RESULT_OK) {
+        avifImageDestroy(image);
+        return NULL;
+    }
+    return image;
+}
+
+static avifBool samePlanes(const avifImage * a, const avifImage * b)
+{
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+        const uint8_t * rowA = avifImagePlane(a, plane);
+        const uint8_t * rowB = avifImagePlane(b, plane);
+        if (!rowA || !rowB) {
+            if (rowA != rowB) {
+                return AVIF_FALSE;
+            }
+            continue;
+        }
+        const size_t rowBytes = (size_t)avifImagePlaneWidth(a, plane) * (a->depth > 8 ? 2 : 1);
+        for (uint32_t j = 0; j < avifImagePlaneHeight(a, plane); ++j) {
+            if (memcmp(&rowA[(size_t)j * avifImagePlaneRowBytes(a, plane)], &rowB[(size_t)j * avifImagePlaneRowBytes(b, plane)], rowBytes) != 0) {
+                return AVIF_FALSE;
+            }
+        }
+    }
+    return AVIF_TRUE;
+}
+
+// Returns the number of thread counts whose output differs from the single job one.
+static int compareBands(const avifRGBImage * rgb, avifPixelFormat yuvFormat, const Options * options)
+{
+    avifImage * single = convert(rgb, yuvFormat, options, 1);
+    if (!single) {
+        printf("FAIL single job conversion\n");
+        return 1;
+    }
+    int failures = 0;
+    for (int maxThreads = 2; maxThreads <= 9; ++maxThreads) {
+        avifImage * banded = convert(rgb, yuvFormat, options, maxThreads);
+        if (!banded || !samePlanes(single, banded)) {
+            printf("FAIL %ux%u format %d depth %u%s%s -> depth %u %s%s, %d threads: %s\n",
+                   rgb->width,
+                   rgb->height,
+                   (int)options->format,
+                   options->rgbDepth,
+                   options->rgbPremultiplied ? " premultiplied" : "",
+                   options->ignoreAlpha ? " ignoring alpha" : "",
+                   options->yuvDepth,
+                   avifPixelFormatToString(yuvFormat),
+                   options->yuvPremultiplied ? " premultiplied" : "",
+                   maxThreads,
+                   banded ? "planes differ" : "conversion failed");
+            ++failures;
+        }
+        if (banded) {
+            avifImageDestroy(banded);
+        }
+    }
+    avifImageDestroy(single);
+    return failures;
+}
+
+int main(void)
+{
+    const avifPixelFormat formats[] = { AVIF_PIXEL_FORMAT_YUV420, AVIF_PIXEL_FORMAT_YUV422, AVIF_PIXEL_FORMAT_YUV444, AVIF_PIXEL_FORMAT_YUV400 };
+    // Heights below 2 rows per band, odd heights and heights that leave a short last band.
+    const uint32_t heights[] = { 3, 17, 33, 61, 64 };
+    const Options options[] = {
+        { AVIF_RGB_FORMAT_RGBA, 8, 8, AVIF_FALSE, AVIF_FALSE, AVIF_FALSE },
+        // Alpha multiplied on the way.
+        { AVIF_RGB_FORMAT_RGBA, 8, 8, AVIF_FALSE, AVIF_TRUE, AVIF_FALSE },
+        // Alpha unmultiplied on the way.
+        { AVIF_RGB_FORMAT_BGRA, 8, 10, AVIF_TRUE, AVIF_FALSE, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_ARGB, 16, 12, AVIF_TRUE, AVIF_FALSE, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_ABGR, 10, 10, AVIF_FALSE, AVIF_TRUE, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_RGBA, 8, 8, AVIF_TRUE, AVIF_FALSE, AVIF_TRUE },
+        { AVIF_RGB_FORMAT_BGR, 8, 8, AVIF_FALSE, AVIF_FALSE, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_RGB, 12, 10, AVIF_FALSE, AVIF_FALSE, AVIF_FALSE },
+    };
+    int failures = 0;
+    int comparisons = 0;
+    for (size_t h = 0; h < sizeof(heights) / sizeof(heights[0]); ++h) {
+        for (size_t o = 0; o < sizeof(options) / sizeof(options[0]); ++o) {
+            avifRGBImage rgb;
+            if (!createRandomRGBImage(37, heights[h], options[o].rgbDepth, options[o].format, &rgb)) {
+                fprintf(stderr, "image allocation failed\n");
+                return 1;
+            }
+            for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+                failures += compareBands(&rgb, formats[f], &options[o]);
+                ++comparisons;
+            }
+            avifRGBImageFreePixels(&rgb);
+        }
+    }
+    if (failures != 0) {
+        printf("%d banded conversions differ from a single job\n", failures);
+        return 1;
+    }
+    printf("%d configurations, banded output is the same as a single job for 2 to 9 threads\n", comparisons);
+    return 0;
+}
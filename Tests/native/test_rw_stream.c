@@ -0,0 +1,162 @@
+// Checks the capacity management of avifRWStream: room reserved with avifRWStreamReserve() takes the whole output
+// without growing the buffer, growth beyond it is geometric, and avifRWStreamFinishWrite() trims the capacity to the
+// written size, shrinking the buffer only for a large slack, without losing any written byte.
+
+#include "avif/internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MB (1024 * 1024)
+#define PIECE_SIZE 1000
+
+static uint8_t patternByte(size_t offset)
+{
+    return (uint8_t)((offset * 2654435761u) >> 13);
+}
+
+// Writes bytes [offset, offset + size) of the pattern in pieces, counting the times the buffer moved
+static avifResult writePattern(avifRWStream * s, size_t size, int * moves)
+{
+    uint8_t piece[PIECE_SIZE];
+    for (size_t written = 0; written < size;) {
+        const size_t pieceSize = AVIF_MIN(size - written, (size_t)PIECE_SIZE);
+        const size_t offset = avifRWStreamOffset(s);
+        for (size_t i = 0; i < pieceSize; ++i) {
+            piece[i] = patternByte(offset + i);
+        }
+        const uint8_t * data = s->raw->data;
+        AVIF_CHECKRES(avifRWStreamWrite(s, piece, pieceSize));
+        if (s->raw->data != data) {
+            ++*moves;
+        }
+        written += pieceSize;
+    }
+    return AVIF_RESULT_OK;
+}
+
+static avifBool holdsPattern(const avifRWData * raw, size_t size)
+{
+    if (raw->size != size) {
+        return AVIF_FALSE;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        if (raw->data[i] != patternByte(i)) {
+            return AVIF_FALSE;
+        }
+    }
+    return AVIF_TRUE;
+}
+
+static int checkReserve(void)
+{
+    int failures = 0;
+    avifRWData raw = AVIF_DATA_EMPTY;
+    avifRWStream s;
+    avifRWStreamStart(&s, &raw);
+
+    int moves = 0;
+    if (avifRWStreamReserve(&s, 3 * MB + 123) != AVIF_RESULT_OK || raw.size != 3 * MB + 123) {
+        printf("FAIL reserving 3 MB gives %zu bytes of capacity\n", raw.size);
+        ++failures;
+    }
+    const uint8_t * reserved = raw.data;
+    if (writePattern(&s, 2 * MB, &moves) != AVIF_RESULT_OK || avifRWStreamReserve(&s, 0) != AVIF_RESULT_OK ||
+        avifRWStreamReserve(&s, MB) != AVIF_RESULT_OK || writePattern(&s, MB + 123, &moves) != AVIF_RESULT_OK) {
+        printf("FAIL writing the reserved bytes\n");
+        ++failures;
+    }
+    if (moves != 0 || raw.data != reserved || raw.size != 3 * MB + 123) {
+        printf("FAIL writing the reserved bytes moved the buffer %d times, capacity %zu\n", moves, raw.size);
+        ++failures;
+    }
+    if (avifRWStreamReserve(&s, SIZE_MAX) != AVIF_RESULT_OUT_OF_MEMORY || raw.data != reserved) {
+        printf("FAIL reserving more than SIZE_MAX bytes\n");
+        ++failures;
+    }
+    avifRWStreamFinishWrite(&s);
+    if (!holdsPattern(&raw, 3 * MB + 123)) {
+        printf("FAIL the reserved stream does not hold the written bytes\n");
+        ++failures;
+    }
+    avifRWDataFree(&raw);
+    printf("%s reserved room takes the output without moving the buffer\n", failures ? "FAIL" : "ok  ");
+    return failures;
+}
+
+static int checkGrowth(void)
+{
+    int failures = 0;
+    avifRWData raw = AVIF_DATA_EMPTY;
+    avifRWStream s;
+    avifRWStreamStart(&s, &raw);
+
+    // Grows by half of the capacity, at least 1 MB: 1, 2, 3, 4.5, 6.75, ... MB, 10 buffers up to 40 MB where steps of
+    // 1 MB would take 41
+    const size_t outputSize = 40 * MB + 17;
+    int moves = 0;
+    size_t capacity = 0;
+    while (avifRWStreamOffset(&s) < outputSize) {
+        if (writePattern(&s, AVIF_MIN(outputSize - avifRWStreamOffset(&s), (size_t)64 * 1024), &moves) != AVIF_RESULT_OK) {
+            printf("FAIL writing %zu bytes\n", outputSize);
+            ++failures;
+            break;
+        }
+        if (raw.size != capacity) {
+            const size_t minimumCapacity = AVIF_MAX(capacity + capacity / 2, capacity + MB);
+            if (raw.size < minimumCapacity) {
+                printf("FAIL capacity grew from %zu to %zu bytes\n", capacity, raw.size);
+                ++failures;
+            }
+            capacity = raw.size;
+        }
+    }
+    if (moves > 12) {
+        printf("FAIL writing %zu bytes moved the buffer %d times\n", outputSize, moves);
+        ++failures;
+    }
+    avifRWStreamFinishWrite(&s);
+    if (!holdsPattern(&raw, outputSize)) {
+        printf("FAIL the grown stream does not hold the written bytes\n");
+        ++failures;
+    }
+    avifRWDataFree(&raw);
+    printf("%s writing %zu bytes moved the buffer %d times\n", failures ? "FAIL" : "ok  ", outputSize, moves);
+    return failures;
+}
+
+// Writes `size` bytes after reserving `reserved`, finishes the write and checks whether the buffer was shrunk
+static int checkFinishWrite(const char * name, size_t reserved, size_t size, avifBool expectShrink)
+{
+    avifRWData raw = AVIF_DATA_EMPTY;
+    avifRWStream s;
+    avifRWStreamStart(&s, &raw);
+    int moves = 0;
+    avifBool written = avifRWStreamReserve(&s, reserved) == AVIF_RESULT_OK && writePattern(&s, size, &moves) == AVIF_RESULT_OK;
+    const uint8_t * data = raw.data;
+    avifRWStreamFinishWrite(&s);
+    const avifBool shrunk = raw.data != data;
+    const avifBool failed = !written || moves != 0 || shrunk != expectShrink ||
+                            (size ? !holdsPattern(&raw, size) : (raw.data != NULL || raw.size != 0));
+    printf("%s %s: %zu of %zu bytes written, %s\n", failed ? "FAIL" : "ok  ", name, size, reserved,
+           size == 0 ? "buffer freed" : (shrunk ? "buffer shrunk" : "slack kept"));
+    avifRWDataFree(&raw);
+    return failed ? 1 : 0;
+}
+
+int main(void)
+{
+    int failures = checkReserve() + checkGrowth();
+    // Slack within 1 MB or a quarter of the output is kept, larger slack is given back
+    failures += checkFinishWrite("slack under 1 MB", 2 * MB + MB / 2, 2 * MB, AVIF_FALSE);
+    failures += checkFinishWrite("slack under a quarter", 40 * MB, 36 * MB, AVIF_FALSE);
+    failures += checkFinishWrite("large slack", 10 * MB, 2 * MB + 5, AVIF_TRUE);
+    failures += checkFinishWrite("small output, large slack", 8 * MB, 100, AVIF_TRUE);
+    failures += checkFinishWrite("nothing written", MB, 0, AVIF_TRUE);
+    if (failures != 0) {
+        printf("%d avifRWStream checks failed\n", failures);
+        return 1;
+    }
+    printf("avifRWStream reserves, grows and trims its buffer without losing bytes\n");
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Bounds the error of the tabulated linear to gamma curves of avifTransferCurveApply() against the exact functions, and
+// of the integer samples written from them, and checks the gamma to linear tables and their cache.
+
+#include "avif/internal.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// See avifTransferCurve in internal.h.
+#define MAX_CURVE_ERROR 5e-6
+// Samples per curve. Half are spread evenly over the linear range, half evenly in its fourth root like the table.
+#define CURVE_SAMPLES (1 << 20)
+
+typedef struct TransferCharacteristics
+{
+    avifTransferCharacteristics atc;
+    const char * name;
+    float maxLinear;
+} TransferCharacteristics;
+
+// Writes a value to an integer sample like avifSetRGBAPixel().
+static uint32_t toSample(float value, float maxChannelF)
+{
+    return (uint32_t)(0.5f + AVIF_CLAMP(value, 0.0f, 1.0f) * maxChannelF);
+}
+
+static int checkCurve(const TransferCharacteristics * tc)
+{
+    avifTransferCurve curve;
+    avifTransferCurveInitLinearToGamma(&curve, tc->atc);
+    const avifTransferFunction toGamma = avifTransferCharacteristicsGetLinearToGammaFunction(tc->atc);
+    const uint32_t depths[] = { 8, 10, 12, 16 };
+    // Largest share of the integer samples of each depth that may round to a neighbouring code value. PQ comes closest,
+    // at about half of these.
+    const double maxMovedRatios[] = { 0.001, 0.003, 0.01, 0.15 };
+    uint32_t moved[4] = { 0 };
+    int maxMove = 0;
+    double maxError = 0.0;
+    float worstLinear = 0.0f;
+    for (uint32_t i = 0; i < CURVE_SAMPLES; ++i) {
+        const double t = (double)(i >> 1) / (CURVE_SAMPLES / 2 - 1);
+        // Slightly beyond the largest linear value, where the curves are flat.
+        const float linear = (float)(((i & 1) ? t * t * t * t : t) * tc->maxLinear * 1.01);
+        float approximated = linear;
+        avifTransferCurveApply(&curve, &approximated, 1);
+        const float exact = toGamma(linear);
+        const double error = fabs((double)approximated - (double)exact);
+        if (error > maxError) {
+            maxError = error;
+            worstLinear = linear;
+        }
+        for (int d = 0; d < 4; ++d) {
+            const float maxChannelF = (float)((1 << depths[d]) - 1);
+            const int move = abs((int)toSample(approximated, maxChannelF) - (int)toSample(exact, maxChannelF));
+            moved[d] += (move != 0);
+            maxMove = (move > maxMove) ? move : maxMove;
+        }
+    }
+    int failed = (maxError > MAX_CURVE_ERROR) || (maxMove > 1);
+    for (int d = 0; d < 4; ++d) {
+        failed |= ((double)moved[d] / CURVE_SAMPLES > maxMovedRatios[d]);
+    }
+    printf("%s %-8s max error %.2e (at linear %g), samples moved by one code value: 8-bit %.4f%%, 10-bit %.4f%%, "
+           "12-bit %.4f%%, 16-bit %.4f%%\n",
+           failed ? "FAIL" : "ok  ",
+           tc->name,
+           maxError,
+           worstLinear,
+           100.0 * moved[0] / CURVE_SAMPLES,
+           100.0 * moved[1] / CURVE_SAMPLES,
+           100.0 * moved[2] / CURVE_SAMPLES,
+           100.0 * moved[3] / CURVE_SAMPLES);
+    return failed;
+}
+
+static int checkGammaToLinearTables(const TransferCharacteristics * tc)
+{
+    int failed = 0;
+    const avifTransferFunction toLinear = avifTransferCharacteristicsGetGammaToLinearFunction(tc->atc);
+    avifGammaToLinearTables tables;
+    memset(&tables, 0, sizeof(tables));
+    const uint32_t depths[] = { 8, 10, 12, 16 };
+    for (int d = 0; d < 4; ++d) {
+        const uint32_t depth = depths[d];
+        const float * table = avifGammaToLinearTablesGet(&tables, tc->atc, depth);
+        if (table == NULL || avifGammaToLinearTablesGet(&tables, tc->atc, depth) != table) {
+            printf("FAIL %s %u-bit table is not built once\n", tc->name, depth);
+            failed = 1;
+            break;
+        }
+        const uint32_t maxValue = (1u << depth) - 1;
+        for (uint32_t v = 0; v <= maxValue; ++v) {
+            const float expected = toLinear(v / (float)maxValue);
+            if (memcmp(&table[v], &expected, sizeof(float)) != 0) {
+                printf("FAIL %s %u-bit table differs from the function at %u\n", tc->name, depth, v);
+                failed = 1;
+                break;
+            }
+        }
+    }
+    avifGammaToLinearTablesFree(&tables);
+    return failed;
+}
+
+int main(void)
+{
+    const TransferCharacteristics transferCharacteristics[] = {
+        { AVIF_TRANSFER_CHARACTERISTICS_BT709, "BT.709", 1.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_BT470M, "BT.470M", 1.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_BT470BG, "BT.470BG", 1.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_SMPTE240, "SMPTE240", 1.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_SRGB, "sRGB", 1.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_PQ, "PQ", 10000.0f / 203.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_HLG, "HLG", 1000.0f / 203.0f },
+        // Not tabulated, exact.
+        { AVIF_TRANSFER_CHARACTERISTICS_LINEAR, "linear", 1.0f },
+        { AVIF_TRANSFER_CHARACTERISTICS_LOG100, "log100", 1.0f },
+    };
+    int failures = 0;
+    for (size_t i = 0; i < sizeof(transferCharacteristics) / sizeof(transferCharacteristics[0]); ++i) {
+        failures += checkCurve(&transferCharacteristics[i]);
+        failures += checkGammaToLinearTables(&transferCharacteristics[i]);
+    }
+    if (failures != 0) {
+        printf("%d transfer curve checks failed\n", failures);
+        return 1;
+    }
+    printf("transfer curves are within %g of the exact functions\n", MAX_CURVE_ERROR);
+    return 0;
+}
@@ -0,0 +1,143 @@
+// avifImageYUVToRGB() splits images in bands of rows when rgb->maxThreads is above one. The output must be the same,
+// byte for byte, as the one of a single job, for every path the bands can take.
+
+#include "avif/avif.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t randomState = 7;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static avifImage * createRandomImage(uint32_t width, uint32_t height, uint32_t depth, avifPixelFormat format)
+{
+    avifImage * image = avifImageCreate(width, height, depth, format);
+    if (!image || avifImageAllocatePlanes(image, AVIF_PLANES_ALL) != AVIF_RESULT_OK) {
+        avifImageDestroy(image);
+        return NULL;
+    }
+    image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT601;
+    const uint32_t maxChannel = (1u << depth) - 1;
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+        uint8_t * row = avifImagePlane(image, plane);
+        if (!row) {
+            continue;
+        }
+        const uint32_t rowBytes = avifImagePlaneRowBytes(image, plane);
+        for (uint32_t j = 0; j < avifImagePlaneHeight(image, plane); ++j, row += rowBytes) {
+            for (uint32_t i = 0; i < avifImagePlaneWidth(image, plane); ++i) {
+                const uint32_t value = nextRandom() & maxChannel;
+                if (depth == 8) {
+                    row[i] = (uint8_t)value;
+                } else {
+                    ((uint16_t *)row)[i] = (uint16_t)value;
+                }
+            }
+        }
+    }
+    return image;
+}
+
+typedef struct Options
+{
+    avifRGBFormat format;
+    uint32_t depth;
+    avifChromaUpsampling upsampling;
+    avifBool alphaPremultiplied;
+} Options;
+
+static avifResult convert(const avifImage * image, const Options * options, int maxThreads, avifRGBImage * rgb)
+{
+    avifRGBImageSetDefaults(rgb, image);
+    rgb->format = options->format;
+    rgb->depth = options->depth;
+    rgb->chromaUpsampling = options->upsampling;
+    rgb->alphaPremultiplied = options->alphaPremultiplied;
+    rgb->maxThreads = maxThreads;
+    avifResult result = avifRGBImageAllocatePixels(rgb);
+    if (result == AVIF_RESULT_OK) {
+        // Padding bytes, if any, compare equal.
+        memset(rgb->pixels, 0, (size_t)rgb->rowBytes * rgb->height);
+        result = avifImageYUVToRGB(image, rgb);
+    }
+    return result;
+}
+
+// Returns the number of thread counts whose output differs from the single job one.
+static int compareBands(const avifImage * image, const Options * options)
+{
+    avifRGBImage single;
+    int failures = 0;
+    if (convert(image, options, 1, &single) != AVIF_RESULT_OK) {
+        avifRGBImageFreePixels(&single);
+        printf("FAIL single job conversion\n");
+        return 1;
+    }
+    for (int maxThreads = 2; maxThreads <= 9; ++maxThreads) {
+        avifRGBImage banded;
+        const avifResult result = convert(image, options, maxThreads, &banded);
+        if (result != AVIF_RESULT_OK || memcmp(single.pixels, banded.pixels, (size_t)single.rowBytes * single.height) != 0) {
+            printf("FAIL %ux%u depth %u %s -> format %d depth %u, upsampling %d%s, %d threads: %s\n",
+                   image->width,
+                   image->height,
+                   image->depth,
+                   avifPixelFormatToString(image->yuvFormat),
+                   (int)options->format,
+                   options->depth,
+                   (int)options->upsampling,
+                   options->alphaPremultiplied ? ", premultiplied" : "",
+                   maxThreads,
+                   result == AVIF_RESULT_OK ? "output differs" : avifResultToString(result));
+            ++failures;
+        }
+        avifRGBImageFreePixels(&banded);
+    }
+    avifRGBImageFreePixels(&single);
+    return failures;
+}
+
+int main(void)
+{
+    const uint32_t depths[] = { 8, 10, 12 };
+    const avifPixelFormat formats[] = { AVIF_PIXEL_FORMAT_YUV444, AVIF_PIXEL_FORMAT_YUV422, AVIF_PIXEL_FORMAT_YUV420, AVIF_PIXEL_FORMAT_YUV400 };
+    // Heights below 2 rows per band, odd heights and heights that leave a short last band.
+    const uint32_t heights[] = { 3, 17, 32, 61 };
+    const Options options[] = {
+        { AVIF_RGB_FORMAT_RGBA, 8, AVIF_CHROMA_UPSAMPLING_AUTOMATIC, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_BGR, 8, AVIF_CHROMA_UPSAMPLING_NEAREST, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_RGB_565, 8, AVIF_CHROMA_UPSAMPLING_BILINEAR, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_RGBA, 8, AVIF_CHROMA_UPSAMPLING_BILINEAR, AVIF_TRUE },
+        { AVIF_RGB_FORMAT_RGB, 8, AVIF_CHROMA_UPSAMPLING_BILINEAR, AVIF_TRUE },
+        { AVIF_RGB_FORMAT_ARGB, 16, AVIF_CHROMA_UPSAMPLING_BILINEAR, AVIF_FALSE },
+        { AVIF_RGB_FORMAT_BGRA, 10, AVIF_CHROMA_UPSAMPLING_BILINEAR, AVIF_FALSE },
+    };
+    int failures = 0;
+    int comparisons = 0;
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d) {
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+            for (size_t h = 0; h < sizeof(heights) / sizeof(heights[0]); ++h) {
+                avifImage * image = createRandomImage(37, heights[h], depths[d], formats[f]);
+                if (!image) {
+                    fprintf(stderr, "image allocation failed\n");
+                    return 1;
+                }
+                for (size_t o = 0; o < sizeof(options) / sizeof(options[0]); ++o) {
+                    failures += compareBands(image, &options[o]);
+                    ++comparisons;
+                }
+                avifImageDestroy(image);
+            }
+        }
+    }
+    if (failures != 0) {
+        printf("%d banded conversions differ from a single job\n", failures);
+        return 1;
+    }
+    printf("%d configurations, banded output is the same as a single job for 2 to 9 threads\n", comparisons);
+    return 0;
+}
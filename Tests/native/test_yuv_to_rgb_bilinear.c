@@ -0,0 +1,250 @@
+// Checks that the bilinear YUV to RGB path for 4:2:0 and 4:2:2 images gives the same output, byte for byte, as
+// avifImageYUVAnyToRGBAnySlow(), which converted these images before it (there is no libyuv here). The slow path is
+// reproduced below: premultiplied outputs still go through the real one, so they check the reproduction itself.
+
+#include "avif/internal.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static uint32_t randomState = 1;
+
+static uint32_t nextRandom(void)
+{
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+static avifImage * createRandomImage(uint32_t width, uint32_t height, uint32_t depth, avifPixelFormat format, avifRange range, avifMatrixCoefficients matrix)
+{
+    avifImage * image = avifImageCreate(width, height, depth, format);
+    if (!image || avifImageAllocatePlanes(image, AVIF_PLANES_ALL) != AVIF_RESULT_OK) {
+        if (image) {
+            avifImageDestroy(image);
+        }
+        return NULL;
+    }
+    image->yuvRange = range;
+    image->matrixCoefficients = matrix;
+    const uint32_t maxChannel = (1u << depth) - 1;
+    for (int plane = AVIF_CHAN_Y; plane <= AVIF_CHAN_A; ++plane) {
+        const uint32_t planeWidth = avifImagePlaneWidth(image, plane);
+        const uint32_t planeHeight = avifImagePlaneHeight(image, plane);
+        uint8_t * row = avifImagePlane(image, plane);
+        const uint32_t rowBytes = avifImagePlaneRowBytes(image, plane);
+        for (uint32_t j = 0; j < planeHeight; ++j, row += rowBytes) {
+            for (uint32_t i = 0; i < planeWidth; ++i) {
+                // Mostly smooth content with some full-scale noise, so that the chroma filter sees both.
+                uint32_t value = (nextRandom() % 8 == 0) ? nextRandom() : (i * 7 + j * 3 + (uint32_t)plane * 50);
+                if (depth == 8) {
+                    row[i] = (uint8_t)value;
+                } else {
+                    // A few samples above the depth, which both paths clamp.
+                    ((uint16_t *)row)[i] = (uint16_t)((nextRandom() % 64 == 0) ? value : (value & maxChannel));
+                }
+            }
+        }
+    }
+    return image;
+}
+
+static uint16_t sampleAt(const avifImage * image, int plane, uint32_t x, uint32_t y)
+{
+    const uint8_t * row = &avifImagePlane(image, plane)[(size_t)y * avifImagePlaneRowBytes(image, plane)];
+    if (image->depth == 8) {
+        return row[x];
+    }
+    return AVIF_MIN(((const uint16_t *)row)[x], (uint16_t)((1u << image->depth) - 1));
+}
+
+// avifImageYUVAnyToRGBAnySlow() for YUV coefficients and bilinear upsampling, written for one pixel at a time.
+static avifBool convertReference(const avifImage * image, avifRGBImage * rgb)
+{
+    avifRGBColorSpaceInfo rgbInfo;
+    avifYUVColorSpaceInfo yuvInfo;
+    if (!avifGetRGBColorSpaceInfo(rgb, &rgbInfo) || !avifGetYUVColorSpaceInfo(image, &yuvInfo)) {
+        return AVIF_FALSE;
+    }
+    const float kr = yuvInfo.kr;
+    const float kg = yuvInfo.kg;
+    const float kb = yuvInfo.kb;
+    const uint32_t shiftX = yuvInfo.formatInfo.chromaShiftX;
+    const uint32_t shiftY = yuvInfo.formatInfo.chromaShiftY;
+    for (uint32_t j = 0; j < image->height; ++j) {
+        for (uint32_t i = 0; i < image->width; ++i) {
+            const uint32_t uvI = i >> shiftX;
+            const uint32_t uvJ = j >> shiftY;
+            uint32_t adjI = uvI;
+            if ((i != 0) && !((i == image->width - 1) && (i % 2) != 0)) {
+                adjI = (i % 2) ? uvI + 1 : uvI - 1;
+            }
+            uint32_t adjJ = uvJ;
+            if ((j != 0) && !((j == image->height - 1) && (j % 2) != 0) && (image->yuvFormat != AVIF_PIXEL_FORMAT_YUV422)) {
+                adjJ = (j % 2) ? uvJ + 1 : uvJ - 1;
+            }
+            float chroma[2];
+            for (int c = 0; c < 2; ++c) {
+                const int plane = AVIF_CHAN_U + c;
+                const float closest = ((float)sampleAt(image, plane, uvI, uvJ) - yuvInfo.biasUV) / yuvInfo.rangeUV;
+                const float adjacentCol = ((float)sampleAt(image, plane, adjI, uvJ) - yuvInfo.biasUV) / yuvInfo.rangeUV;
+                const float adjacentRow = ((float)sampleAt(image, plane, uvI, adjJ) - yuvInfo.biasUV) / yuvInfo.rangeUV;
+                const float diagonal = ((float)sampleAt(image, plane, adjI, adjJ) - yuvInfo.biasUV) / yuvInfo.rangeUV;
+                chroma[c] = (closest * (9.0f / 16.0f)) + (adjacentCol * (3.0f / 16.0f)) + (adjacentRow * (3.0f / 16.0f)) +
+                            (diagonal * (1.0f / 16.0f));
+            }
+            const float Y = ((float)sampleAt(image, AVIF_CHAN_Y, i, j) - yuvInfo.biasY) / yuvInfo.rangeY;
+            const float Cb = chroma[0];
+            const float Cr = chroma[1];
+            const float R = Y + (2 * (1 - kr)) * Cr;
+            const float B = Y + (2 * (1 - kb)) * Cb;
+            const float G = Y - ((2 * ((kr * (1 - kr) * Cr) + (kb * (1 - kb) * Cb))) / kg);
+            float rgba[4] = { AVIF_CLAMP(R, 0.0f, 1.0f), AVIF_CLAMP(G, 0.0f, 1.0f), AVIF_CLAMP(B, 0.0f, 1.0f), 1.0f };
+            // Like avifImageYUVToRGB(), alpha is multiplied in when requested or when the RGB format drops it.
+            if (image->alphaPlane && (rgb->alphaPremultiplied || !avifRGBFormatHasAlpha(rgb->format))) {
+                const float A = sampleAt(image, AVIF_CHAN_A, i, j) / ((float)yuvInfo.maxChannel);
+                for (int c = 0; c < 3; ++c) {
+                    if (A == 0.0f) {
+                        rgba[c] = 0.0f;
+                    } else if (A < 1.0f) {
+                        rgba[c] *= A;
+                    }
+                }
+            }
+            uint8_t * pixel = &rgb->pixels[(size_t)j * rgb->rowBytes + (size_t)i * rgbInfo.pixelBytes];
+            uint32_t values[3];
+            for (int c = 0; c < 3; ++c) {
+                values[c] = (rgb->depth == 8) ? (uint8_t)(0.5f + (rgba[c] * rgbInfo.maxChannelF))
+                                              : (uint16_t)(0.5f + (rgba[c] * rgbInfo.maxChannelF));
+            }
+            if (rgb->format == AVIF_RGB_FORMAT_RGB_565) {
+                *(uint16_t *)pixel = (uint16_t)((values[2] >> 3) | ((values[1] >> 2) << 5) | ((values[0] >> 3) << 11));
+            } else if (rgb->depth == 8) {
+                pixel[rgbInfo.offsetBytesR] = (uint8_t)values[0];
+                pixel[rgbInfo.offsetBytesG] = (uint8_t)values[1];
+                pixel[rgbInfo.offsetBytesB] = (uint8_t)values[2];
+            } else {
+                *(uint16_t *)&pixel[rgbInfo.offsetBytesR] = (uint16_t)values[0];
+                *(uint16_t *)&pixel[rgbInfo.offsetBytesG] = (uint16_t)values[1];
+                *(uint16_t *)&pixel[rgbInfo.offsetBytesB] = (uint16_t)values[2];
+            }
+            if (avifRGBFormatHasAlpha(rgb->format)) {
+                const uint32_t maxChannel = (uint32_t)rgbInfo.maxChannel;
+                const uint32_t alpha = (uint32_t)sampleAt(image, AVIF_CHAN_A, i, j);
+                // Same alpha as avifImageYUVToRGB() copies, for depths that are equal or 8 and 16.
+                uint32_t a = alpha;
+                if (image->depth != rgb->depth) {
+                    a = (uint32_t)(0.5f + (alpha / (float)((1u << image->depth) - 1)) * (float)maxChannel);
+                }
+                if (rgb->depth == 8) {
+                    pixel[rgbInfo.offsetBytesA] = (uint8_t)a;
+                } else {
+                    *(uint16_t *)&pixel[rgbInfo.offsetBytesA] = (uint16_t)a;
+                }
+            }
+        }
+    }
+    return AVIF_TRUE;
+}
+
+static int compareToReference(const avifImage * image, avifRGBFormat format, uint32_t rgbDepth, avifBool alphaPremultiplied, int maxThreads)
+{
+    avifRGBImage converted;
+    avifRGBImage reference;
+    avifRGBImageSetDefaults(&converted, image);
+    converted.format = format;
+    converted.depth = rgbDepth;
+    converted.alphaPremultiplied = alphaPremultiplied;
+    converted.chromaUpsampling = AVIF_CHROMA_UPSAMPLING_BILINEAR;
+    converted.maxThreads = maxThreads;
+    reference = converted;
+    int failed = 1;
+    if (avifRGBImageAllocatePixels(&converted) != AVIF_RESULT_OK || avifRGBImageAllocatePixels(&reference) != AVIF_RESULT_OK) {
+        fprintf(stderr, "allocation failed\n");
+        goto cleanup;
+    }
+    memset(converted.pixels, 0, (size_t)converted.rowBytes * converted.height);
+    memset(reference.pixels, 0, (size_t)reference.rowBytes * reference.height);
+    if (avifImageYUVToRGB(image, &converted) != AVIF_RESULT_OK || !convertReference(image, &reference)) {
+        fprintf(stderr, "conversion failed\n");
+        goto cleanup;
+    }
+
+    // Alpha is not compared, it does not go through either path.
+    const uint32_t pixelSize = avifRGBImagePixelSize(&converted);
+    const uint32_t colorBytes = (format == AVIF_RGB_FORMAT_RGB_565) ? 2 : pixelSize;
+    avifRGBColorSpaceInfo info;
+    if (!avifGetRGBColorSpaceInfo(&converted, &info)) {
+        goto cleanup;
+    }
+    uint32_t mismatches = 0;
+    for (uint32_t j = 0; j < image->height; ++j) {
+        for (uint32_t i = 0; i < image->width; ++i) {
+            const size_t offset = (size_t)j * converted.rowBytes + (size_t)i * pixelSize;
+            for (uint32_t b = 0; b < colorBytes; ++b) {
+                const avifBool isAlpha = avifRGBFormatHasAlpha(format) && (b / info.channelBytes == info.offsetBytesA / info.channelBytes);
+                if (!isAlpha && converted.pixels[offset + b] != reference.pixels[offset + b]) {
+                    ++mismatches;
+                }
+            }
+        }
+    }
+    failed = (mismatches != 0);
+    printf("%s depth %u %s%s %s matrix %d -> format %d depth %u%s, %d threads: %u bytes differ\n",
+           failed ? "FAIL" : "ok  ",
+           image->depth,
+           avifPixelFormatToString(image->yuvFormat),
+           image->alphaPlane ? "+alpha" : "",
+           image->yuvRange == AVIF_RANGE_FULL ? "full" : "limited",
+           (int)image->matrixCoefficients,
+           (int)format,
+           rgbDepth,
+           alphaPremultiplied ? " premultiplied" : "",
+           maxThreads,
+           mismatches);
+
+cleanup:
+    avifRGBImageFreePixels(&converted);
+    avifRGBImageFreePixels(&reference);
+    return failed;
+}
+
+int main(void)
+{
+    const uint32_t depths[] = { 8, 10, 12 };
+    const avifPixelFormat formats[] = { AVIF_PIXEL_FORMAT_YUV420, AVIF_PIXEL_FORMAT_YUV422 };
+    const avifRange ranges[] = { AVIF_RANGE_FULL, AVIF_RANGE_LIMITED };
+    const avifMatrixCoefficients matrices[] = { AVIF_MATRIX_COEFFICIENTS_BT601, AVIF_MATRIX_COEFFICIENTS_BT709, AVIF_MATRIX_COEFFICIENTS_BT2020_NCL };
+    int failures = 0;
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); ++d) {
+        for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f) {
+            for (size_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); ++r) {
+                for (size_t m = 0; m < sizeof(matrices) / sizeof(matrices[0]); ++m) {
+                    // Odd sizes, so that the last chroma column and row are only half covered.
+                    avifImage * image = createRandomImage(133, 61, depths[d], formats[f], ranges[r], matrices[m]);
+                    if (!image) {
+                        fprintf(stderr, "image allocation failed\n");
+                        return 1;
+                    }
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_RGBA, 8, AVIF_FALSE, 1);
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_RGBA, 10, AVIF_FALSE, 1);
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_ARGB, 16, AVIF_FALSE, 4);
+                    // Alpha multiplication, requested or into a format without alpha, is left to the slow path.
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_RGBA, 8, AVIF_TRUE, 1);
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_BGR, 8, AVIF_FALSE, 3);
+                    // Without alpha, formats without alpha take the bilinear path too.
+                    avifImageFreePlanes(image, AVIF_PLANES_A);
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_BGR, 8, AVIF_FALSE, 1);
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_RGB_565, 8, AVIF_FALSE, 1);
+                    failures += compareToReference(image, AVIF_RGB_FORMAT_RGB, 16, AVIF_FALSE, 2);
+                    avifImageDestroy(image);
+                }
+            }
+        }
+    }
+    if (failures != 0) {
+        printf("%d comparisons failed\n", failures);
+        return 1;
+    }
+    printf("the bilinear path matches avifImageYUVAnyToRGBAnySlow() exactly\n");
+    return 0;
+}